@@ -0,0 +1,78 @@
+// Stands in for graphics.cpp and mesh.cpp when there is no OpenGL context, so the example scenes can be set up and
+// stepped without a window. Meshes are still cooked (and cached) when a scene loads them, but never uploaded, and
+// drawing does nothing.
+#include "graphics.h"
+#include "mesh.h"
+#include "obj.h"
+#include "light_array.h"
+
+Shader graphics_shader_create(const s8* vertex_shader_path, const s8* fragment_shader_path) {
+	return 0;
+}
+
+void graphics_entity_render_data_set(eid id, Mesh mesh, vec3 world_scale, vec4 color) {
+}
+
+Entity_Render_Data* graphics_entity_render_data_get(eid id) {
+	return NULL;
+}
+
+void graphics_entity_render_data_destroy(eid id) {
+}
+
+void graphics_entity_render_basic_shader(const Perspective_Camera* camera, const Entity* entity) {
+}
+
+void graphics_entity_render_phong_shader(const Perspective_Camera* camera, const Entity* entity, const Light* lights) {
+}
+
+void graphics_entities_render_phong_shader(const Perspective_Camera* camera, Entity** entities, const Light* lights) {
+}
+
+void graphics_transforms_render_phong_shader(const Perspective_Camera* camera, const Render_Transform* transforms,
+	const Light* lights) {
+}
+
+void graphics_light_create(Light* light, vec3 position, vec4 ambient_color, vec4 diffuse_color, vec4 specular_color) {
+	light->position = position;
+	light->ambient_color = ambient_color;
+	light->diffuse_color = diffuse_color;
+	light->specular_color = specular_color;
+}
+
+void graphics_set_wireframe(boolean wireframe) {
+}
+
+void graphics_renderer_primitives_flush(const Perspective_Camera* camera) {
+}
+
+void graphics_renderer_debug_points(vec3* points, int point_count, vec4 color) {
+}
+
+void graphics_renderer_debug_vector(vec3 p1, vec3 p2, vec4 color) {
+}
+
+Mesh graphics_mesh_create_from_obj(const s8* obj_path) {
+	Vertex* vertices;
+	u32* indices;
+	obj_parse(obj_path, &vertices, &indices);
+	Mesh m = graphics_mesh_create(vertices, indices);
+	array_free(vertices);
+	array_free(indices);
+	return m;
+}
+
+Mesh graphics_quad_create() {
+	Mesh m = {0};
+	m.num_indices = 6;
+	return m;
+}
+
+Mesh graphics_mesh_create(Vertex* vertices, u32* indices) {
+	Mesh m = {0};
+	m.num_indices = array_length(indices);
+	return m;
+}
+
+void mesh_destroy(Mesh* mesh) {
+}
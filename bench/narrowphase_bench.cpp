@@ -0,0 +1,523 @@
+// Measures the narrowphase queries on their own: support points, GJK, EPA and clipping, each over a whole set of collider pairs
+// in fixed poses. Reports the time per query, the hit and failure rates, and histograms of the GJK and EPA iterations.
+//
+// Usage: narrowphase_bench [options] [pose set...]
+// Pose sets are recorded from the scenes with 'physics_bench --dump-poses PATH' (see pose_set.h), and are split by the
+// types of the colliders. Unless --no-generated is given, random poses of a few shape combinations are run too:
+// cube-cube, cube-cylinder, spot hull pairs and sphere-hull. Run it from the root of the repository, so the spot hull is found.
+//   --poses N        Number of generated poses per shape combination (default 10000)
+//   --rounds N       Number of times each query runs over the whole set, the time is the average (default 20)
+//   --seed N         Seed of the generated poses (default 1)
+//   --no-generated   Only runs the given pose sets
+//
+// All queries run as they are, even for pairs that the simulation handles with SAT or analytically (e.g. two boxes or two
+// spheres), so the numbers show the cost of GJK and EPA themselves. For timings, build in release and without the profiler
+// (-DRAW_PHYSICS_PROFILE=OFF), whose timers around GJK, EPA and clipping are not free at this scale.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "common.h"
+#include "light_array.h"
+#include "gjk.h"
+#include "epa.h"
+#include "clipping.h"
+#include "support.h"
+#include "arena.h"
+#include "util.h"
+#include "obj.h"
+#include "cache.h"
+#include "pose_set.h"
+
+#define NUM_HISTOGRAM_BUCKETS 8
+
+// Each bucket holds the iteration counts up to its limit, and more than the limit of the previous bucket
+static const u32 histogram_bucket_limits[NUM_HISTOGRAM_BUCKETS] = {1, 2, 4, 8, 16, 32, 64, UINT32_MAX};
+
+typedef struct {
+	u32 num_poses;
+	u32 num_rounds;
+	u64 seed;
+	boolean run_generated;
+} Bench_Options;
+
+// Every pair has its own colliders, already updated to the pose of the pair, so the queries can run back to back.
+// Each collider is kept in a light array of its own, as 'colliders_update' and 'colliders_destroy' expect.
+typedef struct {
+	Collider* colliders1;
+	Collider* colliders2;
+	// For the support point queries
+	vec3 direction;
+} Bench_Pair;
+
+typedef struct {
+	char name[64];
+	Bench_Pair* pairs;
+} Bench_Set;
+
+typedef struct {
+	r64 support_ns;
+	r64 gjk_ns;
+	r64 epa_ns;
+	r64 clipping_ns;
+	u32 num_pairs;
+	u32 num_gjk_hits;
+	u32 num_gjk_failures;
+	u32 num_epa_failures;
+	u32 num_contacts;
+	u32 gjk_histogram[NUM_HISTOGRAM_BUCKETS];
+	u32 epa_histogram[NUM_HISTOGRAM_BUCKETS];
+} Bench_Result;
+
+// The input of EPA and clipping, found once before timing them
+typedef struct {
+	u32 pair_idx;
+	GJK_Simplex simplex;
+	boolean epa_converged;
+	vec3 normal;
+	r64 penetration;
+} Bench_Hit;
+
+static void print_usage(const char* program) {
+	fprintf(stderr, "usage: %s [--poses N] [--rounds N] [--seed N] [--no-generated] [pose set...]\n", program);
+}
+
+static const char* get_collider_type_name(Collider_Type type) {
+	switch (type) {
+		case COLLIDER_TYPE_SPHERE: return "sphere";
+		case COLLIDER_TYPE_CONVEX_HULL: return "hull";
+		case COLLIDER_TYPE_BOX: return "box";
+		case COLLIDER_TYPE_CAPSULE: return "capsule";
+		case COLLIDER_TYPE_CYLINDER: return "cylinder";
+	}
+	return "unknown";
+}
+
+static Collider* create_single_collider_array(Collider collider) {
+	Collider* colliders = array_new_len(Collider, 1);
+	array_push(colliders, collider);
+	return colliders;
+}
+
+// Spheres and primitives are copied, hulls get a new collider that shares the shape.
+static Collider copy_collider(const Collider* collider) {
+	if (collider->type == COLLIDER_TYPE_CONVEX_HULL) {
+		return collider_convex_hull_create_from_shape(collider->convex_hull.shape);
+	}
+	return *collider;
+}
+
+static void add_pair(Bench_Set* set, const Collider* collider1, vec3 position1, Quaternion rotation1, const Collider* collider2,
+	vec3 position2, Quaternion rotation2, vec3 direction) {
+	Bench_Pair pair;
+	pair.colliders1 = create_single_collider_array(copy_collider(collider1));
+	pair.colliders2 = create_single_collider_array(copy_collider(collider2));
+	pair.direction = direction;
+	colliders_update(pair.colliders1, position1, &rotation1);
+	colliders_update(pair.colliders2, position2, &rotation2);
+	array_push(set->pairs, pair);
+}
+
+static void set_destroy(Bench_Set* set) {
+	for (u32 i = 0; i < array_length(set->pairs); ++i) {
+		colliders_destroy(set->pairs[i].colliders1);
+		colliders_destroy(set->pairs[i].colliders2);
+		array_free(set->pairs[i].colliders1);
+		array_free(set->pairs[i].colliders2);
+	}
+	array_free(set->pairs);
+}
+
+static vec3 random_direction(Util_Random* random) {
+	for (;;) {
+		vec3 v = {
+			util_random_float(random, -1.0, 1.0),
+			util_random_float(random, -1.0, 1.0),
+			util_random_float(random, -1.0, 1.0)
+		};
+		r64 length = gm_vec3_length(v);
+		if (length > 1e-3 && length <= 1.0) {
+			return gm_vec3_scalar_product(1.0 / length, v);
+		}
+	}
+}
+
+static Quaternion random_rotation(Util_Random* random) {
+	return quaternion_new_radians(random_direction(random), util_random_float(random, -PI_F, PI_F));
+}
+
+// Collider 1 sits at the origin, collider 2 anywhere from the center of collider 1 to where their bounding spheres touch,
+// both with random orientations. This gives a mix of deep, shallow and no contacts.
+static void generate_set(Bench_Set* set, const char* name, Collider collider1, Collider collider2, const Bench_Options* options) {
+	snprintf(set->name, sizeof(set->name), "%s", name);
+	set->pairs = array_new_len(Bench_Pair, options->num_poses);
+
+	Collider* colliders1 = create_single_collider_array(copy_collider(&collider1));
+	Collider* colliders2 = create_single_collider_array(copy_collider(&collider2));
+	r64 max_distance = colliders_get_bounding_sphere_radius(colliders1) + colliders_get_bounding_sphere_radius(colliders2);
+
+	Util_Random random;
+	util_random_init(&random, options->seed);
+	for (u32 i = 0; i < options->num_poses; ++i) {
+		Quaternion rotation1 = random_rotation(&random);
+		Quaternion rotation2 = random_rotation(&random);
+		vec3 position2 = gm_vec3_scalar_product(util_random_float(&random, 0.0, max_distance), random_direction(&random));
+		vec3 direction = random_direction(&random);
+		add_pair(set, &collider1, {0.0, 0.0, 0.0}, rotation1, &collider2, position2, rotation2, direction);
+	}
+
+	colliders_destroy(colliders1);
+	colliders_destroy(colliders2);
+	array_free(colliders1);
+	array_free(colliders2);
+}
+
+// The spot models are made of convex pieces, the first one is used for the hull pairs. It is moved to be centered at the
+// origin, since the poses are generated around the origin of the colliders.
+static Collider_Convex_Hull_Shape* load_spot_hull_shape() {
+	Vertex* vertices;
+	u32* indices;
+	if (obj_parse("./res/spot/spot-hull-1.obj", &vertices, &indices) != 0) {
+		return NULL;
+	}
+
+	const r64 SCALE = 2.0;
+	vec3* points = array_new_len(vec3, array_length(vertices));
+	vec3 center = {0.0, 0.0, 0.0};
+	for (u32 i = 0; i < array_length(vertices); ++i) {
+		vec3 point = {SCALE * vertices[i].position.x, SCALE * vertices[i].position.y, SCALE * vertices[i].position.z};
+		center = gm_vec3_add(center, gm_vec3_scalar_product(1.0 / array_length(vertices), point));
+		array_push(points, point);
+	}
+	for (u32 i = 0; i < array_length(points); ++i) {
+		points[i] = gm_vec3_subtract(points[i], center);
+	}
+
+	Collider_Convex_Hull_Shape* shape = collider_convex_hull_shape_create(points, 0);
+	array_free(points);
+	array_free(vertices);
+	array_free(indices);
+	return shape;
+}
+
+static void generate_sets(Bench_Set** sets, const Bench_Options* options) {
+	Collider cube = collider_box_create({0.5, 0.5, 0.5});
+	Collider cylinder = collider_cylinder_create(0.5, 0.5);
+	Collider sphere = collider_sphere_create(0.5f);
+
+	Bench_Set set;
+	generate_set(&set, "cube-cube", cube, cube, options);
+	array_push(*sets, set);
+	generate_set(&set, "cube-cylinder", cube, cylinder, options);
+	array_push(*sets, set);
+
+	Collider_Convex_Hull_Shape* spot_shape = load_spot_hull_shape();
+	if (!spot_shape) {
+		fprintf(stderr, "failed to load the spot hull, run from the root of the repository to include the hull pairs\n");
+		return;
+	}
+
+	Collider spot = collider_convex_hull_create_from_shape(spot_shape);
+	generate_set(&set, "spot-spot", spot, spot, options);
+	array_push(*sets, set);
+	generate_set(&set, "sphere-spot", sphere, spot, options);
+	array_push(*sets, set);
+
+	Collider* spot_colliders = create_single_collider_array(spot);
+	colliders_destroy(spot_colliders);
+	array_free(spot_colliders);
+	collider_convex_hull_shape_release(spot_shape);
+}
+
+// The pairs of the pose set are split by collider types, with the types of each pair in a fixed order.
+static void add_recorded_sets(Bench_Set** sets, const Pose_Set* pose_set, const char* path) {
+	const char* file_name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+	// Colliders of the shapes, which the colliders of the pairs copy
+	Collider* shape_colliders = array_new_len(Collider, array_length(pose_set->shapes));
+	for (u32 i = 0; i < array_length(pose_set->shapes); ++i) {
+		const Pose_Set_Shape* shape = &pose_set->shapes[i];
+		Collider collider;
+		switch (shape->type) {
+			case COLLIDER_TYPE_SPHERE: collider = collider_sphere_create((r32)shape->radius); break;
+			case COLLIDER_TYPE_BOX: collider = collider_box_create(shape->half_extents); break;
+			case COLLIDER_TYPE_CAPSULE: collider = collider_capsule_create(shape->radius, shape->half_height); break;
+			case COLLIDER_TYPE_CYLINDER: collider = collider_cylinder_create(shape->radius, shape->half_height); break;
+			case COLLIDER_TYPE_CONVEX_HULL: default: {
+				// The vertices are already the vertices of a hull, so the hull of them is the same hull
+				collider = collider_convex_hull_create(shape->vertices, 0);
+			} break;
+		}
+		array_push(shape_colliders, collider);
+	}
+
+	u32 first_set = array_length(*sets);
+	for (u32 i = 0; i < array_length(pose_set->pairs); ++i) {
+		Pose_Set_Pair pair = pose_set->pairs[i];
+		if (pose_set->shapes[pair.shape1].type > pose_set->shapes[pair.shape2].type) {
+			pair.shape1 = pose_set->pairs[i].shape2;
+			pair.position1 = pose_set->pairs[i].position2;
+			pair.rotation1 = pose_set->pairs[i].rotation2;
+			pair.shape2 = pose_set->pairs[i].shape1;
+			pair.position2 = pose_set->pairs[i].position1;
+			pair.rotation2 = pose_set->pairs[i].rotation1;
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "%s %s-%s", file_name, get_collider_type_name(pose_set->shapes[pair.shape1].type),
+			get_collider_type_name(pose_set->shapes[pair.shape2].type));
+
+		u32 set_idx;
+		for (set_idx = first_set; set_idx < array_length(*sets); ++set_idx) {
+			if (!strcmp((*sets)[set_idx].name, name)) break;
+		}
+		if (set_idx == array_length(*sets)) {
+			Bench_Set set;
+			snprintf(set.name, sizeof(set.name), "%s", name);
+			set.pairs = array_new(Bench_Pair);
+			array_push(*sets, set);
+		}
+
+		// The direction of the support queries is the one from collider 1 to collider 2
+		vec3 direction = gm_vec3_subtract(pair.position2, pair.position1);
+		direction = gm_vec3_length(direction) > 1e-9 ? gm_vec3_normalize(direction) : vec3{0.0, 1.0, 0.0};
+		add_pair(&(*sets)[set_idx], &shape_colliders[pair.shape1], pair.position1, pair.rotation1,
+			&shape_colliders[pair.shape2], pair.position2, pair.rotation2, direction);
+	}
+
+	colliders_destroy(shape_colliders);
+	array_free(shape_colliders);
+}
+
+static void add_to_histogram(u32* histogram, u32 num_iterations) {
+	for (u32 i = 0; i < NUM_HISTOGRAM_BUCKETS; ++i) {
+		if (num_iterations <= histogram_bucket_limits[i]) {
+			++histogram[i];
+			return;
+		}
+	}
+}
+
+// Runs every query once, without timing, to find which pairs go through EPA and clipping and to count the iterations.
+static Bench_Hit* find_hits(const Bench_Set* set, Bench_Result* result) {
+	Bench_Hit* hits = array_new(Bench_Hit);
+	Arena* arena = arena_get_scratch();
+	Collider_Contact* contacts = array_new(Collider_Contact);
+
+	for (u32 i = 0; i < array_length(set->pairs); ++i) {
+		Bench_Pair* pair = &set->pairs[i];
+		Bench_Hit hit = {0};
+		hit.pair_idx = i;
+
+		GJK_Statistics gjk_statistics;
+		gjk_reset_statistics();
+		boolean collides = gjk_collides(pair->colliders1, pair->colliders2, &hit.simplex);
+		gjk_get_statistics(&gjk_statistics);
+		add_to_histogram(result->gjk_histogram, gjk_statistics.num_iterations);
+		result->num_gjk_failures += gjk_statistics.num_failures;
+		if (!collides) {
+			continue;
+		}
+		++result->num_gjk_hits;
+
+		Epa_Statistics epa_statistics;
+		epa_reset_statistics();
+		GJK_Simplex simplex = hit.simplex;
+		hit.epa_converged = epa(pair->colliders1, pair->colliders2, &simplex, &hit.normal, &hit.penetration);
+		epa_get_statistics(&epa_statistics);
+		add_to_histogram(result->epa_histogram, epa_statistics.num_iterations);
+		result->num_epa_failures += epa_statistics.num_failures;
+
+		if (hit.epa_converged) {
+			Arena_Marker marker = arena_get_marker(arena);
+			array_clear(contacts);
+			clipping_get_contact_manifold(pair->colliders1, pair->colliders2, hit.normal, hit.penetration, &contacts);
+			result->num_contacts += array_length(contacts);
+			arena_reset_to_marker(arena, marker);
+		}
+
+		array_push(hits, hit);
+	}
+
+	array_free(contacts);
+	return hits;
+}
+
+static r64 get_elapsed_ns(std::chrono::steady_clock::time_point begin, u32 num_queries) {
+	if (num_queries == 0) return 0.0;
+	return std::chrono::duration<r64, std::nano>(std::chrono::steady_clock::now() - begin).count() / num_queries;
+}
+
+static void run_set(const Bench_Set* set, const Bench_Options* options, Bench_Result* result) {
+	memset(result, 0, sizeof(Bench_Result));
+	u32 num_pairs = array_length(set->pairs);
+	result->num_pairs = num_pairs;
+
+	Bench_Hit* hits = find_hits(set, result);
+	u32 num_hits = array_length(hits);
+	u32 num_converged = 0;
+	for (u32 i = 0; i < num_hits; ++i) {
+		num_converged += hits[i].epa_converged ? 1 : 0;
+	}
+
+	// Summed into a volatile, so that the compiler can't drop the queries
+	volatile r64 sink = 0.0;
+
+	auto begin = std::chrono::steady_clock::now();
+	for (u32 round = 0; round < options->num_rounds; ++round) {
+		for (u32 i = 0; i < num_pairs; ++i) {
+			sink = sink + support_point(set->pairs[i].colliders1, set->pairs[i].direction).x;
+		}
+	}
+	result->support_ns = get_elapsed_ns(begin, options->num_rounds * num_pairs);
+
+	begin = std::chrono::steady_clock::now();
+	for (u32 round = 0; round < options->num_rounds; ++round) {
+		for (u32 i = 0; i < num_pairs; ++i) {
+			GJK_Simplex simplex;
+			sink = sink + gjk_collides(set->pairs[i].colliders1, set->pairs[i].colliders2, &simplex);
+		}
+	}
+	result->gjk_ns = get_elapsed_ns(begin, options->num_rounds * num_pairs);
+
+	begin = std::chrono::steady_clock::now();
+	for (u32 round = 0; round < options->num_rounds; ++round) {
+		for (u32 i = 0; i < num_hits; ++i) {
+			const Bench_Pair* pair = &set->pairs[hits[i].pair_idx];
+			GJK_Simplex simplex = hits[i].simplex;
+			vec3 normal;
+			r64 penetration;
+			sink = sink + epa(pair->colliders1, pair->colliders2, &simplex, &normal, &penetration);
+		}
+	}
+	result->epa_ns = get_elapsed_ns(begin, options->num_rounds * num_hits);
+
+	// The clipping allocates its temporaries in the scratch arena, like in the simulation, where it is reset every substep
+	Arena* arena = arena_get_scratch();
+	Collider_Contact* contacts = array_new_len(Collider_Contact, 16);
+	begin = std::chrono::steady_clock::now();
+	for (u32 round = 0; round < options->num_rounds; ++round) {
+		for (u32 i = 0; i < num_hits; ++i) {
+			if (!hits[i].epa_converged) continue;
+			const Bench_Pair* pair = &set->pairs[hits[i].pair_idx];
+			Arena_Marker marker = arena_get_marker(arena);
+			array_clear(contacts);
+			clipping_get_contact_manifold(pair->colliders1, pair->colliders2, hits[i].normal, hits[i].penetration, &contacts);
+			arena_reset_to_marker(arena, marker);
+		}
+	}
+	result->clipping_ns = get_elapsed_ns(begin, options->num_rounds * num_converged);
+	array_free(contacts);
+
+	array_free(hits);
+}
+
+static r64 percentage(u32 count, u32 total) {
+	return total > 0 ? 100.0 * count / total : 0.0;
+}
+
+static void print_histogram(const char* name, const u32* histogram) {
+	u32 total = 0;
+	for (u32 i = 0; i < NUM_HISTOGRAM_BUCKETS; ++i) {
+		total += histogram[i];
+	}
+
+	printf("    %-15s", name);
+	u32 previous_limit = 0;
+	for (u32 i = 0; i < NUM_HISTOGRAM_BUCKETS; ++i) {
+		char label[16];
+		u32 limit = histogram_bucket_limits[i];
+		if (limit == UINT32_MAX) {
+			snprintf(label, sizeof(label), "%u+", previous_limit + 1);
+		} else if (limit == previous_limit + 1) {
+			snprintf(label, sizeof(label), "%u", limit);
+		} else {
+			snprintf(label, sizeof(label), "%u-%u", previous_limit + 1, limit);
+		}
+		printf(" %6s: %5.1f%%", label, percentage(histogram[i], total));
+		previous_limit = limit;
+	}
+	printf("\n");
+}
+
+static void print_result(const char* name, const Bench_Result* r) {
+	printf("%-32s %8u %7.1f %10.1f %9.1f %8.2f %9.1f %8.2f %9.1f %9.2f\n", name, r->num_pairs,
+		percentage(r->num_gjk_hits, r->num_pairs), r->support_ns, r->gjk_ns, percentage(r->num_gjk_failures, r->num_pairs),
+		r->epa_ns, percentage(r->num_epa_failures, r->num_gjk_hits), r->clipping_ns,
+		r->num_gjk_hits > r->num_epa_failures ? (r64)r->num_contacts / (r->num_gjk_hits - r->num_epa_failures) : 0.0);
+	print_histogram("gjk iterations", r->gjk_histogram);
+	if (r->num_gjk_hits > 0) {
+		print_histogram("epa iterations", r->epa_histogram);
+	}
+}
+
+int main(int argc, char** argv) {
+	Bench_Options options;
+	options.num_poses = 10000;
+	options.num_rounds = 20;
+	options.seed = 1;
+	options.run_generated = true;
+
+	const char** pose_set_paths = array_new(const char*);
+	for (s32 i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		boolean has_value = i + 1 < argc;
+		if (!strcmp(arg, "--poses") && has_value) {
+			options.num_poses = (u32)strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--rounds") && has_value) {
+			options.num_rounds = (u32)strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--seed") && has_value) {
+			options.seed = strtoull(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--no-generated")) {
+			options.run_generated = false;
+		} else if (arg[0] != '-') {
+			array_push(pose_set_paths, arg);
+		} else {
+			print_usage(argv[0]);
+			array_free(pose_set_paths);
+			return 1;
+		}
+	}
+
+	if (options.num_rounds == 0 || (options.run_generated && options.num_poses == 0)) {
+		print_usage(argv[0]);
+		array_free(pose_set_paths);
+		return 1;
+	}
+
+	s32 exit_code = 0;
+	Bench_Set* sets = array_new(Bench_Set);
+	if (options.run_generated) {
+		generate_sets(&sets, &options);
+	}
+
+	for (u32 i = 0; i < array_length(pose_set_paths); ++i) {
+		Pose_Set pose_set;
+		pose_set_init(&pose_set);
+		if (pose_set_read(&pose_set, pose_set_paths[i])) {
+			add_recorded_sets(&sets, &pose_set, pose_set_paths[i]);
+		} else {
+			fprintf(stderr, "failed to read pose set '%s'\n", pose_set_paths[i]);
+			exit_code = 1;
+		}
+		pose_set_destroy(&pose_set);
+	}
+	array_free(pose_set_paths);
+
+	printf("%u rounds, seed %llu\n", options.num_rounds, (unsigned long long)options.seed);
+	printf("Times are in nanoseconds per query. EPA runs on the GJK hits, clipping on the pairs where EPA converged.\n\n");
+	printf("%-32s %8s %7s %10s %9s %8s %9s %8s %9s %9s\n", "set", "pairs", "hit %", "support", "gjk", "gjk nc%",
+		"epa", "epa nc%", "clipping", "contacts");
+	for (u32 i = 0; i < array_length(sets); ++i) {
+		Bench_Result result;
+		run_set(&sets[i], &options, &result);
+		print_result(sets[i].name, &result);
+		set_destroy(&sets[i]);
+	}
+	array_free(sets);
+
+	arena_destroy_scratches();
+	// After the sets, since the spot hull may be using the cache
+	cache_destroy();
+	return exit_code;
+}
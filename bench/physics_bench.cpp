@@ -0,0 +1,635 @@
+// Steps the example scenes without a window, at a fixed dt, and reports how long each step took.
+// This is the reference for before/after comparisons of performance changes.
+//
+// Usage: physics_bench [options] [scene...]
+// Scenes are given by index or by name (case and spaces/underscores/dashes are ignored). Without scenes, all of them run.
+// Stress scenes (see stress_scenes.h) are added with '--stress TYPE:WIDTH' or '--stress TYPE:WIDTHxHEIGHT', e.g.
+// '--stress cube_rain:20' for 8000 cubes or '--stress hinge_chains:100x50'. They are run after the example scenes.
+//   --frames N    Number of measured frames (default 600)
+//   --warmup N    Frames stepped before measuring, not included in the results (default 0)
+//   --dt S        Fixed time step in seconds (default 1/60)
+//   --threads N   Threads of the thread pool, 0 for one per hardware thread (default 0)
+//   --json PATH   Also writes the results as JSON to PATH
+//   --seed N      Seed of the stress scenes (default 1)
+//   --dump-poses PATH
+//                 Records the collider pairs that the narrowphase tests in the first substep of every measured frame to PATH,
+//                 as a pose set for narrowphase_bench (see pose_set.h). Recording stops after POSE_SET_MAX_PAIRS pairs.
+//   --counters    Also reports the time and the hardware counters of the main phases of the step (see profiler.h), when
+//                 built with the profiler on Linux. Counters only count the main thread, use '--threads 1' to count all work.
+//   --list        Lists the scenes and exits
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <assert.h>
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+#include "common.h"
+#include "light_array.h"
+#include "core.h"
+#include "example_scenes.h"
+#include "stress_scenes.h"
+#include "pbd.h"
+#include "thread_pool.h"
+#include "arena.h"
+#include "cache.h"
+#include "sat.h"
+#include "entity.h"
+#include "pose_set.h"
+#include "profiler.h"
+
+// The cameras of the scenes are still created, they use the window size for the aspect ratio
+s32 window_width = 1920;
+s32 window_height = 1080;
+
+typedef struct {
+	u32 num_frames;
+	u32 num_warmup_frames;
+	r64 dt;
+	u32 num_threads;
+	const char* json_path;
+	u64 seed;
+	const char* pose_set_path;
+	boolean use_counters;
+} Bench_Options;
+
+typedef struct {
+	boolean is_stress_scene;
+	Example_Scene_Type type;
+	Stress_Scene_Parameters stress_parameters;
+} Bench_Scene;
+
+typedef struct {
+	r64 mean;
+	r64 median;
+	r64 p99;
+	r64 max;
+} Bench_Summary;
+
+// Means per frame
+typedef struct {
+	r64 time_ms;
+	r64 counters[PROFILE_COUNTER_COUNT];
+} Bench_Phase;
+
+typedef struct {
+	char scene_name[64];
+	// Step times in milliseconds
+	Bench_Summary step_time;
+	// Per frame counters, see 'Pbd_Step_Statistics'
+	Bench_Summary bodies;
+	Bench_Summary active_bodies;
+	Bench_Summary broadphase_pairs;
+	Bench_Summary narrowphase_pairs;
+	Bench_Summary contacts;
+	Bench_Summary constraints;
+	Bench_Summary narrowphase_hits;
+	Bench_Summary islands;
+	Bench_Summary largest_island;
+	Bench_Summary epa_iterations;
+	Bench_Summary epa_failures;
+	Bench_Summary max_positional_error;
+	// Only filled with --counters, for the phases up to depth 1
+	Bench_Phase phases[PROFILE_PHASE_COUNT];
+} Bench_Result;
+
+static void print_usage(const char* program) {
+	fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--dt S] [--threads N] [--json PATH] [--seed N] [--stress TYPE:WIDTH[xHEIGHT]] "
+		"[--dump-poses PATH] [--counters] [--list] [scene...]\n", program);
+}
+
+// Compares ignoring case, spaces, underscores and dashes, so "cube_storm" and "cube-storm" match "Cube Storm".
+static boolean scene_name_matches(const char* scene_name, const char* arg) {
+	for (;;) {
+		while (*scene_name == ' ' || *scene_name == '_' || *scene_name == '-') ++scene_name;
+		while (*arg == ' ' || *arg == '_' || *arg == '-') ++arg;
+		if (tolower(*scene_name) != tolower(*arg)) return false;
+		if (*scene_name == 0) return true;
+		++scene_name;
+		++arg;
+	}
+}
+
+static boolean parse_scene(const char* arg, Example_Scene_Type* type) {
+	char* end;
+	long index = strtol(arg, &end, 10);
+	if (*arg != 0 && *end == 0) {
+		if (index < 0 || index >= END_EXAMPLE_SCENE) return false;
+		*type = (Example_Scene_Type)index;
+		return true;
+	}
+
+	for (u32 i = 0; i < END_EXAMPLE_SCENE; ++i) {
+		if (scene_name_matches(example_scenes_get((Example_Scene_Type)i).name, arg)) {
+			*type = (Example_Scene_Type)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static boolean parse_stress_scene(const char* arg, u64 seed, Stress_Scene_Parameters* parameters) {
+	const char* separator = strchr(arg, ':');
+	if (!separator) return false;
+
+	u32 i;
+	for (i = 0; i < STRESS_SCENE_COUNT; ++i) {
+		const char* type_name = stress_scene_get_type_name((Stress_Scene_Type)i);
+		if (strlen(type_name) == (size_t)(separator - arg) && !strncmp(type_name, arg, separator - arg)) break;
+	}
+	if (i == STRESS_SCENE_COUNT) return false;
+
+	parameters->type = (Stress_Scene_Type)i;
+	parameters->seed = seed;
+	parameters->height = 0;
+
+	char* end;
+	parameters->width = (u32)strtoul(separator + 1, &end, 10);
+	if (*end == 'x') {
+		parameters->height = (u32)strtoul(end + 1, &end, 10);
+	}
+	if (*end != 0 || parameters->width == 0) return false;
+
+	boolean needs_height = parameters->type == STRESS_SCENE_BRICK_WALL || parameters->type == STRESS_SCENE_HINGE_CHAINS;
+	return needs_height == (parameters->height != 0);
+}
+
+// The bounding box of a collider in world space, from the leaf of the hierarchy of its entity.
+static void get_collider_aabb(const Entity* e, u32 collider_idx, vec3* aabb_min, vec3* aabb_max) {
+	const Colliders_BVH_Node* leaf = NULL;
+	for (u32 i = 0; i < array_length(e->colliders_bvh.nodes); ++i) {
+		if (e->colliders_bvh.nodes[i].is_leaf && e->colliders_bvh.nodes[i].left == collider_idx) {
+			leaf = &e->colliders_bvh.nodes[i];
+			break;
+		}
+	}
+	assert(leaf);
+
+	vec3 center = gm_vec3_scalar_product(0.5, gm_vec3_add(leaf->aabb_min, leaf->aabb_max));
+	vec3 half_extents = gm_vec3_scalar_product(0.5, gm_vec3_subtract(leaf->aabb_max, leaf->aabb_min));
+	vec3 world_center = gm_vec3_add(e->world_position, quaternion_apply_to_vec3(&e->world_rotation, center));
+	vec3 axes[3] = {
+		quaternion_apply_to_vec3(&e->world_rotation, {half_extents.x, 0.0, 0.0}),
+		quaternion_apply_to_vec3(&e->world_rotation, {0.0, half_extents.y, 0.0}),
+		quaternion_apply_to_vec3(&e->world_rotation, {0.0, 0.0, half_extents.z})
+	};
+	vec3 world_half_extents = {
+		fabs(axes[0].x) + fabs(axes[1].x) + fabs(axes[2].x),
+		fabs(axes[0].y) + fabs(axes[1].y) + fabs(axes[2].y),
+		fabs(axes[0].z) + fabs(axes[1].z) + fabs(axes[2].z)
+	};
+	*aabb_min = gm_vec3_subtract(world_center, world_half_extents);
+	*aabb_max = gm_vec3_add(world_center, world_half_extents);
+}
+
+static boolean colliders_may_touch(const Entity* e1, u32 collider1_idx, const Entity* e2, u32 collider2_idx) {
+	// The simulation doesn't look at the bounding boxes of entities with a single collider
+	if (array_length(e1->colliders) == 1 && array_length(e2->colliders) == 1) {
+		return true;
+	}
+
+	vec3 min1, max1, min2, max2;
+	get_collider_aabb(e1, collider1_idx, &min1, &max1);
+	get_collider_aabb(e2, collider2_idx, &min2, &max2);
+	return min1.x <= max2.x && min2.x <= max1.x && min1.y <= max2.y && min2.y <= max1.y && min1.z <= max2.z && min2.z <= max1.z;
+}
+
+// Records the collider pairs that the narrowphase tests in the first substep of each step, at the poses it sees them.
+static void record_poses(const Entity* e1, const Entity* e2, u32 substep, void* data) {
+	Pose_Set* pose_set = (Pose_Set*)data;
+	if (substep != 0) {
+		return;
+	}
+
+	for (u32 i = 0; i < array_length(e1->colliders); ++i) {
+		for (u32 j = 0; j < array_length(e2->colliders); ++j) {
+			if (colliders_may_touch(e1, i, e2, j)) {
+				pose_set_add_pair(pose_set, &e1->colliders[i], e1->world_position, e1->world_rotation,
+					&e2->colliders[j], e2->world_position, e2->world_rotation);
+			}
+		}
+	}
+}
+
+// 'values' is sorted in place.
+static Bench_Summary summarize(r64* values) {
+	Bench_Summary summary = {0};
+	u32 n = array_length(values);
+	if (n == 0) return summary;
+
+	std::sort(values, values + n);
+
+	r64 sum = 0.0;
+	for (u32 i = 0; i < n; ++i) {
+		sum += values[i];
+	}
+
+	summary.mean = sum / n;
+	summary.median = (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+	// Nearest rank
+	u32 p99_rank = (u32)((99 * (u64)n + 99) / 100);
+	summary.p99 = values[p99_rank - 1];
+	summary.max = values[n - 1];
+	return summary;
+}
+
+#ifdef RAW_PHYSICS_PROFILE
+// Adds the phases of the last step to 'phases', divided by the number of frames so they add up to the means.
+static void add_last_step_phases(Bench_Phase* phases, u32 num_frames) {
+	if (profiler_get_num_frames() == 0) return;
+	const Profile_Frame* frame = profiler_get_frame(profiler_get_num_frames() - 1);
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+		phases[i].time_ms += frame->phase_time[i] / 1e6 / num_frames;
+		for (u32 j = 0; j < PROFILE_COUNTER_COUNT; ++j) {
+			phases[i].counters[j] += (r64)frame->phase_counters[i][j] / num_frames;
+		}
+	}
+}
+#endif
+
+// 'pose_set' is NULL if poses are not recorded.
+static boolean run_scene(const Bench_Scene* bench_scene, const Bench_Options* options, Pose_Set* pose_set, Bench_Result* result) {
+	Example_Scene scene = bench_scene->is_stress_scene ? stress_scene_get(&bench_scene->stress_parameters) :
+		example_scenes_get(bench_scene->type);
+	snprintf(result->scene_name, sizeof(result->scene_name), "%s", scene.name);
+	memset(result->phases, 0, sizeof(result->phases));
+
+	if (scene.init() != 0) {
+		fprintf(stderr, "failed to load scene '%s'\n", scene.name);
+		return false;
+	}
+
+	for (u32 i = 0; i < options->num_warmup_frames; ++i) {
+		scene.update(options->dt);
+	}
+
+	r64* step_times = array_new_len(r64, options->num_frames);
+	r64* bodies = array_new_len(r64, options->num_frames);
+	r64* active_bodies = array_new_len(r64, options->num_frames);
+	r64* broadphase_pairs = array_new_len(r64, options->num_frames);
+	r64* narrowphase_pairs = array_new_len(r64, options->num_frames);
+	r64* contacts = array_new_len(r64, options->num_frames);
+	r64* constraints = array_new_len(r64, options->num_frames);
+	r64* narrowphase_hits = array_new_len(r64, options->num_frames);
+	r64* islands = array_new_len(r64, options->num_frames);
+	r64* largest_island = array_new_len(r64, options->num_frames);
+	r64* epa_iterations = array_new_len(r64, options->num_frames);
+	r64* epa_failures = array_new_len(r64, options->num_frames);
+	r64* max_positional_error = array_new_len(r64, options->num_frames);
+
+	// Only the measured frames are recorded
+	if (pose_set) {
+		pbd_set_narrowphase_callback(record_poses, pose_set);
+	}
+
+	for (u32 i = 0; i < options->num_frames; ++i) {
+		auto begin = std::chrono::steady_clock::now();
+		scene.update(options->dt);
+		auto end = std::chrono::steady_clock::now();
+
+		r64 step_time = std::chrono::duration<r64, std::milli>(end - begin).count();
+
+		Pbd_Step_Statistics statistics;
+		pbd_get_last_step_statistics(&statistics);
+
+		array_push(step_times, step_time);
+		array_push(bodies, (r64)statistics.num_bodies);
+		array_push(active_bodies, (r64)statistics.num_active_bodies);
+		array_push(broadphase_pairs, (r64)statistics.num_broadphase_pairs);
+		array_push(narrowphase_pairs, (r64)statistics.num_narrowphase_pairs);
+		array_push(contacts, (r64)statistics.num_contacts);
+		array_push(constraints, (r64)statistics.num_constraints);
+		array_push(narrowphase_hits, (r64)statistics.num_narrowphase_hits);
+		array_push(islands, (r64)statistics.num_islands);
+		array_push(largest_island, (r64)statistics.largest_island_size);
+		array_push(epa_iterations, (r64)statistics.num_epa_iterations);
+		array_push(epa_failures, (r64)statistics.num_epa_failures);
+		array_push(max_positional_error, (r64)statistics.max_positional_error);
+
+#ifdef RAW_PHYSICS_PROFILE
+		if (options->use_counters) {
+			add_last_step_phases(result->phases, options->num_frames);
+		}
+#endif
+	}
+
+	pbd_set_narrowphase_callback(NULL, NULL);
+
+	scene.destroy();
+
+	result->step_time = summarize(step_times);
+	result->bodies = summarize(bodies);
+	result->active_bodies = summarize(active_bodies);
+	result->broadphase_pairs = summarize(broadphase_pairs);
+	result->narrowphase_pairs = summarize(narrowphase_pairs);
+	result->contacts = summarize(contacts);
+	result->constraints = summarize(constraints);
+	result->narrowphase_hits = summarize(narrowphase_hits);
+	result->islands = summarize(islands);
+	result->largest_island = summarize(largest_island);
+	result->epa_iterations = summarize(epa_iterations);
+	result->epa_failures = summarize(epa_failures);
+	result->max_positional_error = summarize(max_positional_error);
+
+	array_free(step_times);
+	array_free(bodies);
+	array_free(active_bodies);
+	array_free(broadphase_pairs);
+	array_free(narrowphase_pairs);
+	array_free(contacts);
+	array_free(constraints);
+	array_free(narrowphase_hits);
+	array_free(islands);
+	array_free(largest_island);
+	array_free(epa_iterations);
+	array_free(epa_failures);
+	array_free(max_positional_error);
+	return true;
+}
+
+static void print_table(const Bench_Result* results, const Bench_Options* options) {
+	printf("%u frames, dt = %.6f s, %u threads, seed %llu\n", options->num_frames, options->dt, thread_pool_get_num_threads(),
+		(unsigned long long)options->seed);
+	printf("Step times are in milliseconds, counters are the mean per frame (narrowphase counters are summed over substeps)\n\n");
+	printf("%-24s %9s %9s %9s %9s %8s %8s %10s %10s %10s %12s\n", "scene", "mean", "median", "p99", "max",
+		"bodies", "active", "bp pairs", "np pairs", "contacts", "constraints");
+	for (u32 i = 0; i < array_length(results); ++i) {
+		const Bench_Result* r = &results[i];
+		printf("%-24s %9.3f %9.3f %9.3f %9.3f %8.1f %8.1f %10.1f %10.1f %10.1f %12.1f\n", r->scene_name,
+			r->step_time.mean, r->step_time.median, r->step_time.p99, r->step_time.max, r->bodies.mean, r->active_bodies.mean,
+			r->broadphase_pairs.mean, r->narrowphase_pairs.mean, r->contacts.mean, r->constraints.mean);
+	}
+
+#ifdef RAW_PHYSICS_PROFILE
+	if (!options->use_counters) {
+		return;
+	}
+
+	// Only the step and its direct phases are counted, on the simulation thread
+	printf("\nHardware counters, mean per frame on the simulation thread (narrowphase only counts its own share with --threads 1)\n");
+	for (u32 i = 0; i < array_length(results); ++i) {
+		const Bench_Result* r = &results[i];
+		printf("\n%s\n", r->scene_name);
+		printf("  %-20s %9s %14s %14s %6s %12s %12s %12s\n", "phase", "time", "cycles", "instructions", "ipc",
+			"l1d misses", "llc misses", "br misses");
+		for (u32 j = 0; j < PROFILE_PHASE_COUNT; ++j) {
+			if (profiler_get_phase_depth((Profile_Phase)j) > 1) {
+				continue;
+			}
+			const Bench_Phase* phase = &r->phases[j];
+			r64 cycles = phase->counters[PROFILE_COUNTER_CYCLES];
+			r64 ipc = cycles > 0.0 ? phase->counters[PROFILE_COUNTER_INSTRUCTIONS] / cycles : 0.0;
+			printf("  %-20s %9.3f %14.0f %14.0f %6.2f %12.0f %12.0f %12.0f\n", profiler_get_phase_name((Profile_Phase)j),
+				phase->time_ms, cycles, phase->counters[PROFILE_COUNTER_INSTRUCTIONS], ipc,
+				phase->counters[PROFILE_COUNTER_L1D_MISSES], phase->counters[PROFILE_COUNTER_LLC_MISSES],
+				phase->counters[PROFILE_COUNTER_BRANCH_MISSES]);
+		}
+	}
+	boolean has_all_counters = true;
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+		if (!profiler_has_hardware_counter((Profile_Counter)i)) {
+			printf("%s%s", has_all_counters ? "\nNot supported here, reads 0: " : ", ", profiler_get_counter_name((Profile_Counter)i));
+			has_all_counters = false;
+		}
+	}
+	if (!has_all_counters) {
+		printf("\n");
+	}
+#endif
+}
+
+static void write_json_summary(FILE* file, const char* name, const Bench_Summary* summary, boolean last) {
+	fprintf(file, "\t\t\t\"%s\": {\"mean\": %.6f, \"median\": %.6f, \"p99\": %.6f, \"max\": %.6f}%s\n", name,
+		summary->mean, summary->median, summary->p99, summary->max, last ? "" : ",");
+}
+
+#ifdef RAW_PHYSICS_PROFILE
+// Phase names are lowercase with underscores, unsupported counters are null
+static void write_json_phases(FILE* file, const Bench_Phase* phases) {
+	fprintf(file, "\t\t\t\"phases\": {\n");
+	boolean first = true;
+	for (u32 i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+		if (profiler_get_phase_depth((Profile_Phase)i) > 1) {
+			continue;
+		}
+
+		s8 name[64];
+		snprintf(name, sizeof(name), "%s", profiler_get_phase_name((Profile_Phase)i));
+		for (s8* c = name; *c; ++c) {
+			*c = *c == ' ' ? '_' : (s8)tolower(*c);
+		}
+
+		fprintf(file, "%s\t\t\t\t\"%s\": {\"time_ms\": %.6f", first ? "" : ",\n", name, phases[i].time_ms);
+		for (u32 j = 0; j < PROFILE_COUNTER_COUNT; ++j) {
+			if (profiler_has_hardware_counter((Profile_Counter)j)) {
+				fprintf(file, ", \"%s\": %.1f", profiler_get_counter_name((Profile_Counter)j), phases[i].counters[j]);
+			} else {
+				fprintf(file, ", \"%s\": null", profiler_get_counter_name((Profile_Counter)j));
+			}
+		}
+		fprintf(file, "}");
+		first = false;
+	}
+	fprintf(file, "\n\t\t\t}\n");
+}
+#endif
+
+static void write_json(FILE* file, const Bench_Result* results, const Bench_Options* options) {
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"frames\": %u,\n", options->num_frames);
+	fprintf(file, "\t\"warmup_frames\": %u,\n", options->num_warmup_frames);
+	fprintf(file, "\t\"dt\": %.9f,\n", options->dt);
+	fprintf(file, "\t\"threads\": %u,\n", thread_pool_get_num_threads());
+	fprintf(file, "\t\"seed\": %llu,\n", (unsigned long long)options->seed);
+	fprintf(file, "\t\"scenes\": [\n");
+	for (u32 i = 0; i < array_length(results); ++i) {
+		const Bench_Result* r = &results[i];
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"name\": \"%s\",\n", r->scene_name);
+		write_json_summary(file, "step_time_ms", &r->step_time, false);
+		write_json_summary(file, "bodies", &r->bodies, false);
+		write_json_summary(file, "active_bodies", &r->active_bodies, false);
+		write_json_summary(file, "broadphase_pairs", &r->broadphase_pairs, false);
+		write_json_summary(file, "narrowphase_pairs", &r->narrowphase_pairs, false);
+		write_json_summary(file, "contacts", &r->contacts, false);
+		write_json_summary(file, "constraints", &r->constraints, false);
+		write_json_summary(file, "narrowphase_hits", &r->narrowphase_hits, false);
+		write_json_summary(file, "islands", &r->islands, false);
+		write_json_summary(file, "largest_island", &r->largest_island, false);
+		write_json_summary(file, "epa_iterations", &r->epa_iterations, false);
+		write_json_summary(file, "epa_failures", &r->epa_failures, false);
+		write_json_summary(file, "max_positional_error", &r->max_positional_error, !options->use_counters);
+#ifdef RAW_PHYSICS_PROFILE
+		if (options->use_counters) {
+			write_json_phases(file, r->phases);
+		}
+#endif
+		fprintf(file, "\t\t}%s\n", i + 1 < array_length(results) ? "," : "");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char** argv) {
+	Bench_Options options;
+	options.num_frames = 600;
+	options.num_warmup_frames = 0;
+	options.dt = 1.0 / 60.0;
+	options.num_threads = 0;
+	options.json_path = NULL;
+	options.seed = 1;
+	options.pose_set_path = NULL;
+	options.use_counters = false;
+
+	Bench_Scene* scenes = array_new(Bench_Scene);
+	// Stress scenes get the seed once all arguments are parsed
+	const char** stress_args = array_new(const char*);
+
+	for (s32 i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		boolean has_value = i + 1 < argc;
+		if (!strcmp(arg, "--frames") && has_value) {
+			options.num_frames = (u32)strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--warmup") && has_value) {
+			options.num_warmup_frames = (u32)strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--dt") && has_value) {
+			options.dt = strtod(argv[++i], NULL);
+		} else if (!strcmp(arg, "--threads") && has_value) {
+			options.num_threads = (u32)strtoul(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--json") && has_value) {
+			options.json_path = argv[++i];
+		} else if (!strcmp(arg, "--seed") && has_value) {
+			options.seed = strtoull(argv[++i], NULL, 10);
+		} else if (!strcmp(arg, "--dump-poses") && has_value) {
+			options.pose_set_path = argv[++i];
+		} else if (!strcmp(arg, "--counters")) {
+			options.use_counters = true;
+		} else if (!strcmp(arg, "--stress") && has_value) {
+			array_push(stress_args, argv[++i]);
+		} else if (!strcmp(arg, "--list")) {
+			for (u32 j = 0; j < END_EXAMPLE_SCENE; ++j) {
+				printf("%2u  %s\n", j, example_scenes_get((Example_Scene_Type)j).name);
+			}
+			printf("\nStress scenes:\n");
+			for (u32 j = 0; j < STRESS_SCENE_COUNT; ++j) {
+				printf("    %s\n", stress_scene_get_type_name((Stress_Scene_Type)j));
+			}
+			array_free(stress_args);
+			array_free(scenes);
+			return 0;
+		} else if (arg[0] != '-') {
+			Bench_Scene scene = {0};
+			if (!parse_scene(arg, &scene.type)) {
+				fprintf(stderr, "unknown scene '%s', use --list to see the scenes\n", arg);
+				array_free(stress_args);
+				array_free(scenes);
+				return 1;
+			}
+			array_push(scenes, scene);
+		} else {
+			print_usage(argv[0]);
+			array_free(stress_args);
+			array_free(scenes);
+			return 1;
+		}
+	}
+
+	if (options.num_frames == 0 || options.dt <= 0.0) {
+		print_usage(argv[0]);
+		array_free(stress_args);
+		array_free(scenes);
+		return 1;
+	}
+
+	if (array_length(scenes) == 0 && array_length(stress_args) == 0) {
+		for (u32 i = 0; i < END_EXAMPLE_SCENE; ++i) {
+			Bench_Scene scene = {0};
+			scene.type = (Example_Scene_Type)i;
+			array_push(scenes, scene);
+		}
+	}
+
+	for (u32 i = 0; i < array_length(stress_args); ++i) {
+		Bench_Scene scene = {0};
+		scene.is_stress_scene = true;
+		if (!parse_stress_scene(stress_args[i], options.seed, &scene.stress_parameters)) {
+			fprintf(stderr, "invalid stress scene '%s', expected TYPE:WIDTH (or TYPE:WIDTHxHEIGHT for brick_wall and hinge_chains)\n",
+				stress_args[i]);
+			array_free(stress_args);
+			array_free(scenes);
+			return 1;
+		}
+		array_push(scenes, scene);
+	}
+	array_free(stress_args);
+
+	thread_pool_init(options.num_threads);
+
+	if (options.use_counters) {
+#ifdef RAW_PHYSICS_PROFILE
+		// Counts this thread, which steps the scenes
+		if (!profiler_enable_hardware_counters()) {
+			fprintf(stderr, "hardware counters are not available (%s), --counters is ignored\n", strerror(errno));
+			options.use_counters = false;
+		}
+#else
+		fprintf(stderr, "physics_bench was built without RAW_PHYSICS_PROFILE, --counters is ignored\n");
+		options.use_counters = false;
+#endif
+	}
+
+	Pose_Set pose_set;
+	pose_set_init(&pose_set);
+
+	Bench_Result* results = array_new(Bench_Result);
+	s32 exit_code = 0;
+	for (u32 i = 0; i < array_length(scenes); ++i) {
+		Bench_Result result;
+		if (!run_scene(&scenes[i], &options, options.pose_set_path ? &pose_set : NULL, &result)) {
+			exit_code = 1;
+			continue;
+		}
+		array_push(results, result);
+	}
+
+	print_table(results, &options);
+
+	// Not to stdout, since loading the scenes may print there
+	if (options.json_path) {
+		FILE* file = fopen(options.json_path, "w");
+		if (file) {
+			write_json(file, results, &options);
+			fclose(file);
+		} else {
+			fprintf(stderr, "failed to open '%s'\n", options.json_path);
+			exit_code = 1;
+		}
+	}
+
+	if (options.pose_set_path) {
+		if (pose_set_write(&pose_set, options.pose_set_path)) {
+			fprintf(stderr, "wrote %u collider pairs to '%s'\n", (u32)array_length(pose_set.pairs), options.pose_set_path);
+		} else {
+			fprintf(stderr, "failed to write '%s'\n", options.pose_set_path);
+			exit_code = 1;
+		}
+	}
+	pose_set_destroy(&pose_set);
+
+#ifdef RAW_PHYSICS_PROFILE
+	profiler_disable_hardware_counters();
+#endif
+
+	array_free(results);
+	array_free(scenes);
+
+	thread_pool_destroy();
+	arena_destroy_scratches();
+	sat_cache_destroy();
+	// After the scenes, since their shapes may be using the cache
+	cache_destroy();
+	return exit_code;
+}
@@ -0,0 +1,247 @@
+#include "pose_set.h"
+#include <stdio.h>
+#include <string.h>
+#include "light_array.h"
+
+void pose_set_init(Pose_Set* set) {
+	set->shapes = array_new(Pose_Set_Shape);
+	set->pairs = array_new(Pose_Set_Pair);
+}
+
+static void clear(Pose_Set* set) {
+	for (u32 i = 0; i < array_length(set->shapes); ++i) {
+		if (set->shapes[i].vertices) {
+			array_free(set->shapes[i].vertices);
+		}
+	}
+	array_clear(set->shapes);
+	array_clear(set->pairs);
+}
+
+void pose_set_destroy(Pose_Set* set) {
+	clear(set);
+	array_free(set->shapes);
+	array_free(set->pairs);
+}
+
+static void get_shape(const Collider* collider, Pose_Set_Shape* shape) {
+	memset(shape, 0, sizeof(Pose_Set_Shape));
+	shape->type = collider->type;
+	switch (collider->type) {
+		case COLLIDER_TYPE_SPHERE: {
+			shape->radius = collider->sphere.radius;
+		} break;
+		case COLLIDER_TYPE_BOX: {
+			shape->half_extents = collider->box.half_extents;
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			shape->radius = collider->capsule.radius;
+			shape->half_height = collider->capsule.half_height;
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			shape->radius = collider->cylinder.radius;
+			shape->half_height = collider->cylinder.half_height;
+		} break;
+		case COLLIDER_TYPE_CONVEX_HULL: {
+			// Not copied yet, the shape may already be in the set
+			const Collider_Convex_Hull_Shape* hull_shape = collider->convex_hull.shape;
+			shape->vertices = hull_shape->vertices;
+		} break;
+	}
+}
+
+static boolean shapes_equal(const Pose_Set_Shape* shape, const Pose_Set_Shape* other, u32 other_num_vertices) {
+	if (shape->type != other->type || shape->radius != other->radius || shape->half_height != other->half_height ||
+		!gm_vec3_equal(shape->half_extents, other->half_extents)) {
+		return false;
+	}
+
+	if (shape->type != COLLIDER_TYPE_CONVEX_HULL) {
+		return true;
+	}
+
+	return array_length(shape->vertices) == other_num_vertices &&
+		!memcmp(shape->vertices, other->vertices, other_num_vertices * sizeof(vec3));
+}
+
+static u32 add_shape(Pose_Set* set, const Collider* collider) {
+	Pose_Set_Shape shape;
+	get_shape(collider, &shape);
+	u32 num_vertices = collider->type == COLLIDER_TYPE_CONVEX_HULL ? collider->convex_hull.shape->num_vertices : 0;
+
+	for (u32 i = 0; i < array_length(set->shapes); ++i) {
+		if (shapes_equal(&set->shapes[i], &shape, num_vertices)) {
+			return i;
+		}
+	}
+
+	if (shape.type == COLLIDER_TYPE_CONVEX_HULL) {
+		const vec3* vertices = shape.vertices;
+		shape.vertices = array_new_len(vec3, num_vertices);
+		for (u32 i = 0; i < num_vertices; ++i) {
+			array_push(shape.vertices, vertices[i]);
+		}
+	}
+
+	array_push(set->shapes, shape);
+	return array_length(set->shapes) - 1;
+}
+
+boolean pose_set_add_pair(Pose_Set* set, const Collider* collider1, vec3 position1, Quaternion rotation1,
+	const Collider* collider2, vec3 position2, Quaternion rotation2) {
+	if (array_length(set->pairs) >= POSE_SET_MAX_PAIRS) {
+		return false;
+	}
+
+	Pose_Set_Pair pair;
+	pair.shape1 = add_shape(set, collider1);
+	pair.shape2 = add_shape(set, collider2);
+	pair.position1 = position1;
+	pair.rotation1 = rotation1;
+	pair.position2 = position2;
+	pair.rotation2 = rotation2;
+	array_push(set->pairs, pair);
+	return true;
+}
+
+boolean pose_set_write(const Pose_Set* set, const char* path) {
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		return false;
+	}
+
+	fprintf(file, "raw_physics_pose_set 1\n");
+	fprintf(file, "shapes %u\n", (u32)array_length(set->shapes));
+	for (u32 i = 0; i < array_length(set->shapes); ++i) {
+		const Pose_Set_Shape* shape = &set->shapes[i];
+		switch (shape->type) {
+			case COLLIDER_TYPE_SPHERE: fprintf(file, "sphere %.17g\n", shape->radius); break;
+			case COLLIDER_TYPE_BOX: {
+				fprintf(file, "box %.17g %.17g %.17g\n", shape->half_extents.x, shape->half_extents.y, shape->half_extents.z);
+			} break;
+			case COLLIDER_TYPE_CAPSULE: fprintf(file, "capsule %.17g %.17g\n", shape->radius, shape->half_height); break;
+			case COLLIDER_TYPE_CYLINDER: fprintf(file, "cylinder %.17g %.17g\n", shape->radius, shape->half_height); break;
+			case COLLIDER_TYPE_CONVEX_HULL: {
+				fprintf(file, "hull %u", (u32)array_length(shape->vertices));
+				for (u32 j = 0; j < array_length(shape->vertices); ++j) {
+					fprintf(file, " %.17g %.17g %.17g", shape->vertices[j].x, shape->vertices[j].y, shape->vertices[j].z);
+				}
+				fprintf(file, "\n");
+			} break;
+		}
+	}
+
+	fprintf(file, "pairs %u\n", (u32)array_length(set->pairs));
+	for (u32 i = 0; i < array_length(set->pairs); ++i) {
+		const Pose_Set_Pair* pair = &set->pairs[i];
+		fprintf(file, "%u %u %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g\n",
+			pair->shape1, pair->shape2,
+			pair->position1.x, pair->position1.y, pair->position1.z,
+			pair->rotation1.x, pair->rotation1.y, pair->rotation1.z, pair->rotation1.w,
+			pair->position2.x, pair->position2.y, pair->position2.z,
+			pair->rotation2.x, pair->rotation2.y, pair->rotation2.z, pair->rotation2.w);
+	}
+
+	boolean success = !ferror(file);
+	fclose(file);
+	return success;
+}
+
+static boolean read_shape(FILE* file, Pose_Set_Shape* shape) {
+	memset(shape, 0, sizeof(Pose_Set_Shape));
+	char type[16];
+	if (fscanf(file, "%15s", type) != 1) {
+		return false;
+	}
+
+	if (!strcmp(type, "sphere")) {
+		shape->type = COLLIDER_TYPE_SPHERE;
+		return fscanf(file, "%lf", &shape->radius) == 1;
+	} else if (!strcmp(type, "box")) {
+		shape->type = COLLIDER_TYPE_BOX;
+		return fscanf(file, "%lf %lf %lf", &shape->half_extents.x, &shape->half_extents.y, &shape->half_extents.z) == 3;
+	} else if (!strcmp(type, "capsule")) {
+		shape->type = COLLIDER_TYPE_CAPSULE;
+		return fscanf(file, "%lf %lf", &shape->radius, &shape->half_height) == 2;
+	} else if (!strcmp(type, "cylinder")) {
+		shape->type = COLLIDER_TYPE_CYLINDER;
+		return fscanf(file, "%lf %lf", &shape->radius, &shape->half_height) == 2;
+	} else if (!strcmp(type, "hull")) {
+		shape->type = COLLIDER_TYPE_CONVEX_HULL;
+		u32 num_vertices;
+		if (fscanf(file, "%u", &num_vertices) != 1 || num_vertices < 4) {
+			return false;
+		}
+
+		shape->vertices = array_new_len(vec3, num_vertices);
+		for (u32 i = 0; i < num_vertices; ++i) {
+			vec3 v;
+			if (fscanf(file, "%lf %lf %lf", &v.x, &v.y, &v.z) != 3) {
+				array_free(shape->vertices);
+				shape->vertices = NULL;
+				return false;
+			}
+			array_push(shape->vertices, v);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+static boolean read_pair(FILE* file, u32 num_shapes, Pose_Set_Pair* pair) {
+	s32 num_read = fscanf(file, "%u %u %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf",
+		&pair->shape1, &pair->shape2,
+		&pair->position1.x, &pair->position1.y, &pair->position1.z,
+		&pair->rotation1.x, &pair->rotation1.y, &pair->rotation1.z, &pair->rotation1.w,
+		&pair->position2.x, &pair->position2.y, &pair->position2.z,
+		&pair->rotation2.x, &pair->rotation2.y, &pair->rotation2.z, &pair->rotation2.w);
+	return num_read == 16 && pair->shape1 < num_shapes && pair->shape2 < num_shapes;
+}
+
+static boolean read_pose_set(Pose_Set* set, FILE* file) {
+	u32 version, num_shapes, num_pairs;
+	if (fscanf(file, "raw_physics_pose_set %u", &version) != 1 || version != 1) {
+		return false;
+	}
+
+	if (fscanf(file, " shapes %u", &num_shapes) != 1) {
+		return false;
+	}
+	for (u32 i = 0; i < num_shapes; ++i) {
+		Pose_Set_Shape shape;
+		if (!read_shape(file, &shape)) {
+			return false;
+		}
+		array_push(set->shapes, shape);
+	}
+
+	if (fscanf(file, " pairs %u", &num_pairs) != 1) {
+		return false;
+	}
+	for (u32 i = 0; i < num_pairs; ++i) {
+		Pose_Set_Pair pair;
+		if (!read_pair(file, num_shapes, &pair)) {
+			return false;
+		}
+		array_push(set->pairs, pair);
+	}
+
+	return true;
+}
+
+boolean pose_set_read(Pose_Set* set, const char* path) {
+	FILE* file = fopen(path, "r");
+	if (!file) {
+		return false;
+	}
+
+	clear(set);
+	boolean success = read_pose_set(set, file);
+	fclose(file);
+
+	if (!success) {
+		clear(set);
+	}
+	return success;
+}
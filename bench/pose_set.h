@@ -0,0 +1,56 @@
+#ifndef RAW_PHYSICS_BENCH_POSE_SET_H
+#define RAW_PHYSICS_BENCH_POSE_SET_H
+#include "common.h"
+#include "gm.h"
+#include "quaternion.h"
+#include "collider.h"
+
+// Pairs of colliders in fixed world poses, recorded from running scenes by physics_bench (--dump-poses) and replayed by
+// narrowphase_bench, so the narrowphase can be measured on the configurations that the simulation actually sees.
+//
+// Pose sets are stored as text:
+//   raw_physics_pose_set 1
+//   shapes N
+//   sphere RADIUS | box HX HY HZ | capsule RADIUS HALF_HEIGHT | cylinder RADIUS HALF_HEIGHT | hull NUM_VERTICES X Y Z...
+//   pairs N
+//   SHAPE1 SHAPE2 X1 Y1 Z1 QX1 QY1 QZ1 QW1 X2 Y2 Z2 QX2 QY2 QZ2 QW2
+// with one shape or pair per line.
+
+#define POSE_SET_MAX_PAIRS 100000
+
+// The local geometry of a collider, relative to the origin of its entity
+typedef struct {
+	Collider_Type type;
+	// Sphere: radius. Capsule and cylinder: radius and half height.
+	r64 radius;
+	r64 half_height;
+	vec3 half_extents;
+	// Light array, only for convex hulls
+	vec3* vertices;
+} Pose_Set_Shape;
+
+typedef struct {
+	u32 shape1;
+	u32 shape2;
+	vec3 position1;
+	Quaternion rotation1;
+	vec3 position2;
+	Quaternion rotation2;
+} Pose_Set_Pair;
+
+typedef struct {
+	Pose_Set_Shape* shapes;
+	Pose_Set_Pair* pairs;
+} Pose_Set;
+
+void pose_set_init(Pose_Set* set);
+void pose_set_destroy(Pose_Set* set);
+// Adds a pair of colliders, given the poses of the entities that own them. Equal shapes are only stored once.
+// Returns false once the set has POSE_SET_MAX_PAIRS pairs.
+boolean pose_set_add_pair(Pose_Set* set, const Collider* collider1, vec3 position1, Quaternion rotation1,
+	const Collider* collider2, vec3 position2, Quaternion rotation2);
+boolean pose_set_write(const Pose_Set* set, const char* path);
+// 'set' must be initialized. On failure it is left empty.
+boolean pose_set_read(Pose_Set* set, const char* path);
+
+#endif
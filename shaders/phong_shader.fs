@@ -3,6 +3,7 @@
 in vec3 fragment_position;
 in vec3 fragment_normal;
 in vec2 fragment_texture_coords;
+flat in vec4 fragment_color;
 
 // Light
 struct Light
@@ -13,12 +14,15 @@ struct Light
 	vec4 specular_color;
 };
 
-uniform mat4 model_matrix;
-uniform Light lights[16];
-uniform int light_quantity;
+// Shared by all draws of a frame, laid out as 'Light_Block' in graphics.cpp
+layout (std140) uniform Lights
+{
+	Light lights[16];
+	int light_quantity;
+};
+
 uniform vec3 camera_position;
 uniform float object_shineness;
-uniform vec4 color;
 // Specular map will not be used (<1,1,1,1> assumed)
 
 out vec4 final_color;
@@ -26,7 +30,7 @@ out vec4 final_color;
 vec3 get_point_color_of_light(Light light)
 {
 	vec3 normal = normalize(fragment_normal);
-	vec4 real_diffuse_color = color;
+	vec4 real_diffuse_color = fragment_color;
 
 	vec3 fragment_to_point_light_vec = normalize(light.position - fragment_position);
 
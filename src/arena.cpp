@@ -0,0 +1,202 @@
+#include "arena.h"
+#include "memory_tracker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <mutex>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(x) (((x) + ARENA_ALIGNMENT - 1) & ~((u64)ARENA_ALIGNMENT - 1))
+#define SCRATCH_BLOCK_SIZE (1024 * 1024)
+#define MAX_SCRATCHES 64
+
+struct Arena_Block {
+	Arena_Block* next;
+	u64 size;
+	u64 used;
+};
+
+// Data starts right after the block header
+#define BLOCK_HEADER_SIZE ARENA_ALIGN(sizeof(Arena_Block))
+#define BLOCK_DATA(B) ((u8*)(B) + BLOCK_HEADER_SIZE)
+
+static thread_local Arena* scratch;
+static std::mutex scratches_mutex;
+static Arena* scratches[MAX_SCRATCHES];
+static u32 num_scratches;
+
+static Arena_Block* block_create(u64 size) {
+	Arena_Block* block = (Arena_Block*)memory_tracker_malloc(BLOCK_HEADER_SIZE + size);
+	block->next = NULL;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+static void* arena_reallocate(Light_Array_Allocator* allocator, void* memory, size_t old_size, size_t new_size) {
+	Arena* arena = (Arena*)allocator;
+	Arena_Block* block = arena->current_block;
+
+	// The last allocation can simply grow, if there is space left in the block
+	if (memory == arena->last_allocation) {
+		u64 offset = (u8*)memory - BLOCK_DATA(block);
+		if (offset + new_size <= block->size) {
+			block->used = ARENA_ALIGN(offset + new_size);
+			return memory;
+		}
+	}
+
+	void* new_memory = arena_allocate(arena, new_size);
+	memcpy(new_memory, memory, MIN(old_size, new_size));
+	return new_memory;
+}
+
+static void arena_free(Light_Array_Allocator* allocator, void* memory) {
+	Arena* arena = (Arena*)allocator;
+
+	// Only the last allocation can be given back, everything else waits for the arena to be reset
+	if (memory == arena->last_allocation) {
+		arena->current_block->used = (u8*)memory - BLOCK_DATA(arena->current_block);
+		arena->last_allocation = NULL;
+	}
+}
+
+void arena_init(Arena* arena, u64 block_size) {
+	arena->allocator.reallocate = arena_reallocate;
+	arena->allocator.free = arena_free;
+	arena->first_block = NULL;
+	arena->current_block = NULL;
+	arena->block_size = block_size;
+	arena->last_allocation = NULL;
+}
+
+void arena_destroy(Arena* arena) {
+	Arena_Block* block = arena->first_block;
+	while (block) {
+		Arena_Block* next = block->next;
+		memory_tracker_free(block);
+		block = next;
+	}
+	arena->first_block = NULL;
+	arena->current_block = NULL;
+	arena->last_allocation = NULL;
+}
+
+void* arena_allocate(Arena* arena, u64 size) {
+	size = ARENA_ALIGN(size);
+	Arena_Block* block = arena->current_block;
+
+	if (!block) {
+		block = block_create(MAX(arena->block_size, size));
+		arena->first_block = block;
+	} else if (block->used + size > block->size) {
+		// Blocks after the current one are left over from before a reset, so they can be reused
+		if (block->next && block->next->size >= size) {
+			block = block->next;
+			block->used = 0;
+		} else {
+			Arena_Block* new_block = block_create(MAX(arena->block_size, size));
+			new_block->next = block->next;
+			block->next = new_block;
+			block = new_block;
+		}
+	}
+	arena->current_block = block;
+
+	void* memory = BLOCK_DATA(block) + block->used;
+	block->used += size;
+	arena->last_allocation = memory;
+	memset(memory, 0, size);
+	return memory;
+}
+
+Arena_Marker arena_get_marker(Arena* arena) {
+	Arena_Marker marker;
+	marker.block = arena->current_block;
+	marker.used = arena->current_block ? arena->current_block->used : 0;
+	return marker;
+}
+
+void arena_reset_to_marker(Arena* arena, Arena_Marker marker) {
+	if (marker.block) {
+		arena->current_block = marker.block;
+		arena->current_block->used = marker.used;
+	} else if (arena->first_block) {
+		arena->current_block = arena->first_block;
+		arena->current_block->used = 0;
+	}
+	arena->last_allocation = NULL;
+}
+
+void arena_reset(Arena* arena) {
+	if (arena->first_block && arena->first_block->next) {
+		u64 total_size = 0;
+		for (Arena_Block* block = arena->first_block; block; block = block->next) {
+			total_size += block->size;
+		}
+		arena_destroy(arena);
+		arena->first_block = block_create(total_size);
+	}
+
+	arena->current_block = arena->first_block;
+	if (arena->current_block) {
+		arena->current_block->used = 0;
+	}
+	arena->last_allocation = NULL;
+}
+
+void* arena_array_allocate(Arena* arena, u64 size_element, u64 capacity) {
+	Dynamic_ArrayBase* base = (Dynamic_ArrayBase*)arena_allocate(arena, sizeof(Dynamic_ArrayBase) + size_element * capacity);
+	base->capacity = capacity;
+	base->length = 0;
+	base->allocator = &arena->allocator;
+	return base + 1;
+}
+
+void* arena_array_copy_dyn(Arena* arena, const void* array, u64 size_element) {
+	const Dynamic_ArrayBase* base = (const Dynamic_ArrayBase*)array - 1;
+	void* copy = arena_array_allocate(arena, size_element, MAX(base->capacity, 1));
+	memcpy(copy, array, base->length * size_element);
+	array_length(copy) = base->length;
+	return copy;
+}
+
+Arena* arena_get_scratch() {
+	if (!scratch) {
+		scratch = (Arena*)memory_tracker_malloc(sizeof(Arena));
+		arena_init(scratch, SCRATCH_BLOCK_SIZE);
+
+		std::lock_guard<std::mutex> lock(scratches_mutex);
+		assert(num_scratches < MAX_SCRATCHES);
+		scratches[num_scratches++] = scratch;
+	}
+
+	return scratch;
+}
+
+void arena_destroy_scratch() {
+	if (!scratch) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(scratches_mutex);
+	for (u32 i = 0; i < num_scratches; ++i) {
+		if (scratches[i] == scratch) {
+			scratches[i] = scratches[--num_scratches];
+			break;
+		}
+	}
+	arena_destroy(scratch);
+	memory_tracker_free(scratch);
+	scratch = NULL;
+}
+
+void arena_destroy_scratches() {
+	std::lock_guard<std::mutex> lock(scratches_mutex);
+	for (u32 i = 0; i < num_scratches; ++i) {
+		arena_destroy(scratches[i]);
+		memory_tracker_free(scratches[i]);
+	}
+	num_scratches = 0;
+	scratch = NULL;
+}
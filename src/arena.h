@@ -0,0 +1,54 @@
+#ifndef RAW_PHYSICS_ARENA_H
+#define RAW_PHYSICS_ARENA_H
+#include "common.h"
+#include "light_array.h"
+
+// A linear allocator. Memory is handed out from big blocks and is only given back when the arena is reset, which makes
+// allocating temporaries very cheap. Arrays created with 'arena_array_new' live in the arena: they can still grow and be
+// freed with the regular light_array macros, but their memory is only reclaimed when the arena is reset (or when they are
+// the last allocation of the arena).
+typedef struct Arena_Block Arena_Block;
+
+typedef struct {
+	// Must be the first field, arrays point back to the arena through it.
+	Light_Array_Allocator allocator;
+	Arena_Block* first_block;
+	Arena_Block* current_block;
+	u64 block_size;
+	// The last allocation, which can be grown or freed in place
+	void* last_allocation;
+} Arena;
+
+typedef struct {
+	Arena_Block* block;
+	u64 used;
+} Arena_Marker;
+
+void arena_init(Arena* arena, u64 block_size);
+void arena_destroy(Arena* arena);
+// Returns zeroed memory, aligned to 16 bytes.
+void* arena_allocate(Arena* arena, u64 size);
+// Frees everything allocated after 'arena_get_marker' was called. Blocks are kept for reuse.
+Arena_Marker arena_get_marker(Arena* arena);
+void arena_reset_to_marker(Arena* arena, Arena_Marker marker);
+// Frees everything. If the arena needed more than one block since the last reset, the blocks are merged into a single
+// block big enough to hold all of them, so a workload that repeats itself stops allocating after the first reset.
+void arena_reset(Arena* arena);
+void* arena_array_allocate(Arena* arena, u64 size_element, u64 capacity);
+void* arena_array_copy_dyn(Arena* arena, const void* array, u64 size_element);
+
+// Each thread has its own scratch arena for its temporaries. The simulation step resets the arena of the thread that runs it
+// and, through the thread pool, the arenas of the workers, so their scratch memory is only valid until the end of the step.
+// The arenas of other threads are only reset by their own thread.
+Arena* arena_get_scratch();
+// Destroys the scratch arena of the calling thread, so that threads that come and go don't keep theirs until the end.
+void arena_destroy_scratch();
+// Must be called after all threads that used their scratch arena are gone.
+void arena_destroy_scratches();
+
+// Creates a new array of type T with starting capacity L in the arena.
+#define arena_array_new(T, L, A) ((T*)arena_array_allocate(A, sizeof(T), MAX(L, 1)))
+// Copies an array into a new array that lives in the arena.
+#define arena_array_copy(Arr, A) arena_array_copy_dyn(A, Arr, sizeof(*(Arr)))
+
+#endif
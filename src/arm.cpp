@@ -1,7 +1,6 @@
 #include "arm.h"
 
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 
 #include "light_array.h"
 #include <stdio.h>
@@ -53,23 +52,23 @@ static Constraint* create_arm() {
 
 	vec3 support_position = {0.0, 15.0, 0.0};
 	vec3 support_collider_scale = {0.2, 0.1, 0.1};
-	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, support_collider_scale);
-	eid support_id = entity_create_fixed(cube_mesh, support_position, quaternion_new({1.0, 0.0, 0.0}, 0.0), support_collider_scale,
+	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, support_collider_scale);
+	eid support_id = examples_util_create_fixed_entity(cube_mesh, support_position, quaternion_new({1.0, 0.0, 0.0}, 0.0), support_collider_scale,
 		{0.0, 1.0, 0.0, 1.0}, support_colliders, 0.5, 0.5, 0.0);
 
 	vec3 upper_arm_collider_scale = {0.2, 1.0, 0.1};
-	Collider* upper_arm_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, upper_arm_collider_scale);
-	eid upper_arm_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), upper_arm_collider_scale,
+	Collider* upper_arm_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, upper_arm_collider_scale);
+	eid upper_arm_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), upper_arm_collider_scale,
 		{1.0, 1.0, 0.0, 1.0}, 1.0, upper_arm_colliders, 0.6, 0.6, 0.0);
 
 	vec3 lower_arm_collider_scale = {0.15, 1.0, 0.1};
-	Collider* lower_arm_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, lower_arm_collider_scale);
-	eid lower_arm_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), lower_arm_collider_scale,
+	Collider* lower_arm_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, lower_arm_collider_scale);
+	eid lower_arm_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), lower_arm_collider_scale,
 		{1.0, 1.0, 0.0, 1.0}, 1.0, lower_arm_colliders, 0.6, 0.6, 0.0);
 
 	vec3 hand_collider_scale = {0.3, 0.3, 0.1};
-	Collider* hand_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, hand_collider_scale);
-	eid hand_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), hand_collider_scale,
+	Collider* hand_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, hand_collider_scale);
+	eid hand_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0), hand_collider_scale,
 		{1.0, 1.0, 0.0, 1.0}, 1.0, hand_colliders, 0.6, 0.6, 0.0);
 
 	array_free(cube_vertices);
@@ -133,7 +132,7 @@ void ex_arm_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -155,7 +154,7 @@ void ex_arm_update(r64 delta_time) {
 		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
 	}
 
-	pbd_simulate_with_constraints(delta_time, entities, constraints, 20, 1, true);
+	pbd_simulate_with_constraints(delta_time, entities, constraints, 20, 1, true, NULL);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		entity_clear_forces(entities[i]);
@@ -164,55 +163,45 @@ void ex_arm_update(r64 delta_time) {
 }
 
 void ex_arm_render() {
-	Entity** entities = entity_get_all();
-
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_arm_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 30.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
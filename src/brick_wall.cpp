@@ -1,6 +1,5 @@
 #include "brick_wall.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -14,6 +13,7 @@
 #include "entity.h"
 #include "util.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
@@ -51,8 +51,8 @@ int ex_brick_wall_init() {
 	Mesh cube_mesh = graphics_mesh_create(cube_vertices, cube_indices);
 
 	vec3 floor_scale = {50.0, 1.0, 50.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, floor_scale);
-	entity_create_fixed(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_box_collider_array(floor_scale);
+	examples_util_create_fixed_entity(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, 0.0);
 
 	brick_eids = array_new(eid);
@@ -69,11 +69,11 @@ int ex_brick_wall_init() {
 		}
 		for (u32 j = 0; j < 4; ++j) {
 			vec3 cube_scale = {brick_width, brick_height, brick_height};
-			Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, cube_scale);
+			Collider* cube_colliders = examples_util_create_single_box_collider_array(cube_scale);
 			vec4 color = ((i + j) % 2 == 0) ?
 				vec4{ 188.0 / 255.0, 74.0 / 255.0, 60.0 / 255.0, 1.0 } :
 				vec4{ 168.0 / 255.0, 64.0 / 255.0, 50.0 / 255.0, 1.0 };
-			eid brick_eid = entity_create(cube_mesh, {x, y, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+			eid brick_eid = examples_util_create_entity(cube_mesh, {x, y, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 				cube_scale, color, 0.5, cube_colliders, static_friction_coefficient, dynamic_friction_coefficient, 0.0);
 			array_push(brick_eids, brick_eid);
 			x += 2 * brick_width + 0.01;
@@ -95,7 +95,7 @@ void ex_brick_wall_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -131,54 +131,45 @@ void ex_brick_wall_update(r64 delta_time) {
 }
 
 void ex_brick_wall_render() {
-	Entity** entities = entity_get_all();
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_brick_wall_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
@@ -210,30 +201,36 @@ void ex_brick_wall_window_resize_process(s32 width, s32 height) {
 	camera_force_matrix_recalculation(&camera);
 }
 
+typedef struct {
+	r64 static_friction_coefficient;
+	r64 dynamic_friction_coefficient;
+} Friction_Coefficients;
+
+static void set_friction_coefficients(void* data) {
+	Friction_Coefficients* coefficients = (Friction_Coefficients*)data;
+	for (u32 i = 0; i < array_length(brick_eids); ++i) {
+		Entity* brick_entity = entity_get_by_id(brick_eids[i]);
+		brick_entity->static_friction_coefficient = coefficients->static_friction_coefficient;
+		brick_entity->dynamic_friction_coefficient = coefficients->dynamic_friction_coefficient;
+		entity_activate(brick_entity);
+	}
+}
+
 void ex_brick_wall_menu_update() {
 	ImGui::Text("Brick Wall");
 	ImGui::Separator();
 
 	ImGui::TextWrapped("Tweak the friction coefficients of the bricks that compose the wall.");
 	ImGui::TextWrapped("Bricks static friction coefficient:");
-	if (ImGui::SliderFloat("fs", &static_friction_coefficient, 0.0f, 1.0f, "%.3f")) {
-		for (u32 i = 0; i < array_length(brick_eids); ++i) {
-			Entity* brick_entity = entity_get_by_id(brick_eids[i]);
-			brick_entity->static_friction_coefficient = (r64)static_friction_coefficient;
-			entity_activate(brick_entity);
-		}
-	}
+	boolean changed = ImGui::SliderFloat("fs", &static_friction_coefficient, 0.0f, 1.0f, "%.3f");
 
 	ImGui::TextWrapped("Bricks dynamic friction coefficient:");
-	bool changed = ImGui::SliderFloat("fd", &dynamic_friction_coefficient, 0.0f, 1.0f, "%.3f");
+	changed |= ImGui::SliderFloat("fd", &dynamic_friction_coefficient, 0.0f, 1.0f, "%.3f");
 	if (changed || dynamic_friction_coefficient > static_friction_coefficient) {
 		// clamp dynamic friction if it was set to be greater than static friction (to be 'physically' more accurate)
 		dynamic_friction_coefficient = CLAMP(dynamic_friction_coefficient, 0.0, static_friction_coefficient);
-		for (u32 i = 0; i < array_length(brick_eids); ++i) {
-			Entity* brick_entity = entity_get_by_id(brick_eids[i]);
-			brick_entity->dynamic_friction_coefficient = (r64)dynamic_friction_coefficient;
-			entity_activate(brick_entity);
-		}
+		Friction_Coefficients coefficients = {(r64)static_friction_coefficient, (r64)dynamic_friction_coefficient};
+		physics_thread_push_command(set_friction_coefficients, &coefficients, sizeof(coefficients));
 	}
 	ImGui::Separator();
 
@@ -1,11 +1,11 @@
 #include "broad.h"
 #include "light_array.h"
-#include "hash_map.h"
+#include "hash_table.h"
 #include "util.h"
 
-Broad_Collision_Pair* broad_get_collision_pairs(Entity** entities) {
+Broad_Collision_Pair* broad_get_collision_pairs(Entity** entities, Arena* arena) {
 	Broad_Collision_Pair pair;
-	Broad_Collision_Pair* collision_pairs = array_new_len(Broad_Collision_Pair, 32);
+	Broad_Collision_Pair* collision_pairs = arena_array_new(Broad_Collision_Pair, 32, arena);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		Entity* e1 = entities[i];
@@ -28,29 +28,29 @@ Broad_Collision_Pair* broad_get_collision_pairs(Entity** entities) {
 	return collision_pairs;
 }
 
-static eid uf_find(Hash_Map* entity_to_parent_map, eid x) {
-	eid p;
-	assert(!hash_map_get(entity_to_parent_map, &x, &p));
-	if (p == x) {
+static eid uf_find(Hash_Table<eid, eid>* entity_to_parent_map, eid x) {
+	eid* p = hash_table_get(entity_to_parent_map, x);
+	assert(p);
+	if (*p == x) {
 		return x;
 	}
 
-	return uf_find(entity_to_parent_map, p);
+	return uf_find(entity_to_parent_map, *p);
 }
 
-static void uf_union(Hash_Map* entity_to_parent_map, eid x, eid y) {
+static void uf_union(Hash_Table<eid, eid>* entity_to_parent_map, eid x, eid y) {
 	eid key = uf_find(entity_to_parent_map, y);
 	eid value = uf_find(entity_to_parent_map, x);
-	assert(hash_map_put(entity_to_parent_map, &key, &value) == 0);
+	hash_table_put(entity_to_parent_map, key, value);
 }
 
-static Hash_Map uf_collect_all(Entity** entities, Broad_Collision_Pair* collision_pairs) {
-	Hash_Map entity_to_parent_map;
-	assert(!hash_map_create(&entity_to_parent_map, 1024, sizeof(eid), sizeof(eid), util_eid_compare, util_eid_hash));
+static Hash_Table<eid, eid> uf_collect_all(Entity** entities, Broad_Collision_Pair* collision_pairs, Arena* arena) {
+	Hash_Table<eid, eid> entity_to_parent_map;
+	hash_table_create(&entity_to_parent_map, array_length(entities), arena);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		eid id = entities[i]->id;
-		assert(!hash_map_put(&entity_to_parent_map, &id, &id));
+		hash_table_put(&entity_to_parent_map, id, id);
 	}
 
 	for (u32 i = 0; i < array_length(collision_pairs); ++i) {
@@ -67,11 +67,11 @@ static Hash_Map uf_collect_all(Entity** entities, Broad_Collision_Pair* collisio
 	return entity_to_parent_map;
 }
 
-eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair* collision_pairs, const Constraint* constraints) {
-	eid** simulation_islands = array_new_len(eid*, 32);
+eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair* collision_pairs, const Constraint* constraints, Arena* arena) {
+	eid** simulation_islands = arena_array_new(eid*, 32, arena);
 
 	// Collect the simulation islands into an entity->parent map
-	Hash_Map entity_to_parent_map = uf_collect_all(entities, collision_pairs);
+	Hash_Table<eid, eid> entity_to_parent_map = uf_collect_all(entities, collision_pairs, arena);
 
 	// Extra step: To avoid bugs, we need to make sure that entities that are part of a same constraint are also part of the same island!
 	if (constraints != NULL) {
@@ -89,8 +89,8 @@ eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair*
 	}
 
 	// As a last step, transform the simulation islands into a nice structure
-	Hash_Map simulation_islands_map;
-	assert(!hash_map_create(&simulation_islands_map, 2 * array_length(entities), sizeof(eid), sizeof(u32), util_eid_compare, util_eid_hash));
+	Hash_Table<eid, u32> simulation_islands_map;
+	hash_table_create(&simulation_islands_map, array_length(entities), arena);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		Entity* e = entities[i];
@@ -99,19 +99,22 @@ eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair*
 		}
 		eid parent = uf_find(&entity_to_parent_map, e->id);
 		u32 simulation_island_idx;
-		if (hash_map_get(&simulation_islands_map, &parent, &simulation_island_idx)) {
+		u32* existing_simulation_island_idx = hash_table_get(&simulation_islands_map, parent);
+		if (existing_simulation_island_idx) {
+			simulation_island_idx = *existing_simulation_island_idx;
+		} else {
 			// Simulation Island not created yet.
-			eid* new_simulation_island = array_new_len(eid, 32);
+			eid* new_simulation_island = arena_array_new(eid, 32, arena);
 			simulation_island_idx = array_length(simulation_islands);
 			array_push(simulation_islands, new_simulation_island);
-			assert(!hash_map_put(&simulation_islands_map, &parent, &simulation_island_idx));
+			hash_table_put(&simulation_islands_map, parent, simulation_island_idx);
 		}
 
 		array_push(simulation_islands[simulation_island_idx], e->id);
 	}
 
-	hash_map_destroy(&entity_to_parent_map);
-	hash_map_destroy(&simulation_islands_map);
+	hash_table_destroy(&entity_to_parent_map);
+	hash_table_destroy(&simulation_islands_map);
 	return simulation_islands;
 }
 
@@ -1,15 +1,17 @@
 #ifndef RAW_PHYSICS_PHYSICS_BROAD_H
 #define RAW_PHYSICS_PHYSICS_BROAD_H
-#include "graphics.h"
+#include "entity.h"
 #include "pbd.h"
+#include "arena.h"
 
 typedef struct {
 	eid e1_id;
 	eid e2_id;
 } Broad_Collision_Pair;
 
-Broad_Collision_Pair* broad_get_collision_pairs(Entity** entities);
-eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair* collision_pairs, const Constraint* constraints);
+// The returned arrays are allocated in 'arena'.
+Broad_Collision_Pair* broad_get_collision_pairs(Entity** entities, Arena* arena);
+eid** broad_collect_simulation_islands(Entity** entities, Broad_Collision_Pair* collision_pairs, const Constraint* constraints, Arena* arena);
 void broad_simulation_islands_destroy(eid** simulation_islands);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "bvh.h"
+#include "light_array.h"
+#include "arena.h"
+#include <float.h>
+#include <math.h>
+
+#define BVH_MAX_STACK_SIZE 256
+
+typedef struct {
+	vec3 aabb_min;
+	vec3 aabb_max;
+	vec3 centroid;
+	u32 collider_idx;
+} Collider_Bounds;
+
+typedef struct {
+	u32 node1;
+	u32 node2;
+} Node_Pair;
+
+static r64 vec3_get(vec3 v, u32 axis) {
+	return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static void get_collider_local_aabb(const Collider* collider, vec3* aabb_min, vec3* aabb_max) {
+	vec3 half_extents;
+	switch (collider->type) {
+		case COLLIDER_TYPE_CONVEX_HULL: {
+			*aabb_min = {DBL_MAX, DBL_MAX, DBL_MAX};
+			*aabb_max = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+			for (u32 i = 0; i < collider->convex_hull.shape->num_vertices; ++i) {
+				vec3 v = collider->convex_hull.shape->vertices[i];
+				*aabb_min = {MIN(aabb_min->x, v.x), MIN(aabb_min->y, v.y), MIN(aabb_min->z, v.z)};
+				*aabb_max = {MAX(aabb_max->x, v.x), MAX(aabb_max->y, v.y), MAX(aabb_max->z, v.z)};
+			}
+			return;
+		} break;
+		case COLLIDER_TYPE_SPHERE: {
+			half_extents = {collider->sphere.radius, collider->sphere.radius, collider->sphere.radius};
+		} break;
+		case COLLIDER_TYPE_BOX: {
+			half_extents = collider->box.half_extents;
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			r64 r = collider->capsule.radius;
+			half_extents = {r, collider->capsule.half_height + r, r};
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			r64 r = collider->cylinder.radius;
+			half_extents = {r, collider->cylinder.half_height, r};
+		} break;
+		default: {
+			assert(0);
+		} break;
+	}
+
+	// All other colliders are centered at the origin of the entity
+	*aabb_min = gm_vec3_invert(half_extents);
+	*aabb_max = half_extents;
+}
+
+// Builds the subtree for 'bounds[start..end)', splitting at the median of the centroids along the longest axis.
+// Returns the index of the root of the subtree.
+static u32 build_node(Colliders_BVH* bvh, Collider_Bounds* bounds, u32 start, u32 end) {
+	Colliders_BVH_Node node;
+	node.aabb_min = {DBL_MAX, DBL_MAX, DBL_MAX};
+	node.aabb_max = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+	vec3 centroid_min = {DBL_MAX, DBL_MAX, DBL_MAX};
+	vec3 centroid_max = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+	for (u32 i = start; i < end; ++i) {
+		node.aabb_min = {MIN(node.aabb_min.x, bounds[i].aabb_min.x), MIN(node.aabb_min.y, bounds[i].aabb_min.y),
+			MIN(node.aabb_min.z, bounds[i].aabb_min.z)};
+		node.aabb_max = {MAX(node.aabb_max.x, bounds[i].aabb_max.x), MAX(node.aabb_max.y, bounds[i].aabb_max.y),
+			MAX(node.aabb_max.z, bounds[i].aabb_max.z)};
+		centroid_min = {MIN(centroid_min.x, bounds[i].centroid.x), MIN(centroid_min.y, bounds[i].centroid.y),
+			MIN(centroid_min.z, bounds[i].centroid.z)};
+		centroid_max = {MAX(centroid_max.x, bounds[i].centroid.x), MAX(centroid_max.y, bounds[i].centroid.y),
+			MAX(centroid_max.z, bounds[i].centroid.z)};
+	}
+
+	u32 node_idx = array_length(bvh->nodes);
+	array_push(bvh->nodes, node);
+
+	if (end - start == 1) {
+		bvh->nodes[node_idx].is_leaf = true;
+		bvh->nodes[node_idx].left = bounds[start].collider_idx;
+		bvh->nodes[node_idx].right = 0;
+		return node_idx;
+	}
+
+	vec3 centroid_extents = gm_vec3_subtract(centroid_max, centroid_min);
+	u32 axis = 0;
+	if (centroid_extents.y > vec3_get(centroid_extents, axis)) axis = 1;
+	if (centroid_extents.z > vec3_get(centroid_extents, axis)) axis = 2;
+
+	// Insertion sort is enough, since entities have just a few colliders
+	for (u32 i = start + 1; i < end; ++i) {
+		Collider_Bounds b = bounds[i];
+		u32 j = i;
+		while (j > start && vec3_get(bounds[j - 1].centroid, axis) > vec3_get(b.centroid, axis)) {
+			bounds[j] = bounds[j - 1];
+			--j;
+		}
+		bounds[j] = b;
+	}
+
+	u32 mid = start + (end - start) / 2;
+	u32 left = build_node(bvh, bounds, start, mid);
+	u32 right = build_node(bvh, bounds, mid, end);
+	// The array might have been reallocated during the recursion
+	bvh->nodes[node_idx].is_leaf = false;
+	bvh->nodes[node_idx].left = left;
+	bvh->nodes[node_idx].right = right;
+	return node_idx;
+}
+
+Colliders_BVH colliders_bvh_create(const Collider* colliders) {
+	Colliders_BVH bvh;
+	u32 num_colliders = array_length(colliders);
+	bvh.nodes = array_new_len(Colliders_BVH_Node, 2 * num_colliders);
+	if (num_colliders == 0) {
+		return bvh;
+	}
+
+	Collider_Bounds* bounds = array_new_len(Collider_Bounds, num_colliders);
+	for (u32 i = 0; i < num_colliders; ++i) {
+		Collider_Bounds b;
+		get_collider_local_aabb(&colliders[i], &b.aabb_min, &b.aabb_max);
+		b.centroid = gm_vec3_scalar_product(0.5, gm_vec3_add(b.aabb_min, b.aabb_max));
+		b.collider_idx = i;
+		array_push(bounds, b);
+	}
+
+	build_node(&bvh, bounds, 0, num_colliders);
+	array_free(bounds);
+	return bvh;
+}
+
+void colliders_bvh_destroy(Colliders_BVH* bvh) {
+	array_free(bvh->nodes);
+}
+
+// Brings the bounding box of 'node' from the space of entity 2 to the space of entity 1, enlarging it to keep it axis-aligned.
+// 'rotation_columns' are the columns of the rotation matrix from space 2 to space 1.
+static void transform_aabb(const Colliders_BVH_Node* node, const vec3 rotation_columns[3], vec3 translation, vec3* aabb_min,
+	vec3* aabb_max) {
+	vec3 center = gm_vec3_scalar_product(0.5, gm_vec3_add(node->aabb_min, node->aabb_max));
+	vec3 half_extents = gm_vec3_scalar_product(0.5, gm_vec3_subtract(node->aabb_max, node->aabb_min));
+
+	vec3 transformed_center = translation;
+	vec3 transformed_half_extents = {0.0, 0.0, 0.0};
+	for (u32 j = 0; j < 3; ++j) {
+		vec3 c = rotation_columns[j];
+		transformed_center = gm_vec3_add(transformed_center, gm_vec3_scalar_product(vec3_get(center, j), c));
+		transformed_half_extents = gm_vec3_add(transformed_half_extents,
+			gm_vec3_scalar_product(vec3_get(half_extents, j), {fabs(c.x), fabs(c.y), fabs(c.z)}));
+	}
+
+	*aabb_min = gm_vec3_subtract(transformed_center, transformed_half_extents);
+	*aabb_max = gm_vec3_add(transformed_center, transformed_half_extents);
+}
+
+static boolean aabbs_overlap(vec3 min1, vec3 max1, vec3 min2, vec3 max2) {
+	return min1.x <= max2.x && min2.x <= max1.x &&
+		min1.y <= max2.y && min2.y <= max1.y &&
+		min1.z <= max2.z && min2.z <= max1.z;
+}
+
+static r64 aabb_volume(const Colliders_BVH_Node* node) {
+	vec3 d = gm_vec3_subtract(node->aabb_max, node->aabb_min);
+	return d.x * d.y * d.z;
+}
+
+// Both hierarchies are descended at the same time. Since the bounding boxes of the second entity are brought to the space
+// of the first one, only the first entity's boxes are tight, which is fine for culling.
+Collider_Contact* colliders_bvh_get_contacts(Collider* colliders1, const Colliders_BVH* bvh1, vec3 position1,
+	const Quaternion* rotation1, Collider* colliders2, const Colliders_BVH* bvh2, vec3 position2, const Quaternion* rotation2) {
+	Collider_Contact* contacts = arena_array_new(Collider_Contact, 16, arena_get_scratch());
+	if (array_length(bvh1->nodes) == 0 || array_length(bvh2->nodes) == 0) {
+		return contacts;
+	}
+
+	// Entities with a single collider don't benefit from the hierarchy.
+	if (array_length(colliders1) == 1 && array_length(colliders2) == 1) {
+		collider_get_contacts(&colliders1[0], &colliders2[0], &contacts);
+		return contacts;
+	}
+
+	vec3 rotation_columns[3];
+	rotation_columns[0] = quaternion_apply_inverse_to_vec3(rotation1, quaternion_apply_to_vec3(rotation2, {1.0, 0.0, 0.0}));
+	rotation_columns[1] = quaternion_apply_inverse_to_vec3(rotation1, quaternion_apply_to_vec3(rotation2, {0.0, 1.0, 0.0}));
+	rotation_columns[2] = quaternion_apply_inverse_to_vec3(rotation1, quaternion_apply_to_vec3(rotation2, {0.0, 0.0, 1.0}));
+	vec3 translation = quaternion_apply_inverse_to_vec3(rotation1, gm_vec3_subtract(position2, position1));
+
+	Node_Pair stack[BVH_MAX_STACK_SIZE];
+	u32 stack_size = 0;
+	stack[stack_size++] = {0, 0};
+
+	while (stack_size > 0) {
+		Node_Pair pair = stack[--stack_size];
+		const Colliders_BVH_Node* node1 = &bvh1->nodes[pair.node1];
+		const Colliders_BVH_Node* node2 = &bvh2->nodes[pair.node2];
+
+		vec3 aabb2_min, aabb2_max;
+		transform_aabb(node2, rotation_columns, translation, &aabb2_min, &aabb2_max);
+		if (!aabbs_overlap(node1->aabb_min, node1->aabb_max, aabb2_min, aabb2_max)) {
+			continue;
+		}
+
+		if (node1->is_leaf && node2->is_leaf) {
+			collider_get_contacts(&colliders1[node1->left], &colliders2[node2->left], &contacts);
+			continue;
+		}
+
+		assert(stack_size + 2 <= BVH_MAX_STACK_SIZE);
+
+		// Descend into the node with the largest volume
+		if (node2->is_leaf || (!node1->is_leaf && aabb_volume(node1) >= aabb_volume(node2))) {
+			stack[stack_size++] = {node1->right, pair.node2};
+			stack[stack_size++] = {node1->left, pair.node2};
+		} else {
+			stack[stack_size++] = {pair.node1, node2->right};
+			stack[stack_size++] = {pair.node1, node2->left};
+		}
+	}
+
+	return contacts;
+}
@@ -0,0 +1,33 @@
+#ifndef RAW_PHYSICS_PHYSICS_BVH_H
+#define RAW_PHYSICS_PHYSICS_BVH_H
+#include "common.h"
+#include "gm.h"
+#include "collider.h"
+#include "quaternion.h"
+
+// A node of the bounding volume hierarchy of an entity's colliders.
+// Bounding boxes are in the local space of the entity, so the hierarchy never needs to be refitted.
+typedef struct {
+	vec3 aabb_min;
+	vec3 aabb_max;
+	// For internal nodes, the indices of the children. For leaves, 'left' is the index of the collider and 'right' is unused.
+	u32 left;
+	u32 right;
+	boolean is_leaf;
+} Colliders_BVH_Node;
+
+typedef struct {
+	// The root is always the first node.
+	Colliders_BVH_Node* nodes;
+} Colliders_BVH;
+
+// The colliders must not be transformed yet (i.e., they must be in the local space of the entity).
+Colliders_BVH colliders_bvh_create(const Collider* colliders);
+void colliders_bvh_destroy(Colliders_BVH* bvh);
+// Gets the contacts between two sets of colliders, only calling the narrowphase for the pairs of colliders whose bounding boxes overlap.
+// 'colliders1' and 'colliders2' must have already been updated to the given positions and rotations.
+// The contacts are allocated in the scratch arena of the calling thread.
+Collider_Contact* colliders_bvh_get_contacts(Collider* colliders1, const Colliders_BVH* bvh1, vec3 position1,
+	const Quaternion* rotation1, Collider* colliders2, const Colliders_BVH* bvh2, vec3 position2, const Quaternion* rotation2);
+
+#endif
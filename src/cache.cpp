@@ -0,0 +1,361 @@
+#include "cache.h"
+#include "light_array.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define CACHE_MAGIC 0x43435052 // "RPCC"
+// Must be bumped whenever the layout of the files changes, including the layout of the structs they store (Vertex, the shape
+// arrays...). Files with another version are rebuilt.
+#define CACHE_VERSION 3
+
+#define CACHE_ALIGN(x) (((x) + 7) & ~(u64)7)
+
+typedef enum {
+	CACHE_ENTRY_MESH = 1,
+	CACHE_ENTRY_CONVEX_HULL_SHAPE = 2
+} Cache_Entry_Type;
+
+// Every part of a file is 8-byte aligned, so the arrays can be used straight from the mapping.
+typedef struct {
+	u32 magic;
+	u32 version;
+	u32 type;
+	u32 padding;
+	// Identifies the entry, it is also the name of the file
+	u64 key;
+	// Hash of the contents of the source, the entry is stale when it changes
+	u64 source_hash;
+	// Size of everything after the header
+	u64 data_size;
+} Cache_File_Header;
+
+// Followed by the vertices and the indices
+typedef struct {
+	u32 num_vertices;
+	u32 num_indices;
+} Cache_Mesh_Header;
+
+// Followed by the arrays of the shape, then by the points it was built from
+typedef struct {
+	Collider_Convex_Hull_Shape_Layout layout;
+	u32 max_vertices;
+	u32 num_points;
+	r64 bounding_radius;
+	Collider_Mass_Properties mass_properties;
+} Cache_Shape_Header;
+
+typedef struct {
+	const void* data;
+	u64 size;
+} Cache_Part;
+
+typedef struct {
+	const u8* memory;
+	u64 size;
+} Cache_Mapping;
+
+// Light array. Mappings are never replaced, because shapes may still be using them: when an entry is rebuilt, its new file
+// is mapped next to the old one.
+static Cache_Mapping* mappings;
+
+// Not meant to be cryptographic, only to tell different sources apart.
+static u64 hash_bytes(const void* data, u64 size, u64 seed) {
+	const u8* bytes = (const u8*)data;
+	u64 hash = seed ^ (size * 0x9e3779b97f4a7c15ull);
+	u64 i = 0;
+	for (; i + 8 <= size; i += 8) {
+		u64 word;
+		memcpy(&word, bytes + i, 8);
+		hash ^= word * 0xff51afd7ed558ccdull;
+		hash = ((hash << 31) | (hash >> 33)) * 0xc4ceb9fe1a85ec53ull;
+	}
+	u64 tail = 0;
+	memcpy(&tail, bytes + i, size - i);
+	hash ^= tail * 0xff51afd7ed558ccdull;
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+// Returns NULL if the file doesn't exist or is empty.
+static const u8* map_file(const char* path, u64* size) {
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return NULL;
+	}
+	HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!file_mapping) {
+		return NULL;
+	}
+	// The view keeps the mapping alive
+	void* memory = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(file_mapping);
+	if (!memory) {
+		return NULL;
+	}
+	*size = (u64)file_size.QuadPart;
+	return (const u8*)memory;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return NULL;
+	}
+	struct stat file_stat;
+	if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+		close(file);
+		return NULL;
+	}
+	void* memory = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (memory == MAP_FAILED) {
+		return NULL;
+	}
+	*size = (u64)file_stat.st_size;
+	return (const u8*)memory;
+#endif
+}
+
+static void unmap_file(const u8* memory, u64 size) {
+#if defined(_WIN32)
+	UnmapViewOfFile(memory);
+#else
+	munmap((void*)memory, (size_t)size);
+#endif
+}
+
+static boolean hash_file(const char* path, u64* hash) {
+	u64 size;
+	const u8* memory = map_file(path, &size);
+	if (!memory) {
+		return false;
+	}
+	*hash = hash_bytes(memory, size, 0);
+	unmap_file(memory, size);
+	return true;
+}
+
+static void get_entry_path(u64 key, char* path, u64 path_size) {
+	snprintf(path, path_size, "%s/%016llx.bin", CACHE_DIRECTORY, (unsigned long long)key);
+}
+
+// Checks that the data after the header has the size its own header says it has, and that the indices in it are in range.
+static boolean is_entry_data_valid(Cache_Entry_Type type, const u8* data, u64 data_size) {
+	switch (type) {
+		case CACHE_ENTRY_MESH: {
+			if (data_size < sizeof(Cache_Mesh_Header)) {
+				return false;
+			}
+			const Cache_Mesh_Header* mesh = (const Cache_Mesh_Header*)data;
+			return data_size == CACHE_ALIGN(sizeof(Cache_Mesh_Header)) + CACHE_ALIGN(mesh->num_vertices * sizeof(Vertex)) +
+				CACHE_ALIGN(mesh->num_indices * sizeof(u32));
+		}
+		case CACHE_ENTRY_CONVEX_HULL_SHAPE: {
+			if (data_size < sizeof(Cache_Shape_Header)) {
+				return false;
+			}
+			const Cache_Shape_Header* shape = (const Cache_Shape_Header*)data;
+			return data_size == CACHE_ALIGN(sizeof(Cache_Shape_Header)) +
+				CACHE_ALIGN(collider_convex_hull_shape_get_arrays_size(&shape->layout)) + CACHE_ALIGN(shape->num_points * sizeof(vec3)) &&
+				collider_convex_hull_shape_are_arrays_valid(&shape->layout, data + CACHE_ALIGN(sizeof(Cache_Shape_Header)));
+		}
+	}
+	return false;
+}
+
+// Returns the data of the entry (everything after the header), mapping its file if needed.
+// Returns NULL if there is no such entry, or if it is stale or was written by another version.
+static const u8* get_entry_data(Cache_Entry_Type type, u64 key, u64 source_hash) {
+	if (!mappings) {
+		mappings = array_new(Cache_Mapping);
+	}
+
+	for (u32 i = 0; i < array_length(mappings); ++i) {
+		const Cache_File_Header* header = (const Cache_File_Header*)mappings[i].memory;
+		if (header->key == key && header->source_hash == source_hash && header->type == (u32)type) {
+			return mappings[i].memory + sizeof(Cache_File_Header);
+		}
+	}
+
+	char path[256];
+	get_entry_path(key, path, sizeof(path));
+	Cache_Mapping mapping;
+	mapping.memory = map_file(path, &mapping.size);
+	if (!mapping.memory) {
+		return NULL;
+	}
+
+	const Cache_File_Header* header = (const Cache_File_Header*)mapping.memory;
+	const u8* data = mapping.memory + sizeof(Cache_File_Header);
+	if (mapping.size < sizeof(Cache_File_Header) || header->magic != CACHE_MAGIC || header->version != CACHE_VERSION ||
+		header->type != (u32)type || header->key != key || header->source_hash != source_hash ||
+		header->data_size != mapping.size - sizeof(Cache_File_Header) || !is_entry_data_valid(type, data, header->data_size)) {
+		unmap_file(mapping.memory, mapping.size);
+		return NULL;
+	}
+
+	array_push(mappings, mapping);
+	return data;
+}
+
+// Writes the parts one after the other, each one padded to 8 bytes. Failing to write is not an error, the entry is simply
+// cooked again next time.
+static void write_entry(Cache_Entry_Type type, u64 key, u64 source_hash, const Cache_Part* parts, u32 num_parts) {
+#if defined(_WIN32)
+	_mkdir(CACHE_DIRECTORY);
+#else
+	mkdir(CACHE_DIRECTORY, 0755);
+#endif
+
+	Cache_File_Header header = {};
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.type = type;
+	header.key = key;
+	header.source_hash = source_hash;
+	for (u32 i = 0; i < num_parts; ++i) {
+		header.data_size += CACHE_ALIGN(parts[i].size);
+	}
+
+	// The file is written under a temporary name and renamed at the end, so a partially written file is never mapped
+	char path[256], temporary_path[sizeof(path) + 4];
+	get_entry_path(key, path, sizeof(path));
+	snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+	FILE* file = fopen(temporary_path, "wb");
+	if (!file) {
+		return;
+	}
+
+	const u8 padding[8] = {0};
+	boolean ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (u32 i = 0; ok && i < num_parts; ++i) {
+		u64 padding_size = CACHE_ALIGN(parts[i].size) - parts[i].size;
+		ok = fwrite(parts[i].data, 1, parts[i].size, file) == parts[i].size &&
+			fwrite(padding, 1, padding_size, file) == padding_size;
+	}
+	ok = (fclose(file) == 0) && ok;
+
+	// If the old file is mapped, replacing it keeps the mapping intact on POSIX systems. On Windows it fails, and the entry is
+	// written again the next time the program runs.
+#if defined(_WIN32)
+	ok = ok && MoveFileExA(temporary_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+	ok = ok && rename(temporary_path, path) == 0;
+#endif
+	if (!ok) {
+		remove(temporary_path);
+	}
+}
+
+static u64 get_mesh_key(const char* obj_path) {
+	return hash_bytes(obj_path, strlen(obj_path), CACHE_ENTRY_MESH);
+}
+
+boolean cache_load_mesh(const char* obj_path, Vertex** vertices, u32** indices) {
+	u64 source_hash;
+	if (!hash_file(obj_path, &source_hash)) {
+		return false;
+	}
+
+	const u8* data = get_entry_data(CACHE_ENTRY_MESH, get_mesh_key(obj_path), source_hash);
+	if (!data) {
+		return false;
+	}
+
+	// Meshes are light arrays that the caller owns, so unlike shapes they are copied out of the mapping
+	const Cache_Mesh_Header* mesh = (const Cache_Mesh_Header*)data;
+	const u8* mesh_vertices = data + CACHE_ALIGN(sizeof(Cache_Mesh_Header));
+	const u8* mesh_indices = mesh_vertices + CACHE_ALIGN(mesh->num_vertices * sizeof(Vertex));
+	*vertices = array_new_len(Vertex, MAX(mesh->num_vertices, 1));
+	*indices = array_new_len(u32, MAX(mesh->num_indices, 1));
+	memcpy(*vertices, mesh_vertices, mesh->num_vertices * sizeof(Vertex));
+	memcpy(*indices, mesh_indices, mesh->num_indices * sizeof(u32));
+	array_length(*vertices) = mesh->num_vertices;
+	array_length(*indices) = mesh->num_indices;
+	return true;
+}
+
+void cache_store_mesh(const char* obj_path, const Vertex* vertices, const u32* indices) {
+	u64 source_hash;
+	if (!hash_file(obj_path, &source_hash)) {
+		return;
+	}
+
+	Cache_Mesh_Header mesh;
+	mesh.num_vertices = array_length(vertices);
+	mesh.num_indices = array_length(indices);
+	Cache_Part parts[3] = {
+		{&mesh, sizeof(mesh)},
+		{vertices, mesh.num_vertices * sizeof(Vertex)},
+		{indices, mesh.num_indices * sizeof(u32)}
+	};
+	write_entry(CACHE_ENTRY_MESH, get_mesh_key(obj_path), source_hash, parts, 3);
+}
+
+Collider_Convex_Hull_Shape* cache_get_convex_hull_shape(const vec3* points, u32 max_vertices) {
+	// The points are the source, so they are also the key
+	u32 num_points = array_length(points);
+	u64 source_hash = hash_bytes(points, num_points * sizeof(vec3), max_vertices);
+	u64 key = hash_bytes(&source_hash, sizeof(source_hash), CACHE_ENTRY_CONVEX_HULL_SHAPE);
+
+	const u8* data = get_entry_data(CACHE_ENTRY_CONVEX_HULL_SHAPE, key, source_hash);
+	if (data) {
+		const Cache_Shape_Header* cached = (const Cache_Shape_Header*)data;
+		const u8* arrays = data + CACHE_ALIGN(sizeof(Cache_Shape_Header));
+		const u8* cached_points = arrays + CACHE_ALIGN(collider_convex_hull_shape_get_arrays_size(&cached->layout));
+		// Two sets of points can share a hash, so a hit is only used when it was built from the very same points
+		if (cached->max_vertices == max_vertices && cached->num_points == num_points &&
+			memcmp(cached_points, points, num_points * sizeof(vec3)) == 0) {
+			return collider_convex_hull_shape_create_from_arrays(&cached->layout, cached->bounding_radius,
+				&cached->mass_properties, arrays);
+		}
+	}
+
+	Collider_Convex_Hull_Shape* shape = collider_convex_hull_shape_create(points, max_vertices);
+	Cache_Shape_Header header = {};
+	collider_convex_hull_shape_get_layout(shape, &header.layout);
+	header.max_vertices = max_vertices;
+	header.num_points = num_points;
+	header.bounding_radius = shape->bounding_radius;
+	header.mass_properties = shape->mass_properties;
+	Cache_Part parts[3] = {
+		{&header, sizeof(header)},
+		{shape->vertices, collider_convex_hull_shape_get_arrays_size(&header.layout)},
+		{points, num_points * sizeof(vec3)}
+	};
+	write_entry(CACHE_ENTRY_CONVEX_HULL_SHAPE, key, source_hash, parts, 3);
+	return shape;
+}
+
+void cache_destroy() {
+	if (!mappings) {
+		return;
+	}
+	for (u32 i = 0; i < array_length(mappings); ++i) {
+		unmap_file(mappings[i].memory, mappings[i].size);
+	}
+	array_free(mappings);
+	mappings = NULL;
+}
@@ -0,0 +1,29 @@
+#ifndef RAW_PHYSICS_CACHE_H
+#define RAW_PHYSICS_CACHE_H
+#include "common.h"
+#include "mesh.h"
+#include "collider.h"
+
+// A cache of cooked assets on disk, so that loading a scene doesn't have to parse obj files and build convex hulls every time.
+// Each entry is a binary file in CACHE_DIRECTORY that starts with a versioned header. Files are memory-mapped and stay mapped
+// until 'cache_destroy', so the data is used in place.
+//
+// Render meshes are keyed by the path of the obj file, and convex hull shapes by the points they are built from. Every entry
+// also stores a hash of the contents of its source, so it is rebuilt automatically when the source changes.
+// The cache is not thread-safe, it must only be used by the thread that loads the scenes.
+
+#define CACHE_DIRECTORY "./cache"
+
+// Fills 'vertices' and 'indices' (light arrays, owned by the caller) with the cooked mesh of the obj file.
+// Returns false if the mesh is not in the cache or if the obj file changed since it was cooked.
+boolean cache_load_mesh(const char* obj_path, Vertex** vertices, u32** indices);
+void cache_store_mesh(const char* obj_path, const Vertex* vertices, const u32* indices);
+
+// Same as 'collider_convex_hull_shape_create', but the shape is taken from the cache when the same points were cooked before.
+// Shapes that come from the cache use the mapped file as their arrays.
+Collider_Convex_Hull_Shape* cache_get_convex_hull_shape(const vec3* points, u32 max_vertices);
+
+// Unmaps all files. No shape that came from the cache can be alive at this point.
+void cache_destroy();
+
+#endif
@@ -1,8 +1,10 @@
 #include "clipping.h"
 #include "light_array.h"
+#include "arena.h"
 #include <float.h>
 #include "gjk.h"
 #include "support.h"
+#include "profiler.h"
 
 typedef struct {
 	vec3 normal;
@@ -56,8 +58,8 @@ static void sutherland_hodgman(vec3* input_polygon, int num_clip_planes, const P
 
 	// Create temporary list of vertices
 	// We will keep ping-pong'ing between the two lists updating them as we go.
-	vec3* input = (vec3*)array_copy(input_polygon);
-	vec3* output = array_new_len(vec3, 4 * array_length(input_polygon));
+	vec3* input = (vec3*)arena_array_copy(input_polygon, arena_get_scratch());
+	vec3* output = arena_array_new(vec3, 4 * array_length(input_polygon), arena_get_scratch());
 
 	for (int i = 0; i < num_clip_planes; ++i) {
 		// If every single point has already been removed previously, just exit
@@ -119,14 +121,14 @@ static vec3 get_closest_point_polygon(vec3 position, Plane* reference_plane) {
 }
 
 static Plane* build_boundary_planes(Collider_Convex_Hull* convex_hull, u32 target_face_idx) {
-	Plane* result = array_new_len(Plane, 16);
-	u32* face_neighbors = convex_hull->face_to_neighbors[target_face_idx];
+	Plane* result = arena_array_new(Plane, 16, arena_get_scratch());
+	const Collider_Convex_Hull_Shape* shape = convex_hull->shape;
 
-	for (u32 i = 0; i < array_length(face_neighbors); ++i) {
-		Collider_Convex_Hull_Face neighbor_face = convex_hull->transformed_faces[face_neighbors[i]];
+	for (u32 i = shape->face_neighbor_offsets[target_face_idx]; i < shape->face_neighbor_offsets[target_face_idx + 1]; ++i) {
+		u32 neighbor_face_idx = shape->face_neighbors[i];
 		Plane p;
-		p.point = convex_hull->transformed_vertices[neighbor_face.elements[0]];
-		p.normal = gm_vec3_invert(neighbor_face.normal);
+		p.point = convex_hull->transformed_vertices[shape->face_vertices[shape->face_vertex_offsets[neighbor_face_idx]]];
+		p.normal = gm_vec3_invert(convex_hull->transformed_face_planes[neighbor_face_idx].normal);
 		array_push(result, p);
 	}
 
@@ -135,16 +137,16 @@ static Plane* build_boundary_planes(Collider_Convex_Hull* convex_hull, u32 targe
 
 static u32 get_face_with_most_fitting_normal(u32 support_idx, const Collider_Convex_Hull* convex_hull, vec3 normal) {
 	const r64 EPSILON = 0.000001;
-	u32* support_faces = convex_hull->vertex_to_faces[support_idx];
+	const Collider_Convex_Hull_Shape* shape = convex_hull->shape;
 
 	r64 max_proj = -DBL_MAX;
-	u32 selected_face_idx;
-	for (u32 i = 0; i < array_length(support_faces); ++i) {
-		Collider_Convex_Hull_Face face = convex_hull->transformed_faces[support_faces[i]];
-		r64 proj = gm_vec3_dot(face.normal, normal);
+	u32 selected_face_idx = 0;
+	for (u32 i = shape->vertex_face_offsets[support_idx]; i < shape->vertex_face_offsets[support_idx + 1]; ++i) {
+		u32 face_idx = shape->vertex_faces[i];
+		r64 proj = gm_vec3_dot(convex_hull->transformed_face_planes[face_idx].normal, normal);
 		if (proj > max_proj) {
 			max_proj = proj;
-			selected_face_idx = support_faces[i];
+			selected_face_idx = face_idx;
 		}
 	}
 
@@ -158,16 +160,20 @@ static dvec4 get_edge_with_most_fitting_normal(u32 support1_idx, u32 support2_id
 	vec3 support1 = convex_hull1->transformed_vertices[support1_idx];
 	vec3 support2 = convex_hull2->transformed_vertices[support2_idx];
 
-	u32* support1_neighbors = convex_hull1->vertex_to_neighbors[support1_idx];
-	u32* support2_neighbors = convex_hull2->vertex_to_neighbors[support2_idx];
+	const Collider_Convex_Hull_Shape* shape1 = convex_hull1->shape;
+	const Collider_Convex_Hull_Shape* shape2 = convex_hull2->shape;
+	const u32* support1_neighbors = shape1->vertex_neighbors + shape1->vertex_neighbor_offsets[support1_idx];
+	const u32* support2_neighbors = shape2->vertex_neighbors + shape2->vertex_neighbor_offsets[support2_idx];
+	u32 num_support1_neighbors = shape1->vertex_neighbor_offsets[support1_idx + 1] - shape1->vertex_neighbor_offsets[support1_idx];
+	u32 num_support2_neighbors = shape2->vertex_neighbor_offsets[support2_idx + 1] - shape2->vertex_neighbor_offsets[support2_idx];
 
 	r64 max_dot = -DBL_MAX;
 	dvec4 selected_edges;
 
-	for (u32 i = 0; i < array_length(support1_neighbors); ++i) {
+	for (u32 i = 0; i < num_support1_neighbors; ++i) {
 		vec3 neighbor1 = convex_hull1->transformed_vertices[support1_neighbors[i]];
 		vec3 edge1 = gm_vec3_subtract(support1, neighbor1);
-		for (u32 j = 0; j < array_length(support2_neighbors); ++j) {
+		for (u32 j = 0; j < num_support2_neighbors; ++j) {
 			vec3 neighbor2 = convex_hull2->transformed_vertices[support2_neighbors[j]];
 			vec3 edge2 = gm_vec3_subtract(support2, neighbor2);
 
@@ -238,14 +244,207 @@ static boolean collision_distance_between_skew_lines(vec3 p1, vec3 d1, vec3 p2,
 	return true;
 }
 
-static vec3* get_vertices_of_faces(Collider_Convex_Hull* hull, Collider_Convex_Hull_Face face) {
-	vec3* vertices = array_new_len(vec3, 16);
-	for (u32 i = 0; i < array_length(face.elements); ++i) {
-		array_push(vertices, hull->transformed_vertices[face.elements[i]]);
+static vec3* get_vertices_of_faces(Collider_Convex_Hull* hull, u32 face_idx) {
+	vec3* vertices = arena_array_new(vec3, 16, arena_get_scratch());
+	const Collider_Convex_Hull_Shape* shape = hull->shape;
+	for (u32 i = shape->face_vertex_offsets[face_idx]; i < shape->face_vertex_offsets[face_idx + 1]; ++i) {
+		array_push(vertices, hull->transformed_vertices[shape->face_vertices[i]]);
 	}
 	return vertices;
 }
 
+static void edge_edge_contact(vec3 p1, vec3 d1, vec3 p2, vec3 d2, vec3 normal, Collider_Contact** contacts) {
+	vec3 l1, l2;
+	if (collision_distance_between_skew_lines(p1, d1, p2, d2, &l1, &l2, 0, 0)) {
+		Collider_Contact contact = {l1, l2, normal};
+		array_push(*contacts, contact);
+	}
+}
+
+static void convex_hull_edge_edge_contact(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2,
+	u32 edge1_v1, u32 edge1_v2, u32 edge2_v1, u32 edge2_v2, vec3 normal, Collider_Contact** contacts) {
+	vec3 p1 = convex_hull1->transformed_vertices[edge1_v1];
+	vec3 d1 = gm_vec3_subtract(convex_hull1->transformed_vertices[edge1_v2], p1);
+	vec3 p2 = convex_hull2->transformed_vertices[edge2_v1];
+	vec3 d2 = gm_vec3_subtract(convex_hull2->transformed_vertices[edge2_v2], p2);
+	edge_edge_contact(p1, d1, p2, d2, normal, contacts);
+}
+
+// Builds the contacts for the incident points that are below the reference face.
+// 'reference_face_normal' is the outward normal of the reference face.
+static void push_contacts_below_reference_face(const vec3* incident_points, vec3 reference_face_point, vec3 reference_face_normal,
+	boolean is_face1_the_reference_face, vec3 normal, Collider_Contact** contacts) {
+	Plane reference_plane;
+	reference_plane.normal = gm_vec3_invert(reference_face_normal);
+	reference_plane.point = reference_face_point;
+
+	vec3* final_clipped_points;
+	sutherland_hodgman((vec3*)incident_points, 1, &reference_plane, &final_clipped_points, true);
+
+	for (u32 i = 0; i < array_length(final_clipped_points); ++i) {
+		vec3 point = final_clipped_points[i];
+		//vec3 closest_point = get_closest_pointPolygon(point, reference_face_support_points);
+		vec3 closest_point = get_closest_point_polygon(point, &reference_plane);
+		vec3 point_diff = gm_vec3_subtract(point, closest_point);
+		r64 contact_penetration;
+
+		// we are projecting the points that are in the incident face on the reference planes
+		// so the points that we have are part of the incident object.
+		Collider_Contact contact;
+		if (is_face1_the_reference_face) {
+			contact_penetration = gm_vec3_dot(point_diff, normal);
+			contact.collision_point1 = gm_vec3_subtract(point, gm_vec3_scalar_product(contact_penetration, normal));
+			contact.collision_point2 = point;
+		} else {
+			contact_penetration = - gm_vec3_dot(point_diff, normal);
+			contact.collision_point1 = point;
+			contact.collision_point2 = gm_vec3_add(point, gm_vec3_scalar_product(contact_penetration, normal));
+		}
+
+		contact.normal = normal;
+
+		if (contact_penetration < 0.0) {
+			array_push(*contacts, contact);
+		}
+	}
+
+	array_free(final_clipped_points);
+}
+
+// Clips the incident face against the side planes of the reference face, keeping only the points that are below the reference face.
+// 'reference_face_normal' is the outward normal of the reference face.
+static void clip_incident_face(const vec3* reference_face_points, vec3 reference_face_normal, const Plane* boundary_planes,
+	vec3* incident_face_points, boolean is_face1_the_reference_face, vec3 normal, Collider_Contact** contacts) {
+	vec3* clipped_points;
+	sutherland_hodgman(incident_face_points, array_length(boundary_planes), boundary_planes, &clipped_points, false);
+	push_contacts_below_reference_face(clipped_points, reference_face_points[0], reference_face_normal, is_face1_the_reference_face,
+		normal, contacts);
+	array_free(clipped_points);
+}
+
+static void face_face_contact_manifold(Collider_Convex_Hull* convex_hull1, Collider_Convex_Hull* convex_hull2, u32 face1_idx,
+	u32 face2_idx, boolean is_face1_the_reference_face, vec3 normal, Collider_Contact** contacts) {
+	vec3* reference_face_support_points = is_face1_the_reference_face ?
+		get_vertices_of_faces(convex_hull1, face1_idx) : get_vertices_of_faces(convex_hull2, face2_idx);
+	vec3* incident_face_support_points = is_face1_the_reference_face ?
+		get_vertices_of_faces(convex_hull2, face2_idx) : get_vertices_of_faces(convex_hull1, face1_idx);
+
+	Plane* boundary_planes = is_face1_the_reference_face ? build_boundary_planes(convex_hull1, face1_idx) :
+		build_boundary_planes(convex_hull2, face2_idx);
+
+	vec3 reference_face_normal = is_face1_the_reference_face ? convex_hull1->transformed_face_planes[face1_idx].normal :
+		convex_hull2->transformed_face_planes[face2_idx].normal;
+	clip_incident_face(reference_face_support_points, reference_face_normal, boundary_planes, incident_face_support_points,
+		is_face1_the_reference_face, normal, contacts);
+
+	array_free(reference_face_support_points);
+	array_free(incident_face_support_points);
+	array_free(boundary_planes);
+}
+
+static vec3 box_face_normal(const Collider_Box* box, u32 face_idx) {
+	return face_idx % 2 == 0 ? box->axes[face_idx / 2] : gm_vec3_invert(box->axes[face_idx / 2]);
+}
+
+static r64 box_half_extent(const Collider_Box* box, u32 axis) {
+	return axis == 0 ? box->half_extents.x : (axis == 1 ? box->half_extents.y : box->half_extents.z);
+}
+
+// Gets the face of the box whose normal is the most aligned with 'direction'.
+static u32 get_box_face_with_most_fitting_normal(const Collider_Box* box, vec3 direction) {
+	r64 max_proj = -DBL_MAX;
+	u32 selected_face_idx = 0;
+	for (u32 i = 0; i < 3; ++i) {
+		r64 proj = gm_vec3_dot(box->axes[i], direction);
+		if (fabs(proj) > max_proj) {
+			max_proj = fabs(proj);
+			selected_face_idx = 2 * i + (proj >= 0.0 ? 0 : 1);
+		}
+	}
+
+	return selected_face_idx;
+}
+
+// The vertices of the face, in cyclic order.
+static vec3* get_vertices_of_box_face(const Collider_Box* box, u32 face_idx) {
+	u32 axis = face_idx / 2;
+	vec3 u = gm_vec3_scalar_product(box_half_extent(box, (axis + 1) % 3), box->axes[(axis + 1) % 3]);
+	vec3 v = gm_vec3_scalar_product(box_half_extent(box, (axis + 2) % 3), box->axes[(axis + 2) % 3]);
+	vec3 face_center = gm_vec3_add(box->center, gm_vec3_scalar_product(box_half_extent(box, axis), box_face_normal(box, face_idx)));
+
+	vec3* vertices = arena_array_new(vec3, 4, arena_get_scratch());
+	array_push(vertices, gm_vec3_add(face_center, gm_vec3_add(u, v)));
+	array_push(vertices, gm_vec3_add(face_center, gm_vec3_subtract(v, u)));
+	array_push(vertices, gm_vec3_subtract(face_center, gm_vec3_add(u, v)));
+	array_push(vertices, gm_vec3_add(face_center, gm_vec3_subtract(u, v)));
+	return vertices;
+}
+
+// The side planes of a box face are the four faces around it, pointing inwards.
+static Plane* build_box_boundary_planes(const Collider_Box* box, u32 face_idx) {
+	Plane* result = arena_array_new(Plane, 4, arena_get_scratch());
+	u32 axis = face_idx / 2;
+	for (u32 i = 0; i < 6; ++i) {
+		if (i / 2 == axis) {
+			continue;
+		}
+		vec3 face_normal = box_face_normal(box, i);
+		Plane p;
+		p.point = gm_vec3_add(box->center, gm_vec3_scalar_product(box_half_extent(box, i / 2), face_normal));
+		p.normal = gm_vec3_invert(face_normal);
+		array_push(result, p);
+	}
+
+	return result;
+}
+
+// Gets the edge of the box that is parallel to 'axis' and is the furthest along 'direction'.
+static void get_box_edge(const Collider_Box* box, u32 axis, vec3 direction, vec3* start, vec3* edge) {
+	vec3 p = box->center;
+	for (u32 i = 0; i < 3; ++i) {
+		if (i == axis) {
+			continue;
+		}
+		r64 h = box_half_extent(box, i);
+		p = gm_vec3_add(p, gm_vec3_scalar_product(gm_vec3_dot(box->axes[i], direction) >= 0.0 ? h : -h, box->axes[i]));
+	}
+
+	vec3 half_edge = gm_vec3_scalar_product(box_half_extent(box, axis), box->axes[axis]);
+	*start = gm_vec3_subtract(p, half_edge);
+	*edge = gm_vec3_scalar_product(2.0, half_edge);
+}
+
+static void box_box_contact_manifold_from_sat(const Collider_Box* box1, const Collider_Box* box2, const SAT_Result* sat_result,
+	Collider_Contact** contacts) {
+	vec3 normal = sat_result->normal;
+
+	if (sat_result->feature.type == SAT_FEATURE_EDGES) {
+		vec3 p1, d1, p2, d2;
+		get_box_edge(box1, sat_result->feature.index1, normal, &p1, &d1);
+		get_box_edge(box2, sat_result->feature.index2, gm_vec3_invert(normal), &p2, &d2);
+		edge_edge_contact(p1, d1, p2, d2, normal, contacts);
+		return;
+	}
+
+	boolean is_face1_the_reference_face = sat_result->feature.type == SAT_FEATURE_FACE1;
+	const Collider_Box* reference_box = is_face1_the_reference_face ? box1 : box2;
+	const Collider_Box* incident_box = is_face1_the_reference_face ? box2 : box1;
+	u32 reference_face_idx = is_face1_the_reference_face ? sat_result->feature.index1 : sat_result->feature.index2;
+	vec3 reference_face_normal = box_face_normal(reference_box, reference_face_idx);
+	u32 incident_face_idx = get_box_face_with_most_fitting_normal(incident_box, gm_vec3_invert(reference_face_normal));
+
+	vec3* reference_face_points = get_vertices_of_box_face(reference_box, reference_face_idx);
+	vec3* incident_face_points = get_vertices_of_box_face(incident_box, incident_face_idx);
+	Plane* boundary_planes = build_box_boundary_planes(reference_box, reference_face_idx);
+
+	clip_incident_face(reference_face_points, reference_face_normal, boundary_planes, incident_face_points,
+		is_face1_the_reference_face, normal, contacts);
+
+	array_free(reference_face_points);
+	array_free(incident_face_points);
+	array_free(boundary_planes);
+}
+
 void convex_convex_contact_manifold(Collider* collider1, Collider* collider2, vec3 normal, Collider_Contact** contacts) {
 	assert(collider1->type == COLLIDER_TYPE_CONVEX_HULL);
 	assert(collider2->type == COLLIDER_TYPE_CONVEX_HULL);
@@ -261,90 +460,295 @@ void convex_convex_contact_manifold(Collider* collider1, Collider* collider2, ve
 	u32 support2_idx = support_point_get_index(convex_hull2, inverted_normal);
 	u32 face1_idx = get_face_with_most_fitting_normal(support1_idx, convex_hull1, normal);
 	u32 face2_idx = get_face_with_most_fitting_normal(support2_idx, convex_hull2, inverted_normal);
-	Collider_Convex_Hull_Face face1 = convex_hull1->transformed_faces[face1_idx];
-	Collider_Convex_Hull_Face face2 = convex_hull2->transformed_faces[face2_idx];
+	vec3 face1_normal = convex_hull1->transformed_face_planes[face1_idx].normal;
+	vec3 face2_normal = convex_hull2->transformed_face_planes[face2_idx].normal;
 	dvec4 edges = get_edge_with_most_fitting_normal(support1_idx, support2_idx, convex_hull1, convex_hull2, normal, &edge_normal);
 
-	r64 chosen_normal1_dot = gm_vec3_dot(face1.normal, normal);
-	r64 chosen_normal2_dot = gm_vec3_dot(face2.normal, inverted_normal);
+	r64 chosen_normal1_dot = gm_vec3_dot(face1_normal, normal);
+	r64 chosen_normal2_dot = gm_vec3_dot(face2_normal, inverted_normal);
 	r64 edge_normal_dot = gm_vec3_dot(edge_normal, normal);
 
 	if (edge_normal_dot > chosen_normal1_dot + EPSILON && edge_normal_dot > chosen_normal2_dot + EPSILON) {
 		//printf("EDGE\n");
-		vec3 l1, l2;
-		vec3 p1 = convex_hull1->transformed_vertices[edges.x];
-		vec3 d1 = gm_vec3_subtract(convex_hull1->transformed_vertices[edges.y], p1);
-		vec3 p2 = convex_hull2->transformed_vertices[edges.z];
-		vec3 d2 = gm_vec3_subtract(convex_hull2->transformed_vertices[edges.w], p2);
-		assert(collision_distance_between_skew_lines(p1, d1, p2, d2, &l1, &l2, 0, 0));
-		Collider_Contact contact = {l1, l2, normal};
-		array_push(*contacts, contact);
+		convex_hull_edge_edge_contact(convex_hull1, convex_hull2, edges.x, edges.y, edges.z, edges.w, normal, contacts);
 	} else {
 		//printf("FACE\n");
 		boolean is_face1_the_reference_face = chosen_normal1_dot > chosen_normal2_dot;
-		vec3* reference_face_support_points = is_face1_the_reference_face ?
-			get_vertices_of_faces(convex_hull1, face1) : get_vertices_of_faces(convex_hull2, face2);
-		vec3* incident_face_support_points = is_face1_the_reference_face ?
-			get_vertices_of_faces(convex_hull2, face2) : get_vertices_of_faces(convex_hull1, face1);
-
-		Plane* boundary_planes = is_face1_the_reference_face ? build_boundary_planes(convex_hull1, face1_idx) :
-			build_boundary_planes(convex_hull2, face2_idx);
-
-		vec3* clipped_points;
-		sutherland_hodgman(incident_face_support_points, array_length(boundary_planes), boundary_planes, &clipped_points, false);
-
-		Plane reference_plane;
-		reference_plane.normal = is_face1_the_reference_face ? gm_vec3_invert(face1.normal) :
-			gm_vec3_invert(face2.normal);
-		reference_plane.point = reference_face_support_points[0];
-
-		vec3* final_clipped_points;
-		sutherland_hodgman(clipped_points, 1, &reference_plane, &final_clipped_points, true);
-
-		for (u32 i = 0; i < array_length(final_clipped_points); ++i) {
-			vec3 point = final_clipped_points[i];
-			//vec3 closest_point = get_closest_pointPolygon(point, reference_face_support_points);
-			vec3 closest_point = get_closest_point_polygon(point, &reference_plane);
-			vec3 point_diff = gm_vec3_subtract(point, closest_point);
-			r64 contact_penetration;
-
-			// we are projecting the points that are in the incident face on the reference planes
-			// so the points that we have are part of the incident object.
-			Collider_Contact contact;
-			if (is_face1_the_reference_face) {
-				contact_penetration = gm_vec3_dot(point_diff, normal);
-				contact.collision_point1 = gm_vec3_subtract(point, gm_vec3_scalar_product(contact_penetration, normal));
-				contact.collision_point2 = point;
+		face_face_contact_manifold(convex_hull1, convex_hull2, face1_idx, face2_idx, is_face1_the_reference_face, normal, contacts);
+	}
+
+	if (array_length(contacts) == 0) {
+		//printf("Warning: no intersection was found\n");
+	}
+}
+
+// Builds the contact manifold straight from the features found by the separating axis test.
+// The reference feature is already known, so only the incident face needs to be searched for.
+void clipping_get_contact_manifold_from_sat(Collider* collider1, Collider* collider2, const SAT_Result* sat_result,
+	Collider_Contact** contacts) {
+	PROFILE_SCOPE(PROFILE_PHASE_CLIPPING);
+#ifdef RAW_PHYSICS_PROFILE
+	// 'contacts' is shared by all the collider pairs of two entities, so only the ones added by this call are counted
+	u32 num_contacts_before = array_length(*contacts);
+#endif
+	if (collider1->type == COLLIDER_TYPE_BOX && collider2->type == COLLIDER_TYPE_BOX) {
+		box_box_contact_manifold_from_sat(&collider1->box, &collider2->box, sat_result, contacts);
+		PROFILE_SCOPE_SET_ARG("contacts", array_length(*contacts) - num_contacts_before);
+		return;
+	}
+
+	assert(collider1->type == COLLIDER_TYPE_CONVEX_HULL);
+	assert(collider2->type == COLLIDER_TYPE_CONVEX_HULL);
+	Collider_Convex_Hull* convex_hull1 = &collider1->convex_hull;
+	Collider_Convex_Hull* convex_hull2 = &collider2->convex_hull;
+	vec3 normal = sat_result->normal;
+
+	switch (sat_result->feature.type) {
+		case SAT_FEATURE_FACE1: {
+			vec3 inverted_normal = gm_vec3_invert(normal);
+			u32 support2_idx = support_point_get_index(convex_hull2, inverted_normal);
+			u32 face2_idx = get_face_with_most_fitting_normal(support2_idx, convex_hull2, inverted_normal);
+			face_face_contact_manifold(convex_hull1, convex_hull2, sat_result->feature.index1, face2_idx, true, normal, contacts);
+		} break;
+		case SAT_FEATURE_FACE2: {
+			u32 support1_idx = support_point_get_index(convex_hull1, normal);
+			u32 face1_idx = get_face_with_most_fitting_normal(support1_idx, convex_hull1, normal);
+			face_face_contact_manifold(convex_hull1, convex_hull2, face1_idx, sat_result->feature.index2, false, normal, contacts);
+		} break;
+		case SAT_FEATURE_EDGES: {
+			Collider_Convex_Hull_Edge edge1 = convex_hull1->shape->edges[sat_result->feature.index1];
+			Collider_Convex_Hull_Edge edge2 = convex_hull2->shape->edges[sat_result->feature.index2];
+			convex_hull_edge_edge_contact(convex_hull1, convex_hull2, edge1.v1, edge1.v2, edge2.v1, edge2.v2, normal, contacts);
+		} break;
+	}
+	PROFILE_SCOPE_SET_ARG("contacts", array_length(*contacts) - num_contacts_before);
+}
+
+// The feature of a collider that is the furthest along a direction: a face (three or more points), an edge (two points)
+// or a single point. Curved shapes only have faces/edges when the direction is (almost) aligned with them.
+typedef struct {
+	vec3* points;
+	// Outward normal and side planes of the face. Only valid for faces.
+	vec3 normal;
+	Plane* boundary_planes;
+} Feature;
+
+#define CYLINDER_CAP_NUM_POINTS 8
+
+// Cosine of the maximum angle between the contact normal and a face normal for the face to be used as a reference face
+static const r64 FACE_ALIGNMENT_TOLERANCE = 0.98;
+// Sine of the maximum angle between the contact normal and the side of a capsule/cylinder for the side to be used as an edge
+static const r64 SIDE_ALIGNMENT_TOLERANCE = 0.02;
+
+static boolean is_feature_face(const Feature* feature) {
+	return array_length(feature->points) >= 3;
+}
+
+// Side planes of a convex polygon, pointing inwards.
+static Plane* build_polygon_boundary_planes(const vec3* points, vec3 normal) {
+	Plane* result = arena_array_new(Plane, array_length(points), arena_get_scratch());
+	vec3 centroid = {0.0, 0.0, 0.0};
+	for (u32 i = 0; i < array_length(points); ++i) {
+		centroid = gm_vec3_add(centroid, points[i]);
+	}
+	centroid = gm_vec3_scalar_product(1.0 / array_length(points), centroid);
+
+	for (u32 i = 0; i < array_length(points); ++i) {
+		vec3 a = points[i];
+		vec3 b = points[(i + 1) % array_length(points)];
+		Plane p;
+		p.point = a;
+		p.normal = gm_vec3_normalize(gm_vec3_cross(normal, gm_vec3_subtract(b, a)));
+		if (gm_vec3_dot(p.normal, gm_vec3_subtract(centroid, a)) < 0.0) {
+			p.normal = gm_vec3_invert(p.normal);
+		}
+		array_push(result, p);
+	}
+
+	return result;
+}
+
+static void get_perpendicular_basis(vec3 axis, vec3* u, vec3* v) {
+	vec3 helper = fabs(axis.x) < 0.9 ? vec3{1.0, 0.0, 0.0} : vec3{0.0, 1.0, 0.0};
+	*u = gm_vec3_normalize(gm_vec3_cross(axis, helper));
+	*v = gm_vec3_cross(axis, *u);
+}
+
+static void get_feature(Collider* collider, vec3 direction, Feature* feature) {
+	feature->points = arena_array_new(vec3, CYLINDER_CAP_NUM_POINTS, arena_get_scratch());
+	feature->boundary_planes = NULL;
+	feature->normal = direction;
+
+	switch (collider->type) {
+		case COLLIDER_TYPE_CONVEX_HULL: {
+			Collider_Convex_Hull* convex_hull = &collider->convex_hull;
+			u32 support_idx = support_point_get_index(convex_hull, direction);
+			u32 face_idx = get_face_with_most_fitting_normal(support_idx, convex_hull, direction);
+			const Collider_Convex_Hull_Shape* shape = convex_hull->shape;
+			for (u32 i = shape->face_vertex_offsets[face_idx]; i < shape->face_vertex_offsets[face_idx + 1]; ++i) {
+				array_push(feature->points, convex_hull->transformed_vertices[shape->face_vertices[i]]);
+			}
+			feature->normal = convex_hull->transformed_face_planes[face_idx].normal;
+			feature->boundary_planes = build_boundary_planes(convex_hull, face_idx);
+		} break;
+		case COLLIDER_TYPE_BOX: {
+			u32 face_idx = get_box_face_with_most_fitting_normal(&collider->box, direction);
+			array_free(feature->points);
+			feature->points = get_vertices_of_box_face(&collider->box, face_idx);
+			feature->normal = box_face_normal(&collider->box, face_idx);
+			feature->boundary_planes = build_box_boundary_planes(&collider->box, face_idx);
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			const Collider_Cylinder* cylinder = &collider->cylinder;
+			r64 proj = gm_vec3_dot(cylinder->axis, direction);
+			vec3 cap_normal = proj >= 0.0 ? cylinder->axis : gm_vec3_invert(cylinder->axis);
+			vec3 cap_center = gm_vec3_add(cylinder->center, gm_vec3_scalar_product(cylinder->half_height, cap_normal));
+			if (fabs(proj) >= FACE_ALIGNMENT_TOLERANCE) {
+				// The cap, approximated by a regular polygon whose vertices are on the rim
+				vec3 u, v;
+				get_perpendicular_basis(cylinder->axis, &u, &v);
+				for (u32 i = 0; i < CYLINDER_CAP_NUM_POINTS; ++i) {
+					r64 angle = 2.0 * PI_F * i / CYLINDER_CAP_NUM_POINTS;
+					vec3 offset = gm_vec3_add(gm_vec3_scalar_product(cylinder->radius * cos(angle), u),
+						gm_vec3_scalar_product(cylinder->radius * sin(angle), v));
+					array_push(feature->points, gm_vec3_add(cap_center, offset));
+				}
+				feature->normal = cap_normal;
+				feature->boundary_planes = build_polygon_boundary_planes(feature->points, cap_normal);
+			} else if (fabs(proj) <= SIDE_ALIGNMENT_TOLERANCE) {
+				// A segment of the side
+				vec3 radial = gm_vec3_normalize(gm_vec3_subtract(direction, gm_vec3_scalar_product(proj, cylinder->axis)));
+				vec3 side_center = gm_vec3_add(cylinder->center, gm_vec3_scalar_product(cylinder->radius, radial));
+				vec3 half_side = gm_vec3_scalar_product(cylinder->half_height, cylinder->axis);
+				array_push(feature->points, gm_vec3_add(side_center, half_side));
+				array_push(feature->points, gm_vec3_subtract(side_center, half_side));
+			} else {
+				array_push(feature->points, support_point(collider, direction));
+			}
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			const Collider_Capsule* capsule = &collider->capsule;
+			r64 proj = gm_vec3_dot(capsule->axis, gm_vec3_normalize(direction));
+			if (fabs(proj) <= SIDE_ALIGNMENT_TOLERANCE) {
+				vec3 radial = gm_vec3_normalize(gm_vec3_subtract(direction, gm_vec3_scalar_product(proj, capsule->axis)));
+				vec3 side_center = gm_vec3_add(capsule->center, gm_vec3_scalar_product(capsule->radius, radial));
+				vec3 half_side = gm_vec3_scalar_product(capsule->half_height, capsule->axis);
+				array_push(feature->points, gm_vec3_add(side_center, half_side));
+				array_push(feature->points, gm_vec3_subtract(side_center, half_side));
 			} else {
-				contact_penetration = - gm_vec3_dot(point_diff, normal);
-				contact.collision_point1 = point;
-				contact.collision_point2 = gm_vec3_add(point, gm_vec3_scalar_product(contact_penetration, normal));
+				array_push(feature->points, support_point(collider, direction));
 			}
+		} break;
+		case COLLIDER_TYPE_SPHERE: {
+			array_push(feature->points, support_point(collider, direction));
+		} break;
+	}
+}
+
+static void feature_destroy(Feature* feature) {
+	array_free(feature->points);
+	if (feature->boundary_planes) {
+		array_free(feature->boundary_planes);
+	}
+}
 
-			contact.normal = normal;
+static boolean is_point_inside_planes(const Plane* planes, vec3 point) {
+	for (u32 i = 0; i < array_length(planes); ++i) {
+		if (!is_point_in_plane(&planes[i], point)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-			if (contact_penetration < 0.0) {
-				array_push(*contacts, contact);
+// Clips the segment a-b against the planes, keeping the part that is inside all of them. Returns false if nothing is left.
+static boolean clip_segment(const Plane* planes, vec3* a, vec3* b) {
+	r64 t_min = 0.0, t_max = 1.0;
+	vec3 ab = gm_vec3_subtract(*b, *a);
+	for (u32 i = 0; i < array_length(planes); ++i) {
+		r64 da = gm_vec3_dot(planes[i].normal, gm_vec3_subtract(*a, planes[i].point));
+		r64 dab = gm_vec3_dot(planes[i].normal, ab);
+		if (fabs(dab) < 1e-12) {
+			if (da < 0.0) {
+				return false;
 			}
+			continue;
 		}
+		r64 t = -da / dab;
+		if (dab > 0.0) {
+			t_min = MAX(t_min, t);
+		} else {
+			t_max = MIN(t_max, t);
+		}
+	}
 
-		array_free(reference_face_support_points);
-		array_free(incident_face_support_points);
-		array_free(boundary_planes);
-		array_free(clipped_points);
-		array_free(final_clipped_points);
+	if (t_min > t_max) {
+		return false;
 	}
 
-	if (array_length(contacts) == 0) {
-		//printf("Warning: no intersection was found\n");
+	vec3 start = *a;
+	*a = gm_vec3_add(start, gm_vec3_scalar_product(t_min, ab));
+	*b = gm_vec3_add(start, gm_vec3_scalar_product(t_max, ab));
+	return true;
+}
+
+// Contact manifold for pairs that involve curved colliders (capsules and cylinders).
+// The features of both colliders are collected, and the incident feature is clipped against the reference face.
+// If there is no reference face (e.g., a cylinder touching with its rim), a single contact is built from the support point.
+static void generic_contact_manifold(Collider* collider1, Collider* collider2, vec3 normal, r64 penetration,
+	Collider_Contact** contacts) {
+	Feature feature1, feature2;
+	get_feature(collider1, normal, &feature1);
+	get_feature(collider2, gm_vec3_invert(normal), &feature2);
+
+	r64 alignment1 = is_feature_face(&feature1) ? gm_vec3_dot(feature1.normal, normal) : -1.0;
+	r64 alignment2 = is_feature_face(&feature2) ? -gm_vec3_dot(feature2.normal, normal) : -1.0;
+	u32 num_contacts = array_length(*contacts);
+
+	if (MAX(alignment1, alignment2) >= FACE_ALIGNMENT_TOLERANCE) {
+		boolean is_face1_the_reference_face = alignment1 >= alignment2;
+		Feature* reference = is_face1_the_reference_face ? &feature1 : &feature2;
+		Feature* incident = is_face1_the_reference_face ? &feature2 : &feature1;
+
+		if (is_feature_face(incident)) {
+			clip_incident_face(reference->points, reference->normal, reference->boundary_planes, incident->points,
+				is_face1_the_reference_face, normal, contacts);
+		} else if (array_length(incident->points) == 2) {
+			vec3 a = incident->points[0];
+			vec3 b = incident->points[1];
+			if (clip_segment(reference->boundary_planes, &a, &b)) {
+				vec3* clipped_points = arena_array_new(vec3, 2, arena_get_scratch());
+				array_push(clipped_points, a);
+				array_push(clipped_points, b);
+				push_contacts_below_reference_face(clipped_points, reference->points[0], reference->normal,
+					is_face1_the_reference_face, normal, contacts);
+				array_free(clipped_points);
+			}
+		} else if (is_point_inside_planes(reference->boundary_planes, incident->points[0])) {
+			push_contacts_below_reference_face(incident->points, reference->points[0], reference->normal,
+				is_face1_the_reference_face, normal, contacts);
+		}
+	}
+
+	if (array_length(*contacts) == num_contacts) {
+		Collider_Contact contact;
+		contact.collision_point1 = support_point(collider1, normal);
+		contact.collision_point2 = gm_vec3_subtract(contact.collision_point1, gm_vec3_scalar_product(penetration, normal));
+		contact.normal = normal;
+		array_push(*contacts, contact);
 	}
+
+	feature_destroy(&feature1);
+	feature_destroy(&feature2);
 }
 
 void clipping_get_contact_manifold(Collider* collider1, Collider* collider2, vec3 normal, r64 penetration,
 	Collider_Contact** contacts) {
-	// TODO: For now, we only consider CONVEX and SPHERE colliders.
-	// If new colliders are added, we can think about making this more generic.
-
+	PROFILE_SCOPE(PROFILE_PHASE_CLIPPING);
+#ifdef RAW_PHYSICS_PROFILE
+	// 'contacts' is shared by all the collider pairs of two entities, so only the ones added by this call are counted
+	u32 num_contacts_before = array_length(*contacts);
+#endif
 	if (collider1->type == COLLIDER_TYPE_SPHERE) {
 		vec3 sphere_collision_point = support_point(collider1, normal);
 
@@ -362,10 +766,10 @@ void clipping_get_contact_manifold(Collider* collider1, Collider* collider2, vec
 		contact.collision_point2 = sphere_collision_point;
 		contact.normal = normal;
 		array_push(*contacts, contact);
-	} else {
-		// For now, this case must be convex-convex
-		assert(collider1->type == COLLIDER_TYPE_CONVEX_HULL);
-		assert(collider2->type == COLLIDER_TYPE_CONVEX_HULL);
+	} else if (collider1->type == COLLIDER_TYPE_CONVEX_HULL && collider2->type == COLLIDER_TYPE_CONVEX_HULL) {
 		convex_convex_contact_manifold(collider1, collider2, normal, contacts);
+	} else {
+		generic_contact_manifold(collider1, collider2, normal, penetration, contacts);
 	}
+	PROFILE_SCOPE_SET_ARG("contacts", array_length(*contacts) - num_contacts_before);
 }
\ No newline at end of file
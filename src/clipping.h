@@ -2,7 +2,10 @@
 #define RAW_PHYSICS_PHYSICS_CLIPPING_H
 #include "gm.h"
 #include "collider.h"
+#include "sat.h"
 
 void clipping_get_contact_manifold(Collider* collider1, Collider* collider2, vec3 normal, r64 penetration, Collider_Contact** contacts);
+void clipping_get_contact_manifold_from_sat(Collider* collider1, Collider* collider2, const SAT_Result* sat_result,
+	Collider_Contact** contacts);
 
 #endif
\ No newline at end of file
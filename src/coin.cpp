@@ -1,6 +1,5 @@
 #include "coin.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -13,6 +12,7 @@
 #include "pbd.h"
 #include "entity.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
@@ -44,8 +44,6 @@ int ex_coin_init() {
 	// Create light
 	lights = examples_util_create_lights();
 
-	// TODO: We don't have a collider of type CYLINDER yet, hence we are using a complex convex hull to represent the cylinder here.
-	// Once that is added to the engine we should use the cylinder collider here.
 	Vertex* coin_vertices;
 	u32* coin_indices;
 	obj_parse("./res/cylinder.obj", &coin_vertices, &coin_indices);
@@ -53,8 +51,10 @@ int ex_coin_init() {
 
 	vec3 coin_scale = {3.0, 0.1, 3.0};
 	//vec3 coin_scale = {1.0, 1.0, 1.0}; // for debug
-	Collider* coin_colliders = examples_util_create_single_convex_hull_collider_array(coin_vertices, coin_indices, coin_scale);
-	coin_eid = entity_create(coin_mesh, {0.0, 4.0, 0.0}, quaternion_new({1.0, 0.0, 1.0}, 30.0),
+	// The cylinder mesh has radius 1 and height 2
+	Collider* coin_colliders = array_new(Collider);
+	array_push(coin_colliders, collider_cylinder_create(coin_scale.x, coin_scale.y));
+	coin_eid = examples_util_create_entity(coin_mesh, {0.0, 4.0, 0.0}, quaternion_new({1.0, 0.0, 1.0}, 30.0),
 		coin_scale, {205.0 / 255.0, 127.0 / 255.0, 50.0 / 255.0, 1.0}, 1.0,
 		coin_colliders, 0.5, 0.5, restitution_coefficient);
 
@@ -63,8 +63,8 @@ int ex_coin_init() {
 	obj_parse("./res/floor.obj", &floor_vertices, &floor_indices);
 	Mesh floor_mesh = graphics_mesh_create(floor_vertices, floor_indices);
 	vec3 floor_scale = {1.0, 1.0, 1.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(floor_vertices, floor_indices, floor_scale);
-	floor_eid = entity_create_fixed(floor_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(floor_vertices, floor_scale);
+	floor_eid = examples_util_create_fixed_entity(floor_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, restitution_coefficient);
 	array_free(floor_vertices);
 	array_free(floor_indices);
@@ -83,7 +83,7 @@ void ex_coin_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -113,49 +113,40 @@ void ex_coin_update(r64 delta_time) {
 }
 
 void ex_coin_render() {
-	Entity** entities = entity_get_all();
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_coin_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 }
 
@@ -187,20 +178,23 @@ void ex_coin_window_resize_process(s32 width, s32 height) {
 	camera_force_matrix_recalculation(&camera);
 }
 
-void ex_coin_menu_update() {
+static void set_restitution_coefficient(void* data) {
+	r64 restitution_coefficient = *(r64*)data;
 	Entity* coin_entity = entity_get_by_id(coin_eid);
 	Entity* floor_entity = entity_get_by_id(floor_eid);
+	coin_entity->restitution_coefficient = restitution_coefficient;
+	floor_entity->restitution_coefficient = restitution_coefficient;
+	entity_activate(coin_entity);
+}
 
+void ex_coin_menu_update() {
 	ImGui::Text("Coin");
 	ImGui::Separator();
 
-	ImGui::TextWrapped("The engine does not have a cylinder collider yet. The coin collider is being created as a generic convex hull. This is just an experiment :)");
-
 	ImGui::TextWrapped("Coin and floor restitution coefficient:");
 	if (ImGui::SliderFloat("rc", &restitution_coefficient, 0.0f, 0.8f, "%.3f")) {
-		coin_entity->restitution_coefficient = (r64)restitution_coefficient;
-		floor_entity->restitution_coefficient = (r64)restitution_coefficient;
-		entity_activate(coin_entity);
+		r64 coefficient = (r64)restitution_coefficient;
+		physics_thread_push_command(set_restitution_coefficient, &coefficient, sizeof(coefficient));
 	}
 
 	ImGui::Separator();
@@ -1,11 +1,14 @@
 #include "collider.h"
-#include "hash_map.h"
+#include "hash_table.h"
+#include "quickhull.h"
+#include "memory_tracker.h"
 #include <memory.h>
 #include "light_array.h"
 #include "util.h"
 #include "gjk.h"
 #include "clipping.h"
 #include "epa.h"
+#include "sat.h"
 #include "util.h"
 #include <float.h>
 
@@ -20,372 +23,490 @@ Collider collider_sphere_create(const r32 radius) {
 void collider_sphere_destroy(Collider* collider) {
 }
 
-static r64 get_sphere_collider_bounding_sphere_radius(const Collider* collider) {
-	return collider->sphere.radius;
+Collider collider_box_create(vec3 half_extents) {
+	Collider collider;
+	collider.type = COLLIDER_TYPE_BOX;
+	collider.box.half_extents = half_extents;
+	collider.box.center = {0.0, 0.0, 0.0};
+	collider.box.axes[0] = {1.0, 0.0, 0.0};
+	collider.box.axes[1] = {0.0, 1.0, 0.0};
+	collider.box.axes[2] = {0.0, 0.0, 1.0};
+	return collider;
 }
 
-static boolean do_triangles_share_same_vertex(dvec3 t1, dvec3 t2) {
-	return t1.x == t2.x || t1.x == t2.y || t1.x == t2.z ||
-		t1.y == t2.x || t1.y == t2.y || t1.y == t2.z ||
-		t1.z == t2.x || t1.z == t2.y || t1.z == t2.z;
+void collider_box_destroy(Collider* collider) {
 }
 
-static boolean do_faces_share_same_vertex(u32* e1, u32* e2) {
-	for (u32 i = 0; i < array_length(e1); ++i) {
-		u32 i1 = e1[i];
-		for (u32 j = 0; j < array_length(e2); ++j) {
-			u32 i2 = e2[j];
-			if (i1 == i2) {
-				return true;
-			}
-		}
-	}
+Collider collider_capsule_create(r64 radius, r64 half_height) {
+	Collider collider;
+	collider.type = COLLIDER_TYPE_CAPSULE;
+	collider.capsule.radius = radius;
+	collider.capsule.half_height = half_height;
+	collider.capsule.center = {0.0, 0.0, 0.0};
+	collider.capsule.axis = {0.0, 1.0, 0.0};
+	return collider;
+}
 
-	return false;
+void collider_capsule_destroy(Collider* collider) {
 }
 
-static void collect_faces_planar_to(vec3* hull, dvec3* hull_triangle_faces, u32** triangle_faces_to_neighbor_faces_map,
-	boolean* is_triangle_face_already_processed_arr, u32 face_to_test_idx, vec3 target_normal, dvec3** out) {
-	const r64 EPSILON = 0.000001;
-	dvec3 face_to_test = hull_triangle_faces[face_to_test_idx];
-	vec3 v1 = hull[face_to_test.x];
-	vec3 v2 = hull[face_to_test.y];
-	vec3 v3 = hull[face_to_test.z];
-	
-	vec3 v12 = gm_vec3_subtract(v2, v1);
-	vec3 v13 = gm_vec3_subtract(v3, v1);
-	vec3 face_normal = gm_vec3_normalize(gm_vec3_cross(v12, v13));
+Collider collider_cylinder_create(r64 radius, r64 half_height) {
+	Collider collider;
+	collider.type = COLLIDER_TYPE_CYLINDER;
+	collider.cylinder.radius = radius;
+	collider.cylinder.half_height = half_height;
+	collider.cylinder.center = {0.0, 0.0, 0.0};
+	collider.cylinder.axis = {0.0, 1.0, 0.0};
+	return collider;
+}
 
-	if (is_triangle_face_already_processed_arr[face_to_test_idx]) {
-		return;
-	}
+void collider_cylinder_destroy(Collider* collider) {
+}
 
-	r64 projection = gm_vec3_dot(face_normal, target_normal);
+static r64 get_sphere_collider_bounding_sphere_radius(const Collider* collider) {
+	return collider->sphere.radius;
+}
 
-	if ((projection - 1.0) > -EPSILON && (projection - 1.0) < EPSILON) {
-		array_push(*out, face_to_test);
-		is_triangle_face_already_processed_arr[face_to_test_idx] = true;
+static r64 get_box_collider_bounding_sphere_radius(const Collider* collider) {
+	return gm_vec3_length(collider->box.half_extents);
+}
 
-		u32* neighbor_faces = triangle_faces_to_neighbor_faces_map[face_to_test_idx];
+static r64 get_capsule_collider_bounding_sphere_radius(const Collider* collider) {
+	return collider->capsule.half_height + collider->capsule.radius;
+}
 
-		for (u32 i = 0; i < array_length(neighbor_faces); ++i) {
-			u32 neighbor_face_idx = neighbor_faces[i];
-			collect_faces_planar_to(hull, hull_triangle_faces, triangle_faces_to_neighbor_faces_map,
-				is_triangle_face_already_processed_arr, neighbor_face_idx, target_normal, out);
-		}
-	}
+static r64 get_cylinder_collider_bounding_sphere_radius(const Collider* collider) {
+	return sqrt(collider->cylinder.half_height * collider->cylinder.half_height + collider->cylinder.radius * collider->cylinder.radius);
 }
 
-static s32 get_edge_index(const dvec2* edges, dvec2 edge) {
-	for (s32 i = 0; i < array_length(edges); ++i) {
-		dvec2 current_edge = edges[i];
-		if (current_edge.x == edge.x && current_edge.y == edge.y) {
-			return i;
-		}
-		if (current_edge.x == edge.y && current_edge.y == edge.x) {
-			return i;
+// Collect the unique edges of the hull, i.e., the edges of the faces' boundaries. Each edge is shared by two faces.
+static Collider_Convex_Hull_Edge* build_convex_hull_edges(u32* const* faces) {
+	Collider_Convex_Hull_Edge* edges = array_new(Collider_Convex_Hull_Edge);
+	Hash_Table<u64, u32> vertices_to_edge_map;
+	hash_table_create(&vertices_to_edge_map, 256);
+
+	for (u32 i = 0; i < array_length(faces); ++i) {
+		u32* face = faces[i];
+		for (u32 j = 0; j < array_length(face); ++j) {
+			u32 v1 = face[j];
+			u32 v2 = face[(j + 1) % array_length(face)];
+			u64 key = ((u64)MIN(v1, v2) << 32) | (u64)MAX(v1, v2);
+
+			u32* edge_idx = hash_table_get(&vertices_to_edge_map, key);
+			if (!edge_idx) {
+				Collider_Convex_Hull_Edge edge = {v1, v2, i, i};
+				hash_table_put(&vertices_to_edge_map, key, (u32)array_length(edges));
+				array_push(edges, edge);
+			} else {
+				edges[*edge_idx].face2 = i;
+			}
 		}
 	}
 
-	return -1;
+	hash_table_destroy(&vertices_to_edge_map);
+	return edges;
 }
 
-static Collider_Convex_Hull_Face create_convex_hull_face(dvec3* triangles, vec3 face_normal) {
-	dvec2* edges = array_new(dvec2);
+static r64 get_convex_hull_collider_bounding_sphere_radius(const Collider* collider) {
+	return collider->convex_hull.shape->bounding_radius;
+}
 
-	// Collect the edges that form the border of the face
-	for (u32 i = 0; i < array_length(triangles); ++i) {
-		dvec3 triangle = triangles[i];
+#define SHAPE_ALIGN(x) (((x) + 7) & ~(u64)7)
 
-		dvec2 edge1 = {triangle.x, triangle.y};
-		dvec2 edge2 = {triangle.y, triangle.z};
-		dvec2 edge3 = {triangle.z, triangle.x};
+// Returns the number of items in all rows.
+static u32 get_rows_num_items(u32* const* rows) {
+	u32 num_items = 0;
+	for (u32 i = 0; i < array_length(rows); ++i) {
+		num_items += array_length(rows[i]);
+	}
+	return num_items;
+}
 
-		s32 edge1_idx = get_edge_index(edges, edge1);
+// Copies the rows one after the other into 'items', filling 'offsets', which must have room for one more entry than there are rows.
+static void pack_rows(u32* const* rows, u32* offsets, u32* items) {
+	u32 num_items = 0;
+	for (u32 i = 0; i < array_length(rows); ++i) {
+		offsets[i] = num_items;
+		memcpy(items + num_items, rows[i], array_length(rows[i]) * sizeof(u32));
+		num_items += array_length(rows[i]);
+	}
+	offsets[array_length(rows)] = num_items;
+}
 
-		if (edge1_idx >= 0) {
-			array_remove(edges, edge1_idx);
-		} else {
-			array_push(edges, edge1);
-		}
+// Returns the address of the next array of 'size' bytes in 'memory', and advances it.
+static void* take_shape_array(u8** memory, u64 size) {
+	void* array = *memory;
+	*memory += SHAPE_ALIGN(size);
+	return array;
+}
 
-		s32 edge2_idx = get_edge_index(edges, edge2);
+u64 collider_convex_hull_shape_get_arrays_size(const Collider_Convex_Hull_Shape_Layout* layout) {
+	// In 64 bits, since the layout may come from a file and have any counts
+	return SHAPE_ALIGN(layout->num_vertices * sizeof(vec3)) +
+		SHAPE_ALIGN(layout->num_faces * sizeof(Collider_Convex_Hull_Plane)) +
+		SHAPE_ALIGN(layout->num_edges * sizeof(Collider_Convex_Hull_Edge)) +
+		SHAPE_ALIGN(((u64)layout->num_faces + 1 + layout->num_face_vertices) * sizeof(u32)) +
+		SHAPE_ALIGN(((u64)layout->num_vertices + 1 + layout->num_vertex_faces) * sizeof(u32)) +
+		SHAPE_ALIGN(((u64)layout->num_vertices + 1 + layout->num_vertex_neighbors) * sizeof(u32)) +
+		SHAPE_ALIGN(((u64)layout->num_faces + 1 + layout->num_face_neighbors) * sizeof(u32));
+}
 
-		if (edge2_idx >= 0) {
-			array_remove(edges, edge2_idx);
-		} else {
-			array_push(edges, edge2);
-		}
+void collider_convex_hull_shape_get_layout(const Collider_Convex_Hull_Shape* shape, Collider_Convex_Hull_Shape_Layout* layout) {
+	layout->num_vertices = shape->num_vertices;
+	layout->num_faces = shape->num_faces;
+	layout->num_edges = shape->num_edges;
+	layout->num_face_vertices = shape->face_vertex_offsets[shape->num_faces];
+	layout->num_vertex_faces = shape->vertex_face_offsets[shape->num_vertices];
+	layout->num_vertex_neighbors = shape->vertex_neighbor_offsets[shape->num_vertices];
+	layout->num_face_neighbors = shape->face_neighbor_offsets[shape->num_faces];
+}
 
-		s32 edge3_idx = get_edge_index(edges, edge3);
+// Points the arrays of the shape to their place in 'memory'.
+static void place_shape_arrays(Collider_Convex_Hull_Shape* shape, const Collider_Convex_Hull_Shape_Layout* layout, u8* memory) {
+	shape->num_vertices = layout->num_vertices;
+	shape->num_faces = layout->num_faces;
+	shape->num_edges = layout->num_edges;
+	shape->vertices = (vec3*)take_shape_array(&memory, layout->num_vertices * sizeof(vec3));
+	shape->face_planes = (Collider_Convex_Hull_Plane*)take_shape_array(&memory, layout->num_faces * sizeof(Collider_Convex_Hull_Plane));
+	shape->edges = (Collider_Convex_Hull_Edge*)take_shape_array(&memory, layout->num_edges * sizeof(Collider_Convex_Hull_Edge));
+	// Each offsets array is followed by its items, so they end up in the same cache lines for small hulls
+	shape->face_vertex_offsets = (u32*)take_shape_array(&memory, (layout->num_faces + 1 + layout->num_face_vertices) * sizeof(u32));
+	shape->face_vertices = shape->face_vertex_offsets + layout->num_faces + 1;
+	shape->vertex_face_offsets = (u32*)take_shape_array(&memory, (layout->num_vertices + 1 + layout->num_vertex_faces) * sizeof(u32));
+	shape->vertex_faces = shape->vertex_face_offsets + layout->num_vertices + 1;
+	shape->vertex_neighbor_offsets = (u32*)take_shape_array(&memory,
+		(layout->num_vertices + 1 + layout->num_vertex_neighbors) * sizeof(u32));
+	shape->vertex_neighbors = shape->vertex_neighbor_offsets + layout->num_vertices + 1;
+	shape->face_neighbor_offsets = (u32*)take_shape_array(&memory, (layout->num_faces + 1 + layout->num_face_neighbors) * sizeof(u32));
+	shape->face_neighbors = shape->face_neighbor_offsets + layout->num_faces + 1;
+}
 
-		if (edge3_idx >= 0) {
-			array_remove(edges, edge3_idx);
-		} else {
-			array_push(edges, edge3);
+// The offsets of a compressed row list must start at 0, never decrease and end at the number of items, and the items must be
+// below 'num_targets' (the number of vertices or faces they refer to).
+static boolean are_rows_valid(const u32* offsets, u32 num_rows, const u32* items, u32 num_items, u32 num_targets) {
+	if (offsets[0] != 0 || offsets[num_rows] != num_items) {
+		return false;
+	}
+	for (u32 i = 0; i < num_rows; ++i) {
+		if (offsets[i] > offsets[i + 1]) {
+			return false;
 		}
 	}
-
-	// Nicely order the edges
-	for (u32 i = 0; i < array_length(edges); ++i) {
-		dvec2 current_edge = edges[i];
-		for (u32 j = i + 1; j < array_length(edges); ++j) {
-			dvec2 candidate_edge = edges[j];
-
-			if (current_edge.y != candidate_edge.x && current_edge.y != candidate_edge.y) {
-				continue;
-			}
-
-			if (current_edge.y == candidate_edge.y) {
-				u32 tmp = candidate_edge.x;
-				candidate_edge.x = candidate_edge.y;
-				candidate_edge.y = tmp;
-			}
-
-			dvec2 tmp = edges[i + 1];
-			edges[i + 1] = candidate_edge;
-			edges[j] = tmp;
+	for (u32 i = 0; i < num_items; ++i) {
+		if (items[i] >= num_targets) {
+			return false;
 		}
 	}
+	return true;
+}
 
-	assert(edges[0].x == edges[array_length(edges) - 1].y);
+boolean collider_convex_hull_shape_are_arrays_valid(const Collider_Convex_Hull_Shape_Layout* layout, const void* arrays) {
+	Collider_Convex_Hull_Shape shape;
+	place_shape_arrays(&shape, layout, (u8*)arrays);
 
-	// Simply create the face elements based on the edges
-	u32* face_elements = array_new(u32);
-	for (u32 i = 0; i < array_length(edges); ++i) {
-		dvec2 current_edge = edges[i];
-		array_push(face_elements, current_edge.x);
+	for (u32 i = 0; i < layout->num_edges; ++i) {
+		Collider_Convex_Hull_Edge edge = shape.edges[i];
+		if (edge.v1 >= layout->num_vertices || edge.v2 >= layout->num_vertices || edge.face1 >= layout->num_faces ||
+			edge.face2 >= layout->num_faces) {
+			return false;
+		}
 	}
 
-	array_free(edges);
+	return are_rows_valid(shape.face_vertex_offsets, layout->num_faces, shape.face_vertices, layout->num_face_vertices,
+			layout->num_vertices) &&
+		are_rows_valid(shape.vertex_face_offsets, layout->num_vertices, shape.vertex_faces, layout->num_vertex_faces,
+			layout->num_faces) &&
+		are_rows_valid(shape.vertex_neighbor_offsets, layout->num_vertices, shape.vertex_neighbors, layout->num_vertex_neighbors,
+			layout->num_vertices) &&
+		are_rows_valid(shape.face_neighbor_offsets, layout->num_faces, shape.face_neighbors, layout->num_face_neighbors,
+			layout->num_faces);
+}
 
-	Collider_Convex_Hull_Face face;
-	face.elements = face_elements;
-	face.normal = face_normal;
-	return face;
+Collider_Convex_Hull_Shape* collider_convex_hull_shape_create_from_arrays(const Collider_Convex_Hull_Shape_Layout* layout,
+	r64 bounding_radius, const Collider_Mass_Properties* mass_properties, const void* arrays) {
+	assert(((u64)arrays & 7) == 0);
+	Collider_Convex_Hull_Shape* shape = (Collider_Convex_Hull_Shape*)memory_tracker_malloc(sizeof(Collider_Convex_Hull_Shape));
+	shape->reference_count = 1;
+	shape->bounding_radius = bounding_radius;
+	shape->mass_properties = *mass_properties;
+	// Shapes never write to their arrays
+	place_shape_arrays(shape, layout, (u8*)arrays);
+	return shape;
 }
 
-static boolean is_neighbor_already_in_vertex_to_neighbors_map(u32* vertex_to_neighbors, u32 neighbor) {
-	for (u32 i = 0; i < array_length(vertex_to_neighbors); ++i) {
-		if (vertex_to_neighbors[i] == neighbor) {
-			return true;
+// Integrates over the tetrahedra formed by a reference point and a fan triangulation of each face, using the covariance form
+// of the tetrahedron integrals ('How to find the inertia tensor (or other mass properties) of a 3D solid body represented by
+// a triangle mesh', Blow and Binstock 2004).
+static void compute_convex_hull_mass_properties(Collider_Convex_Hull_Shape* shape) {
+	// Working relative to a vertex of the hull keeps the numbers small when the hull is far from the origin
+	vec3 reference = shape->vertices[0];
+	r64 volume = 0.0;
+	vec3 weighted_center = {0.0, 0.0, 0.0};
+	r64 covariance[3][3] = {0};
+
+	for (u32 i = 0; i < shape->num_faces; ++i) {
+		u32 first = shape->face_vertex_offsets[i];
+		u32 end = shape->face_vertex_offsets[i + 1];
+		vec3 a = gm_vec3_subtract(shape->vertices[shape->face_vertices[first]], reference);
+		for (u32 j = first + 1; j + 1 < end; ++j) {
+			vec3 b = gm_vec3_subtract(shape->vertices[shape->face_vertices[j]], reference);
+			vec3 c = gm_vec3_subtract(shape->vertices[shape->face_vertices[j + 1]], reference);
+			// Six times the signed volume of the tetrahedron, positive because faces are counter-clockwise from outside
+			r64 det = gm_vec3_dot(a, gm_vec3_cross(b, c));
+			vec3 sum = gm_vec3_add(a, gm_vec3_add(b, c));
+			volume += det / 6.0;
+			weighted_center = gm_vec3_add(weighted_center, gm_vec3_scalar_product(det / 24.0, sum));
+
+			// The covariance of the tetrahedron (0, a, b, c) is det / 120 * (a a^T + b b^T + c c^T + sum sum^T)
+			r64 va[3] = {a.x, a.y, a.z};
+			r64 vb[3] = {b.x, b.y, b.z};
+			r64 vc[3] = {c.x, c.y, c.z};
+			r64 vs[3] = {sum.x, sum.y, sum.z};
+			for (u32 r = 0; r < 3; ++r) {
+				for (u32 k = 0; k < 3; ++k) {
+					covariance[r][k] += (det / 120.0) * (va[r] * va[k] + vb[r] * vb[k] + vc[r] * vc[k] + vs[r] * vs[k]);
+				}
+			}
 		}
 	}
 
-	return false;
-}
-
-static r64 get_convex_hull_collider_bounding_sphere_radius(const Collider* collider) {
-	r64 max_distance = 0.0;
-	for (u32 i = 0; i < array_length(collider->convex_hull.vertices); ++i) {
-		vec3 v = collider->convex_hull.vertices[i];
-		r64 distance = gm_vec3_length(v);
-		if (distance > max_distance) {
-			max_distance = distance;
+	assert(volume > 0.0);
+	vec3 center = gm_vec3_scalar_product(1.0 / volume, weighted_center);
+	r64 vcenter[3] = {center.x, center.y, center.z};
+	// Move the covariance from the reference point to the center of mass
+	for (u32 r = 0; r < 3; ++r) {
+		for (u32 k = 0; k < 3; ++k) {
+			covariance[r][k] -= volume * vcenter[r] * vcenter[k];
 		}
 	}
 
-	return max_distance;
+	Collider_Mass_Properties* properties = &shape->mass_properties;
+	properties->volume = volume;
+	properties->center_of_mass = gm_vec3_add(reference, center);
+	r64 trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+	for (u32 r = 0; r < 3; ++r) {
+		for (u32 k = 0; k < 3; ++k) {
+			properties->inertia_tensor.data[r][k] = (r == k ? trace : 0.0) - covariance[r][k];
+		}
+	}
 }
 
-// Create a convex hull from the vertices+indices
-// For now, we assume that the mesh is already a convex hull
-// This function only makes sure that vertices are unique - duplicated vertices will be merged.
-Collider collider_convex_hull_create(const vec3* vertices, const u32* indices) {
-	Hash_Map vertex_to_idx_map;
-	hash_map_create(&vertex_to_idx_map, 1024, sizeof(vec3), sizeof(u32), util_vec3_compare, util_vec3_hash);
+// Packs the vertices and the topology into a single allocation. The rows of each map are indexed by vertex or face.
+static Collider_Convex_Hull_Shape* pack_convex_hull_shape(const vec3* vertices, u32* const* faces, const vec3* face_normals,
+	const Collider_Convex_Hull_Edge* edges, u32* const* vertex_to_faces, u32* const* vertex_to_neighbors,
+	u32* const* face_to_neighbors) {
+	Collider_Convex_Hull_Shape_Layout layout;
+	layout.num_vertices = array_length(vertices);
+	layout.num_faces = array_length(faces);
+	layout.num_edges = array_length(edges);
+	layout.num_face_vertices = get_rows_num_items(faces);
+	layout.num_vertex_faces = get_rows_num_items(vertex_to_faces);
+	layout.num_vertex_neighbors = get_rows_num_items(vertex_to_neighbors);
+	layout.num_face_neighbors = get_rows_num_items(face_to_neighbors);
+	u32 num_vertices = layout.num_vertices;
+	u32 num_faces = layout.num_faces;
+	u32 num_edges = layout.num_edges;
+
+	u64 size = SHAPE_ALIGN(sizeof(Collider_Convex_Hull_Shape)) + collider_convex_hull_shape_get_arrays_size(&layout);
+	u8* memory = (u8*)memory_tracker_malloc(size);
+
+	Collider_Convex_Hull_Shape* shape = (Collider_Convex_Hull_Shape*)take_shape_array(&memory, sizeof(Collider_Convex_Hull_Shape));
+	shape->reference_count = 1;
+	place_shape_arrays(shape, &layout, memory);
+
+	memcpy(shape->vertices, vertices, num_vertices * sizeof(vec3));
+	memcpy(shape->edges, edges, num_edges * sizeof(Collider_Convex_Hull_Edge));
+	pack_rows(faces, shape->face_vertex_offsets, shape->face_vertices);
+	pack_rows(vertex_to_faces, shape->vertex_face_offsets, shape->vertex_faces);
+	pack_rows(vertex_to_neighbors, shape->vertex_neighbor_offsets, shape->vertex_neighbors);
+	pack_rows(face_to_neighbors, shape->face_neighbor_offsets, shape->face_neighbors);
+
+	for (u32 i = 0; i < num_faces; ++i) {
+		shape->face_planes[i].normal = face_normals[i];
+		shape->face_planes[i].distance = gm_vec3_dot(face_normals[i], vertices[faces[i][0]]);
+	}
 
-	vec3* hull = array_new(vec3);
-	
-	// Build hull, eliminating duplicated vertex
-	for (u32 i = 0; i < array_length(vertices); ++i) {
-		vec3 current_vertex = vertices[i];
-		u32 current_index;
-		if (hash_map_get(&vertex_to_idx_map, &current_vertex, &current_index)) {
-			current_index = array_length(hull);
-			array_push(hull, current_vertex);
-			hash_map_put(&vertex_to_idx_map, &current_vertex, &current_index);
-		}
+	shape->bounding_radius = 0.0;
+	for (u32 i = 0; i < num_vertices; ++i) {
+		shape->bounding_radius = MAX(shape->bounding_radius, gm_vec3_length(vertices[i]));
 	}
 
-	// Collect all triangle faces that compose the just-built hull
-	dvec3* hull_triangle_faces = array_new(dvec3);
-	for (u32 i = 0; i < array_length(indices); i += 3) {
-		u32 i1 = indices[i];
-		u32 i2 = indices[i + 1];
-		u32 i3 = indices[i + 2];
-		vec3 v1 = vertices[i1];
-		vec3 v2 = vertices[i2];
-		vec3 v3 = vertices[i3];
+	compute_convex_hull_mass_properties(shape);
 
-		u32 new_i1, new_i2, new_i3;
-		assert(hash_map_get(&vertex_to_idx_map, &v1, &new_i1) == 0);
-		assert(hash_map_get(&vertex_to_idx_map, &v2, &new_i2) == 0);
-		assert(hash_map_get(&vertex_to_idx_map, &v3, &new_i3) == 0);
-		
-		dvec3 triangle = {(s32)new_i1, (s32)new_i2, (s32)new_i3};
-		array_push(hull_triangle_faces, triangle);
-	}
+	return shape;
+}
 
-	// Prepare vertex to faces map
-	u32** vertex_to_faces_map = (u32**)malloc(sizeof(u32*) * array_length(hull));
-	for (u32 i = 0; i < array_length(hull); ++i) {
-		vertex_to_faces_map[i] = array_new(u32);
+// Frees a jagged array built with light arrays.
+static void free_rows(u32** rows) {
+	for (u32 i = 0; i < array_length(rows); ++i) {
+		array_free(rows[i]);
 	}
+	array_free(rows);
+}
 
-	// Prepare vertex to neighbors map
-	u32** vertex_to_neighbors_map = (u32**)malloc(sizeof(u32*) * array_length(hull));
-	for (u32 i = 0; i < array_length(hull); ++i) {
-		vertex_to_neighbors_map[i] = array_new(u32);
+// Builds the adjacency of the hull's faces and vertices, and packs everything into a shape.
+static Collider_Convex_Hull_Shape* create_shape_from_hull(const Quickhull_Result* hull) {
+	u32 num_vertices = array_length(hull->vertices);
+	u32 num_faces = array_length(hull->faces);
+	Collider_Convex_Hull_Edge* edges = build_convex_hull_edges(hull->faces);
+
+	u32** vertex_to_faces = array_new_len(u32*, num_vertices);
+	u32** vertex_to_neighbors = array_new_len(u32*, num_vertices);
+	for (u32 i = 0; i < num_vertices; ++i) {
+		array_push(vertex_to_faces, array_new(u32));
+		array_push(vertex_to_neighbors, array_new(u32));
 	}
 
-	// Prepare triangle faces to neighbors map
-	u32** triangle_faces_to_neighbor_faces_map = (u32**)malloc(sizeof(u32*) * array_length(hull_triangle_faces));
-	for (u32 i = 0; i < array_length(hull_triangle_faces); ++i) {
-		triangle_faces_to_neighbor_faces_map[i] = array_new(u32);
+	for (u32 i = 0; i < num_faces; ++i) {
+		for (u32 j = 0; j < array_length(hull->faces[i]); ++j) {
+			array_push(vertex_to_faces[hull->faces[i][j]], i);
+		}
 	}
 
-	// Create the vertex to neighbors map
-	for (u32 i = 0; i < array_length(hull_triangle_faces); ++i) {
-		dvec3 triangle_face = hull_triangle_faces[i];
+	for (u32 i = 0; i < array_length(edges); ++i) {
+		array_push(vertex_to_neighbors[edges[i].v1], edges[i].v2);
+		array_push(vertex_to_neighbors[edges[i].v2], edges[i].v1);
+	}
 
-		for (u32 j = 0; j < array_length(hull_triangle_faces); ++j) {
-			if (i == j) {
-				continue;
-			}
+	// Faces are neighbors if they share at least one vertex. 'last_face_added_to' avoids adding the same neighbor twice.
+	u32** face_to_neighbors = array_new_len(u32*, num_faces);
+	u32* last_face_added_to = array_new_len(u32, num_faces);
+	for (u32 i = 0; i < num_faces; ++i) {
+		array_push(face_to_neighbors, array_new(u32));
+		array_push(last_face_added_to, i);
+	}
 
-			dvec3 face_to_test = hull_triangle_faces[j];
-			if (do_triangles_share_same_vertex(triangle_face, face_to_test)) {
-				array_push(triangle_faces_to_neighbor_faces_map[i], j);
+	for (u32 i = 0; i < num_faces; ++i) {
+		for (u32 j = 0; j < array_length(hull->faces[i]); ++j) {
+			u32* vertex_faces = vertex_to_faces[hull->faces[i][j]];
+			for (u32 k = 0; k < array_length(vertex_faces); ++k) {
+				u32 neighbor = vertex_faces[k];
+				if (last_face_added_to[neighbor] != i) {
+					last_face_added_to[neighbor] = i;
+					array_push(face_to_neighbors[i], neighbor);
+				}
 			}
 		}
-
-		// Fill vertex to edges map
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.x], triangle_face.y)) {
-			array_push(vertex_to_neighbors_map[triangle_face.x], triangle_face.y);
-		}
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.x], triangle_face.z)) {
-			array_push(vertex_to_neighbors_map[triangle_face.x], triangle_face.z);
-		}
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.y], triangle_face.x)) {
-			array_push(vertex_to_neighbors_map[triangle_face.y], triangle_face.x);
-		}
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.y], triangle_face.z)) {
-			array_push(vertex_to_neighbors_map[triangle_face.y], triangle_face.z);
-		}
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.z], triangle_face.x)) {
-			array_push(vertex_to_neighbors_map[triangle_face.z], triangle_face.x);
-		}
-		if (!is_neighbor_already_in_vertex_to_neighbors_map(vertex_to_neighbors_map[triangle_face.z], triangle_face.y)) {
-			array_push(vertex_to_neighbors_map[triangle_face.z], triangle_face.y);
-		}
 	}
 
-	// Collect all 'de facto' faces of the convex hull
-	Collider_Convex_Hull_Face* faces = array_new(Collider_Convex_Hull_Face);
-	boolean* is_triangle_face_already_processed_arr = (boolean*)calloc(array_length(hull_triangle_faces), sizeof(boolean));
-
-	for (u32 i = 0; i < array_length(hull_triangle_faces); ++i) {
-		if (is_triangle_face_already_processed_arr[i]) {
-			continue;
-		}
-
-		dvec3 triangle_face = hull_triangle_faces[i];
-		vec3 v1 = hull[triangle_face.x];
-		vec3 v2 = hull[triangle_face.y];
-		vec3 v3 = hull[triangle_face.z];
-
-		vec3 v12 = gm_vec3_subtract(v2, v1);
-		vec3 v13 = gm_vec3_subtract(v3, v1);
-		vec3 normal = gm_vec3_normalize(gm_vec3_cross(v12, v13));
-
-		dvec3* planar_faces = array_new(dvec3);
-		collect_faces_planar_to(hull, hull_triangle_faces, triangle_faces_to_neighbor_faces_map,
-			is_triangle_face_already_processed_arr, i, normal, &planar_faces);
-
-		Collider_Convex_Hull_Face new_face = create_convex_hull_face(planar_faces, normal);
-		u32 new_face_index = array_length(faces);
-		array_push(faces, new_face);
-
-		// Fill vertex to faces map accordingly
-		for (u32 j = 0; j < array_length(planar_faces); ++j) {
-			dvec3 planar_face = planar_faces[j];
-			array_push(vertex_to_faces_map[planar_face.x], new_face_index);
-			array_push(vertex_to_faces_map[planar_face.y], new_face_index);
-			array_push(vertex_to_faces_map[planar_face.z], new_face_index);
-		}
+	Collider_Convex_Hull_Shape* shape = pack_convex_hull_shape(hull->vertices, hull->faces, hull->face_normals, edges,
+		vertex_to_faces, vertex_to_neighbors, face_to_neighbors);
 
-		array_free(planar_faces);
-	}
+	array_free(edges);
+	array_free(last_face_added_to);
+	free_rows(vertex_to_faces);
+	free_rows(vertex_to_neighbors);
+	free_rows(face_to_neighbors);
+	return shape;
+}
 
-	// Prepare face to neighbors map
-	u32** face_to_neighbor_faces_map = (u32**)malloc(sizeof(u32*) * array_length(faces));
-	for (u32 i = 0; i < array_length(faces); ++i) {
-		face_to_neighbor_faces_map[i] = array_new(u32);
+Collider_Convex_Hull_Shape* collider_convex_hull_shape_create(const vec3* points, u32 max_vertices) {
+	Quickhull_Result hull;
+	if (!quickhull_build(points, max_vertices, &hull)) {
+		// The points must enclose some volume
+		assert(0);
+		return NULL;
 	}
 
-	// Fill faces to neighbor faces map
-	for (u32 i = 0; i < array_length(faces); ++i) {
-		Collider_Convex_Hull_Face face = faces[i];
+	Collider_Convex_Hull_Shape* shape = create_shape_from_hull(&hull);
+	quickhull_result_destroy(&hull);
+	return shape;
+}
 
-		for (u32 j = 0; j < array_length(faces); ++j) {
-			if (i == j) {
-				continue;
-			}
+void collider_convex_hull_shape_retain(Collider_Convex_Hull_Shape* shape) {
+	++shape->reference_count;
+}
 
-			Collider_Convex_Hull_Face candidate_face = faces[j];
-			if (do_faces_share_same_vertex(face.elements, candidate_face.elements)) {
-				array_push(face_to_neighbor_faces_map[i], j);
-			}
-		}
+void collider_convex_hull_shape_release(Collider_Convex_Hull_Shape* shape) {
+	assert(shape->reference_count > 0);
+	if (--shape->reference_count > 0) {
+		return;
 	}
 
-	hash_map_destroy(&vertex_to_idx_map);
-	for (u32 i = 0; i < array_length(hull_triangle_faces); ++i) {
-		array_free(triangle_faces_to_neighbor_faces_map[i]);
-	}
-	free(triangle_faces_to_neighbor_faces_map);
-	free(is_triangle_face_already_processed_arr);
-	array_free(hull_triangle_faces);
+	// The arrays either live in the same allocation as the shape or are owned by someone else
+	memory_tracker_free(shape);
+}
+
+// Allocates the world space arrays of the hull, initialized with the local space vertices and planes.
+static void convex_hull_allocate_transformed(Collider_Convex_Hull* convex_hull, Collider_Convex_Hull_Shape* shape) {
+	u64 vertices_size = shape->num_vertices * sizeof(vec3);
+	u64 planes_size = shape->num_faces * sizeof(Collider_Convex_Hull_Plane);
+	u8* memory = (u8*)memory_tracker_malloc(vertices_size + planes_size);
+
+	convex_hull->shape = shape;
+	convex_hull->transformed_vertices = (vec3*)memory;
+	convex_hull->transformed_face_planes = (Collider_Convex_Hull_Plane*)(memory + vertices_size);
+	memcpy(convex_hull->transformed_vertices, shape->vertices, vertices_size);
+	memcpy(convex_hull->transformed_face_planes, shape->face_planes, planes_size);
+}
 
-	Collider_Convex_Hull convex_hull;
-	convex_hull.faces = faces;
-	convex_hull.transformed_faces = (Collider_Convex_Hull_Face*)array_copy(faces);
-	convex_hull.vertices = hull;
-	convex_hull.transformed_vertices = (vec3*)array_copy(hull);
-	convex_hull.vertex_to_faces = vertex_to_faces_map;
-	convex_hull.vertex_to_neighbors = vertex_to_neighbors_map;
-	convex_hull.face_to_neighbors = face_to_neighbor_faces_map;
+Collider collider_convex_hull_create_from_shape(Collider_Convex_Hull_Shape* shape) {
+	collider_convex_hull_shape_retain(shape);
 
 	Collider collider;
 	collider.type = COLLIDER_TYPE_CONVEX_HULL;
-	collider.convex_hull = convex_hull;
+	convex_hull_allocate_transformed(&collider.convex_hull, shape);
 	return collider;
 }
 
-static void collider_convex_hull_destroy(Collider* collider) {
-	for (u32 i = 0; i < array_length(collider->convex_hull.vertices); ++i) {
-		array_free(collider->convex_hull.vertex_to_faces[i]);
+Collider collider_convex_hull_create(const vec3* points, u32 max_vertices) {
+	Collider_Convex_Hull_Shape* shape = collider_convex_hull_shape_create(points, max_vertices);
+	Collider collider = collider_convex_hull_create_from_shape(shape);
+	// The collider holds the only reference
+	collider_convex_hull_shape_release(shape);
+	return collider;
+}
+
+// Topology of the box [-1, 1]^3, shared by the convex hull views of all boxes.
+// Vertex i is at ((i & 1) ? 1 : -1, (i & 2) ? 1 : -1, (i & 4) ? 1 : -1).
+static Collider_Convex_Hull_Shape* create_box_convex_hull_shape() {
+	vec3* vertices = array_new_len(vec3, 8);
+	for (u32 i = 0; i < 8; ++i) {
+		vec3 v = {(i & 1) ? 1.0 : -1.0, (i & 2) ? 1.0 : -1.0, (i & 4) ? 1.0 : -1.0};
+		array_push(vertices, v);
 	}
-	free(collider->convex_hull.vertex_to_faces);
-	for (u32 i = 0; i < array_length(collider->convex_hull.vertices); ++i) {
-		array_free(collider->convex_hull.vertex_to_neighbors[i]);
+
+	Collider_Convex_Hull_Shape* shape = collider_convex_hull_shape_create(vertices, 0);
+	array_free(vertices);
+	return shape;
+}
+
+void collider_box_get_convex_hull_view(const Collider* box, Collider* view, Arena* arena) {
+	assert(box->type == COLLIDER_TYPE_BOX);
+	// Initialized only once, and never destroyed.
+	static Collider_Convex_Hull_Shape* const box_shape = create_box_convex_hull_shape();
+	vec3* transformed_vertices = (vec3*)arena_allocate(arena, box_shape->num_vertices * sizeof(vec3));
+	Collider_Convex_Hull_Plane* transformed_face_planes =
+		(Collider_Convex_Hull_Plane*)arena_allocate(arena, box_shape->num_faces * sizeof(Collider_Convex_Hull_Plane));
+
+	const Collider_Box* b = &box->box;
+	vec3 x = gm_vec3_scalar_product(b->half_extents.x, b->axes[0]);
+	vec3 y = gm_vec3_scalar_product(b->half_extents.y, b->axes[1]);
+	vec3 z = gm_vec3_scalar_product(b->half_extents.z, b->axes[2]);
+	for (u32 i = 0; i < box_shape->num_vertices; ++i) {
+		vec3 v = box_shape->vertices[i];
+		transformed_vertices[i] = gm_vec3_add(b->center, gm_vec3_add(gm_vec3_scalar_product(v.x, x),
+			gm_vec3_add(gm_vec3_scalar_product(v.y, y), gm_vec3_scalar_product(v.z, z))));
 	}
-	free(collider->convex_hull.vertex_to_neighbors);
-	for (u32 i = 0; i < array_length(collider->convex_hull.faces); ++i) {
-		array_free(collider->convex_hull.face_to_neighbors[i]);
+	for (u32 i = 0; i < box_shape->num_faces; ++i) {
+		vec3 n = box_shape->face_planes[i].normal;
+		vec3 normal = gm_vec3_add(gm_vec3_scalar_product(n.x, b->axes[0]),
+			gm_vec3_add(gm_vec3_scalar_product(n.y, b->axes[1]), gm_vec3_scalar_product(n.z, b->axes[2])));
+		vec3 point_on_face = transformed_vertices[box_shape->face_vertices[box_shape->face_vertex_offsets[i]]];
+		transformed_face_planes[i].normal = normal;
+		transformed_face_planes[i].distance = gm_vec3_dot(normal, point_on_face);
 	}
-	free(collider->convex_hull.face_to_neighbors);
 
-	array_free(collider->convex_hull.vertices);
-	array_free(collider->convex_hull.transformed_vertices);
-	for (u32 i = 0; i < array_length(collider->convex_hull.faces); ++i) {
-		array_free(collider->convex_hull.faces[i].elements);
-	}
-	array_free(collider->convex_hull.faces);
+	view->type = COLLIDER_TYPE_CONVEX_HULL;
+	view->convex_hull.shape = box_shape;
+	view->convex_hull.transformed_vertices = transformed_vertices;
+	view->convex_hull.transformed_face_planes = transformed_face_planes;
+}
 
-	// The 'elements' array of the transformed faces is the same as the one stored in 'faces', so we don't need to release it again.
-	array_free(collider->convex_hull.transformed_faces);
+static void collider_convex_hull_destroy(Collider* collider) {
+	// The face planes live in the same allocation as the vertices
+	memory_tracker_free(collider->convex_hull.transformed_vertices);
+	collider_convex_hull_shape_release(collider->convex_hull.shape);
 }
 
 static void collider_destroy(Collider* collider) {
@@ -396,6 +517,15 @@ static void collider_destroy(Collider* collider) {
 		case COLLIDER_TYPE_SPHERE: {
 			collider_sphere_destroy(collider);
 		} break;
+		case COLLIDER_TYPE_BOX: {
+			collider_box_destroy(collider);
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			collider_capsule_destroy(collider);
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			collider_cylinder_destroy(collider);
+		} break;
 	}
 }
 
@@ -409,28 +539,46 @@ void colliders_destroy(Collider* colliders) {
 static void collider_update(Collider* collider, vec3 translation, const Quaternion* rotation) {
 	switch (collider->type) {
 		case COLLIDER_TYPE_CONVEX_HULL: {
+			Collider_Convex_Hull* convex_hull = &collider->convex_hull;
+			const Collider_Convex_Hull_Shape* shape = convex_hull->shape;
 			mat4 model_matrix_no_scale = util_get_model_matrix_no_scale(rotation, translation);
-			for (u32 i = 0; i < array_length(collider->convex_hull.transformed_vertices); ++i) {
+			for (u32 i = 0; i < shape->num_vertices; ++i) {
 				vec4 vertex = {
-					collider->convex_hull.vertices[i].x,
-					collider->convex_hull.vertices[i].y,
-					collider->convex_hull.vertices[i].z,
+					shape->vertices[i].x,
+					shape->vertices[i].y,
+					shape->vertices[i].z,
 					1.0
 				};
 				vec4 transformed_vertex = gm_mat4_multiply_vec4(&model_matrix_no_scale, vertex);
 				transformed_vertex = gm_vec4_scalar_product(1.0 / transformed_vertex.w, transformed_vertex);
-				collider->convex_hull.transformed_vertices[i] = gm_vec4_to_vec3(transformed_vertex);
+				convex_hull->transformed_vertices[i] = gm_vec4_to_vec3(transformed_vertex);
 			}
 
-			for (u32 i = 0; i < array_length(collider->convex_hull.transformed_faces); ++i) {
-				vec3 normal = collider->convex_hull.faces[i].normal;
-				vec3 transformed_normal = gm_mat4_multiply_vec3(&model_matrix_no_scale, normal, false);
-				collider->convex_hull.transformed_faces[i].normal = gm_vec3_normalize(transformed_normal);
+			for (u32 i = 0; i < shape->num_faces; ++i) {
+				vec3 normal = shape->face_planes[i].normal;
+				vec3 transformed_normal = gm_vec3_normalize(gm_mat4_multiply_vec3(&model_matrix_no_scale, normal, false));
+				vec3 point_on_face = convex_hull->transformed_vertices[shape->face_vertices[shape->face_vertex_offsets[i]]];
+				convex_hull->transformed_face_planes[i].normal = transformed_normal;
+				convex_hull->transformed_face_planes[i].distance = gm_vec3_dot(transformed_normal, point_on_face);
 			}
 		} break;
 		case COLLIDER_TYPE_SPHERE: {
 			collider->sphere.center = translation;
 		} break;
+		case COLLIDER_TYPE_BOX: {
+			collider->box.center = translation;
+			collider->box.axes[0] = quaternion_apply_to_vec3(rotation, {1.0, 0.0, 0.0});
+			collider->box.axes[1] = quaternion_apply_to_vec3(rotation, {0.0, 1.0, 0.0});
+			collider->box.axes[2] = quaternion_apply_to_vec3(rotation, {0.0, 0.0, 1.0});
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			collider->capsule.center = translation;
+			collider->capsule.axis = quaternion_apply_to_vec3(rotation, {0.0, 1.0, 0.0});
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			collider->cylinder.center = translation;
+			collider->cylinder.axis = quaternion_apply_to_vec3(rotation, {0.0, 1.0, 0.0});
+		} break;
 		default: {
 			assert(0);
 		} break;
@@ -444,49 +592,79 @@ void colliders_update(Collider* colliders, vec3 translation, const Quaternion* r
 	}
 }
 
-// @TODO: We need to rewrite this function
-mat3 colliders_get_default_inertia_tensor(Collider* colliders, r64 mass) {
-	// For now, the center of mass is always assumed to be at 0,0,0
-	if (array_length(colliders) == 1) {
-		Collider* collider = &colliders[0];
-
-		if (collider->type == COLLIDER_TYPE_SPHERE) {
-			// for now we assume the sphere is centered at its center of mass (because then the inertia tensor is simple)
-			assert(gm_vec3_is_zero(collider->sphere.center));
-
-			r64 I = (2.0 / 5.0) * mass * collider->sphere.radius * collider->sphere.radius;
-			mat3 result = {0};
-			result.data[0][0] = I;
-			result.data[1][1] = I;
-			result.data[2][2] = I;
-			return result;
+// Boxes, spheres, capsules and cylinders are centered at the origin of the entity.
+static void collider_get_mass_properties(const Collider* collider, Collider_Mass_Properties* properties) {
+	mat3 inertia = {0};
+	switch (collider->type) {
+		case COLLIDER_TYPE_CONVEX_HULL: {
+			*properties = collider->convex_hull.shape->mass_properties;
+			return;
 		}
+		case COLLIDER_TYPE_SPHERE: {
+			r64 r = collider->sphere.radius;
+			properties->volume = (4.0 / 3.0) * PI_F * r * r * r;
+			inertia.data[0][0] = (2.0 / 5.0) * properties->volume * r * r;
+			inertia.data[1][1] = inertia.data[0][0];
+			inertia.data[2][2] = inertia.data[0][0];
+		} break;
+		case COLLIDER_TYPE_BOX: {
+			vec3 size = gm_vec3_scalar_product(2.0, collider->box.half_extents);
+			properties->volume = size.x * size.y * size.z;
+			inertia.data[0][0] = (1.0 / 12.0) * properties->volume * (size.y * size.y + size.z * size.z);
+			inertia.data[1][1] = (1.0 / 12.0) * properties->volume * (size.x * size.x + size.z * size.z);
+			inertia.data[2][2] = (1.0 / 12.0) * properties->volume * (size.x * size.x + size.y * size.y);
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			r64 r = collider->cylinder.radius;
+			r64 h = 2.0 * collider->cylinder.half_height;
+			properties->volume = PI_F * r * r * h;
+			inertia.data[0][0] = (1.0 / 12.0) * properties->volume * (3.0 * r * r + h * h);
+			inertia.data[1][1] = (1.0 / 2.0) * properties->volume * r * r;
+			inertia.data[2][2] = inertia.data[0][0];
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			// A cylinder and two hemispheres
+			r64 r = collider->capsule.radius;
+			r64 h = 2.0 * collider->capsule.half_height;
+			r64 cylinder_volume = PI_F * r * r * h;
+			r64 spheres_volume = (4.0 / 3.0) * PI_F * r * r * r;
+			properties->volume = cylinder_volume + spheres_volume;
+			inertia.data[0][0] = cylinder_volume * (h * h / 12.0 + r * r / 4.0) +
+				spheres_volume * (2.0 * r * r / 5.0 + h * h / 4.0 + 3.0 * h * r / 8.0);
+			inertia.data[1][1] = cylinder_volume * r * r / 2.0 + spheres_volume * 2.0 * r * r / 5.0;
+			inertia.data[2][2] = inertia.data[0][0];
+		} break;
+		default: assert(0); break;
 	}
 
-	u32 total_num_vertices = 0;
+	properties->center_of_mass = vec3{0.0, 0.0, 0.0};
+	properties->inertia_tensor = inertia;
+}
+
+mat3 colliders_get_default_inertia_tensor(Collider* colliders, r64 mass) {
+	r64 total_volume = 0.0;
 	for (u32 i = 0; i < array_length(colliders); ++i) {
-		Collider* collider = &colliders[i];
-		total_num_vertices += array_length(collider->convex_hull.vertices);
+		Collider_Mass_Properties properties;
+		collider_get_mass_properties(&colliders[i], &properties);
+		total_volume += properties.volume;
 	}
 
-	r64 mass_per_vertex = mass / total_num_vertices;
-
+	// Overlapping colliders count their common volume twice
+	r64 density = mass / total_volume;
 	mat3 result = {0};
 	for (u32 i = 0; i < array_length(colliders); ++i) {
-		Collider* collider = &colliders[i];
-		assert(collider->type == COLLIDER_TYPE_CONVEX_HULL);
-
-		for (u32 j = 0; j < array_length(collider->convex_hull.vertices); ++j) {
-			vec3 v = collider->convex_hull.vertices[j];
-			result.data[0][0] += mass_per_vertex * (v.y * v.y + v.z * v.z);
-			result.data[0][1] += mass_per_vertex * v.x * v.y;
-			result.data[0][2] += mass_per_vertex * v.x * v.z;
-			result.data[1][0] += mass_per_vertex * v.x * v.y;
-			result.data[1][1] += mass_per_vertex * (v.x * v.x + v.z * v.z);
-			result.data[1][2] += mass_per_vertex * v.y * v.z;
-			result.data[2][0] += mass_per_vertex * v.x * v.z;
-			result.data[2][1] += mass_per_vertex * v.y * v.z;
-			result.data[2][2] += mass_per_vertex * (v.x * v.x + v.y * v.y);
+		Collider_Mass_Properties properties;
+		collider_get_mass_properties(&colliders[i], &properties);
+
+		// Parallel axis theorem: I_origin = I_center + V * (|c|^2 * E - c * c^T)
+		vec3 c = properties.center_of_mass;
+		r64 vc[3] = {c.x, c.y, c.z};
+		r64 c_squared = gm_vec3_dot(c, c);
+		for (u32 r = 0; r < 3; ++r) {
+			for (u32 k = 0; k < 3; ++k) {
+				r64 shift = properties.volume * ((r == k ? c_squared : 0.0) - vc[r] * vc[k]);
+				result.data[r][k] += density * (properties.inertia_tensor.data[r][k] + shift);
+			}
 		}
 	}
 
@@ -501,6 +679,15 @@ static r64 collider_get_bounding_sphere_radius(const Collider* collider) {
 		case COLLIDER_TYPE_SPHERE: {
 			return get_sphere_collider_bounding_sphere_radius(collider);
 		} break;
+		case COLLIDER_TYPE_BOX: {
+			return get_box_collider_bounding_sphere_radius(collider);
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			return get_capsule_collider_bounding_sphere_radius(collider);
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			return get_cylinder_collider_bounding_sphere_radius(collider);
+		} break;
 	}
 
 	assert(0);
@@ -520,7 +707,272 @@ r64 colliders_get_bounding_sphere_radius(const Collider* colliders) {
 	return max_bounding_sphere_radius;
 }
 
-static void collider_get_contacts(Collider* collider1, Collider* collider2, Collider_Contact** contacts) {
+// Pushes a contact between the shapes 'a' and 'b', where 'normal' points from 'a' to 'b'.
+static void push_contact(vec3 point_on_a, vec3 point_on_b, vec3 normal, boolean is_a_first, Collider_Contact** contacts) {
+	Collider_Contact contact;
+	if (is_a_first) {
+		contact.collision_point1 = point_on_a;
+		contact.collision_point2 = point_on_b;
+		contact.normal = normal;
+	} else {
+		contact.collision_point1 = point_on_b;
+		contact.collision_point2 = point_on_a;
+		contact.normal = gm_vec3_invert(normal);
+	}
+	array_push(*contacts, contact);
+}
+
+// The sphere center is brought to the local space of the box, where the closest point of the box is found by clamping.
+// If the center is inside the box, the contact is built using the face that is closest to the center.
+static void box_sphere_get_contacts(const Collider* box_collider, const Collider* sphere_collider, boolean is_box_first,
+	Collider_Contact** contacts) {
+	const Collider_Box* box = &box_collider->box;
+	const Collider_Sphere* sphere = &sphere_collider->sphere;
+
+	vec3 d = gm_vec3_subtract(sphere->center, box->center);
+	r64 local_center[3], closest[3];
+	r64 half_extents[3] = {box->half_extents.x, box->half_extents.y, box->half_extents.z};
+	boolean is_center_inside = true;
+	for (u32 i = 0; i < 3; ++i) {
+		local_center[i] = gm_vec3_dot(d, box->axes[i]);
+		closest[i] = MIN(MAX(local_center[i], -half_extents[i]), half_extents[i]);
+		if (closest[i] != local_center[i]) {
+			is_center_inside = false;
+		}
+	}
+
+	// Normal points from the box to the sphere
+	vec3 normal;
+	if (is_center_inside) {
+		u32 closest_axis = 0;
+		r64 min_distance = DBL_MAX;
+		for (u32 i = 0; i < 3; ++i) {
+			r64 distance = half_extents[i] - fabs(local_center[i]);
+			if (distance < min_distance) {
+				min_distance = distance;
+				closest_axis = i;
+			}
+		}
+		r64 sign = local_center[closest_axis] >= 0.0 ? 1.0 : -1.0;
+		closest[closest_axis] = sign * half_extents[closest_axis];
+		normal = gm_vec3_scalar_product(sign, box->axes[closest_axis]);
+	} else {
+		vec3 local_diff = {local_center[0] - closest[0], local_center[1] - closest[1], local_center[2] - closest[2]};
+		r64 distance_sqd = gm_vec3_dot(local_diff, local_diff);
+		if (distance_sqd > sphere->radius * sphere->radius) {
+			return;
+		}
+		r64 distance = sqrt(distance_sqd);
+		normal = gm_vec3_scalar_product(1.0 / distance, gm_vec3_add(gm_vec3_scalar_product(local_diff.x, box->axes[0]),
+			gm_vec3_add(gm_vec3_scalar_product(local_diff.y, box->axes[1]), gm_vec3_scalar_product(local_diff.z, box->axes[2]))));
+	}
+
+	vec3 box_point = gm_vec3_add(box->center, gm_vec3_add(gm_vec3_scalar_product(closest[0], box->axes[0]),
+		gm_vec3_add(gm_vec3_scalar_product(closest[1], box->axes[1]), gm_vec3_scalar_product(closest[2], box->axes[2]))));
+	vec3 sphere_point = gm_vec3_subtract(sphere->center, gm_vec3_scalar_product(sphere->radius, normal));
+	push_contact(box_point, sphere_point, normal, is_box_first, contacts);
+}
+
+// The closest point of the hull to the sphere center is found with a GJK distance query, which is much cheaper than GJK + EPA.
+// If the center is inside the hull, the contact is built using the face that is closest to the center.
+static void convex_hull_sphere_get_contacts(Collider* hull_collider, const Collider* sphere_collider, boolean is_hull_first,
+	Collider_Contact** contacts) {
+	const Collider_Convex_Hull* convex_hull = &hull_collider->convex_hull;
+	const Collider_Sphere* sphere = &sphere_collider->sphere;
+
+	// Normal points from the hull to the sphere
+	vec3 normal;
+	vec3 hull_point;
+	if (gjk_get_closest_point(hull_collider, sphere->center, &hull_point)) {
+		vec3 diff = gm_vec3_subtract(sphere->center, hull_point);
+		r64 distance_sqd = gm_vec3_dot(diff, diff);
+		if (distance_sqd > sphere->radius * sphere->radius) {
+			return;
+		}
+		normal = gm_vec3_scalar_product(1.0 / sqrt(distance_sqd), diff);
+	} else {
+		r64 max_distance = -DBL_MAX;
+		for (u32 i = 0; i < convex_hull->shape->num_faces; ++i) {
+			const Collider_Convex_Hull_Plane* plane = &convex_hull->transformed_face_planes[i];
+			r64 distance = gm_vec3_dot(plane->normal, sphere->center) - plane->distance;
+			if (distance > max_distance) {
+				max_distance = distance;
+				normal = plane->normal;
+			}
+		}
+		hull_point = gm_vec3_subtract(sphere->center, gm_vec3_scalar_product(max_distance, normal));
+	}
+
+	vec3 sphere_point = gm_vec3_subtract(sphere->center, gm_vec3_scalar_product(sphere->radius, normal));
+	push_contact(hull_point, sphere_point, normal, is_hull_first, contacts);
+}
+
+// Builds the contact between the spheres (center1, radius1) and (center2, radius2), if they are touching.
+static void spheres_get_contacts(vec3 center1, r64 radius1, vec3 center2, r64 radius2, Collider_Contact** contacts) {
+	vec3 distance_vector = gm_vec3_subtract(center2, center1);
+	r64 distance_sqd = gm_vec3_dot(distance_vector, distance_vector);
+	r64 min_distance = radius1 + radius2;
+	if (distance_sqd >= min_distance * min_distance) {
+		return;
+	}
+
+	r64 distance = sqrt(distance_sqd);
+	// If the centers coincide, any direction works.
+	vec3 normal = distance > 1e-12 ? gm_vec3_scalar_product(1.0 / distance, distance_vector) : vec3{0.0, 1.0, 0.0};
+	Collider_Contact contact;
+	contact.collision_point1 = gm_vec3_add(center1, gm_vec3_scalar_product(radius1, normal));
+	contact.collision_point2 = gm_vec3_subtract(center2, gm_vec3_scalar_product(radius2, normal));
+	contact.normal = normal;
+	array_push(*contacts, contact);
+}
+
+static vec3 get_capsule_segment_start(const Collider_Capsule* capsule) {
+	return gm_vec3_subtract(capsule->center, gm_vec3_scalar_product(capsule->half_height, capsule->axis));
+}
+
+static vec3 get_capsule_segment_end(const Collider_Capsule* capsule) {
+	return gm_vec3_add(capsule->center, gm_vec3_scalar_product(capsule->half_height, capsule->axis));
+}
+
+static vec3 closest_point_on_segment(vec3 a, vec3 b, vec3 point) {
+	vec3 ab = gm_vec3_subtract(b, a);
+	r64 length_sqd = gm_vec3_dot(ab, ab);
+	if (length_sqd < 1e-12) {
+		return a;
+	}
+	r64 t = gm_vec3_dot(gm_vec3_subtract(point, a), ab) / length_sqd;
+	t = MIN(MAX(t, 0.0), 1.0);
+	return gm_vec3_add(a, gm_vec3_scalar_product(t, ab));
+}
+
+// Closest points between the segments p1-q1 and p2-q2.
+// Based on 'Real-Time Collision Detection' (Christer Ericson), section 5.1.9
+static void closest_points_between_segments(vec3 p1, vec3 q1, vec3 p2, vec3 q2, vec3* c1, vec3* c2) {
+	const r64 EPSILON = 1e-12;
+	vec3 d1 = gm_vec3_subtract(q1, p1);
+	vec3 d2 = gm_vec3_subtract(q2, p2);
+	vec3 r = gm_vec3_subtract(p1, p2);
+	r64 a = gm_vec3_dot(d1, d1);
+	r64 e = gm_vec3_dot(d2, d2);
+	r64 f = gm_vec3_dot(d2, r);
+	r64 s, t;
+
+	if (a <= EPSILON && e <= EPSILON) {
+		s = t = 0.0;
+	} else if (a <= EPSILON) {
+		s = 0.0;
+		t = MIN(MAX(f / e, 0.0), 1.0);
+	} else {
+		r64 c = gm_vec3_dot(d1, r);
+		if (e <= EPSILON) {
+			t = 0.0;
+			s = MIN(MAX(-c / a, 0.0), 1.0);
+		} else {
+			r64 b = gm_vec3_dot(d1, d2);
+			r64 denom = a * e - b * b;
+			s = denom > EPSILON ? MIN(MAX((b * f - c * e) / denom, 0.0), 1.0) : 0.0;
+			t = (b * s + f) / e;
+			if (t < 0.0) {
+				t = 0.0;
+				s = MIN(MAX(-c / a, 0.0), 1.0);
+			} else if (t > 1.0) {
+				t = 1.0;
+				s = MIN(MAX((b - c) / a, 0.0), 1.0);
+			}
+		}
+	}
+
+	*c1 = gm_vec3_add(p1, gm_vec3_scalar_product(s, d1));
+	*c2 = gm_vec3_add(p2, gm_vec3_scalar_product(t, d2));
+}
+
+static void capsule_sphere_get_contacts(const Collider_Capsule* capsule, const Collider_Sphere* sphere, boolean is_capsule_first,
+	Collider_Contact** contacts) {
+	vec3 closest = closest_point_on_segment(get_capsule_segment_start(capsule), get_capsule_segment_end(capsule), sphere->center);
+	if (is_capsule_first) {
+		spheres_get_contacts(closest, capsule->radius, sphere->center, sphere->radius, contacts);
+	} else {
+		spheres_get_contacts(sphere->center, sphere->radius, closest, capsule->radius, contacts);
+	}
+}
+
+// Capsules are spheres swept along their segments, so the contact is the contact between the spheres placed at the closest points
+// of the segments. When the segments are parallel, two contacts are built at the ends of their overlap, so capsules can rest on each other.
+static void capsules_get_contacts(const Collider_Capsule* capsule1, const Collider_Capsule* capsule2, Collider_Contact** contacts) {
+	const r64 PARALLEL_EPSILON = 0.001;
+	vec3 p1 = get_capsule_segment_start(capsule1);
+	vec3 q1 = get_capsule_segment_end(capsule1);
+	vec3 p2 = get_capsule_segment_start(capsule2);
+	vec3 q2 = get_capsule_segment_end(capsule2);
+
+	if (gm_vec3_length(gm_vec3_cross(capsule1->axis, capsule2->axis)) < PARALLEL_EPSILON &&
+		capsule1->half_height > 0.0 && capsule2->half_height > 0.0) {
+		// Project the second segment onto the first one
+		r64 t1 = gm_vec3_dot(gm_vec3_subtract(p2, capsule1->center), capsule1->axis);
+		r64 t2 = gm_vec3_dot(gm_vec3_subtract(q2, capsule1->center), capsule1->axis);
+		r64 overlap_start = MAX(MIN(t1, t2), -capsule1->half_height);
+		r64 overlap_end = MIN(MAX(t1, t2), capsule1->half_height);
+		if (overlap_end - overlap_start > PARALLEL_EPSILON) {
+			vec3 a = gm_vec3_add(capsule1->center, gm_vec3_scalar_product(overlap_start, capsule1->axis));
+			vec3 b = gm_vec3_add(capsule1->center, gm_vec3_scalar_product(overlap_end, capsule1->axis));
+			spheres_get_contacts(a, capsule1->radius, closest_point_on_segment(p2, q2, a), capsule2->radius, contacts);
+			spheres_get_contacts(b, capsule1->radius, closest_point_on_segment(p2, q2, b), capsule2->radius, contacts);
+			return;
+		}
+	}
+
+	vec3 c1, c2;
+	closest_points_between_segments(p1, q1, p2, q2, &c1, &c2);
+	spheres_get_contacts(c1, capsule1->radius, c2, capsule2->radius, contacts);
+}
+
+// Same idea as the box-sphere case, but in cylindrical coordinates.
+static void cylinder_sphere_get_contacts(const Collider_Cylinder* cylinder, const Collider_Sphere* sphere, boolean is_cylinder_first,
+	Collider_Contact** contacts) {
+	vec3 d = gm_vec3_subtract(sphere->center, cylinder->center);
+	r64 h = gm_vec3_dot(d, cylinder->axis);
+	vec3 radial = gm_vec3_subtract(d, gm_vec3_scalar_product(h, cylinder->axis));
+	r64 radial_length = gm_vec3_length(radial);
+	vec3 radial_direction;
+	if (radial_length > 1e-12) {
+		radial_direction = gm_vec3_scalar_product(1.0 / radial_length, radial);
+	} else {
+		// The center is on the axis, pick any direction perpendicular to it
+		vec3 v = fabs(cylinder->axis.x) < 0.9 ? vec3{1.0, 0.0, 0.0} : vec3{0.0, 1.0, 0.0};
+		radial_direction = gm_vec3_normalize(gm_vec3_cross(cylinder->axis, v));
+	}
+
+	// Normal points from the cylinder to the sphere
+	vec3 normal, cylinder_point;
+	if (fabs(h) <= cylinder->half_height && radial_length <= cylinder->radius) {
+		// The center is inside the cylinder
+		r64 sign = h >= 0.0 ? 1.0 : -1.0;
+		if (cylinder->half_height - fabs(h) < cylinder->radius - radial_length) {
+			normal = gm_vec3_scalar_product(sign, cylinder->axis);
+			cylinder_point = gm_vec3_add(cylinder->center, gm_vec3_add(gm_vec3_scalar_product(sign * cylinder->half_height, cylinder->axis), radial));
+		} else {
+			normal = radial_direction;
+			cylinder_point = gm_vec3_add(cylinder->center, gm_vec3_add(gm_vec3_scalar_product(h, cylinder->axis),
+				gm_vec3_scalar_product(cylinder->radius, radial_direction)));
+		}
+	} else {
+		r64 clamped_h = MIN(MAX(h, -cylinder->half_height), cylinder->half_height);
+		r64 clamped_radial_length = MIN(radial_length, cylinder->radius);
+		cylinder_point = gm_vec3_add(cylinder->center, gm_vec3_add(gm_vec3_scalar_product(clamped_h, cylinder->axis),
+			gm_vec3_scalar_product(clamped_radial_length, radial_direction)));
+		vec3 diff = gm_vec3_subtract(sphere->center, cylinder_point);
+		r64 distance_sqd = gm_vec3_dot(diff, diff);
+		if (distance_sqd > sphere->radius * sphere->radius) {
+			return;
+		}
+		normal = gm_vec3_scalar_product(1.0 / sqrt(distance_sqd), diff);
+	}
+
+	vec3 sphere_point = gm_vec3_subtract(sphere->center, gm_vec3_scalar_product(sphere->radius, normal));
+	push_contact(cylinder_point, sphere_point, normal, is_cylinder_first, contacts);
+}
+
+void collider_get_contacts(Collider* collider1, Collider* collider2, Collider_Contact** contacts) {
 	GJK_Simplex simplex;
 	r64 penetration;
 	vec3 normal;
@@ -541,6 +993,84 @@ static void collider_get_contacts(Collider* collider1, Collider* collider2, Coll
 		return;
 	}
 
+	if (collider1->type == COLLIDER_TYPE_BOX && collider2->type == COLLIDER_TYPE_BOX) {
+		SAT_Result sat_result;
+		if (sat_collides_boxes(&collider1->box, &collider2->box, &sat_result)) {
+			clipping_get_contact_manifold_from_sat(collider1, collider2, &sat_result, contacts);
+		}
+
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_BOX && collider2->type == COLLIDER_TYPE_SPHERE) {
+		box_sphere_get_contacts(collider1, collider2, true, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_SPHERE && collider2->type == COLLIDER_TYPE_BOX) {
+		box_sphere_get_contacts(collider2, collider1, false, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_CAPSULE && collider2->type == COLLIDER_TYPE_SPHERE) {
+		capsule_sphere_get_contacts(&collider1->capsule, &collider2->sphere, true, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_SPHERE && collider2->type == COLLIDER_TYPE_CAPSULE) {
+		capsule_sphere_get_contacts(&collider2->capsule, &collider1->sphere, false, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_CAPSULE && collider2->type == COLLIDER_TYPE_CAPSULE) {
+		capsules_get_contacts(&collider1->capsule, &collider2->capsule, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_CYLINDER && collider2->type == COLLIDER_TYPE_SPHERE) {
+		cylinder_sphere_get_contacts(&collider1->cylinder, &collider2->sphere, true, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_SPHERE && collider2->type == COLLIDER_TYPE_CYLINDER) {
+		cylinder_sphere_get_contacts(&collider2->cylinder, &collider1->sphere, false, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_CONVEX_HULL && collider2->type == COLLIDER_TYPE_SPHERE) {
+		convex_hull_sphere_get_contacts(collider1, collider2, true, contacts);
+		return;
+	}
+
+	if (collider1->type == COLLIDER_TYPE_SPHERE && collider2->type == COLLIDER_TYPE_CONVEX_HULL) {
+		convex_hull_sphere_get_contacts(collider2, collider1, false, contacts);
+		return;
+	}
+
+	// Boxes are tested against generic convex hulls through their convex hull view. The view only lives for this call, so the
+	// SAT feature cache is keyed by the box itself.
+	const Collider* cache_key1 = collider1;
+	const Collider* cache_key2 = collider2;
+	Collider box_view;
+	if (collider1->type == COLLIDER_TYPE_BOX && collider2->type == COLLIDER_TYPE_CONVEX_HULL) {
+		collider_box_get_convex_hull_view(collider1, &box_view, arena_get_scratch());
+		collider1 = &box_view;
+	} else if (collider1->type == COLLIDER_TYPE_CONVEX_HULL && collider2->type == COLLIDER_TYPE_BOX) {
+		collider_box_get_convex_hull_view(collider2, &box_view, arena_get_scratch());
+		collider2 = &box_view;
+	}
+
+	// For convex hulls that are small enough, the separating axis test directly gives us the reference and incident features.
+	if (collider1->type == COLLIDER_TYPE_CONVEX_HULL && collider2->type == COLLIDER_TYPE_CONVEX_HULL &&
+		sat_can_collide_convex_hulls(&collider1->convex_hull, &collider2->convex_hull)) {
+		SAT_Result sat_result;
+		if (sat_collides(collider1, collider2, cache_key1, cache_key2, &sat_result)) {
+			clipping_get_contact_manifold_from_sat(collider1, collider2, &sat_result, contacts);
+		}
+
+		return;
+	}
+
 	// Call GJK to check if there is a collision
 	if (gjk_collides(collider1, collider2, &simplex)) {
 		// There is a collision.
@@ -556,17 +1086,3 @@ static void collider_get_contacts(Collider* collider1, Collider* collider2, Coll
 
 	return;
 }
-
-Collider_Contact* colliders_get_contacts(Collider* colliders1, Collider* colliders2) {
-	Collider_Contact* contacts = array_new_len(Collider_Contact, 16);
-
-	for (u32 i = 0; i < array_length(colliders1); ++i) {
-		Collider* collider1 = &colliders1[i];
-		for (u32 j = 0; j < array_length(colliders2); ++j) {
-			Collider* collider2 = &colliders2[j];
-			collider_get_contacts(collider1, collider2, &contacts);
-		}
-	}
-
-	return contacts;
-}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define RAW_PHYSICS_PHYSICS_COLLIDER_H
 #include "gm.h"
 #include "quaternion.h"
+#include "arena.h"
 
 typedef struct {
 	vec3 collision_point1;
@@ -9,20 +10,77 @@ typedef struct {
 	vec3 normal;
 } Collider_Contact;
 
+// A face plane: the points p of the face satisfy dot(normal, p) = distance.
 typedef struct {
-	u32* elements;
 	vec3 normal;
-} Collider_Convex_Hull_Face;
+	r64 distance;
+} Collider_Convex_Hull_Plane;
 
+// An edge of the convex hull, shared by exactly two faces.
 typedef struct {
+	u32 v1, v2;
+	u32 face1, face2;
+} Collider_Convex_Hull_Edge;
+
+// Mass properties for a uniform density of 1, so they only need to be scaled by the density of the body.
+typedef struct {
+	r64 volume;
+	vec3 center_of_mass;
+	// About the center of mass
+	mat3 inertia_tensor;
+} Collider_Mass_Properties;
+
+// The immutable part of a convex hull: the vertices in local space and the topology.
+// Shapes are reference counted, so any number of colliders can share the same shape. Since colliders don't deal with scaling,
+// the scale is baked into the vertices, and each scale needs its own shape.
+//
+// The shape and all its arrays live in a single allocation, unless the arrays come from somewhere else (see
+// 'collider_convex_hull_shape_create_from_arrays'). The adjacency lists are stored in compressed rows: the items of
+// row i of 'X' are X[X_offsets[i]] to X[X_offsets[i + 1] - 1], so each offsets array has one more entry than there are rows.
+typedef struct {
+	u32 reference_count;
+	u32 num_vertices;
+	u32 num_faces;
+	u32 num_edges;
+	// Distance from the origin to the farthest vertex
+	r64 bounding_radius;
+	// Integrated over the volume of the hull when the shape is created
+	Collider_Mass_Properties mass_properties;
+
 	vec3* vertices;
-	vec3* transformed_vertices;
-	Collider_Convex_Hull_Face* faces;
-	Collider_Convex_Hull_Face* transformed_faces;
+	Collider_Convex_Hull_Plane* face_planes;
+	Collider_Convex_Hull_Edge* edges;
+
+	// The vertices of each face, in order around the face.
+	u32* face_vertex_offsets;
+	u32* face_vertices;
+	// The faces that touch each vertex.
+	u32* vertex_face_offsets;
+	u32* vertex_faces;
+	// The vertices connected to each vertex.
+	u32* vertex_neighbor_offsets;
+	u32* vertex_neighbors;
+	// The faces that share at least one vertex with each face.
+	u32* face_neighbor_offsets;
+	u32* face_neighbors;
+} Collider_Convex_Hull_Shape;
 
-	u32** vertex_to_faces;
-	u32** vertex_to_neighbors;
-	u32** face_to_neighbors;
+// The number of items in each array of a shape. This is all that is needed to find the arrays in the block that holds them.
+typedef struct {
+	u32 num_vertices;
+	u32 num_faces;
+	u32 num_edges;
+	u32 num_face_vertices;
+	u32 num_vertex_faces;
+	u32 num_vertex_neighbors;
+	u32 num_face_neighbors;
+} Collider_Convex_Hull_Shape_Layout;
+
+typedef struct {
+	Collider_Convex_Hull_Shape* shape;
+	// The vertices and face planes of the shape in world space, in a single allocation owned by the collider.
+	vec3* transformed_vertices;
+	Collider_Convex_Hull_Plane* transformed_face_planes;
 } Collider_Convex_Hull;
 
 typedef struct {
@@ -30,9 +88,37 @@ typedef struct {
 	vec3 center;
 } Collider_Sphere;
 
+// A box centered at the origin of the entity.
+// Faces are indexed as 2 * axis + (0 for the positive side, 1 for the negative side), e.g. face 3 is the -Y face.
+typedef struct {
+	vec3 half_extents;
+	vec3 center;
+	vec3 axes[3];
+} Collider_Box;
+
+// A capsule centered at the origin of the entity and aligned with its Y axis.
+// 'half_height' is half the distance between the centers of the two hemispheres.
+typedef struct {
+	r64 radius;
+	r64 half_height;
+	vec3 center;
+	vec3 axis;
+} Collider_Capsule;
+
+// A cylinder centered at the origin of the entity and aligned with its Y axis.
+typedef struct {
+	r64 radius;
+	r64 half_height;
+	vec3 center;
+	vec3 axis;
+} Collider_Cylinder;
+
 typedef enum {
 	COLLIDER_TYPE_SPHERE,
-	COLLIDER_TYPE_CONVEX_HULL
+	COLLIDER_TYPE_CONVEX_HULL,
+	COLLIDER_TYPE_BOX,
+	COLLIDER_TYPE_CAPSULE,
+	COLLIDER_TYPE_CYLINDER
 } Collider_Type;
 
 typedef struct {
@@ -40,18 +126,51 @@ typedef struct {
 	union {
 		Collider_Convex_Hull convex_hull;
 		Collider_Sphere sphere;
+		Collider_Box box;
+		Collider_Capsule capsule;
+		Collider_Cylinder cylinder;
 	};
 } Collider;
 
 // @NOTE: for simplicity (and speed), we don't deal with scaling in the colliders.
 // therefore, if the object is scaled, the collider needs to be recreated (and the vertices should be already scaled when creating it)
-Collider collider_convex_hull_create(const vec3* vertices, const u32* indices);
+// 'points' is a light array with any cloud of points (e.g. the vertices of a render mesh), whose convex hull becomes the collider.
+// Coplanar faces are merged. If 'max_vertices' is not 0, the hull is simplified to have at most that many vertices.
+Collider collider_convex_hull_create(const vec3* points, u32 max_vertices);
+// Creates a shape with a single reference, owned by the caller. Shapes are not thread-safe, they must be created, retained
+// and released by a single thread.
+Collider_Convex_Hull_Shape* collider_convex_hull_shape_create(const vec3* points, u32 max_vertices);
+// The arrays of a shape are packed one after the other in a block of memory that starts at 'shape->vertices' and contains no
+// pointers, so the block can be written to a file as is (see cache.h).
+void collider_convex_hull_shape_get_layout(const Collider_Convex_Hull_Shape* shape, Collider_Convex_Hull_Shape_Layout* layout);
+u64 collider_convex_hull_shape_get_arrays_size(const Collider_Convex_Hull_Shape_Layout* layout);
+// Checks that the arrays of a block that comes from outside (e.g. a file) are consistent, so they can be used as indices: the
+// offsets of each adjacency list start at 0, never decrease and end at its number of items, and all vertex and face indices
+// are in range. The block must have the size given by 'collider_convex_hull_shape_get_arrays_size'.
+boolean collider_convex_hull_shape_are_arrays_valid(const Collider_Convex_Hull_Shape_Layout* layout, const void* arrays);
+// Creates a shape (with a single reference) on top of a block of arrays, e.g. one that was mapped from a file. The block must be
+// 8-byte aligned. It is used in place, not copied, so it must outlive the shape.
+Collider_Convex_Hull_Shape* collider_convex_hull_shape_create_from_arrays(const Collider_Convex_Hull_Shape_Layout* layout,
+	r64 bounding_radius, const Collider_Mass_Properties* mass_properties, const void* arrays);
+void collider_convex_hull_shape_retain(Collider_Convex_Hull_Shape* shape);
+void collider_convex_hull_shape_release(Collider_Convex_Hull_Shape* shape);
+// The collider takes a new reference to the shape, which is released by 'colliders_destroy'.
+Collider collider_convex_hull_create_from_shape(Collider_Convex_Hull_Shape* shape);
 Collider collider_sphere_create(const r32 radius);
+Collider collider_box_create(vec3 half_extents);
+Collider collider_capsule_create(r64 radius, r64 half_height);
+Collider collider_cylinder_create(r64 radius, r64 half_height);
+// Boxes don't store any topology. This fills 'view' with a convex hull representation of the box, so it can be tested against
+// generic convex hulls. The world space arrays of the view are allocated from 'arena', and it holds no reference to its shape.
+void collider_box_get_convex_hull_view(const Collider* box, Collider* view, Arena* arena);
 
 void colliders_update(Collider* colliders, vec3 translation, const Quaternion* rotation);
 void colliders_destroy(Collider* collider);
+// The inertia tensor about the origin of the entity, which is the point bodies rotate about. The mass is spread uniformly over
+// the volume of the colliders.
 mat3 colliders_get_default_inertia_tensor(Collider* colliders, r64 mass);
 r64 colliders_get_bounding_sphere_radius(const Collider* colliders);
-Collider_Contact* colliders_get_contacts(Collider* colliders1, Collider* colliders2);
+// Appends the contacts between the two colliders to 'contacts'.
+void collider_get_contacts(Collider* collider1, Collider* collider2, Collider_Contact** contacts);
 
 #endif
\ No newline at end of file
@@ -2,22 +2,14 @@
 #include <math.h>
 #include <assert.h>
 #include "core.h"
-#include "cube_and_ramp.h"
-#include "debug.h"
-#include "cube_storm.h"
-#include "seesaw.h"
-#include "spring.h"
-#include "brick_wall.h"
-#include "mirror_cube.h"
-#include "hinge_joints.h"
-#include "arm.h"
-#include "stack.h"
-#include "rott_pendulum.h"
-#include "triple_pendula.h"
-#include "spot_storm.h"
-#include "coin.h"
+#include "example_scenes.h"
 #include "menu.h"
 #include "imgui.h"
+#include "thread_pool.h"
+#include "arena.h"
+#include "cache.h"
+#include "sat.h"
+#include "physics_thread.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
@@ -32,6 +24,8 @@ static Example_Scene_Type selected_scene;
 // Used when fps is fixed
 static bool fix_fps = true;
 static int fps = 60;
+// When set, the scene is stepped by the physics thread at 'fps', and drawn with interpolated poses
+static bool simulate_on_thread = true;
 
 static int load_selected_scene() {
 	return example_scenes[selected_scene].init();
@@ -41,31 +35,43 @@ static void core_destroy_selected_scene() {
 	example_scenes[selected_scene].destroy();
 }
 
+// Called by the physics thread. The selected scene only changes while the thread is paused.
+static void step_selected_scene(r64 delta_time) {
+	example_scenes[selected_scene].update(delta_time);
+}
+
 int core_init() {
-	example_scenes[DEBUG_EXAMPLE_SCENE] = debug_example_scene;
-	example_scenes[CUBE_AND_RAMP_EXAMPLE_SCENE] = cube_and_ramp_example_scene;
-	example_scenes[CUBE_STORM_EXAMPLE_SCENE] = cube_storm_example_scene;
-	example_scenes[SEESAW_EXAMPLE_SCENE] = seesaw_example_scene;
-	example_scenes[SPRING_EXAMPLE_SCENE] = spring_example_scene;
-	example_scenes[BRICK_WALL_EXAMPLE_SCENE] = brick_wall_example_scene;
-	example_scenes[MIRROR_CUBE_EXAMPLE_SCENE] = mirror_cube_example_scene;
-	example_scenes[HINGE_JOINTS_EXAMPLE_SCENE] = hinge_joints_example_scene;
-	example_scenes[ARM_EXAMPLE_SCENE] = arm_example_scene;
-	example_scenes[STACK_EXAMPLE_SCENE] = stack_example_scene;
-	example_scenes[ROTT_PENDULUM_EXAMPLE_SCENE] = rott_pendulum_example_scene;
-	example_scenes[TRIPLE_PENDULA_EXAMPLE_SCENE] = triple_pendula_example_scene;
-	example_scenes[SPOT_STORM_EXAMPLE_SCENE] = spot_storm_example_scene;
-	example_scenes[COIN_EXAMPLE_SCENE] = coin_example_scene;
+	for (u32 i = 0; i < END_EXAMPLE_SCENE; ++i) {
+		example_scenes[i] = example_scenes_get((Example_Scene_Type)i);
+	}
+
+	thread_pool_init(0);
 
 	selected_scene = EXAMPLE_SCENE_INITIAL;
-	return load_selected_scene();
+	int result = load_selected_scene();
+	if (result == 0 && simulate_on_thread) {
+		physics_thread_start(step_selected_scene, 1.0 / fps);
+	}
+	return result;
 }
 
 void core_destroy() {
+	if (physics_thread_is_running()) {
+		physics_thread_stop();
+	}
 	core_destroy_selected_scene();
+	thread_pool_destroy();
+	arena_destroy_scratches();
+	sat_cache_destroy();
+	// After the scene, since its shapes may be using the cache
+	cache_destroy();
 }
 
 void core_update(r64 delta_time) {
+	if (physics_thread_is_running()) {
+		return;
+	}
+
 	if (fix_fps) {
 		fps = CLAMP(fps, FPS_MIN, FPS_MAX);
 		delta_time = 1.0 / fps;
@@ -107,12 +113,28 @@ void core_menu_render() {
     if (ImGui::Begin(MENU_TITLE, NULL, 0)) {
         ImGui::Text("Press [ESC] to open/close the menu");
 
-        ImGui::Checkbox("Fix timestep for FPS", &fix_fps);
-        if (fix_fps) {
-            ImGui::DragInt("FPS", &fps, 0.1f, FPS_MIN, FPS_MAX);
+        if (ImGui::Checkbox("Simulate on a separate thread", &simulate_on_thread)) {
+            if (simulate_on_thread) {
+                fps = CLAMP(fps, FPS_MIN, FPS_MAX);
+                physics_thread_start(step_selected_scene, 1.0 / fps);
+            } else {
+                physics_thread_stop();
+            }
+        }
+
+        if (simulate_on_thread) {
+            if (ImGui::DragInt("Steps per second", &fps, 0.1f, FPS_MIN, FPS_MAX)) {
+                fps = CLAMP(fps, FPS_MIN, FPS_MAX);
+                physics_thread_set_delta_time(1.0 / fps);
+            }
         } else {
-            ImGui::Text("Timestep will be calculated per frame");
-            ImGui::Text("Simulation might become a bit unstable.");
+            ImGui::Checkbox("Fix timestep for FPS", &fix_fps);
+            if (fix_fps) {
+                ImGui::DragInt("FPS", &fps, 0.1f, FPS_MIN, FPS_MAX);
+            } else {
+                ImGui::Text("Timestep will be calculated per frame");
+                ImGui::Text("Simulation might become a bit unstable.");
+            }
         }
 
         // left
@@ -143,9 +165,12 @@ void core_menu_render() {
 }
 
 void core_switch_scene(Example_Scene_Type scene) {
+	// Scenes create meshes when they load, so they are loaded here, with the physics thread waiting
+	physics_thread_pause();
 	core_destroy_selected_scene();
 	selected_scene = scene;
 	load_selected_scene();
+	physics_thread_resume();
 
 	// Force scene's camera to reset
 	extern GLFWwindow* main_window;
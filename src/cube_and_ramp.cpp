@@ -1,6 +1,5 @@
 #include "cube_and_ramp.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -13,10 +12,16 @@
 #include "pbd.h"
 #include "entity.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
 static eid cube_eid, ramp_eid;
+// Whether the push key is held. The physics thread pushes once per step while it is, so the force doesn't depend on how many
+// frames are drawn per step. 'cube_push_held' belongs to the physics thread and is set by a command whenever the key changes,
+// 'input_cube_push_held' is what the input sent last.
+static boolean cube_push_held;
+static boolean input_cube_push_held;
 static r32 static_friction_coefficient = 1.0;
 static r32 dynamic_friction_coefficient = 0.7;
 static r32 restitution_coefficient = 0.0;
@@ -45,6 +50,8 @@ int ex_cube_and_ramp_init() {
 	camera = create_camera();
 	// Create light
 	lights = examples_util_create_lights();
+	cube_push_held = false;
+	input_cube_push_held = false;
 	
 	Vertex* ramp_vertices;
 	u32* ramp_indices;
@@ -52,8 +59,8 @@ int ex_cube_and_ramp_init() {
 	Mesh ramp_mesh = graphics_mesh_create(ramp_vertices, ramp_indices);
 
 	vec3 ramp_scale = {2.0, 4.0, 10.0};
-	Collider* ramp_colliders = examples_util_create_single_convex_hull_collider_array(ramp_vertices, ramp_indices, ramp_scale);
-	ramp_eid = entity_create_fixed(ramp_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, -90.0),
+	Collider* ramp_colliders = examples_util_create_single_convex_hull_collider_array(ramp_vertices, ramp_scale);
+	ramp_eid = examples_util_create_fixed_entity(ramp_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, -90.0),
 		ramp_scale, {1.0, 1.0, 1.0, 1.0}, ramp_colliders, static_friction_coefficient, dynamic_friction_coefficient, restitution_coefficient);
 
 	Vertex* cube_vertices;
@@ -62,8 +69,8 @@ int ex_cube_and_ramp_init() {
 	Mesh cube_mesh = graphics_mesh_create(cube_vertices, cube_indices);
 
 	vec3 cube_scale = {1.0, 1.0, 1.0};
-	Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, cube_scale);
-	cube_eid = entity_create(cube_mesh, {-5.0, 4.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
+	Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_scale);
+	cube_eid = examples_util_create_entity(cube_mesh, {-5.0, 4.0, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
 		cube_scale, {0.8, 0.8, 1.0, 1.0}, 1.0, cube_colliders, static_friction_coefficient, dynamic_friction_coefficient, restitution_coefficient);
 
 	array_free(cube_vertices);
@@ -82,7 +89,7 @@ void ex_cube_and_ramp_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -90,6 +97,16 @@ void ex_cube_and_ramp_destroy() {
 	entity_module_destroy();
 }
 
+static void push_cube() {
+	Entity* cube_entity = entity_get_by_id(cube_eid);
+	entity_add_force(cube_entity, {0.0, 1.0, 0.0}, {10.0, 0.0, 0.0}, false);
+	entity_activate(cube_entity);
+}
+
+static void set_cube_push_held(void* data) {
+	cube_push_held = *(boolean*)data;
+}
+
 void ex_cube_and_ramp_update(r64 delta_time) {
 	Entity** entities = entity_get_all();
 
@@ -103,6 +120,10 @@ void ex_cube_and_ramp_update(r64 delta_time) {
 		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
 	}
 
+	if (cube_push_held) {
+		push_cube();
+	}
+
 	pbd_simulate(delta_time, entities, 20, 1, true);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
@@ -112,54 +133,44 @@ void ex_cube_and_ramp_update(r64 delta_time) {
 }
 
 void ex_cube_and_ramp_render() {
-	Entity** entities = entity_get_all();
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_cube_and_ramp_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
-	if (key_state[GLFW_KEY_P]) {
-		Entity* cube_entity = entity_get_by_id(cube_eid);
-		entity_add_force(cube_entity, {0.0, 1.0, 0.0}, {10.0, 0.0, 0.0}, false);
-		entity_activate(cube_entity);
+	if (key_state[KEY_P] != input_cube_push_held) {
+		input_cube_push_held = key_state[KEY_P];
+		physics_thread_push_command(set_cube_push_held, &input_cube_push_held, sizeof(input_cube_push_held));
 	}
 }
 
@@ -191,46 +202,58 @@ void ex_cube_and_ramp_window_resize_process(s32 width, s32 height) {
 	camera_force_matrix_recalculation(&camera);
 }
 
-void ex_cube_and_ramp_menu_update() {
+typedef struct {
+	r64 static_friction_coefficient;
+	r64 dynamic_friction_coefficient;
+	r64 restitution_coefficient;
+} Coefficients;
+
+static void set_coefficients(void* data) {
+	Coefficients* coefficients = (Coefficients*)data;
 	Entity* cube_entity = entity_get_by_id(cube_eid);
 	Entity* ramp_entity = entity_get_by_id(ramp_eid);
+	cube_entity->static_friction_coefficient = coefficients->static_friction_coefficient;
+	ramp_entity->static_friction_coefficient = coefficients->static_friction_coefficient;
+	cube_entity->dynamic_friction_coefficient = coefficients->dynamic_friction_coefficient;
+	ramp_entity->dynamic_friction_coefficient = coefficients->dynamic_friction_coefficient;
+	cube_entity->restitution_coefficient = coefficients->restitution_coefficient;
+	entity_activate(cube_entity);
+}
 
+void ex_cube_and_ramp_menu_update() {
 	ImGui::Text("Cube and Ramp");
 	ImGui::Separator();
 
+	boolean changed = false;
 	ImGui::TextWrapped("Tweak the friction coefficients to see how the cube slide on the ramp.");
 	ImGui::TextWrapped("Cube and ramp static friction coefficient:");
 	if (ImGui::SliderFloat("fs", &static_friction_coefficient, 0.0f, 1.0f, "%.3f")) {
 		// if static friction was set to be less than static friction, make sure they are the same (to be 'physically' more accurate)
 		if (dynamic_friction_coefficient > static_friction_coefficient) {
-			cube_entity->dynamic_friction_coefficient = (r64)static_friction_coefficient;
-			ramp_entity->dynamic_friction_coefficient = (r64)static_friction_coefficient;
-			dynamic_friction_coefficient = (r64)static_friction_coefficient;
+			dynamic_friction_coefficient = static_friction_coefficient;
 		}
-
-		cube_entity->static_friction_coefficient = (r64)static_friction_coefficient;
-		ramp_entity->static_friction_coefficient = (r64)static_friction_coefficient;
-		entity_activate(cube_entity);
+		changed = true;
 	}
 
 	ImGui::TextWrapped("Cube and ramp dynamic friction coefficient:");
 	if (ImGui::SliderFloat("fd", &dynamic_friction_coefficient, 0.0f, 1.0f, "%.3f")) {
 		// if dynamic friction was set to be greater than static friction, make sure they are the same (to be 'physically' more accurate)
 		if (dynamic_friction_coefficient > static_friction_coefficient) {
-			cube_entity->static_friction_coefficient = (r64)dynamic_friction_coefficient;
-			ramp_entity->static_friction_coefficient = (r64)dynamic_friction_coefficient;
-			static_friction_coefficient = (r64)dynamic_friction_coefficient;
+			static_friction_coefficient = dynamic_friction_coefficient;
 		}
-
-		cube_entity->dynamic_friction_coefficient = (r64)dynamic_friction_coefficient;
-		ramp_entity->dynamic_friction_coefficient = (r64)dynamic_friction_coefficient;
-		entity_activate(cube_entity);
+		changed = true;
 	}
 
 	ImGui::TextWrapped("Cube restitution coefficient:");
 	if (ImGui::SliderFloat("rc", &restitution_coefficient, 0.0f, 0.8f, "%.3f")) {
-		cube_entity->restitution_coefficient = (r64)restitution_coefficient;
-		entity_activate(cube_entity);
+		changed = true;
+	}
+
+	// The entities may be owned by the physics thread
+	if (changed) {
+		Coefficients coefficients = {(r64)static_friction_coefficient, (r64)dynamic_friction_coefficient,
+			(r64)restitution_coefficient};
+		physics_thread_push_command(set_coefficients, &coefficients, sizeof(coefficients));
 	}
 	ImGui::Separator();
 
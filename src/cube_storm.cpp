@@ -1,6 +1,5 @@
 #include "cube_storm.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -47,8 +46,8 @@ int ex_cube_storm_init() {
 	Mesh cube_mesh = graphics_mesh_create(cube_vertices, cube_indices);
 
 	vec3 floor_scale = {50.0, 1.0, 50.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, floor_scale);
-	entity_create_fixed(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_box_collider_array(floor_scale);
+	examples_util_create_fixed_entity(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, 0.0);
 
 	const u32 N = 3;
@@ -66,8 +65,8 @@ int ex_cube_storm_init() {
 				z += gap;
 
 				vec3 cube_scale = {1.0, 1.0, 1.0};
-				Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, cube_scale);
-				entity_create(cube_mesh, {x, y, z}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+				Collider* cube_colliders = examples_util_create_single_box_collider_array(cube_scale);
+				examples_util_create_entity(cube_mesh, {x, y, z}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 					cube_scale, util_pallete(i + j + k), 1.0, cube_colliders, 0.8, 0.8, 0.0);
 			}
 		}
@@ -87,7 +86,7 @@ void ex_cube_storm_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -119,54 +118,45 @@ void ex_cube_storm_update(r64 delta_time) {
 }
 
 void ex_cube_storm_render() {
-	Entity** entities = entity_get_all();
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_cube_storm_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
@@ -1,6 +1,5 @@
 #include "debug.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -14,6 +13,7 @@
 #include "entity.h"
 #include "util.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
@@ -58,8 +58,8 @@ int ex_debug_init() {
 	obj_parse("./res/floor.obj", &floor_vertices, &floor_indices);
 	Mesh floor_mesh = graphics_mesh_create(floor_vertices, floor_indices);
 	vec3 floor_scale = {1.0, 1.0, 1.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(floor_vertices, floor_indices, floor_scale);
-	entity_create_fixed(floor_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(floor_vertices, floor_scale);
+	examples_util_create_fixed_entity(floor_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, 0.0);
 	array_free(floor_vertices);
 	array_free(floor_indices);
@@ -75,7 +75,7 @@ void ex_debug_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -111,9 +111,8 @@ void ex_debug_update(r64 delta_time) {
 }
 
 void ex_debug_render() {
-	Entity** entities = entity_get_all();
-
 	#if 0
+	Entity** entities = entity_get_all();
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		for (u32 j = i + 1; j < array_length(entities); ++j) {
 			Entity* e1 = entities[i];
@@ -135,64 +134,57 @@ void ex_debug_render() {
 					graphics_renderer_debug_vector(cp2, gm_vec3_add(cp2, normal), {1.0, 1.0, 1.0, 1.0});
 				}
 
-				e1->color = {0.0, 1.0, 0.0, 1.0};
-				e2->color = {0.0, 1.0, 0.0, 1.0};
+				graphics_entity_render_data_get(e1->id)->color = {0.0, 1.0, 0.0, 1.0};
+				graphics_entity_render_data_get(e2->id)->color = {0.0, 1.0, 0.0, 1.0};
 			} else {
-				e1->color = {1.0, 0.0, 0.0, 1.0};
-				e2->color = {1.0, 0.0, 0.0, 1.0};
+				graphics_entity_render_data_get(e1->id)->color = {1.0, 0.0, 0.0, 1.0};
+				graphics_entity_render_data_get(e2->id)->color = {1.0, 0.0, 0.0, 1.0};
 			}
 		}
 	}
+	array_free(entities);
 	#endif
 
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_debug_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 30.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
 /*
-	if (key_state[GLFW_KEY_X])
+	if (key_state[KEY_X])
 	{
-		if (key_state[GLFW_KEY_LEFT_SHIFT] || key_state[GLFW_KEY_RIGHT_SHIFT])
+		if (key_state[KEY_LEFT_SHIFT] || key_state[KEY_RIGHT_SHIFT])
 		{
 			Quaternion rotation = quaternion_new({1.0f, 0.0f, 0.0f}, rotation_speed * delta_time);
 			entity_set_rotation(e, quaternion_product(&rotation, &e->world_rotation));
@@ -203,9 +195,9 @@ void ex_debug_input_process(boolean* key_state, r64 delta_time) {
 			entity_set_rotation(e, quaternion_product(&rotation, &e->world_rotation));
 		}
 	}
-	if (key_state[GLFW_KEY_Y])
+	if (key_state[KEY_Y])
 	{
-		if (key_state[GLFW_KEY_LEFT_SHIFT] || key_state[GLFW_KEY_RIGHT_SHIFT])
+		if (key_state[KEY_LEFT_SHIFT] || key_state[KEY_RIGHT_SHIFT])
 		{
 			Quaternion rotation = quaternion_new({0.0f, 1.0f, 0.0f}, rotation_speed * delta_time);
 			entity_set_rotation(e, quaternion_product(&rotation, &e->world_rotation));
@@ -216,9 +208,9 @@ void ex_debug_input_process(boolean* key_state, r64 delta_time) {
 			entity_set_rotation(e, quaternion_product(&rotation, &e->world_rotation));
 		}
 	}
-	if (key_state[GLFW_KEY_Z])
+	if (key_state[KEY_Z])
 	{
-		if (key_state[GLFW_KEY_LEFT_SHIFT] || key_state[GLFW_KEY_RIGHT_SHIFT])
+		if (key_state[KEY_LEFT_SHIFT] || key_state[KEY_RIGHT_SHIFT])
 		{
 			Quaternion rotation = quaternion_new({0.0f, 0.0f, 1.0f}, rotation_speed * delta_time);
 			entity_set_rotation(e, quaternion_product(&rotation, &e->world_rotation));
@@ -231,18 +223,25 @@ void ex_debug_input_process(boolean* key_state, r64 delta_time) {
 	}
 */
 
-	if (key_state[GLFW_KEY_1]) {
+	if (key_state[KEY_1]) {
 		is_mouse_bound_to_entity_movement = true;
 	} else {
 		is_mouse_bound_to_entity_movement = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
+static void move_target_entity(void* data) {
+	vec3* offset = (vec3*)data;
+	Entity** entities = entity_get_all();
+	entity_set_position(entities[1], gm_vec3_add(entities[1]->world_position, *offset));
+	array_free(entities);
+}
+
 void ex_debug_mouse_change_process(boolean reset, r64 x_pos, r64 y_pos) {
 	static r64 x_pos_old, y_pos_old;
 
@@ -263,12 +262,8 @@ void ex_debug_mouse_change_process(boolean reset, r64 x_pos, r64 y_pos) {
 		vec3 y_diff = gm_vec3_scalar_product(-target_point_move_speed * (r64)y_difference, camera_y);
 		vec3 x_diff = gm_vec3_scalar_product(target_point_move_speed * (r64)x_difference, camera_x);
 
-		Entity** entities = entity_get_all();
-		vec3 position = entities[1]->world_position;
-		position = gm_vec3_add(position, y_diff);
-		position = gm_vec3_add(position, x_diff);
-		entity_set_position(entities[1], position);
-		array_free(entities);
+		vec3 offset = gm_vec3_add(y_diff, x_diff);
+		physics_thread_push_command(move_target_entity, &offset, sizeof(offset));
 	} else {
 		// NORMAL CAMERA MOVEMENT!
 		static const r64 camera_mouse_speed = 0.1;
@@ -1,16 +1,17 @@
 #include "entity.h"
 #include "light_array.h"
-#include "glad/glad.h"
-#include "hash_map.h"
+#include "hash_table.h"
 #include "util.h"
+#include <atomic>
 
 Entity** entities;
-Hash_Map entities_map;
-eid eid_counter;
+Hash_Table<eid, Entity*> entities_map;
+// Atomic, since ids can be reserved by a thread other than the one that creates the entities
+static std::atomic<eid> eid_counter;
 
 void entity_module_init() {
 	entities = array_new(Entity*);
-	assert(hash_map_create(&entities_map, 1024, sizeof(eid), sizeof(Entity*), util_eid_compare, util_eid_hash) == 0);
+	hash_table_create(&entities_map, 1024);
 }
 
 void entity_module_destroy() {
@@ -18,18 +19,15 @@ void entity_module_destroy() {
 		entity_destroy(entities[i]);
 	}
 	array_free(entities);
-	hash_map_destroy(&entities_map);
+	hash_table_destroy(&entities_map);
 }
 
-static eid entity_create_ex(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, r64 mass, Collider* colliders,
+static eid entity_create_ex(eid id, vec3 world_position, Quaternion world_rotation, r64 mass, Collider* colliders,
 		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient, bool is_fixed) {
 	Entity* entity = (Entity*)malloc(sizeof(Entity));
-	entity->id = eid_counter++;
-	entity->mesh = mesh;
-	entity->color = color;
+	entity->id = id;
 	entity->world_position = world_position;
 	entity->world_rotation = world_rotation;
-	entity->world_scale = world_scale;
 	entity->angular_velocity = vec3{0.0, 0.0, 0.0};
 	entity->linear_velocity = vec3{0.0, 0.0, 0.0};
 	entity->previous_angular_velocity = vec3{0.0, 0.0, 0.0};
@@ -42,13 +40,17 @@ static eid entity_create_ex(Mesh mesh, vec3 world_position, Quaternion world_rot
 	} else {
 		entity->inverse_mass = 1.0 / mass;
 		entity->inertia_tensor = colliders_get_default_inertia_tensor(colliders, mass);
-		assert(gm_mat3_inverse(&entity->inertia_tensor, &entity->inverse_inertia_tensor));
+		// Not inside the assert, which is compiled out in release builds
+		boolean invertible = gm_mat3_inverse(&entity->inertia_tensor, &entity->inverse_inertia_tensor);
+		assert(invertible);
+		(void)invertible;
 	}
 	entity->forces = array_new(Physics_Force);
 	entity->fixed = is_fixed;
 	entity->active = true;
 	entity->deactivation_time = 0.0;
 	entity->colliders = colliders;
+	entity->colliders_bvh = colliders_bvh_create(colliders);
 	entity->static_friction_coefficient = static_friction_coefficient;
 	entity->dynamic_friction_coefficient = dynamic_friction_coefficient;
 	entity->restitution_coefficient = restitution_coefficient;
@@ -60,29 +62,36 @@ static eid entity_create_ex(Mesh mesh, vec3 world_position, Quaternion world_rot
 	}
 
 	array_push(entities, entity);
-	assert(!hash_map_put(&entities_map, &entity->id, &entity));
+	hash_table_put(&entities_map, entity->id, entity);
 	return entity->id;
 }
 
-eid entity_create(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, r64 mass, Collider* colliders,
+eid entity_create(vec3 world_position, Quaternion world_rotation, r64 mass, Collider* colliders,
 		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient) {
-	return entity_create_ex(mesh, world_position, world_rotation, world_scale, color, mass, colliders,
+	return entity_create_ex(entity_reserve_id(), world_position, world_rotation, mass, colliders,
 		static_friction_coefficient, dynamic_friction_coefficient, restitution_coefficient, false);
 }
 
-eid entity_create_fixed(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, Collider* colliders,
+eid entity_reserve_id() {
+	return eid_counter++;
+}
+
+eid entity_create_with_id(eid id, vec3 world_position, Quaternion world_rotation, r64 mass, Collider* colliders,
+		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient) {
+	assert(!entity_get_by_id(id));
+	return entity_create_ex(id, world_position, world_rotation, mass, colliders,
+		static_friction_coefficient, dynamic_friction_coefficient, restitution_coefficient, false);
+}
+
+eid entity_create_fixed(vec3 world_position, Quaternion world_rotation, Collider* colliders,
 		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient) {
-	return entity_create_ex(mesh, world_position, world_rotation, world_scale, color, 0.0, colliders,
+	return entity_create_ex(entity_reserve_id(), world_position, world_rotation, 0.0, colliders,
 		static_friction_coefficient, dynamic_friction_coefficient, restitution_coefficient, true);
 }
 
 Entity* entity_get_by_id(eid id) {
-	Entity* e;
-	if (hash_map_get(&entities_map, &id, &e)) {
-		return NULL;
-	}
-
-	return e;
+	Entity** e = hash_table_get(&entities_map, id);
+	return e ? *e : NULL;
 }
 
 Entity** entity_get_all() {
@@ -91,6 +100,7 @@ Entity** entity_get_all() {
 
 void entity_destroy(Entity* entity) {
 	array_free(entity->forces);
+	colliders_bvh_destroy(&entity->colliders_bvh);
 
 	// @TODO: avoid the need of this loop
 	for (u32 i = 0; i < array_length(entities); ++i) {
@@ -100,58 +110,11 @@ void entity_destroy(Entity* entity) {
 		}
 	}
 
-	assert(hash_map_delete(&entities_map, &entity->id) == 0);
+	boolean removed = hash_table_remove(&entities_map, entity->id);
+	assert(removed);
 	free(entity);
 }
 
-static mat4 entity_get_model_matrix_no_translation(const Entity* entity) {
-	r64 s, c;
-
-	mat4 scale_matrix = {
-		entity->world_scale.x, 0.0, 0.0, 0.0,
-		0.0, entity->world_scale.y, 0.0, 0.0,
-		0.0, 0.0, entity->world_scale.z, 0.0,
-		0.0, 0.0, 0.0, 1.0
-	};
-
-	mat4 rotation_matrix = quaternion_get_matrix(&entity->world_rotation);
-
-	mat4 model_matrix = gm_mat4_multiply(&rotation_matrix, &scale_matrix);
-	return model_matrix;
-}
-
-mat4 entity_get_model_matrix(const Entity* entity) {
-	r64 s, c;
-
-	mat4 scale_matrix =  {
-		entity->world_scale.x, 0.0, 0.0, 0.0,
-		0.0, entity->world_scale.y, 0.0, 0.0,
-		0.0, 0.0, entity->world_scale.z, 0.0,
-		0.0, 0.0, 0.0, 1.0
-	};
-
-	mat4 rotation_matrix = quaternion_get_matrix(&entity->world_rotation);
-
-	mat4 translation_matrix =  {
-		1.0, 0.0, 0.0, entity->world_position.x,
-		0.0, 1.0, 0.0, entity->world_position.y,
-		0.0, 0.0, 1.0, entity->world_position.z,
-		0.0, 0.0, 0.0, 1.0
-	};
-
-	mat4 model_matrix = gm_mat4_multiply(&rotation_matrix, &scale_matrix);
-	model_matrix = gm_mat4_multiply(&translation_matrix, &model_matrix);
-	return model_matrix;
-}
-
-void entity_mesh_replace(Entity* entity, Mesh mesh, boolean delete_normal_map) {
-	glDeleteBuffers(1, &entity->mesh.VBO);
-	glDeleteBuffers(1, &entity->mesh.EBO);
-	glDeleteVertexArrays(1, &entity->mesh.VAO);
-
-	entity->mesh = mesh;
-}
-
 void entity_set_position(Entity* entity, vec3 world_position) {
 	entity->world_position = world_position;
 }
@@ -160,10 +123,6 @@ void entity_set_rotation(Entity* entity, Quaternion world_rotation) {
 	entity->world_rotation = world_rotation;
 }
 
-void entity_set_scale(Entity* entity, vec3 world_scale) {
-	entity->world_scale = world_scale;
-}
-
 void entity_activate(Entity* entity) {
 	entity->active = true;
 	entity->deactivation_time = 0.0;
@@ -180,8 +139,7 @@ void entity_add_force(Entity* entity, vec3 position, vec3 force, boolean local_c
 		force = quaternion_apply_to_vec3(&entity->world_rotation, force);
 
 		// note that we don't need translation since we want to be centered at entity anyway
-		mat4 model_matrix = entity_get_model_matrix_no_translation(entity);
-		position = gm_mat4_multiply_vec3(&model_matrix, position, true);
+		position = quaternion_apply_to_vec3(&entity->world_rotation, position);
 	}
 
 	Physics_Force pf;
@@ -2,8 +2,8 @@
 #define RAW_PHYSICS_ENTITY_H
 
 #include "gm.h"
-#include "mesh.h"
 #include "collider.h"
+#include "bvh.h"
 #include "quaternion.h"
 
 typedef u64 eid;
@@ -17,14 +17,13 @@ typedef struct {
 typedef struct {
 	eid id;
 
-	Mesh mesh;
+	// Entities only hold simulation state. Whatever is needed to draw them is kept by the application (see graphics.h).
 	vec3 world_position;
 	Quaternion world_rotation;
-	vec3 world_scale;
-	vec4 color;
 
 	// Physics Related
 	Collider* colliders;
+	Colliders_BVH colliders_bvh;
 	r64 bounding_sphere_radius;
 	Physics_Force* forces;
 	r64 inverse_mass;
@@ -49,18 +48,20 @@ typedef struct {
 void entity_module_init();
 void entity_module_destroy();
 
-eid entity_create(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, r64 mass, Collider* colliders,
+eid entity_create(vec3 world_position, Quaternion world_rotation, r64 mass, Collider* colliders,
 		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient);
-eid entity_create_fixed(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, Collider* colliders,
+eid entity_create_fixed(vec3 world_position, Quaternion world_rotation, Collider* colliders,
+		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient);
+// Reserves the id of an entity that is created later with 'entity_create_with_id', e.g. by a command that runs on the physics
+// thread (see physics_thread.h), so that the caller can refer to the entity right away.
+eid entity_reserve_id();
+eid entity_create_with_id(eid id, vec3 world_position, Quaternion world_rotation, r64 mass, Collider* colliders,
 		r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient);
 Entity* entity_get_by_id(eid id);
 Entity** entity_get_all();
 void entity_destroy(Entity* entity);
-mat4 entity_get_model_matrix(const Entity* entity);
-void entity_mesh_replace(Entity* entity, Mesh mesh, boolean delete_normal_map);
 void entity_set_position(Entity* entity, vec3 world_position);
 void entity_set_rotation(Entity* entity, Quaternion world_rotation);
-void entity_set_scale(Entity* entity, vec3 world_scale);
 void entity_activate(Entity* entity);
 void entity_add_force(Entity* entity, vec3 position, vec3 force, boolean local_coords);
 void entity_clear_forces(Entity* entity);
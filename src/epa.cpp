@@ -1,238 +1,326 @@
 #include "epa.h"
-#include "light_array.h"
 #include <float.h>
+#include <atomic>
 #include "support.h"
+#include "profiler.h"
 
-static const r64 EPSILON = 0.0001;
-
-void polytope_from_gjk_simplex(const GJK_Simplex* s, vec3** _polytope, dvec3** _faces) {
-	assert(s->num == 4);
-	vec3* polytope = array_new_len(vec3, 4);
-	dvec3* faces = array_new_len(dvec3, 4);
-
-	array_push(polytope, s->a);
-	array_push(polytope, s->b);
-	array_push(polytope, s->c);
-	array_push(polytope, s->d);
-
-	dvec3 i1 = {0, 1, 2}; // ABC
-	dvec3 i2 = {0, 2, 3}; // ACD
-	dvec3 i3 = {0, 3, 1}; // ADB
-	dvec3 i4 = {1, 2, 3}; // BCD
-
-	array_push(faces, i1);
-	array_push(faces, i2);
-	array_push(faces, i3);
-	array_push(faces, i4);
-
-	*_polytope = polytope;
-	*_faces = faces;
-}
+#define EPA_MAX_ITERATIONS 100
+#define EPA_MAX_VERTICES (EPA_MAX_ITERATIONS + 4)
+#define EPA_MAX_FACES 512
+#define EPA_MAX_HORIZON_EDGES 128
+// Marks a horizon vertex that no new face starts at
+#define EPA_NO_FACE 0xFFFF
 
-void get_face_normal_and_distance_to_origin(dvec3 face, vec3* polytope, vec3* _normal, r64* _distance) {
-	vec3 a = polytope[face.x];
-	vec3 b = polytope[face.y];
-	vec3 c = polytope[face.z];
-
-	vec3 ab = gm_vec3_subtract(b, a);
-	vec3 ac = gm_vec3_subtract(c, a);
-	vec3 normal = gm_vec3_normalize(gm_vec3_cross(ab, ac));
-
-	assert(normal.x != 0.0 || normal.y != 0.0 || normal.z != 0.0);
-
-	// When this value is not 0, it is possible that the normals are not found even if the polytope is not degenerate
-	const r64 DISTANCE_TO_ORIGIN_TOLERANCE = 0.0000000000000;
-
-	// the distance from the face's *plane* to the origin (considering an infinite plane).
-	r64 distance = gm_vec3_dot(normal, a);
-	if (distance < -DISTANCE_TO_ORIGIN_TOLERANCE) {
-		// if the distance is less than 0, it means that our normal is point inwards instead of outwards
-		// in this case, we just invert both normal and distance
-		// this way, we don't need to worry about face's winding
-		normal = gm_vec3_invert(normal);
-		distance = -distance;
-	} else if (distance >= -DISTANCE_TO_ORIGIN_TOLERANCE && distance <= DISTANCE_TO_ORIGIN_TOLERANCE) {
-		// if the distance is exactly 0.0, then it means that the origin is lying exactly on the face.
-		// in this case, we can't directly infer the orientation of the normal.
-		// since our shape is convex, we analyze the other vertices of the hull to deduce the orientation
-		boolean was_able_to_calculate_normal = false;
-		for (u32 i = 0; i < array_length(polytope); ++i) {
-			vec3 current = polytope[i];
-			r64 auxiliar_distance = gm_vec3_dot(normal, current);
-			if (auxiliar_distance < -DISTANCE_TO_ORIGIN_TOLERANCE || auxiliar_distance > DISTANCE_TO_ORIGIN_TOLERANCE) {
-				// since the shape is convex, the other vertices should always be "behind" the normal plane
-				normal = auxiliar_distance < -DISTANCE_TO_ORIGIN_TOLERANCE ? normal : gm_vec3_invert(normal);
-				was_able_to_calculate_normal = true;
-				break;
-			}
+static const r64 EPSILON = 0.0001;
+static const r64 DEGENERATE_FACE_EPSILON = 1e-20;
+
+// A triangular face of the polytope.
+// Vertices are stored counter-clockwise when looking at the face from outside the polytope, i.e., the normal points outwards.
+// Edge i goes from vertices[i] to vertices[(i + 1) % 3]. 'neighbors[i]' is the face that shares edge i and 'neighbor_edges[i]'
+// is the index of that same edge inside the neighbor face.
+typedef struct {
+	vec3 normal;
+	r64 distance;
+	u16 vertices[3];
+	u16 neighbors[3];
+	u8 neighbor_edges[3];
+	boolean obsolete;
+} Epa_Face;
+
+typedef struct {
+	u16 face;
+	u8 edge;
+} Epa_Edge;
+
+// All the memory used by EPA. It lives in thread-local storage, so EPA never touches the heap.
+typedef struct {
+	vec3 vertices[EPA_MAX_VERTICES];
+	u32 num_vertices;
+
+	Epa_Face faces[EPA_MAX_FACES];
+	u32 num_faces;
+
+	// Binary min-heap of face indices, ordered by distance to the origin.
+	// Faces that become obsolete are not removed from the heap, they are just skipped when popped.
+	u16 heap[EPA_MAX_FACES];
+	u32 heap_size;
+
+	Epa_Edge horizon[EPA_MAX_HORIZON_EDGES];
+	u32 num_horizon_edges;
+	boolean horizon_overflow;
+} Epa_Scratch;
+
+static thread_local Epa_Scratch scratch;
+// EPA runs in parallel during the narrowphase, so the statistics are updated atomically.
+static std::atomic<u32> num_calls;
+static std::atomic<u32> num_iterations;
+static std::atomic<u32> num_failures;
+
+static void heap_push(Epa_Scratch* s, u16 face_idx) {
+	u32 i = s->heap_size++;
+	r64 distance = s->faces[face_idx].distance;
+	while (i > 0) {
+		u32 parent = (i - 1) / 2;
+		if (s->faces[s->heap[parent]].distance <= distance) {
+			break;
 		}
-
-		// If we were not able to calculate the normal, it means that ALL points of the polytope are in the same plane
-		// Therefore, we either have a degenerate polytope or our tolerance is not big enough
-		assert(was_able_to_calculate_normal);
+		s->heap[i] = s->heap[parent];
+		i = parent;
 	}
-
-	*_normal = normal;
-	*_distance = distance;
+	s->heap[i] = face_idx;
 }
 
-void add_edge(dvec2** edges, dvec2 edge, vec3* polytope) {
-	// @TODO: we can use a hash table here
-	for (u32 i = 0; i < array_length(*edges); ++i) {
-		dvec2 current = (*edges)[i];
-		if (edge.x == current.x && edge.y == current.y) {
-			array_remove(*edges, i);
-			return;
+static u16 heap_pop(Epa_Scratch* s) {
+	u16 result = s->heap[0];
+	u16 last = s->heap[--s->heap_size];
+	r64 distance = s->faces[last].distance;
+	u32 i = 0;
+	for (;;) {
+		u32 child = 2 * i + 1;
+		if (child >= s->heap_size) {
+			break;
 		}
-		if (edge.x == current.y && edge.y == current.x) {
-			array_remove(*edges, i);
-			return;
+		if (child + 1 < s->heap_size && s->faces[s->heap[child + 1]].distance < s->faces[s->heap[child]].distance) {
+			++child;
 		}
-
-		// @TEMPORARY: Once indexes point to unique vertices, this won't be needed.
-		vec3 current_v1 = polytope[current.x];
-		vec3 current_v2 = polytope[current.y];
-		vec3 edge_v1 = polytope[edge.x];
-		vec3 edge_v2 = polytope[edge.y];
-
-		if (gm_vec3_equal(current_v1, edge_v1) && gm_vec3_equal(current_v2, edge_v2)) {
-			array_remove(*edges, i);
-			return;
+		if (distance <= s->faces[s->heap[child]].distance) {
+			break;
 		}
+		s->heap[i] = s->heap[child];
+		i = child;
+	}
+	if (s->heap_size > 0) {
+		s->heap[i] = last;
+	}
+	return result;
+}
 
-		if (gm_vec3_equal(current_v1, edge_v2) && gm_vec3_equal(current_v2, edge_v1)) {
-			array_remove(*edges, i);
-			return;
-		}
+// Creates a new face and calculates its normal and distance to the origin.
+// Returns false if the face is degenerate or if we ran out of space.
+static boolean add_face(Epa_Scratch* s, u16 v0, u16 v1, u16 v2, u16* face_idx) {
+	if (s->num_faces == EPA_MAX_FACES) {
+		return false;
 	}
 
-	array_push(*edges, edge);
+	vec3 a = s->vertices[v0];
+	vec3 b = s->vertices[v1];
+	vec3 c = s->vertices[v2];
+	vec3 normal = gm_vec3_cross(gm_vec3_subtract(b, a), gm_vec3_subtract(c, a));
+	r64 length_sqd = gm_vec3_dot(normal, normal);
+	if (length_sqd < DEGENERATE_FACE_EPSILON) {
+		return false;
+	}
+
+	*face_idx = (u16)s->num_faces++;
+	Epa_Face* face = &s->faces[*face_idx];
+	face->normal = gm_vec3_scalar_product(1.0 / sqrt(length_sqd), normal);
+	// Since the origin is inside the polytope, this should never be negative (except for numerical errors)
+	face->distance = gm_vec3_dot(face->normal, a);
+	face->vertices[0] = v0;
+	face->vertices[1] = v1;
+	face->vertices[2] = v2;
+	face->obsolete = false;
+	return true;
 }
 
-static vec3 triangle_centroid(vec3 p1, vec3 p2, vec3 p3) {
-	vec3 centroid = gm_vec3_add(gm_vec3_add(p2, p3), p1);
-	centroid = gm_vec3_scalar_product(1.0 / 3.0, centroid);
-	return centroid;
+static void link_faces(Epa_Scratch* s, u16 f1, u8 e1, u16 f2, u8 e2) {
+	s->faces[f1].neighbors[e1] = f2;
+	s->faces[f1].neighbor_edges[e1] = e2;
+	s->faces[f2].neighbors[e2] = f1;
+	s->faces[f2].neighbor_edges[e2] = e1;
 }
 
-boolean epa(Collider* collider1, Collider* collider2, GJK_Simplex* simplex, vec3* _normal, r64* _penetration) {
-	vec3* polytope;
-	dvec3* faces;
+static boolean is_face_visible(const Epa_Face* face, vec3 point) {
+	return gm_vec3_dot(face->normal, point) - face->distance > 0.0;
+}
 
-	// build initial polytope from GJK simplex
-	polytope_from_gjk_simplex(simplex, &polytope, &faces);
+// Walks the faces that can be seen from 'point', marking them as obsolete, and collects the edges that separate visible faces
+// from the faces that are not visible (the horizon). 'edge' is the edge of 'face_idx' through which we arrived at this face.
+// Edges are collected in counter-clockwise order.
+static void collect_horizon(Epa_Scratch* s, u16 face_idx, u8 edge, vec3 point) {
+	Epa_Face* face = &s->faces[face_idx];
+	if (face->obsolete) {
+		return;
+	}
 
-	vec3* normals = array_new_len(vec3, 128);
-	r64* faces_distance_to_origin = array_new_len(r64, 128);
+	if (!is_face_visible(face, point)) {
+		if (s->num_horizon_edges == EPA_MAX_HORIZON_EDGES) {
+			s->horizon_overflow = true;
+			return;
+		}
+		Epa_Edge horizon_edge = {face_idx, edge};
+		s->horizon[s->num_horizon_edges++] = horizon_edge;
+		return;
+	}
 
-	vec3 min_normal;
-	r64 min_distance = DBL_MAX;
+	face->obsolete = true;
+	u8 next = (edge + 1) % 3;
+	u8 prev = (edge + 2) % 3;
+	collect_horizon(s, face->neighbors[next], face->neighbor_edges[next], point);
+	collect_horizon(s, face->neighbors[prev], face->neighbor_edges[prev], point);
+}
+
+// Builds the initial tetrahedron from the GJK simplex, with all faces pointing outwards.
+static boolean polytope_from_gjk_simplex(Epa_Scratch* s, const GJK_Simplex* simplex) {
+	assert(simplex->num == 4);
+
+	s->vertices[0] = simplex->a;
+	s->vertices[1] = simplex->b;
+	s->vertices[2] = simplex->c;
+	s->vertices[3] = simplex->d;
+	s->num_vertices = 4;
+	s->num_faces = 0;
+	s->heap_size = 0;
+
+	// Make sure that (0, 1, 2) is counter-clockwise when seen from outside, i.e., vertex 3 is behind it.
+	vec3 n = gm_vec3_cross(gm_vec3_subtract(s->vertices[1], s->vertices[0]), gm_vec3_subtract(s->vertices[2], s->vertices[0]));
+	if (gm_vec3_dot(n, gm_vec3_subtract(s->vertices[3], s->vertices[0])) > 0.0) {
+		vec3 tmp = s->vertices[1];
+		s->vertices[1] = s->vertices[2];
+		s->vertices[2] = tmp;
+	}
 
-	for (u32 i = 0; i < array_length(faces); ++i) {
-		vec3 normal;
-		r64 distance;
-		dvec3 face = faces[i];
+	u16 f0, f1, f2, f3;
+	if (!add_face(s, 0, 1, 2, &f0) ||
+		!add_face(s, 0, 3, 1, &f1) ||
+		!add_face(s, 0, 2, 3, &f2) ||
+		!add_face(s, 1, 3, 2, &f3)) {
+		// The simplex is degenerate
+		return false;
+	}
 
-		get_face_normal_and_distance_to_origin(face, polytope, &normal, &distance);
+	link_faces(s, f0, 0, f1, 2); // 0-1
+	link_faces(s, f0, 1, f3, 2); // 1-2
+	link_faces(s, f0, 2, f2, 0); // 2-0
+	link_faces(s, f1, 0, f2, 2); // 0-3
+	link_faces(s, f1, 1, f3, 0); // 3-1
+	link_faces(s, f2, 1, f3, 1); // 2-3
+
+	heap_push(s, f0);
+	heap_push(s, f1);
+	heap_push(s, f2);
+	heap_push(s, f3);
+	return true;
+}
 
-		array_push(normals, normal);
-		array_push(faces_distance_to_origin, distance);
+// Replaces the faces that are visible from the new vertex by a fan of faces connecting the horizon to the vertex.
+static boolean expand_polytope(Epa_Scratch* s, u16 visible_face_idx, u16 new_vertex_idx) {
+	vec3 point = s->vertices[new_vertex_idx];
+	Epa_Face* visible_face = &s->faces[visible_face_idx];
 
-		if (distance < min_distance) {
-			min_distance = distance;
-			min_normal = normal;
-		}
+	s->num_horizon_edges = 0;
+	s->horizon_overflow = false;
+	visible_face->obsolete = true;
+	for (u8 i = 0; i < 3; ++i) {
+		collect_horizon(s, visible_face->neighbors[i], visible_face->neighbor_edges[i], point);
 	}
 
-	dvec2* edges = array_new_len(dvec2, 1024);
-	boolean converged = false;
-	for (u32 it = 0; it < 100; ++it) {
-		vec3 support_point = support_point_of_minkowski_difference(collider1, collider2, min_normal);
+	if (s->horizon_overflow || s->num_horizon_edges < 3) {
+		return false;
+	}
 
-		// If the support time lies on the face currently set as the closest to the origin, we are done.
-		r64 d = gm_vec3_dot(min_normal, support_point);
-		if (fabs(d - min_distance) < EPSILON) {
-			*_normal = min_normal;
-			*_penetration = min_distance;
-			converged = true;
-			//printf("epa: took %d iterations to converge\n", it);
-			break;
+	// Maps a horizon vertex to the new face that starts at it, so the fan can be linked without searching.
+	u16 face_starting_at_vertex[EPA_MAX_VERTICES];
+	for (u32 i = 0; i < s->num_vertices; ++i) {
+		face_starting_at_vertex[i] = EPA_NO_FACE;
+	}
+	u16 first_new_face = (u16)s->num_faces;
+
+	for (u32 i = 0; i < s->num_horizon_edges; ++i) {
+		Epa_Edge horizon_edge = s->horizon[i];
+		const Epa_Face* hidden_face = &s->faces[horizon_edge.face];
+		// The new face traverses the horizon edge in the opposite direction of the hidden face.
+		u16 a = hidden_face->vertices[(horizon_edge.edge + 1) % 3];
+		u16 b = hidden_face->vertices[horizon_edge.edge];
+
+		u16 new_face_idx;
+		if (!add_face(s, a, b, new_vertex_idx, &new_face_idx)) {
+			return false;
 		}
 
-		// add new point to polytope
-		u32 new_point_index = array_length(polytope);
-		array_push(polytope, support_point);
+		link_faces(s, new_face_idx, 0, horizon_edge.face, horizon_edge.edge);
+		face_starting_at_vertex[a] = new_face_idx;
+	}
 
-		// Expand Polytope
-		for (u32 i = 0; i < array_length(normals); ++i) {
-			vec3 normal = normals[i];
-			dvec3 face = faces[i];
+	for (u16 i = first_new_face; i < s->num_faces; ++i) {
+		// Edge 1 goes from 'b' to the new vertex, and it is shared with the new face that starts at 'b'
+		u16 b = s->faces[i].vertices[1];
+		if (face_starting_at_vertex[b] == EPA_NO_FACE) {
+			// Rounding made the horizon something other than a single closed loop
+			return false;
+		}
+		link_faces(s, i, 1, face_starting_at_vertex[b], 2);
+	}
 
-			// If the face normal points towards the support point, we need to reconstruct it.
-			vec3 centroid = triangle_centroid(
-				polytope[face.x],
-				polytope[face.y],
-				polytope[face.z]
-			);
+	for (u16 i = first_new_face; i < s->num_faces; ++i) {
+		heap_push(s, i);
+	}
 
-			// If the face normal points towards the support point, we need to reconstruct it.
-			if (gm_vec3_dot(normal, gm_vec3_subtract(support_point, centroid)) > 0.0) {
-				dvec3 face = faces[i];
+	return true;
+}
 
-				dvec2 edge1 = {face.x, face.y};
-				dvec2 edge2 = {face.y, face.z};
-				dvec2 edge3 = {face.z, face.x};
+boolean epa(Collider* collider1, Collider* collider2, GJK_Simplex* simplex, vec3* _normal, r64* _penetration) {
+	PROFILE_SCOPE(PROFILE_PHASE_EPA);
+	Epa_Scratch* s = &scratch;
+	++num_calls;
 
-				add_edge(&edges, edge1, polytope);
-				add_edge(&edges, edge2, polytope);
-				add_edge(&edges, edge3, polytope);
+	if (!polytope_from_gjk_simplex(s, simplex)) {
+		++num_failures;
+		return false;
+	}
 
-				// Relative order between the two arrays should be kept.
-				array_remove(faces, i);
-				array_remove(faces_distance_to_origin, i);
-				array_remove(normals, i);
+	for (u32 it = 0; it < EPA_MAX_ITERATIONS; ++it) {
+		++num_iterations;
+		PROFILE_SCOPE_SET_ARG("iterations", it + 1);
 
-				--i;
+		// Get the face that is closest to the origin, ignoring faces that were already removed from the polytope.
+		u16 closest_face_idx;
+		do {
+			if (s->heap_size == 0) {
+				++num_failures;
+				return false;
 			}
-		}
+			closest_face_idx = heap_pop(s);
+		} while (s->faces[closest_face_idx].obsolete);
 
-		for (u32 i = 0; i < array_length(edges); ++i) {
-			dvec2 edge = edges[i];
-			dvec3 new_face;
-			new_face.x = edge.x;
-			new_face.y = edge.y;
-			new_face.z = new_point_index;
-			array_push(faces, new_face);
+		const Epa_Face* closest_face = &s->faces[closest_face_idx];
+		vec3 support_point = support_point_of_minkowski_difference(collider1, collider2, closest_face->normal);
 
-			vec3 new_face_normal;
-			r64 new_face_distance;
-			get_face_normal_and_distance_to_origin(new_face, polytope, &new_face_normal, &new_face_distance);
+		// If the support point lies on the face currently set as the closest to the origin, we are done.
+		r64 d = gm_vec3_dot(closest_face->normal, support_point);
+		boolean converged = d - closest_face->distance < EPSILON;
 
-			array_push(normals, new_face_normal);
-			array_push(faces_distance_to_origin, new_face_distance);
+		// If the support point is already part of the face, the polytope can't be expanded anymore.
+		for (u32 i = 0; !converged && i < 3; ++i) {
+			converged = gm_vec3_equal(support_point, s->vertices[closest_face->vertices[i]]);
 		}
 
-		min_distance = DBL_MAX;
-		for (u32 i = 0; i < array_length(faces_distance_to_origin); ++i) {
-			r64 distance = faces_distance_to_origin[i];
-			if (distance < min_distance) {
-				min_distance = distance;
-				min_normal = normals[i];
-			}
+		if (converged) {
+			*_normal = closest_face->normal;
+			*_penetration = closest_face->distance;
+			return true;
 		}
 
-		array_clear(edges);
+		u16 new_vertex_idx = (u16)s->num_vertices++;
+		s->vertices[new_vertex_idx] = support_point;
+
+		if (!expand_polytope(s, closest_face_idx, new_vertex_idx)) {
+			break;
+		}
 	}
 
-	array_free(faces);
-	array_free(polytope);
-	array_free(normals);
-	array_free(faces_distance_to_origin);
-	array_free(edges);
+	++num_failures;
+	return false;
+}
 
-	if (!converged) {
-		printf("EPA did not converge.\n");
-	}
+void epa_get_statistics(Epa_Statistics* statistics) {
+	statistics->num_calls = num_calls;
+	statistics->num_iterations = num_iterations;
+	statistics->num_failures = num_failures;
+}
 
-	return converged;
+void epa_reset_statistics() {
+	num_calls = 0;
+	num_iterations = 0;
+	num_failures = 0;
 }
\ No newline at end of file
@@ -5,6 +5,15 @@
 #include "gm.h"
 #include "gjk.h"
 
+typedef struct {
+	u32 num_calls;
+	u32 num_iterations;
+	// Number of times EPA did not converge (or the polytope became degenerate). In this case no contact is generated.
+	u32 num_failures;
+} Epa_Statistics;
+
 boolean epa(Collider* collider1, Collider* collider2, GJK_Simplex* simplex, vec3* normal, r64* penetration);
+void epa_get_statistics(Epa_Statistics* statistics);
+void epa_reset_statistics();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "example_scenes.h"
+#include <assert.h>
+#include "cube_and_ramp.h"
+#include "debug.h"
+#include "cube_storm.h"
+#include "seesaw.h"
+#include "spring.h"
+#include "brick_wall.h"
+#include "mirror_cube.h"
+#include "hinge_joints.h"
+#include "arm.h"
+#include "stack.h"
+#include "rott_pendulum.h"
+#include "triple_pendula.h"
+#include "spot_storm.h"
+#include "coin.h"
+
+Example_Scene example_scenes_get(Example_Scene_Type type) {
+	switch (type) {
+		case DEBUG_EXAMPLE_SCENE: return debug_example_scene;
+		case CUBE_AND_RAMP_EXAMPLE_SCENE: return cube_and_ramp_example_scene;
+		case CUBE_STORM_EXAMPLE_SCENE: return cube_storm_example_scene;
+		case SEESAW_EXAMPLE_SCENE: return seesaw_example_scene;
+		case SPRING_EXAMPLE_SCENE: return spring_example_scene;
+		case BRICK_WALL_EXAMPLE_SCENE: return brick_wall_example_scene;
+		case MIRROR_CUBE_EXAMPLE_SCENE: return mirror_cube_example_scene;
+		case HINGE_JOINTS_EXAMPLE_SCENE: return hinge_joints_example_scene;
+		case ARM_EXAMPLE_SCENE: return arm_example_scene;
+		case STACK_EXAMPLE_SCENE: return stack_example_scene;
+		case ROTT_PENDULUM_EXAMPLE_SCENE: return rott_pendulum_example_scene;
+		case TRIPLE_PENDULA_EXAMPLE_SCENE: return triple_pendula_example_scene;
+		case SPOT_STORM_EXAMPLE_SCENE: return spot_storm_example_scene;
+		case COIN_EXAMPLE_SCENE: return coin_example_scene;
+		default: break;
+	}
+
+	assert(0);
+	return debug_example_scene;
+}
@@ -0,0 +1,9 @@
+#ifndef RAW_PHYSICS_EXAMPLE_SCENES_H
+#define RAW_PHYSICS_EXAMPLE_SCENES_H
+
+#include "core.h"
+
+// All example scenes, so they can be loaded both by the samples app and by the benchmark.
+Example_Scene example_scenes_get(Example_Scene_Type type);
+
+#endif
@@ -1,23 +1,11 @@
 #include "examples_util.h"
 #include "light_array.h"
 #include "obj.h"
+#include "cache.h"
+#include "physics_thread.h"
 
-Collider* examples_util_create_single_convex_hull_collider_array(Vertex* vertices, u32* indices, vec3 scale) {
-	vec3* vertices_positions = array_new(vec3);
-	for (u32 i = 0; i < array_length(vertices); ++i) {
-		vec3 position = {
-			(r64)vertices[i].position.x,
-			(r64)vertices[i].position.y,
-			(r64)vertices[i].position.z
-		};
-		position.x *= scale.x;
-		position.y *= scale.y;
-		position.z *= scale.z;
-		array_push(vertices_positions, position);
-	}
-	Collider collider = collider_convex_hull_create(vertices_positions, indices);
-	array_free(vertices_positions);
-
+Collider* examples_util_create_single_convex_hull_collider_array(Vertex* vertices, vec3 scale) {
+	Collider collider = examples_util_create_convex_hull_collider(vertices, scale);
 	Collider* colliders = array_new(Collider);
 	array_push(colliders, collider);
 	return colliders;
@@ -31,7 +19,16 @@ Collider* examples_util_create_sphere_convex_hull_array(r32 radius) {
 	return colliders;
 }
 
-Collider examples_util_create_convex_hull_collider(Vertex* vertices, u32* indices, vec3 scale) {
+// The box matches 'cube.obj' scaled by 'half_extents'
+Collider* examples_util_create_single_box_collider_array(vec3 half_extents) {
+	Collider collider = collider_box_create(half_extents);
+	Collider* colliders = array_new(Collider);
+	array_push(colliders, collider);
+
+	return colliders;
+}
+
+Collider_Convex_Hull_Shape* examples_util_create_convex_hull_shape(Vertex* vertices, vec3 scale) {
 	vec3* vertices_positions = array_new(vec3);
 	for (u32 i = 0; i < array_length(vertices); ++i) {
 		vec3 position = {
@@ -44,11 +41,50 @@ Collider examples_util_create_convex_hull_collider(Vertex* vertices, u32* indice
 		position.z *= scale.z;
 		array_push(vertices_positions, position);
 	}
-	Collider collider = collider_convex_hull_create(vertices_positions, indices);
+	Collider_Convex_Hull_Shape* shape = cache_get_convex_hull_shape(vertices_positions, 0);
 	array_free(vertices_positions);
+	return shape;
+}
+
+Collider examples_util_create_convex_hull_collider(Vertex* vertices, vec3 scale) {
+	Collider_Convex_Hull_Shape* shape = examples_util_create_convex_hull_shape(vertices, scale);
+	Collider collider = collider_convex_hull_create_from_shape(shape);
+	collider_convex_hull_shape_release(shape);
 	return collider;
 }
 
+eid examples_util_create_entity(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, r64 mass,
+	Collider* colliders, r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient) {
+	eid id = entity_create(world_position, world_rotation, mass, colliders, static_friction_coefficient, dynamic_friction_coefficient,
+		restitution_coefficient);
+	graphics_entity_render_data_set(id, mesh, world_scale, color);
+	return id;
+}
+
+eid examples_util_create_fixed_entity(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color,
+	Collider* colliders, r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient) {
+	eid id = entity_create_fixed(world_position, world_rotation, colliders, static_friction_coefficient, dynamic_friction_coefficient,
+		restitution_coefficient);
+	graphics_entity_render_data_set(id, mesh, world_scale, color);
+	return id;
+}
+
+typedef struct {
+	eid id;
+	vec3 world_position;
+	Quaternion world_rotation;
+	Collider* colliders;
+	vec3 linear_velocity;
+} Thrown_Object;
+
+static void create_thrown_object(void* data) {
+	Thrown_Object* thrown_object = (Thrown_Object*)data;
+	entity_create_with_id(thrown_object->id, thrown_object->world_position, thrown_object->world_rotation, 1.0,
+		thrown_object->colliders, 0.8, 0.8, 0.0);
+	Entity* e = entity_get_by_id(thrown_object->id);
+	e->linear_velocity = thrown_object->linear_velocity;
+}
+
 void examples_util_throw_object(Perspective_Camera* camera, r64 velocity_norm) {
 	vec3 camera_z = camera_get_z_axis(camera);
 	vec3 camera_pos = camera->position;
@@ -59,7 +95,9 @@ void examples_util_throw_object(Perspective_Camera* camera, r64 velocity_norm) {
 	const char* mesh_name;
 	int r = rand();
 	int is_sphere = 0;
+	int is_box = 0;
 	if (r % 4 == 0) {
+		is_box = 1;
 		mesh_name = "./res/cube.obj";
 	} else if (r % 4 == 1) {
 		mesh_name = "./res/ico.obj";
@@ -80,18 +118,26 @@ void examples_util_throw_object(Perspective_Camera* camera, r64 velocity_norm) {
 		r64 radius = 1.0;
 		scale = {radius, radius, radius};
 		colliders = examples_util_create_sphere_convex_hull_array(radius);
+	} else if (is_box) {
+		scale = {1.0, 1.0, 1.0};
+		colliders = examples_util_create_single_box_collider_array(scale);
 	} else {
 		scale = {1.0, 1.0, 1.0};
-		colliders = examples_util_create_single_convex_hull_collider_array(vertices, indices, scale);
+		colliders = examples_util_create_single_convex_hull_collider_array(vertices, scale);
 	}
 
-	eid id = entity_create(m, entity_position, quaternion_new({0.35, 0.44, 0.12}, 0.0),
-		scale, {rand() / (r64)RAND_MAX, rand() / (r64)RAND_MAX, rand() / (r64)RAND_MAX, 1.0}, 1.0, colliders, 0.8, 0.8, 0.0);
+	// The mesh is created here, since it needs the OpenGL context, while the entity is created by the physics thread
+	Thrown_Object thrown_object;
+	thrown_object.id = entity_reserve_id();
+	thrown_object.world_position = entity_position;
+	thrown_object.world_rotation = quaternion_new({0.35, 0.44, 0.12}, 0.0);
+	thrown_object.colliders = colliders;
+	thrown_object.linear_velocity = gm_vec3_scalar_product(velocity_norm, gm_vec3_scalar_product(-1.0, camera_z));
+	graphics_entity_render_data_set(thrown_object.id, m, scale,
+		{rand() / (r64)RAND_MAX, rand() / (r64)RAND_MAX, rand() / (r64)RAND_MAX, 1.0});
+	physics_thread_push_command(create_thrown_object, &thrown_object, sizeof(thrown_object));
 	array_free(vertices);
 	array_free(indices);
-
-	Entity* e = entity_get_by_id(id);
-	e->linear_velocity = gm_vec3_scalar_product(velocity_norm, gm_vec3_scalar_product(-1.0, camera_z));
 }
 
 Light* examples_util_create_lights() {
@@ -106,4 +152,37 @@ Light* examples_util_create_lights() {
 	array_push(lights, light);
 
 	return lights;
+}
+
+Render_Transform* examples_util_get_render_transforms() {
+	Render_Transform* transforms = array_new(Render_Transform);
+
+	if (!physics_thread_is_running()) {
+		Entity** entities = entity_get_all();
+		for (u32 i = 0; i < array_length(entities); ++i) {
+			Render_Transform transform = {entities[i]->id, entities[i]->world_position, entities[i]->world_rotation};
+			array_push(transforms, transform);
+		}
+		array_free(entities);
+		return transforms;
+	}
+
+	const Physics_Snapshot* snapshot = physics_thread_acquire_snapshot();
+	r64 alpha = physics_snapshot_get_alpha(snapshot);
+	for (u32 i = 0; i < array_length(snapshot->bodies); ++i) {
+		const Physics_Body_Transform* body = &snapshot->bodies[i];
+		Render_Transform transform;
+		transform.id = body->id;
+		transform.world_position = gm_vec3_add(gm_vec3_scalar_product(1.0 - alpha, body->previous_world_position),
+			gm_vec3_scalar_product(alpha, body->world_position));
+		transform.world_rotation = quaternion_nlerp(&body->previous_world_rotation, &body->world_rotation, alpha);
+		array_push(transforms, transform);
+	}
+	return transforms;
+}
+
+void examples_util_render_entities(const Perspective_Camera* camera, const Light* lights) {
+	Render_Transform* transforms = examples_util_get_render_transforms();
+	graphics_transforms_render_phong_shader(camera, transforms, lights);
+	array_free(transforms);
 }
\ No newline at end of file
@@ -6,9 +6,23 @@
 #include "graphics.h"
 #include "collider.h"
 
-Collider* examples_util_create_single_convex_hull_collider_array(Vertex* vertices, u32* indices, vec3 scale);
-Collider examples_util_create_convex_hull_collider(Vertex* vertices, u32* indices, vec3 scale);
+Collider* examples_util_create_single_convex_hull_collider_array(Vertex* vertices, vec3 scale);
+Collider* examples_util_create_single_box_collider_array(vec3 half_extents);
+Collider examples_util_create_convex_hull_collider(Vertex* vertices, vec3 scale);
+// The shape is created with a single reference, owned by the caller.
+Collider_Convex_Hull_Shape* examples_util_create_convex_hull_shape(Vertex* vertices, vec3 scale);
+// Create the physics entity and register what is needed to draw it.
+eid examples_util_create_entity(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color, r64 mass,
+	Collider* colliders, r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient);
+eid examples_util_create_fixed_entity(Mesh mesh, vec3 world_position, Quaternion world_rotation, vec3 world_scale, vec4 color,
+	Collider* colliders, r64 static_friction_coefficient, r64 dynamic_friction_coefficient, r64 restitution_coefficient);
+// When the simulation runs on the physics thread, the entity is only created by the next step, but it can be drawn right away.
 void examples_util_throw_object(Perspective_Camera* camera, r64 velocity_norm);
 Light* examples_util_create_lights();
+// The poses to draw the entities with. When the simulation runs on the physics thread (see physics_thread.h), they are
+// interpolated between its last two steps, otherwise they are the entities themselves. Light array, freed by the caller.
+Render_Transform* examples_util_get_render_transforms();
+// Draws all entities with the poses of 'examples_util_get_render_transforms'
+void examples_util_render_entities(const Perspective_Camera* camera, const Light* lights);
 
 #endif
\ No newline at end of file
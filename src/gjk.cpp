@@ -2,7 +2,16 @@
 #include "light_array.h"
 #include <float.h>
 #include <math.h>
+#include <atomic>
 #include "support.h"
+#include "profiler.h"
+
+#define GJK_MAX_ITERATIONS 100
+
+// GJK runs in parallel during the narrowphase, so the statistics are updated atomically, once per call.
+static std::atomic<u32> num_calls;
+static std::atomic<u32> num_iterations;
+static std::atomic<u32> num_failures;
 
 static void add_to_simplex(GJK_Simplex* simplex, vec3 point) {
 	switch (simplex->num) {
@@ -348,18 +357,21 @@ static boolean do_simplex(GJK_Simplex* simplex, vec3* direction) {
 }
 
 boolean gjk_collides(Collider* collider1, Collider* collider2, GJK_Simplex* _simplex) {
+	PROFILE_SCOPE(PROFILE_PHASE_GJK);
 	GJK_Simplex simplex;
 
 	simplex.a = support_point_of_minkowski_difference(collider1, collider2, {0.0, 0.0, 1.0});
 	simplex.num = 1; 
 
 	vec3 direction = gm_vec3_scalar_product(-1.0, simplex.a);
+	++num_calls;
 
-	for (u32 i = 0; i < 100; ++i) {
+	for (u32 i = 0; i < GJK_MAX_ITERATIONS; ++i) {
 		vec3 next_point = support_point_of_minkowski_difference(collider1, collider2, direction);
 		
 		if (gm_vec3_dot(next_point, direction) < 0.0) {
 			// No intersection.
+			num_iterations += i + 1;
 			return false;
 		}
 
@@ -370,10 +382,222 @@ boolean gjk_collides(Collider* collider1, Collider* collider2, GJK_Simplex* _sim
 			if (_simplex) {
 				*_simplex = simplex;
 			}
+			num_iterations += i + 1;
 			return true;
 		}
 	}
 
 	//printf("GJK did not converge.\n");
+	num_iterations += GJK_MAX_ITERATIONS;
+	++num_failures;
 	return false;
 }
+
+void gjk_get_statistics(GJK_Statistics* statistics) {
+	statistics->num_calls = num_calls;
+	statistics->num_iterations = num_iterations;
+	statistics->num_failures = num_failures;
+}
+
+void gjk_reset_statistics() {
+	num_calls = 0;
+	num_iterations = 0;
+	num_failures = 0;
+}
+
+// Closest point to the origin on the segment 'points[0]'-'points[1]'.
+// The simplex is reduced to the vertices that support the closest point.
+static vec3 closest_point_to_origin_segment(vec3* points, u32* num_points) {
+	vec3 a = points[0];
+	vec3 b = points[1];
+	vec3 ab = gm_vec3_subtract(b, a);
+	r64 t = -gm_vec3_dot(a, ab);
+	if (t <= 0.0) {
+		*num_points = 1;
+		return a;
+	}
+
+	r64 ab_length_sqd = gm_vec3_dot(ab, ab);
+	if (t >= ab_length_sqd) {
+		points[0] = b;
+		*num_points = 1;
+		return b;
+	}
+
+	return gm_vec3_add(a, gm_vec3_scalar_product(t / ab_length_sqd, ab));
+}
+
+// Closest point to the origin on the triangle 'points[0]'-'points[1]'-'points[2]', by checking its Voronoi regions.
+// The simplex is reduced to the vertices that support the closest point.
+// Based on "Real-Time Collision Detection", Christer Ericson, Section 5.1.5
+static vec3 closest_point_to_origin_triangle(vec3* points, u32* num_points) {
+	vec3 a = points[0];
+	vec3 b = points[1];
+	vec3 c = points[2];
+	vec3 ab = gm_vec3_subtract(b, a);
+	vec3 ac = gm_vec3_subtract(c, a);
+
+	r64 d1 = -gm_vec3_dot(ab, a);
+	r64 d2 = -gm_vec3_dot(ac, a);
+	if (d1 <= 0.0 && d2 <= 0.0) {
+		// Vertex A region
+		*num_points = 1;
+		return a;
+	}
+
+	r64 d3 = -gm_vec3_dot(ab, b);
+	r64 d4 = -gm_vec3_dot(ac, b);
+	if (d3 >= 0.0 && d4 <= d3) {
+		// Vertex B region
+		points[0] = b;
+		*num_points = 1;
+		return b;
+	}
+
+	r64 vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+		// Edge AB region
+		*num_points = 2;
+		return gm_vec3_add(a, gm_vec3_scalar_product(d1 / (d1 - d3), ab));
+	}
+
+	r64 d5 = -gm_vec3_dot(ab, c);
+	r64 d6 = -gm_vec3_dot(ac, c);
+	if (d6 >= 0.0 && d5 <= d6) {
+		// Vertex C region
+		points[0] = c;
+		*num_points = 1;
+		return c;
+	}
+
+	r64 vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+		// Edge AC region
+		points[1] = c;
+		*num_points = 2;
+		return gm_vec3_add(a, gm_vec3_scalar_product(d2 / (d2 - d6), ac));
+	}
+
+	r64 va = d3 * d6 - d5 * d4;
+	if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+		// Edge BC region
+		points[0] = b;
+		points[1] = c;
+		*num_points = 2;
+		return gm_vec3_add(b, gm_vec3_scalar_product((d4 - d3) / ((d4 - d3) + (d5 - d6)), gm_vec3_subtract(c, b)));
+	}
+
+	// Face region
+	r64 denominator = 1.0 / (va + vb + vc);
+	r64 v = vb * denominator;
+	r64 w = vc * denominator;
+	return gm_vec3_add(a, gm_vec3_add(gm_vec3_scalar_product(v, ab), gm_vec3_scalar_product(w, ac)));
+}
+
+// Whether the origin and 'd' are on opposite sides of the plane of the triangle 'a'-'b'-'c'.
+static boolean is_origin_outside_of_plane(vec3 a, vec3 b, vec3 c, vec3 d) {
+	vec3 n = gm_vec3_cross(gm_vec3_subtract(b, a), gm_vec3_subtract(c, a));
+	r64 sign_origin = -gm_vec3_dot(a, n);
+	r64 sign_d = gm_vec3_dot(gm_vec3_subtract(d, a), n);
+	return sign_origin * sign_d < 0.0;
+}
+
+// Closest point to the origin on the tetrahedron 'points[0..3]'. If the origin is inside the tetrahedron, the origin is returned
+// and the simplex is kept. Otherwise, the simplex is reduced to the vertices that support the closest point.
+static vec3 closest_point_to_origin_tetrahedron(vec3* points, u32* num_points) {
+	const u32 faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+	vec3 closest_point = {0.0, 0.0, 0.0};
+	r64 min_distance_sqd = DBL_MAX;
+	vec3 best_points[3];
+	u32 best_num_points = 4;
+
+	for (u32 i = 0; i < 4; ++i) {
+		vec3 a = points[faces[i][0]];
+		vec3 b = points[faces[i][1]];
+		vec3 c = points[faces[i][2]];
+		vec3 d = points[faces[i][3]];
+		if (!is_origin_outside_of_plane(a, b, c, d)) {
+			continue;
+		}
+
+		vec3 face_points[3] = {a, b, c};
+		u32 face_num_points = 3;
+		vec3 q = closest_point_to_origin_triangle(face_points, &face_num_points);
+		r64 distance_sqd = gm_vec3_dot(q, q);
+		if (distance_sqd < min_distance_sqd) {
+			min_distance_sqd = distance_sqd;
+			closest_point = q;
+			best_num_points = face_num_points;
+			for (u32 j = 0; j < face_num_points; ++j) {
+				best_points[j] = face_points[j];
+			}
+		}
+	}
+
+	if (best_num_points < 4) {
+		for (u32 j = 0; j < best_num_points; ++j) {
+			points[j] = best_points[j];
+		}
+	}
+	*num_points = best_num_points;
+	return closest_point;
+}
+
+static vec3 closest_point_to_origin(vec3* points, u32* num_points) {
+	switch (*num_points) {
+		case 1: return points[0];
+		case 2: return closest_point_to_origin_segment(points, num_points);
+		case 3: return closest_point_to_origin_triangle(points, num_points);
+		case 4: return closest_point_to_origin_tetrahedron(points, num_points);
+	}
+
+	assert(0);
+	return points[0];
+}
+
+// Unlike gjk_collides, the simplex here always holds the vertices that support the point that is the closest to the origin,
+// since we need the distance and not only a yes/no answer.
+// Based on "Real-Time Collision Detection", Christer Ericson, Section 9.5
+boolean gjk_get_closest_point(Collider* collider, vec3 point, vec3* closest_point) {
+	const r64 RELATIVE_EPSILON = 1e-10;
+	const r64 ABSOLUTE_EPSILON = 1e-12;
+
+	// The points of the simplex are relative to 'point', so we look for the point of the shape that is closest to the origin.
+	vec3 points[4];
+	points[0] = gm_vec3_subtract(support_point(collider, {0.0, 0.0, 1.0}), point);
+	u32 num_points = 1;
+	vec3 v = points[0];
+
+	for (u32 i = 0; i < 64; ++i) {
+		r64 v_length_sqd = gm_vec3_dot(v, v);
+		if (v_length_sqd < ABSOLUTE_EPSILON) {
+			// The point is touching the shape
+			return false;
+		}
+
+		vec3 w = gm_vec3_subtract(support_point(collider, gm_vec3_invert(v)), point);
+		if (v_length_sqd - gm_vec3_dot(v, w) <= RELATIVE_EPSILON * v_length_sqd) {
+			// We can't get any closer to the origin
+			break;
+		}
+
+		boolean is_repeated = false;
+		for (u32 j = 0; j < num_points; ++j) {
+			is_repeated |= gm_vec3_equal(points[j], w);
+		}
+		if (is_repeated) {
+			break;
+		}
+
+		points[num_points++] = w;
+		v = closest_point_to_origin(points, &num_points);
+		if (num_points == 4) {
+			// The point is inside the shape
+			return false;
+		}
+	}
+
+	*closest_point = gm_vec3_add(point, v);
+	return true;
+}
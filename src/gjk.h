@@ -10,6 +10,19 @@ typedef struct {
 	u32 num;
 } GJK_Simplex;
 
+typedef struct {
+	u32 num_calls;
+	u32 num_iterations;
+	// Number of times GJK gave up after the maximum number of iterations. In this case no collision is reported.
+	u32 num_failures;
+} GJK_Statistics;
+
 boolean gjk_collides(Collider* collider1, Collider* collider2, GJK_Simplex* simplex);
+// Only 'gjk_collides' is counted.
+void gjk_get_statistics(GJK_Statistics* statistics);
+void gjk_reset_statistics();
+// Gets the point of the collider that is the closest to 'point'.
+// Returns false if 'point' is inside the collider, in which case 'closest_point' is not set.
+boolean gjk_get_closest_point(Collider* collider, vec3 point, vec3* closest_point);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,3 @@
+// The implementation of gm.h is part of the physics library, so programs that link it don't need to provide it.
+#define GRAPHICS_MATH_IMPLEMENT
+#include "gm.h"
@@ -5,13 +5,19 @@
 #include "stb_image.h"
 #include "stb_image_write.h"
 #include "light_array.h"
+#include "hash_table.h"
 #include <math.h>
+#include <stddef.h>
+#include <algorithm>
 #include "util.h"
 
 #define PHONG_VERTEX_SHADER_PATH "./shaders/phong_shader.vs"
 #define PHONG_FRAGMENT_SHADER_PATH "./shaders/phong_shader.fs"
 #define BASIC_VERTEX_SHADER_PATH "./shaders/basic_shader.vs"
 #define BASIC_FRAGMENT_SHADER_PATH "./shaders/basic_shader.fs"
+// Must match the size of the light array of the phong shader
+#define MAX_LIGHTS 16
+#define LIGHTS_BLOCK_BINDING 0
 
 Shader graphics_shader_create(const s8* vertex_shader_path, const s8* fragment_shader_path) {
 	s8* vertex_shader_code = util_read_file(vertex_shader_path, 0);
@@ -58,43 +64,105 @@ Shader graphics_shader_create(const s8* vertex_shader_path, const s8* fragment_s
 typedef struct {
 	Shader phong_shader;
 	Shader basic_shader;
+	// Uniform locations of the phong shader, which don't change once it is linked
+	GLint phong_camera_position_location;
+	GLint phong_shineness_location;
+	GLint phong_view_matrix_location;
+	GLint phong_projection_matrix_location;
 	boolean initialized;
 } Predefined_Shaders;
 
 Predefined_Shaders predefined_shaders;
 
+// The lights uniform block of the phong shader, in the std140 layout: vec3s take as much space as vec4s.
+typedef struct {
+	fvec4 position;
+	fvec4 ambient_color;
+	fvec4 diffuse_color;
+	fvec4 specular_color;
+} Light_Block_Entry;
+
+typedef struct {
+	Light_Block_Entry lights[MAX_LIGHTS];
+	s32 light_quantity;
+	s32 padding[3];
+} Light_Block;
+
+// What the phong shader needs per entity, streamed to the instance buffer every frame.
+typedef struct {
+	// Column-major, as attributes can't be transposed
+	r32 model_matrix[16];
+	fvec4 color;
+} Phong_Instance;
+
+typedef struct {
+	u32 vao;
+	u32 num_indices;
+	u32 transform_idx;
+} Phong_Draw;
+
+typedef struct {
+	u32 lights_ubo;
+	u32 instance_vbo;
+	u32 instance_vbo_capacity;
+	// Kept between frames, so that drawing doesn't allocate once they are big enough
+	Phong_Draw* draws;
+	Phong_Instance* instances;
+	Render_Transform* transforms;
+	boolean initialized;
+} Phong_Batch_Context;
+
+static Phong_Batch_Context phong_ctx;
+
 static void init_predefined_shaders() {
 	if (!predefined_shaders.initialized) {
 		predefined_shaders.phong_shader = graphics_shader_create(PHONG_VERTEX_SHADER_PATH, PHONG_FRAGMENT_SHADER_PATH);
 		predefined_shaders.basic_shader = graphics_shader_create(BASIC_VERTEX_SHADER_PATH, BASIC_FRAGMENT_SHADER_PATH);
+
+		Shader shader = predefined_shaders.phong_shader;
+		predefined_shaders.phong_camera_position_location = glGetUniformLocation(shader, "camera_position");
+		predefined_shaders.phong_shineness_location = glGetUniformLocation(shader, "object_shineness");
+		predefined_shaders.phong_view_matrix_location = glGetUniformLocation(shader, "view_matrix");
+		predefined_shaders.phong_projection_matrix_location = glGetUniformLocation(shader, "projection_matrix");
+		glUniformBlockBinding(shader, glGetUniformBlockIndex(shader, "Lights"), LIGHTS_BLOCK_BINDING);
 		predefined_shaders.initialized = true;
 	}
 }
 
-static s8* build_light_uniform_name(s8* buffer, s32 index, const s8* property) {
-	sprintf(buffer, "lights[%d].%s", index, property);
-	return buffer;
+static void init_phong_batch_context() {
+	if (phong_ctx.initialized) return;
+	phong_ctx.initialized = true;
+
+	glGenBuffers(1, &phong_ctx.lights_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, phong_ctx.lights_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Light_Block), 0, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, phong_ctx.lights_ubo);
+
+	glGenBuffers(1, &phong_ctx.instance_vbo);
+	phong_ctx.instance_vbo_capacity = 0;
+	phong_ctx.draws = array_new(Phong_Draw);
+	phong_ctx.instances = array_new(Phong_Instance);
+	phong_ctx.transforms = array_new(Render_Transform);
 }
 
-static void light_update_uniforms(const Light* lights, Shader shader) {
-	s32 number_of_lights = array_length(lights);
-	s8 buffer[64];
-	glUseProgram(shader);
+static fvec4 vec4_to_fvec4(vec4 v) {
+	return {(r32)v.x, (r32)v.y, (r32)v.z, (r32)v.w};
+}
 
-	for (s32 i = 0; i < number_of_lights; ++i) {
-		Light light = lights[i];
-		GLint light_position_location = glGetUniformLocation(shader, build_light_uniform_name(buffer, i, "position"));
-		GLint ambient_color_location = glGetUniformLocation(shader, build_light_uniform_name(buffer, i, "ambient_color"));
-		GLint diffuse_color_location = glGetUniformLocation(shader, build_light_uniform_name(buffer, i, "diffuse_color"));
-		GLint specular_color_location = glGetUniformLocation(shader, build_light_uniform_name(buffer, i, "specular_color"));
-		glUniform3f(light_position_location, (r32)light.position.x, (r32)light.position.y, (r32)light.position.z);
-		glUniform4f(ambient_color_location, (r32)light.ambient_color.x, (r32)light.ambient_color.y, (r32)light.ambient_color.z, (r32)light.ambient_color.w);
-		glUniform4f(diffuse_color_location, (r32)light.diffuse_color.x, (r32)light.diffuse_color.y, (r32)light.diffuse_color.z, (r32)light.diffuse_color.w);
-		glUniform4f(specular_color_location, (r32)light.specular_color.x, (r32)light.specular_color.y, (r32)light.specular_color.z, (r32)light.specular_color.w);
+static void lights_upload(const Light* lights) {
+	Light_Block block = {0};
+	block.light_quantity = MIN((s32)array_length(lights), MAX_LIGHTS);
+	for (s32 i = 0; i < block.light_quantity; ++i) {
+		block.lights[i].position = {(r32)lights[i].position.x, (r32)lights[i].position.y, (r32)lights[i].position.z, 1.0f};
+		block.lights[i].ambient_color = vec4_to_fvec4(lights[i].ambient_color);
+		block.lights[i].diffuse_color = vec4_to_fvec4(lights[i].diffuse_color);
+		block.lights[i].specular_color = vec4_to_fvec4(lights[i].specular_color);
 	}
 
-	GLint light_quantity_location = glGetUniformLocation(shader, "light_quantity");
-	glUniform1i(light_quantity_location, number_of_lights);
+	glBindBuffer(GL_UNIFORM_BUFFER, phong_ctx.lights_ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Light_Block), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 static void graphics_mesh_render(Shader shader, Mesh mesh) {
@@ -105,14 +173,60 @@ static void graphics_mesh_render(Shader shader, Mesh mesh) {
 	glBindVertexArray(0);
 }
 
+static Hash_Table<eid, Entity_Render_Data> entity_render_data;
+
+void graphics_entity_render_data_set(eid id, Mesh mesh, vec3 world_scale, vec4 color) {
+	if (!entity_render_data.control) {
+		hash_table_create(&entity_render_data, 1024);
+	}
+
+	Entity_Render_Data render_data;
+	render_data.mesh = mesh;
+	render_data.world_scale = world_scale;
+	render_data.color = color;
+	hash_table_put(&entity_render_data, id, render_data);
+}
+
+Entity_Render_Data* graphics_entity_render_data_get(eid id) {
+	if (!entity_render_data.control) {
+		return NULL;
+	}
+	return hash_table_get(&entity_render_data, id);
+}
+
+void graphics_entity_render_data_destroy(eid id) {
+	Entity_Render_Data* render_data = graphics_entity_render_data_get(id);
+	if (render_data) {
+		mesh_destroy(&render_data->mesh);
+		hash_table_remove(&entity_render_data, id);
+	}
+}
+
+static mat4 get_model_matrix(const Quaternion* world_rotation, vec3 world_position, const Entity_Render_Data* render_data) {
+	mat4 scale_matrix =  {
+		render_data->world_scale.x, 0.0, 0.0, 0.0,
+		0.0, render_data->world_scale.y, 0.0, 0.0,
+		0.0, 0.0, render_data->world_scale.z, 0.0,
+		0.0, 0.0, 0.0, 1.0
+	};
+
+	mat4 model_matrix = util_get_model_matrix_no_scale(world_rotation, world_position);
+	return gm_mat4_multiply(&model_matrix, &scale_matrix);
+}
+
 void graphics_entity_render_basic_shader(const Perspective_Camera* camera, const Entity* entity) {
+	const Entity_Render_Data* render_data = graphics_entity_render_data_get(entity->id);
+	if (!render_data) {
+		return;
+	}
+
 	init_predefined_shaders();
 	Shader shader = predefined_shaders.basic_shader;
 	glUseProgram(shader);
 	GLint model_matrix_location = glGetUniformLocation(shader, "model_matrix");
 	GLint view_matrix_location = glGetUniformLocation(shader, "view_matrix");
 	GLint projection_matrix_location = glGetUniformLocation(shader, "projection_matrix");
-	mat4 model_matrix = entity_get_model_matrix(entity);
+	mat4 model_matrix = get_model_matrix(&entity->world_rotation, entity->world_position, render_data);
 	r32 model[16], view[16], proj[16];
 	util_matrix_to_r32_array(&model_matrix, model);
 	util_matrix_to_r32_array(&camera->view_matrix, view);
@@ -120,36 +234,134 @@ void graphics_entity_render_basic_shader(const Perspective_Camera* camera, const
 	glUniformMatrix4fv(model_matrix_location, 1, GL_TRUE, (GLfloat*)model);
 	glUniformMatrix4fv(view_matrix_location, 1, GL_TRUE, (GLfloat*)view);
 	glUniformMatrix4fv(projection_matrix_location, 1, GL_TRUE, (GLfloat*)proj);
-	graphics_mesh_render(shader, entity->mesh);
+	graphics_mesh_render(shader, render_data->mesh);
 	glUseProgram(0);
 }
 
-void graphics_entity_render_phong_shader(const Perspective_Camera* camera, const Entity* entity, const Light* lights) {
+static boolean phong_draw_less(const Phong_Draw& d1, const Phong_Draw& d2) {
+	return d1.vao < d2.vao || (d1.vao == d2.vao && d1.transform_idx < d2.transform_idx);
+}
+
+// Points the instance attributes of the bound VAO at the instances starting at 'first_instance'. GL 3.3 has no base instance
+// for instanced draws, so each batch moves the attribute offsets instead.
+static void set_instance_attributes(u32 first_instance) {
+	uintptr_t offset = first_instance * sizeof(Phong_Instance);
+	for (u32 i = 0; i < 4; ++i) {
+		glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Phong_Instance),
+			(void*)(offset + offsetof(Phong_Instance, model_matrix) + i * 4 * sizeof(r32)));
+		glEnableVertexAttribArray(3 + i);
+		glVertexAttribDivisor(3 + i, 1);
+	}
+	glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(Phong_Instance), (void*)(offset + offsetof(Phong_Instance, color)));
+	glEnableVertexAttribArray(7);
+	glVertexAttribDivisor(7, 1);
+}
+
+static void render_phong_instances(const Perspective_Camera* camera, const Render_Transform* transforms, u32 num_transforms,
+	const Light* lights) {
 	init_predefined_shaders();
+	init_phong_batch_context();
+
+	// Entities are drawn grouped by mesh, in the order they were given within each mesh
+	array_clear(phong_ctx.draws);
+	for (u32 i = 0; i < num_transforms; ++i) {
+		const Entity_Render_Data* render_data = graphics_entity_render_data_get(transforms[i].id);
+		if (!render_data) {
+			continue;
+		}
+		Phong_Draw draw = {render_data->mesh.VAO, render_data->mesh.num_indices, i};
+		array_push(phong_ctx.draws, draw);
+	}
+
+	u32 num_draws = array_length(phong_ctx.draws);
+	if (num_draws == 0) {
+		return;
+	}
+	std::sort(phong_ctx.draws, phong_ctx.draws + num_draws, phong_draw_less);
+
+	array_clear(phong_ctx.instances);
+	for (u32 i = 0; i < num_draws; ++i) {
+		const Render_Transform* transform = &transforms[phong_ctx.draws[i].transform_idx];
+		const Entity_Render_Data* render_data = graphics_entity_render_data_get(transform->id);
+		mat4 model_matrix = get_model_matrix(&transform->world_rotation, transform->world_position, render_data);
+
+		Phong_Instance instance;
+		for (u32 column = 0; column < 4; ++column) {
+			for (u32 row = 0; row < 4; ++row) {
+				instance.model_matrix[column * 4 + row] = (r32)model_matrix.data[row][column];
+			}
+		}
+		instance.color = vec4_to_fvec4(render_data->color);
+		array_push(phong_ctx.instances, instance);
+	}
+
+	// Orphans the previous contents, so the driver doesn't wait for the draws of the last frame
+	glBindBuffer(GL_ARRAY_BUFFER, phong_ctx.instance_vbo);
+	phong_ctx.instance_vbo_capacity = MAX(phong_ctx.instance_vbo_capacity, num_draws);
+	glBufferData(GL_ARRAY_BUFFER, phong_ctx.instance_vbo_capacity * sizeof(Phong_Instance), 0, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, num_draws * sizeof(Phong_Instance), phong_ctx.instances);
+
+	lights_upload(lights);
+
 	Shader shader = predefined_shaders.phong_shader;
 	glUseProgram(shader);
-	light_update_uniforms(lights, shader);
-	GLint camera_position_location = glGetUniformLocation(shader, "camera_position");
-	GLint shineness_location = glGetUniformLocation(shader, "object_shineness");
-	GLint model_matrix_location = glGetUniformLocation(shader, "model_matrix");
-	GLint view_matrix_location = glGetUniformLocation(shader, "view_matrix");
-	GLint projection_matrix_location = glGetUniformLocation(shader, "projection_matrix");
-	glUniform3f(camera_position_location, (r32)camera->position.x, (r32)camera->position.y, (r32)camera->position.z);
-	glUniform1f(shineness_location, 128.0f);
-	mat4 model_matrix = entity_get_model_matrix(entity);
-	r32 model[16], view[16], proj[16];
-	util_matrix_to_r32_array(&model_matrix, model);
+	r32 view[16], proj[16];
 	util_matrix_to_r32_array(&camera->view_matrix, view);
 	util_matrix_to_r32_array(&camera->projection_matrix, proj);
-	glUniformMatrix4fv(model_matrix_location, 1, GL_TRUE, (GLfloat*)model);
-	glUniformMatrix4fv(view_matrix_location, 1, GL_TRUE, (GLfloat*)view);
-	glUniformMatrix4fv(projection_matrix_location, 1, GL_TRUE, (GLfloat*)proj);
-	GLint diffuse_color_location = glGetUniformLocation(shader, "color");
-	glUniform4f(diffuse_color_location, (r32)entity->color.x, (r32)entity->color.y, (r32)entity->color.z, (r32)entity->color.w);
-	graphics_mesh_render(shader, entity->mesh);
+	glUniform3f(predefined_shaders.phong_camera_position_location, (r32)camera->position.x, (r32)camera->position.y,
+		(r32)camera->position.z);
+	glUniform1f(predefined_shaders.phong_shineness_location, 128.0f);
+	glUniformMatrix4fv(predefined_shaders.phong_view_matrix_location, 1, GL_TRUE, (GLfloat*)view);
+	glUniformMatrix4fv(predefined_shaders.phong_projection_matrix_location, 1, GL_TRUE, (GLfloat*)proj);
+
+	// One draw call per mesh
+	u32 batch_begin = 0;
+	while (batch_begin < num_draws) {
+		u32 batch_end = batch_begin + 1;
+		while (batch_end < num_draws && phong_ctx.draws[batch_end].vao == phong_ctx.draws[batch_begin].vao) {
+			++batch_end;
+		}
+
+		glBindVertexArray(phong_ctx.draws[batch_begin].vao);
+		set_instance_attributes(batch_begin);
+		glDrawElementsInstanced(GL_TRIANGLES, phong_ctx.draws[batch_begin].num_indices, GL_UNSIGNED_INT, 0,
+			batch_end - batch_begin);
+		batch_begin = batch_end;
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glUseProgram(0);
 }
 
+static Render_Transform get_entity_transform(const Entity* entity) {
+	Render_Transform transform;
+	transform.id = entity->id;
+	transform.world_position = entity->world_position;
+	transform.world_rotation = entity->world_rotation;
+	return transform;
+}
+
+void graphics_entity_render_phong_shader(const Perspective_Camera* camera, const Entity* entity, const Light* lights) {
+	Render_Transform transform = get_entity_transform(entity);
+	render_phong_instances(camera, &transform, 1, lights);
+}
+
+void graphics_entities_render_phong_shader(const Perspective_Camera* camera, Entity** entities, const Light* lights) {
+	init_phong_batch_context();
+	array_clear(phong_ctx.transforms);
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		Render_Transform transform = get_entity_transform(entities[i]);
+		array_push(phong_ctx.transforms, transform);
+	}
+	render_phong_instances(camera, phong_ctx.transforms, array_length(phong_ctx.transforms), lights);
+}
+
+void graphics_transforms_render_phong_shader(const Perspective_Camera* camera, const Render_Transform* transforms,
+	const Light* lights) {
+	render_phong_instances(camera, transforms, array_length(transforms), lights);
+}
+
 void graphics_light_create(Light* light, vec3 position, vec4 ambient_color, vec4 diffuse_color, vec4 specular_color) {
 	light->position = position;
 	light->ambient_color = ambient_color;
@@ -293,6 +505,10 @@ void graphics_renderer_debug_points(vec3* points, int point_count, vec4 color) {
 	primitives_ctx.point_count += point_count;
 }
 
+void graphics_set_wireframe(boolean wireframe) {
+	glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+}
+
 void graphics_renderer_debug_vector(vec3 p1, vec3 p2, vec4 color) {
 	graphics_renderer_primitives_init();
 	setup_primitives_render();
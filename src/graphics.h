@@ -15,10 +15,36 @@ typedef struct {
 	vec4 specular_color;
 } Light;
 
+// Entities only hold simulation state, what is needed to draw them is kept here, keyed by the entity id.
+// The mesh is transformed by the scale first, then by the rotation and position of the entity.
+typedef struct {
+	Mesh mesh;
+	vec3 world_scale;
+	vec4 color;
+} Entity_Render_Data;
+
+// The pose to draw an entity with, which can differ from the entity itself, e.g. when interpolating between simulation steps
+typedef struct {
+	eid id;
+	vec3 world_position;
+	Quaternion world_rotation;
+} Render_Transform;
+
 Shader graphics_shader_create(const s8* vertex_shader_path, const s8* fragment_shader_path);
+void graphics_entity_render_data_set(eid id, Mesh mesh, vec3 world_scale, vec4 color);
+Entity_Render_Data* graphics_entity_render_data_get(eid id);
+// Destroys the mesh of the entity and forgets its render data.
+void graphics_entity_render_data_destroy(eid id);
 void graphics_entity_render_basic_shader(const Perspective_Camera* camera, const Entity* entity);
 void graphics_entity_render_phong_shader(const Perspective_Camera* camera, const Entity* entity, const Light* lights);
+// Draws all entities that have render data with one instanced draw call per mesh. 'entities' is a light array.
+void graphics_entities_render_phong_shader(const Perspective_Camera* camera, Entity** entities, const Light* lights);
+// Same as above, for entities drawn with the given poses. 'transforms' is a light array.
+void graphics_transforms_render_phong_shader(const Perspective_Camera* camera, const Render_Transform* transforms,
+	const Light* lights);
 void graphics_light_create(Light* light, vec3 position, vec4 ambient_color, vec4 diffuse_color, vec4 specular_color);
+// Draws only the edges of the triangles from now on, or fills them again.
+void graphics_set_wireframe(boolean wireframe);
 
 // Render primitives
 void graphics_renderer_primitives_flush(const Perspective_Camera* camera);
@@ -0,0 +1,215 @@
+#ifndef RAW_PHYSICS_HASH_TABLE_H
+#define RAW_PHYSICS_HASH_TABLE_H
+#include "common.h"
+#include "gm.h"
+#include "arena.h"
+#include "memory_tracker.h"
+#include <string.h>
+#include <assert.h>
+
+// An open-addressing hash table with linear probing, specialized at compile time for the key and value types, so hashing
+// and comparing keys are inlined instead of going through function pointers.
+//
+// Each slot has a control byte, stored contiguously apart from keys and values: 0 if the slot is empty, otherwise the top
+// 7 bits of the key hash with the high bit set. Probing walks the control bytes and only compares keys when the tag matches.
+// Removing shifts the following elements of the cluster back, so there are no tombstones.
+//
+// Keys need 'hash_table_hash' and 'hash_table_equals' overloads. The table can live in an arena, in which case memory is
+// never freed, only reclaimed when the arena is reset.
+
+#define HASH_TABLE_EMPTY 0
+#define HASH_TABLE_MIN_SLOTS 16
+
+template <typename K, typename V>
+struct Hash_Table {
+	u8* control;
+	K* keys;
+	V* values;
+	// Always a power of two
+	u32 num_slots;
+	u32 num_elements;
+	// NULL if the table lives in the heap
+	Arena* arena;
+};
+
+static inline u64 hash_table_hash(u64 key) {
+	// splitmix64 finalizer, entity ids are sequential so they need a good mix
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+	return key;
+}
+
+static inline u64 hash_table_hash(u32 key) {
+	return hash_table_hash((u64)key);
+}
+
+static inline u64 hash_table_hash(vec3 key) {
+	// Adding 0.0 turns -0.0 into 0.0, since they compare equal
+	r64 coords[3] = {key.x + 0.0, key.y + 0.0, key.z + 0.0};
+	u64 bits[3];
+	memcpy(bits, coords, sizeof(bits));
+	return hash_table_hash(bits[0] ^ hash_table_hash(bits[1] ^ hash_table_hash(bits[2])));
+}
+
+static inline boolean hash_table_equals(u64 key1, u64 key2) {
+	return key1 == key2;
+}
+
+static inline boolean hash_table_equals(u32 key1, u32 key2) {
+	return key1 == key2;
+}
+
+static inline boolean hash_table_equals(vec3 key1, vec3 key2) {
+	return key1.x == key2.x && key1.y == key2.y && key1.z == key2.z;
+}
+
+static inline u8 hash_table_get_tag(u64 hash) {
+	return (u8)(0x80 | (hash >> 57));
+}
+
+template <typename K, typename V>
+static void hash_table_allocate(Hash_Table<K, V>* table, u32 num_slots) {
+	u64 keys_offset = (num_slots + alignof(K) - 1) & ~((u64)alignof(K) - 1);
+	u64 values_offset = (keys_offset + num_slots * sizeof(K) + alignof(V) - 1) & ~((u64)alignof(V) - 1);
+	u64 size = values_offset + num_slots * sizeof(V);
+
+	u8* memory = table->arena ? (u8*)arena_allocate(table->arena, size) : (u8*)memory_tracker_calloc(1, size);
+	table->control = memory;
+	table->keys = (K*)(memory + keys_offset);
+	table->values = (V*)(memory + values_offset);
+	table->num_slots = num_slots;
+	table->num_elements = 0;
+}
+
+template <typename K, typename V>
+static void hash_table_release(Hash_Table<K, V>* table) {
+	if (!table->arena) {
+		memory_tracker_free(table->control);
+	}
+}
+
+// Creates a table that can hold 'capacity' elements without growing. If 'arena' is not NULL, the table lives in the arena.
+template <typename K, typename V>
+static void hash_table_create(Hash_Table<K, V>* table, u32 capacity, Arena* arena = NULL) {
+	u32 num_slots = HASH_TABLE_MIN_SLOTS;
+	// The load factor is kept at 1/2 at most, so clusters stay short
+	while (num_slots < 2 * capacity) {
+		num_slots <<= 1;
+	}
+
+	table->arena = arena;
+	hash_table_allocate(table, num_slots);
+}
+
+template <typename K, typename V>
+static void hash_table_destroy(Hash_Table<K, V>* table) {
+	hash_table_release(table);
+	table->control = NULL;
+	table->keys = NULL;
+	table->values = NULL;
+	table->num_slots = 0;
+	table->num_elements = 0;
+}
+
+// Removes all elements, keeping the memory.
+template <typename K, typename V>
+static void hash_table_clear(Hash_Table<K, V>* table) {
+	memset(table->control, HASH_TABLE_EMPTY, table->num_slots);
+	table->num_elements = 0;
+}
+
+// Finds the slot of 'key', or the empty slot where it would be inserted.
+template <typename K, typename V>
+static inline u32 hash_table_find_slot(const Hash_Table<K, V>* table, K key, u64 hash) {
+	u32 mask = table->num_slots - 1;
+	u8 tag = hash_table_get_tag(hash);
+	u32 slot = (u32)hash & mask;
+	for (;;) {
+		u8 control = table->control[slot];
+		if (control == HASH_TABLE_EMPTY || (control == tag && hash_table_equals(table->keys[slot], key))) {
+			return slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+template <typename K, typename V>
+static void hash_table_put(Hash_Table<K, V>* table, K key, V value);
+
+// Makes sure the table can hold 'capacity' elements without growing.
+template <typename K, typename V>
+static void hash_table_reserve(Hash_Table<K, V>* table, u32 capacity) {
+	if (2 * capacity <= table->num_slots) {
+		return;
+	}
+
+	Hash_Table<K, V> old_table = *table;
+	hash_table_create(table, capacity, old_table.arena);
+	for (u32 i = 0; i < old_table.num_slots; ++i) {
+		if (old_table.control[i] != HASH_TABLE_EMPTY) {
+			hash_table_put(table, old_table.keys[i], old_table.values[i]);
+		}
+	}
+	hash_table_release(&old_table);
+}
+
+// Returns a pointer to the value of 'key', or NULL if the key is not in the table.
+// The pointer is valid until the table is modified.
+template <typename K, typename V>
+static inline V* hash_table_get(const Hash_Table<K, V>* table, K key) {
+	u32 slot = hash_table_find_slot(table, key, hash_table_hash(key));
+	if (table->control[slot] == HASH_TABLE_EMPTY) {
+		return NULL;
+	}
+	return &table->values[slot];
+}
+
+// Inserts 'key', or replaces its value if it is already in the table.
+template <typename K, typename V>
+static void hash_table_put(Hash_Table<K, V>* table, K key, V value) {
+	if (2 * (table->num_elements + 1) > table->num_slots) {
+		hash_table_reserve(table, 2 * (table->num_elements + 1));
+	}
+
+	u64 hash = hash_table_hash(key);
+	u32 slot = hash_table_find_slot(table, key, hash);
+	if (table->control[slot] == HASH_TABLE_EMPTY) {
+		table->control[slot] = hash_table_get_tag(hash);
+		table->keys[slot] = key;
+		++table->num_elements;
+	}
+	table->values[slot] = value;
+}
+
+// Returns false if the key was not in the table.
+template <typename K, typename V>
+static boolean hash_table_remove(Hash_Table<K, V>* table, K key) {
+	u32 mask = table->num_slots - 1;
+	u32 slot = hash_table_find_slot(table, key, hash_table_hash(key));
+	if (table->control[slot] == HASH_TABLE_EMPTY) {
+		return false;
+	}
+
+	// Move back the elements after the removed one that can't be found anymore, until the end of the cluster
+	u32 gap = slot;
+	for (u32 next = (gap + 1) & mask; table->control[next] != HASH_TABLE_EMPTY; next = (next + 1) & mask) {
+		u32 home = (u32)hash_table_hash(table->keys[next]) & mask;
+		// The element can fill the gap if its home slot is not cyclically in (gap, next]
+		boolean home_after_gap = gap <= next ? (home > gap && home <= next) : (home > gap || home <= next);
+		if (!home_after_gap) {
+			table->control[gap] = table->control[next];
+			table->keys[gap] = table->keys[next];
+			table->values[gap] = table->values[next];
+			gap = next;
+		}
+	}
+
+	table->control[gap] = HASH_TABLE_EMPTY;
+	--table->num_elements;
+	return true;
+}
+
+#endif
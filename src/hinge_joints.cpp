@@ -1,6 +1,5 @@
 #include "hinge_joints.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -43,13 +42,13 @@ static Constraint create_lever(vec3 lever_position, Quaternion lever_rotation, r
 	Mesh lever_mesh = graphics_mesh_create(lever_vertices, lever_indices);
 
 	vec3 support_collider_scale = {1.0, 1.0, 1.0};
-	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(support_vertices, support_indices, support_collider_scale);
-	eid support_id = entity_create_fixed(support_mesh, lever_position, lever_rotation, support_collider_scale,
+	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(support_vertices, support_collider_scale);
+	eid support_id = examples_util_create_fixed_entity(support_mesh, lever_position, lever_rotation, support_collider_scale,
 		{0.0, 1.0, 0.0, 1.0}, support_colliders, 0.5, 0.5, 0.0);
 
 	vec3 lever_collider_scale = {1.0, 1.0, 1.0};
-	Collider* lever_colliders = examples_util_create_single_convex_hull_collider_array(lever_vertices, lever_indices, lever_collider_scale);
-	eid lever_id = entity_create(lever_mesh, lever_position, lever_rotation, lever_collider_scale,
+	Collider* lever_colliders = examples_util_create_single_convex_hull_collider_array(lever_vertices, lever_collider_scale);
+	eid lever_id = examples_util_create_entity(lever_mesh, lever_position, lever_rotation, lever_collider_scale,
 		{1.0, 1.0, 0.0, 1.0}, 1.0, lever_colliders, 0.6, 0.6, 0.0);
 
 	array_free(support_vertices);
@@ -111,7 +110,7 @@ void ex_hinge_joints_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -134,7 +133,7 @@ void ex_hinge_joints_update(r64 delta_time) {
 		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
 	}
 
-	pbd_simulate_with_constraints(delta_time, entities, constraints, 20, 1, true);
+	pbd_simulate_with_constraints(delta_time, entities, constraints, 20, 1, true, NULL);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		entity_clear_forces(entities[i]);
@@ -142,71 +141,77 @@ void ex_hinge_joints_update(r64 delta_time) {
 	array_free(entities);
 }
 
+static const Render_Transform* find_render_transform(const Render_Transform* transforms, eid id) {
+	for (u32 i = 0; i < array_length(transforms); ++i) {
+		if (transforms[i].id == id) {
+			return &transforms[i];
+		}
+	}
+	return NULL;
+}
+
 void ex_hinge_joints_render() {
-	Entity** entities = entity_get_all();
+	// Drawn with the same poses as the entities, which may be running on the physics thread
+	Render_Transform* transforms = examples_util_get_render_transforms();
 
 	// Render the aligned axes of every joint
 	for (u32 i = 0; i < array_length(constraints); ++i) {
 		Constraint* c = &constraints[i];
 		if (c->type == HINGE_JOINT_CONSTRAINT) {
-			Entity* support_entity = entity_get_by_id(c->e1_id);
-			Entity* lever_entity = entity_get_by_id(c->e2_id);
-			vec3 e1_a_wc = quaternion_get_right(&support_entity->world_rotation);
-			vec3 e2_a_wc = quaternion_get_right(&lever_entity->world_rotation);
-			graphics_renderer_debug_vector(support_entity->world_position, gm_vec3_add(support_entity->world_position, e1_a_wc),
-				{1.0, 0.0, 0.0, 1.0});
-			graphics_renderer_debug_vector(lever_entity->world_position, gm_vec3_add(lever_entity->world_position, e2_a_wc),
-				{0.0, 0.0, 0.0, 1.0});
+			const Render_Transform* support_transform = find_render_transform(transforms, c->e1_id);
+			const Render_Transform* lever_transform = find_render_transform(transforms, c->e2_id);
+			if (!support_transform || !lever_transform) {
+				continue;
+			}
+			vec3 e1_a_wc = quaternion_get_right(&support_transform->world_rotation);
+			vec3 e2_a_wc = quaternion_get_right(&lever_transform->world_rotation);
+			graphics_renderer_debug_vector(support_transform->world_position,
+				gm_vec3_add(support_transform->world_position, e1_a_wc), {1.0, 0.0, 0.0, 1.0});
+			graphics_renderer_debug_vector(lever_transform->world_position,
+				gm_vec3_add(lever_transform->world_position, e2_a_wc), {0.0, 0.0, 0.0, 1.0});
 		}
 	}
 
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	graphics_transforms_render_phong_shader(&camera, transforms, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
+	array_free(transforms);
 }
 
 void ex_hinge_joints_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 30.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
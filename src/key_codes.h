@@ -0,0 +1,24 @@
+#ifndef RAW_PHYSICS_KEY_CODES_H
+#define RAW_PHYSICS_KEY_CODES_H
+
+// Indices in the key state array of the keys the example scenes react to. The samples fill the array from GLFW callbacks,
+// so these are GLFW's values (main.cpp checks it), but the scenes don't need GLFW to build, e.g. in the headless benchmark.
+#define KEY_SPACE 32
+#define KEY_1 49
+#define KEY_A 65
+#define KEY_B 66
+#define KEY_D 68
+#define KEY_L 76
+#define KEY_M 77
+#define KEY_N 78
+#define KEY_P 80
+#define KEY_S 83
+#define KEY_V 86
+#define KEY_W 87
+#define KEY_X 88
+#define KEY_Y 89
+#define KEY_Z 90
+#define KEY_LEFT_SHIFT 340
+#define KEY_RIGHT_SHIFT 344
+
+#endif
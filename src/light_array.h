@@ -27,6 +27,19 @@
 
     ----------------------------------------------------------------------------------
 
+    Heap memory is allocated through LIGHT_ARRAY_CALLOC, LIGHT_ARRAY_REALLOC and LIGHT_ARRAY_FREE, which have the same
+    signatures as calloc, realloc and free. They can be defined before including this file to hook the allocations.
+    In raw-physics they default to the memory tracker (memory_tracker.h), which counts allocations per simulation phase.
+
+    ----------------------------------------------------------------------------------
+
+    Arrays can also live in memory owned by a custom allocator (e.g. an arena), by setting the
+    'allocator' field of the array base when creating it. Growing and freeing the array will then
+    go through the allocator instead of realloc/free. Copies made with array_copy always live in
+    the heap.
+
+    ----------------------------------------------------------------------------------
+
     Usage:
     An example usage of creating, pushing, popping, removing and freeing an array:
 
@@ -70,11 +83,28 @@
 #include <string.h>
 #endif
 
+#if !defined(LIGHT_ARRAY_CALLOC)
+#include "memory_tracker.h"
+#define LIGHT_ARRAY_CALLOC memory_tracker_calloc
+#define LIGHT_ARRAY_REALLOC memory_tracker_realloc
+#define LIGHT_ARRAY_FREE memory_tracker_free
+#endif
+
+struct Light_Array_Allocator;
+
 typedef struct {
     size_t capacity;
     size_t length;
+    /* NULL if the array lives in the heap */
+    struct Light_Array_Allocator* allocator;
 } Dynamic_ArrayBase;
 
+typedef struct Light_Array_Allocator {
+    /* must behave like realloc, 'old_size' is the size of the block that is currently allocated */
+    void* (*reallocate)(struct Light_Array_Allocator* allocator, void* block, size_t old_size, size_t new_size);
+    void  (*free)(struct Light_Array_Allocator* allocator, void* block);
+} Light_Array_Allocator;
+
 #define LIGHT_ARRAY_MIN(x, y) (y ^ ((x ^ y) & -(x < y)))
 #define LIGHT_ARRAY_MAX(x, y) (x ^ ((x ^ y) & -(x < y)))
 #if defined(__GNUC__)
@@ -92,29 +122,53 @@ typedef struct {
 
 #if defined(__cplusplus)
 /* creates a new array of type T */
-#define array_new(T) (T*)((char*)&(((Dynamic_ArrayBase*)calloc(1, sizeof(Dynamic_ArrayBase) + sizeof(T)))->capacity = 1) + sizeof(Dynamic_ArrayBase))
-#define array_new_len(T, L) (T*)((char*)&(((Dynamic_ArrayBase*)calloc(1, sizeof(Dynamic_ArrayBase) + sizeof(T) * L))->capacity = L) + sizeof(Dynamic_ArrayBase))
+#define array_new(T) (T*)((char*)&(((Dynamic_ArrayBase*)LIGHT_ARRAY_CALLOC(1, sizeof(Dynamic_ArrayBase) + sizeof(T)))->capacity = 1) + sizeof(Dynamic_ArrayBase))
+#define array_new_len(T, L) (T*)((char*)&(((Dynamic_ArrayBase*)LIGHT_ARRAY_CALLOC(1, sizeof(Dynamic_ArrayBase) + sizeof(T) * L))->capacity = L) + sizeof(Dynamic_ArrayBase))
 #else
 #define array_new(T) array_dyn_allocate(sizeof(T) + sizeof(Dynamic_ArrayBase))
 /* creates a new array of type T with starting capacity L */
 #define array_new_len(T, L) array_dyn_allocate_capacity(sizeof(T), L)
 #endif
 static LIGHT_ARRAY_API void* array_dyn_allocate(size_t size) {
-    void* res = calloc(1, size);
+    void* res = LIGHT_ARRAY_CALLOC(1, size);
     ((Dynamic_ArrayBase*)res)->capacity = 1;
     return (void*)((char*)res + sizeof(Dynamic_ArrayBase));
 }
 static LIGHT_ARRAY_API void* array_dyn_allocate_capacity(size_t size_element, size_t capacity) {
-    void* res = calloc(1, size_element * capacity + sizeof(Dynamic_ArrayBase));
+    void* res = LIGHT_ARRAY_CALLOC(1, size_element * capacity + sizeof(Dynamic_ArrayBase));
     ((Dynamic_ArrayBase*)res)->capacity = capacity;
     return (void*)((char*)res + sizeof(Dynamic_ArrayBase));
 }
+/* internal of the library, grows the memory block of the array given its base */
+static LIGHT_ARRAY_API void* array_dyn_reallocate(Dynamic_ArrayBase* base, size_t old_size, size_t new_size) {
+    if (base->allocator) {
+        return base->allocator->reallocate(base->allocator, base, old_size, new_size);
+    }
+    return LIGHT_ARRAY_REALLOC(base, new_size);
+}
+/* internal of the library, frees the memory block of the array given its base */
+static LIGHT_ARRAY_API void array_dyn_free(Dynamic_ArrayBase* base) {
+    if (base->allocator) {
+        base->allocator->free(base->allocator, base);
+    } else {
+        LIGHT_ARRAY_FREE(base);
+    }
+}
+/* internal of the library, copies the array into a new heap array */
+static LIGHT_ARRAY_API void* array_dyn_copy(void* array, size_t size_element) {
+    Dynamic_ArrayBase* base = (Dynamic_ArrayBase*)array - 1;
+    void* res = array_dyn_allocate_capacity(size_element, base->capacity);
+    memmove(res, array, base->length * size_element);
+    ((Dynamic_ArrayBase*)res - 1)->length = base->length;
+    return res;
+}
 
 /* given an array created by array_new and a value (rvalue) of the base type of the array, puts that value in the last
    position of the current array, it allocates memory automatically when the capacity is reached. The policy to allocate
    is exponential (doubles every allocation). */
 #define array_push(A, V) ((array_length(A) == array_capacity(A)) \
-    ? *((void**)&(A)) = (void*)((Dynamic_ArrayBase*)realloc((Dynamic_ArrayBase*)(A) - 1, sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * array_capacity(A) * 2) + 1), \
+    ? *((void**)&(A)) = (void*)((Dynamic_ArrayBase*)array_dyn_reallocate((Dynamic_ArrayBase*)(A) - 1, \
+        sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * array_capacity(A), sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * array_capacity(A) * 2) + 1), \
     array_capacity(A) = array_capacity(A) * 2 : 0, \
     (A)[array_length(A)++] = (V))
 
@@ -122,7 +176,8 @@ static LIGHT_ARRAY_API void* array_dyn_allocate_capacity(size_t size_element, si
    bytes of memory, changing the array capacity but not its length.
  */
 #define array_allocate(A, V) ((array_length(A) + (V) >= array_capacity(A)) \
-    ? *((void**)&(A)) = (void*)((Dynamic_ArrayBase*)realloc((Dynamic_ArrayBase*)(A) - 1, sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * (array_length(A) + (V))) + 1), \
+    ? *((void**)&(A)) = (void*)((Dynamic_ArrayBase*)array_dyn_reallocate((Dynamic_ArrayBase*)(A) - 1, \
+        sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * array_capacity(A), sizeof(Dynamic_ArrayBase) + sizeof(*(A)) * (array_length(A) + (V))) + 1), \
     array_capacity(A) = (array_length(A) + (V)) : 0)
 
 /* inserts into a given array A the value V (rvalue of type of the array) in the index I and pushes every value after
@@ -133,7 +188,7 @@ static LIGHT_ARRAY_API void* array_dyn_allocate_capacity(size_t size_element, si
 #define array_pop(A) (array_length(A) > 0) ? (A)[--array_length(A)] : 0
 
 /* frees the memory of the array, the array pointer becomes invalid. */
-#define array_free(A) free(array_base(A))
+#define array_free(A) array_dyn_free(array_base(A))
 
 /* clears the array but keeps the current capacity, that is, keeps the memory allocated. */
 #define array_clear(A) array_length(A) = 0
@@ -146,13 +201,13 @@ static LIGHT_ARRAY_API void* array_dyn_allocate_capacity(size_t size_element, si
 #define array_remove(A, Index) (array_length(A)--, (A)[Index] = (A)[array_length(A)])
 
 /* copies an array to a new one, its capacity and length are also preserved */
-#define array_copy(A) ((void*)((Dynamic_ArrayBase*) \
-    memmove((Dynamic_ArrayBase*)array_dyn_allocate_capacity(sizeof(*A), array_capacity(A)) - 1, \
-    array_base(A), sizeof(Dynamic_ArrayBase) + array_length(A) * sizeof(*A)) + 1))
+#define array_copy(A) array_dyn_copy((void*)(A), sizeof(*A))
 
 /* appends all elements from A2 at the end of A1. A2 remains unchanged */
 #define array_append(A1, A2) (array_length(A1) + array_length(A2) >= array_capacity(A1)) \
-    ? *((void**)&(A1)) = (void*)((Dynamic_ArrayBase*)realloc((Dynamic_ArrayBase*)(A1) - 1, sizeof(Dynamic_ArrayBase) + sizeof(*(A1)) * (array_capacity(A1) + array_capacity(A2)) * 2) + 1), \
+    ? *((void**)&(A1)) = (void*)((Dynamic_ArrayBase*)array_dyn_reallocate((Dynamic_ArrayBase*)(A1) - 1, \
+        sizeof(Dynamic_ArrayBase) + sizeof(*(A1)) * array_capacity(A1), \
+        sizeof(Dynamic_ArrayBase) + sizeof(*(A1)) * (array_capacity(A1) + array_capacity(A2)) * 2) + 1), \
     array_capacity(A1) = (array_capacity(A1) + array_capacity(A2)) * 2 : 0, \
     memcpy(A1 + array_length(A1), A2, array_length(A2) * sizeof(*(A1))), \
     array_length(A1) += array_length(A2)
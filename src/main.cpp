@@ -1,12 +1,9 @@
 #define DYNAMIC_ARRAY_IMPLEMENT
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
-#define GRAPHICS_MATH_IMPLEMENT
-#define C_FEK_HASH_MAP_IMPLEMENT
 #include "light_array.h"
 #include "stb_image.h"
 #include "stb_image_write.h"
-#include "hash_map.h"
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
@@ -14,6 +11,11 @@
 #include "core.h"
 #include "gm.h"
 #include "menu.h"
+#include "key_codes.h"
+
+// The scenes read the key state array with the key codes of key_codes.h
+static_assert(KEY_SPACE == GLFW_KEY_SPACE && KEY_1 == GLFW_KEY_1 && KEY_A == GLFW_KEY_A && KEY_Z == GLFW_KEY_Z &&
+	KEY_LEFT_SHIFT == GLFW_KEY_LEFT_SHIFT && KEY_RIGHT_SHIFT == GLFW_KEY_RIGHT_SHIFT, "Key codes don't match GLFW's");
 
 #define WINDOW_TITLE "basic-engine"
 
@@ -0,0 +1,187 @@
+#include "memory_tracker.h"
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#define BLOCK_SIZE(B) _msize(B)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define BLOCK_SIZE(B) malloc_size(B)
+#else
+#include <malloc.h>
+#define BLOCK_SIZE(B) malloc_usable_size(B)
+#endif
+
+typedef struct {
+	std::atomic<u64> num_allocations;
+	std::atomic<u64> num_reallocations;
+	std::atomic<u64> num_frees;
+	std::atomic<u64> allocated_bytes;
+	std::atomic<u64> peak_bytes_in_use;
+} Atomic_Memory_Counters;
+
+typedef enum {
+	ALLOCATION,
+	REALLOCATION
+} Allocation_Type;
+
+// Allocations can come from any thread (e.g. the narrowphase workers), so everything is atomic
+static Atomic_Memory_Counters phase_counters[MEMORY_PHASE_COUNT];
+static thread_local Memory_Phase current_phase = MEMORY_PHASE_NONE;
+static std::atomic<u64> bytes_in_use;
+static std::atomic<u64> peak_bytes_in_use;
+// The statistics are read by the application while the simulation may be writing them from its own thread
+static std::mutex last_step_statistics_mutex;
+static Memory_Step_Statistics last_step_statistics;
+
+static const char* phase_names[MEMORY_PHASE_COUNT] = {
+	"Other",
+	"Broadphase",
+	"Islands",
+	"Narrowphase",
+	"Solve",
+	"Velocity Solve"
+};
+
+static void update_peak(std::atomic<u64>* peak, u64 value) {
+	u64 current = peak->load(std::memory_order_relaxed);
+	while (value > current && !peak->compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+// 'old_block_size' and 'new_block_size' are the real sizes of the blocks, which might be larger than the requested size
+static void track_allocation(Allocation_Type type, size_t requested_size, size_t old_block_size, size_t new_block_size) {
+	u64 in_use = bytes_in_use.fetch_add(new_block_size - old_block_size, std::memory_order_relaxed) + new_block_size - old_block_size;
+	update_peak(&peak_bytes_in_use, in_use);
+
+	if (current_phase == MEMORY_PHASE_NONE) {
+		return;
+	}
+
+	Atomic_Memory_Counters* counters = &phase_counters[current_phase];
+	if (type == ALLOCATION) {
+		counters->num_allocations.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		counters->num_reallocations.fetch_add(1, std::memory_order_relaxed);
+	}
+	counters->allocated_bytes.fetch_add(requested_size, std::memory_order_relaxed);
+	update_peak(&counters->peak_bytes_in_use, in_use);
+}
+
+static void track_free(size_t block_size) {
+	bytes_in_use.fetch_sub(block_size, std::memory_order_relaxed);
+
+	if (current_phase != MEMORY_PHASE_NONE) {
+		phase_counters[current_phase].num_frees.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void* memory_tracker_malloc(size_t size) {
+	void* block = malloc(size);
+	if (block) {
+		track_allocation(ALLOCATION, size, 0, BLOCK_SIZE(block));
+	}
+	return block;
+}
+
+void* memory_tracker_calloc(size_t num, size_t size) {
+	void* block = calloc(num, size);
+	if (block) {
+		track_allocation(ALLOCATION, num * size, 0, BLOCK_SIZE(block));
+	}
+	return block;
+}
+
+void* memory_tracker_realloc(void* block, size_t size) {
+	if (!block) {
+		return memory_tracker_malloc(size);
+	}
+
+	size_t old_block_size = BLOCK_SIZE(block);
+	void* new_block = realloc(block, size);
+	if (new_block) {
+		track_allocation(REALLOCATION, size, old_block_size, BLOCK_SIZE(new_block));
+	} else if (size == 0) {
+		// The block was freed
+		track_free(old_block_size);
+	}
+	return new_block;
+}
+
+void memory_tracker_free(void* block) {
+	if (!block) {
+		return;
+	}
+
+	track_free(BLOCK_SIZE(block));
+	free(block);
+}
+
+void memory_tracker_begin_step() {
+	for (u32 i = 0; i < MEMORY_PHASE_COUNT; ++i) {
+		Atomic_Memory_Counters* counters = &phase_counters[i];
+		counters->num_allocations = 0;
+		counters->num_reallocations = 0;
+		counters->num_frees = 0;
+		counters->allocated_bytes = 0;
+		counters->peak_bytes_in_use = 0;
+	}
+
+	memory_tracker_set_phase(MEMORY_PHASE_OTHER);
+}
+
+void memory_tracker_end_step() {
+	current_phase = MEMORY_PHASE_NONE;
+
+	Memory_Step_Statistics statistics;
+	Memory_Counters* step = &statistics.step;
+	*step = Memory_Counters{};
+	for (u32 i = 0; i < MEMORY_PHASE_COUNT; ++i) {
+		Atomic_Memory_Counters* counters = &phase_counters[i];
+		Memory_Counters* phase = &statistics.phases[i];
+		phase->num_allocations = counters->num_allocations;
+		phase->num_reallocations = counters->num_reallocations;
+		phase->num_frees = counters->num_frees;
+		phase->allocated_bytes = counters->allocated_bytes;
+		phase->peak_bytes_in_use = counters->peak_bytes_in_use;
+
+		step->num_allocations += phase->num_allocations;
+		step->num_reallocations += phase->num_reallocations;
+		step->num_frees += phase->num_frees;
+		step->allocated_bytes += phase->allocated_bytes;
+		step->peak_bytes_in_use = MAX(step->peak_bytes_in_use, phase->peak_bytes_in_use);
+	}
+
+	std::lock_guard<std::mutex> lock(last_step_statistics_mutex);
+	last_step_statistics = statistics;
+}
+
+void memory_tracker_set_phase(Memory_Phase phase) {
+	current_phase = phase;
+	// Phases that don't allocate still report how much memory was in use
+	if (phase != MEMORY_PHASE_NONE) {
+		update_peak(&phase_counters[phase].peak_bytes_in_use, bytes_in_use.load(std::memory_order_relaxed));
+	}
+}
+
+Memory_Phase memory_tracker_get_phase() {
+	return current_phase;
+}
+
+const char* memory_tracker_get_phase_name(Memory_Phase phase) {
+	return phase_names[phase];
+}
+
+void memory_tracker_get_last_step_statistics(Memory_Step_Statistics* statistics) {
+	std::lock_guard<std::mutex> lock(last_step_statistics_mutex);
+	*statistics = last_step_statistics;
+}
+
+u64 memory_tracker_get_bytes_in_use() {
+	return bytes_in_use;
+}
+
+u64 memory_tracker_get_peak_bytes_in_use() {
+	return peak_bytes_in_use;
+}
@@ -0,0 +1,60 @@
+#ifndef RAW_PHYSICS_MEMORY_TRACKER_H
+#define RAW_PHYSICS_MEMORY_TRACKER_H
+#include "common.h"
+#include <stddef.h>
+
+// light_array.h allocates through these functions, so every allocation it makes is counted.
+// Counters are attributed to the phase of the simulation step that the allocating thread is in. Each thread has a phase of its
+// own, so that allocations made by other threads while a step runs (e.g. rendering) are not counted in the step.
+
+typedef enum {
+	// Anything that happens inside a step, but outside the other phases
+	MEMORY_PHASE_OTHER,
+	MEMORY_PHASE_BROADPHASE,
+	MEMORY_PHASE_ISLANDS,
+	MEMORY_PHASE_NARROWPHASE,
+	MEMORY_PHASE_SOLVE,
+	MEMORY_PHASE_VELOCITY_SOLVE,
+	MEMORY_PHASE_COUNT,
+	// Outside of a step, allocations are not attributed to any phase
+	MEMORY_PHASE_NONE = MEMORY_PHASE_COUNT
+} Memory_Phase;
+
+typedef struct {
+	u64 num_allocations;
+	u64 num_reallocations;
+	u64 num_frees;
+	// Bytes requested by allocations and reallocations
+	u64 allocated_bytes;
+	// Highest number of bytes in use by the whole program while the phase was running
+	u64 peak_bytes_in_use;
+} Memory_Counters;
+
+typedef struct {
+	Memory_Counters phases[MEMORY_PHASE_COUNT];
+	// The sum of all phases, with the peak of the whole step
+	Memory_Counters step;
+} Memory_Step_Statistics;
+
+void* memory_tracker_malloc(size_t size);
+void* memory_tracker_calloc(size_t num, size_t size);
+void* memory_tracker_realloc(void* block, size_t size);
+void memory_tracker_free(void* block);
+
+// Called by the simulation at the start and end of each step, on the thread that runs it. Only allocations made inside a step
+// are attributed to phases.
+void memory_tracker_begin_step();
+void memory_tracker_end_step();
+// Sets the phase of the calling thread.
+void memory_tracker_set_phase(Memory_Phase phase);
+// The phase of the calling thread, MEMORY_PHASE_NONE outside of a step. The thread pool gives it to the workers that run a
+// parallel loop, so that their allocations are counted in the phase of the thread that started the loop.
+Memory_Phase memory_tracker_get_phase();
+const char* memory_tracker_get_phase_name(Memory_Phase phase);
+// Statistics of the last step that finished. Can be called from any thread, even while a step is running.
+void memory_tracker_get_last_step_statistics(Memory_Step_Statistics* statistics);
+// Number of bytes currently allocated through the tracker, and the highest it has ever been.
+u64 memory_tracker_get_bytes_in_use();
+u64 memory_tracker_get_peak_bytes_in_use();
+
+#endif
@@ -4,6 +4,8 @@
 #include "imgui_impl_opengl3.h"
 #include "core.h"
 #include "common.h"
+#include "memory_tracker.h"
+#include "profiler.h"
 #include <stdio.h>
 
 #include "light_array.h"
@@ -49,6 +51,126 @@ core_menu_render();
 ImGui::End();
 }
 
+static void draw_memory_counters_row(const char* name, const Memory_Counters* counters) {
+	ImGui::Text("%s", name); ImGui::NextColumn();
+	ImGui::Text("%llu", (unsigned long long)counters->num_allocations); ImGui::NextColumn();
+	ImGui::Text("%llu", (unsigned long long)counters->num_reallocations); ImGui::NextColumn();
+	ImGui::Text("%llu", (unsigned long long)counters->num_frees); ImGui::NextColumn();
+	ImGui::Text("%.1f", counters->allocated_bytes / 1024.0); ImGui::NextColumn();
+	ImGui::Text("%.1f", counters->peak_bytes_in_use / 1024.0); ImGui::NextColumn();
+}
+
+static void draw_memory_window() {
+	ImGui::SetNextWindowPos(ImVec2(20, 20), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(560, 240), ImGuiCond_FirstUseEver);
+
+	if (ImGui::Begin("Memory", NULL, 0)) {
+		Memory_Step_Statistics statistics;
+		memory_tracker_get_last_step_statistics(&statistics);
+
+		ImGui::Text("In use: %.1f KB (peak %.1f KB)", memory_tracker_get_bytes_in_use() / 1024.0,
+			memory_tracker_get_peak_bytes_in_use() / 1024.0);
+		ImGui::Text("Last simulation step:");
+
+		ImGui::Columns(6, "memory_phases");
+		ImGui::Text("Phase"); ImGui::NextColumn();
+		ImGui::Text("Allocs"); ImGui::NextColumn();
+		ImGui::Text("Reallocs"); ImGui::NextColumn();
+		ImGui::Text("Frees"); ImGui::NextColumn();
+		ImGui::Text("KB"); ImGui::NextColumn();
+		ImGui::Text("Peak KB"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		for (u32 i = 0; i < MEMORY_PHASE_COUNT; ++i) {
+			draw_memory_counters_row(memory_tracker_get_phase_name((Memory_Phase)i), &statistics.phases[i]);
+		}
+		ImGui::Separator();
+		draw_memory_counters_row("Step", &statistics.step);
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
+
+#ifdef RAW_PHYSICS_PROFILE
+static void draw_profiler_window() {
+	ImGui::SetNextWindowPos(ImVec2(20, 280), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(560, 420), ImGuiCond_FirstUseEver);
+
+	if (ImGui::Begin("Profiler", NULL, 0)) {
+		// A copy, since the simulation may be writing new frames from its own thread
+		static Profile_Frame frames[PROFILER_NUM_FRAMES];
+		u32 num_frames = profiler_copy_frames(frames);
+		if (num_frames == 0) {
+			ImGui::Text("No simulation steps yet.");
+			ImGui::End();
+			return;
+		}
+
+		// Averages over the whole ring buffer, so that the bars don't flicker
+		r64 phase_times[PROFILE_PHASE_COUNT] = {0};
+		r64 phase_calls[PROFILE_PHASE_COUNT] = {0};
+		r32 step_times[PROFILER_NUM_FRAMES];
+		r32 max_step_time = 0.0f;
+		for (u32 i = 0; i < num_frames; ++i) {
+			const Profile_Frame* frame = &frames[i];
+			for (u32 j = 0; j < PROFILE_PHASE_COUNT; ++j) {
+				phase_times[j] += frame->phase_time[j] / 1e6 / num_frames;
+				phase_calls[j] += (r64)frame->phase_calls[j] / num_frames;
+			}
+			step_times[i] = (r32)(frame->phase_time[PROFILE_PHASE_STEP] / 1e6);
+			max_step_time = MAX(max_step_time, step_times[i]);
+		}
+
+		ImGui::Text("Step time (ms), last %u steps:", num_frames);
+		s8 overlay[64];
+		snprintf(overlay, sizeof(overlay), "last %.3f ms, max %.3f ms", step_times[num_frames - 1], max_step_time);
+		ImGui::PlotLines("##step_times", step_times, num_frames, 0, overlay, 0.0f, max_step_time * 1.1f, ImVec2(0, 80));
+		ImGui::Separator();
+
+		ImGui::Text("Average per step (phases in the thread pool add up the time of all threads):");
+		ImGui::Columns(3, "profiler_phases");
+		ImGui::SetColumnWidth(0, 160);
+		ImGui::Text("Phase"); ImGui::NextColumn();
+		ImGui::Text("Time"); ImGui::NextColumn();
+		ImGui::Text("Calls"); ImGui::NextColumn();
+		ImGui::Separator();
+
+		r64 step_time = phase_times[PROFILE_PHASE_STEP];
+		for (u32 i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+			ImGui::Indent(12.0f * profiler_get_phase_depth((Profile_Phase)i) + 1.0f);
+			ImGui::Text("%s", profiler_get_phase_name((Profile_Phase)i));
+			ImGui::Unindent(12.0f * profiler_get_phase_depth((Profile_Phase)i) + 1.0f);
+			ImGui::NextColumn();
+
+			s8 label[32];
+			snprintf(label, sizeof(label), "%.3f ms", phase_times[i]);
+			r32 fraction = step_time > 0.0 ? (r32)(phase_times[i] / step_time) : 0.0f;
+			ImGui::ProgressBar(MIN(fraction, 1.0f), ImVec2(-1.0f, 0.0f), label);
+			ImGui::NextColumn();
+
+			ImGui::Text("%.1f", phase_calls[i]); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+		ImGui::Separator();
+
+		static s32 num_trace_frames = 60;
+		u32 trace_frames_left = profiler_get_trace_frames_left();
+		if (trace_frames_left > 0) {
+			ImGui::Text("Capturing trace.json, %u steps left...", trace_frames_left);
+		} else {
+			ImGui::InputInt("Steps", &num_trace_frames);
+			num_trace_frames = CLAMP(num_trace_frames, 1, 10000);
+			if (ImGui::Button("Capture trace")) {
+				profiler_capture_trace((u32)num_trace_frames, "trace.json");
+			}
+			ImGui::SameLine();
+			ImGui::TextDisabled("(writes trace.json, open it in ui.perfetto.dev)");
+		}
+	}
+	ImGui::End();
+}
+#endif
+
 void menu_render() {
 	// Start the Dear ImGui frame
 	ImGui_ImplOpenGL3_NewFrame();
@@ -60,6 +182,10 @@ void menu_render() {
 
 #if 1
 	draw_main_window();
+	draw_memory_window();
+#ifdef RAW_PHYSICS_PROFILE
+	draw_profiler_window();
+#endif
 #else
 	ImGui::ShowDemoWindow();
 #endif
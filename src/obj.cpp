@@ -3,8 +3,9 @@
 #include <iostream>
 #include "graphics.h"
 #include "light_array.h"
+#include "cache.h"
 
-int obj_parse(const char* obj_path, Vertex** vertices, u32** indices) {
+static int parse_obj_file(const char* obj_path, Vertex** vertices, u32** indices) {
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::string warn;
@@ -140,4 +141,14 @@ int obj_parse(const char* obj_path, Vertex** vertices, u32** indices) {
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+int obj_parse(const char* obj_path, Vertex** vertices, u32** indices) {
+	if (cache_load_mesh(obj_path, vertices, indices)) {
+		return 0;
+	}
+
+	int result = parse_obj_file(obj_path, vertices, indices);
+	cache_store_mesh(obj_path, *vertices, *indices);
+	return result;
+}
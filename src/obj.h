@@ -4,6 +4,7 @@
 #include "common.h"
 #include "graphics.h"
 
+// The cooked mesh is kept in the cache (see cache.h), so the obj file is only parsed again when it changes.
 int obj_parse(const char* obj_path, Vertex** vertices, u32** indices);
 
 #endif
\ No newline at end of file
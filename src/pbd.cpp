@@ -2,10 +2,18 @@
 #include "light_array.h"
 #include <assert.h>
 #include <float.h>
+#include <algorithm>
 #include "broad.h"
 #include "pbd_base_constraints.h"
 #include "util.h"
 #include "physics_util.h"
+#include "thread_pool.h"
+#include "arena.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+#include "gjk.h"
+#include "epa.h"
+#include "sat.h"
 
 //#include <fenv.h>
 
@@ -15,6 +23,10 @@
 #define DEACTIVATION_TIME_TO_BE_INACTIVE 1.0
 #define USE_QUATERNIONS_LINEARIZED_FORMULAS
 
+static Pbd_Step_Statistics last_step_statistics;
+static Pbd_Narrowphase_Callback narrowphase_callback;
+static void* narrowphase_callback_data;
+
 void pbd_positional_constraint_init(Constraint* constraint, eid e1_id, eid e2_id, vec3 r1_lc, vec3 r2_lc, r64 compliance, vec3 distance) {
 	constraint->type = POSITIONAL_CONSTRAINT;
 	constraint->e1_id = e1_id;
@@ -405,6 +417,37 @@ static void solve_constraint(Constraint* constraint, r64 h) {
 	assert(0);
 }
 
+// How far the constraint is from being satisfied positionally, measured like the solver measures it. 0 for orientation constraints.
+static r64 get_positional_error(const Constraint* constraint) {
+	Entity* e1 = entity_get_by_id(constraint->e1_id);
+	Entity* e2 = entity_get_by_id(constraint->e2_id);
+
+	switch (constraint->type) {
+		case POSITIONAL_CONSTRAINT: {
+			vec3 attachment_distance = gm_vec3_subtract(e1->world_position, e2->world_position);
+			return gm_vec3_length(gm_vec3_subtract(attachment_distance, constraint->positional_constraint.distance));
+		} break;
+		case COLLISION_CONSTRAINT: {
+			vec3 p1 = calculate_p(e1, constraint->collision_constraint.r1_lc);
+			vec3 p2 = calculate_p(e2, constraint->collision_constraint.r2_lc);
+			return MAX(gm_vec3_dot(gm_vec3_subtract(p1, p2), constraint->collision_constraint.normal), 0.0);
+		} break;
+		case HINGE_JOINT_CONSTRAINT: {
+			vec3 p1 = calculate_p(e1, constraint->hinge_joint_constraint.r1_lc);
+			vec3 p2 = calculate_p(e2, constraint->hinge_joint_constraint.r2_lc);
+			return gm_vec3_length(gm_vec3_subtract(p1, p2));
+		} break;
+		case SPHERICAL_JOINT_CONSTRAINT: {
+			vec3 p1 = calculate_p(e1, constraint->spherical_joint_constraint.r1_lc);
+			vec3 p2 = calculate_p(e2, constraint->spherical_joint_constraint.r2_lc);
+			return gm_vec3_length(gm_vec3_subtract(p1, p2));
+		} break;
+		case MUTUAL_ORIENTATION_CONSTRAINT: break;
+	}
+
+	return 0.0;
+}
+
 void clipping_contact_to_collision_constraint(Entity* e1, Entity* e2, Collider_Contact* contact, Constraint* constraint) {
 	constraint->type = COLLISION_CONSTRAINT;
 	constraint->e1_id = e1->id;
@@ -423,12 +466,12 @@ void clipping_contact_to_collision_constraint(Entity* e1, Entity* e2, Collider_C
 	constraint->collision_constraint.r2_lc = quaternion_apply_to_vec3(&q2_inv, r2_wc);
 }
 
-static Constraint* copy_constraints(Constraint* constraints) {
+static Constraint* copy_constraints(Constraint* constraints, Arena* arena) {
 	if (constraints == NULL) {
-		return array_new(Constraint);
+		return arena_array_new(Constraint, 64, arena);
 	}
 
-	Constraint* copied_constraints = (Constraint*)array_copy(constraints);
+	Constraint* copied_constraints = (Constraint*)arena_array_copy(constraints, arena);
 
 	for (u32 i = 0; i < array_length(copied_constraints); ++i) {
 		Constraint* constraint = &copied_constraints[i];
@@ -461,21 +504,188 @@ static Constraint* copy_constraints(Constraint* constraints) {
 	return copied_constraints;
 }
 
+typedef struct {
+	Entity* e1;
+	Entity* e2;
+} Narrowphase_Pair;
+
+typedef struct {
+	const Narrowphase_Pair* pairs;
+	// The constraints found by each chunk of pairs
+	Constraint** chunk_constraints;
+	// The number of pairs of each chunk that have contacts
+	u32* chunk_num_hits;
+	// The SAT features found by each chunk, written to the feature cache once all chunks are done
+	SAT_Cache_Update** chunk_sat_cache_updates;
+} Narrowphase_Job;
+
+// Gets the broadphase pairs that need to go through the narrowphase in this substep.
+static Narrowphase_Pair* get_narrowphase_pairs(const Broad_Collision_Pair* broad_collision_pairs, Arena* arena) {
+	Narrowphase_Pair* narrowphase_pairs = arena_array_new(Narrowphase_Pair, array_length(broad_collision_pairs), arena);
+	for (u32 i = 0; i < array_length(broad_collision_pairs); ++i) {
+		Entity* e1 = entity_get_by_id(broad_collision_pairs[i].e1_id);
+		Entity* e2 = entity_get_by_id(broad_collision_pairs[i].e2_id);
+
+		// If e1 is "colliding" with e2, they must be either both active or both inactive
+		if (!e1->fixed && !e2->fixed) {
+			assert((e1->active && e2->active) || (!e1->active && !e2->active));
+		}
+
+		// No need to solve the collision if both entities are either inactive or fixed
+		if ((e1->fixed || !e1->active) && (e2->fixed || !e2->active)) {
+			continue;
+		}
+
+		Narrowphase_Pair pair = {e1, e2};
+		array_push(narrowphase_pairs, pair);
+	}
+
+	return narrowphase_pairs;
+}
+
+static void update_colliders_task(void* data, u32, u32 begin, u32 end) {
+	Entity** entities = (Entity**)data;
+	for (u32 i = begin; i < end; ++i) {
+		Entity* e = entities[i];
+		colliders_update(e->colliders, e->world_position, &e->world_rotation);
+	}
+}
+
+// Brings the colliders of every entity that is part of a narrowphase pair to the current position and orientation of the entity.
+// Each entity is updated once, no matter how many pairs it is part of.
+static void update_colliders(const Narrowphase_Pair* narrowphase_pairs, Arena* arena) {
+	Entity** pair_entities = arena_array_new(Entity*, 2 * array_length(narrowphase_pairs), arena);
+	for (u32 i = 0; i < array_length(narrowphase_pairs); ++i) {
+		array_push(pair_entities, narrowphase_pairs[i].e1);
+		array_push(pair_entities, narrowphase_pairs[i].e2);
+	}
+
+	// std::sort instead of qsort, since glibc's qsort allocates a temporary buffer
+	std::sort(pair_entities, pair_entities + array_length(pair_entities));
+
+	u32 num_unique_entities = 0;
+	for (u32 i = 0; i < array_length(pair_entities); ++i) {
+		if (num_unique_entities == 0 || pair_entities[num_unique_entities - 1] != pair_entities[i]) {
+			pair_entities[num_unique_entities++] = pair_entities[i];
+		}
+	}
+
+	thread_pool_parallel_for(num_unique_entities, 8, update_colliders_task, pair_entities);
+}
+
+static void narrowphase_task(void* data, u32 chunk_idx, u32 begin, u32 end) {
+	Narrowphase_Job* job = (Narrowphase_Job*)data;
+	// The constraints live in the scratch arena of the thread running the chunk, until they are merged
+	Constraint* constraints = arena_array_new(Constraint, 64, arena_get_scratch());
+	SAT_Cache_Update* sat_cache_updates = arena_array_new(SAT_Cache_Update, 64, arena_get_scratch());
+	sat_cache_begin_recording(&sat_cache_updates);
+	u32 num_hits = 0;
+
+	for (u32 i = begin; i < end; ++i) {
+		Entity* e1 = job->pairs[i].e1;
+		Entity* e2 = job->pairs[i].e2;
+		Collider_Contact* contacts = colliders_bvh_get_contacts(e1->colliders, &e1->colliders_bvh, e1->world_position,
+			&e1->world_rotation, e2->colliders, &e2->colliders_bvh, e2->world_position, &e2->world_rotation);
+		for (u32 l = 0; l < array_length(contacts); ++l) {
+			Constraint constraint;
+			clipping_contact_to_collision_constraint(e1, e2, &contacts[l], &constraint);
+			array_push(constraints, constraint);
+		}
+		num_hits += array_length(contacts) > 0;
+		array_free(contacts);
+	}
+
+	sat_cache_end_recording();
+	job->chunk_constraints[chunk_idx] = constraints;
+	job->chunk_num_hits[chunk_idx] = num_hits;
+	job->chunk_sat_cache_updates[chunk_idx] = sat_cache_updates;
+}
+
+// Runs the narrowphase for all pairs in the thread pool, and appends a collision constraint for each contact to 'constraints'.
+// Constraints are appended in the same order as the pairs, so the result does not depend on the number of threads.
+// Returns the number of pairs that have contacts.
+static u32 collect_collision_constraints(const Narrowphase_Pair* narrowphase_pairs, Constraint** constraints, Arena* arena) {
+	const u32 MIN_PAIRS_PER_CHUNK = 4;
+	u32 num_pairs = array_length(narrowphase_pairs);
+	u32 num_chunks = thread_pool_get_num_chunks(num_pairs, MIN_PAIRS_PER_CHUNK);
+	if (num_chunks == 0) {
+		return 0;
+	}
+
+	Narrowphase_Job job;
+	job.pairs = narrowphase_pairs;
+	job.chunk_constraints = (Constraint**)arena_allocate(arena, num_chunks * sizeof(Constraint*));
+	job.chunk_num_hits = (u32*)arena_allocate(arena, num_chunks * sizeof(u32));
+	job.chunk_sat_cache_updates = (SAT_Cache_Update**)arena_allocate(arena, num_chunks * sizeof(SAT_Cache_Update*));
+	thread_pool_parallel_for(num_pairs, MIN_PAIRS_PER_CHUNK, narrowphase_task, &job);
+
+	u32 num_hits = 0;
+	for (u32 i = 0; i < num_chunks; ++i) {
+		Constraint* chunk_constraints = job.chunk_constraints[i];
+		for (u32 j = 0; j < array_length(chunk_constraints); ++j) {
+			array_push(*constraints, chunk_constraints[j]);
+		}
+		num_hits += job.chunk_num_hits[i];
+		// In chunk order, so the cache doesn't depend on the threads either
+		sat_cache_apply(job.chunk_sat_cache_updates[i]);
+	}
+
+	// All chunk constraints were merged, so the scratch memory used by the workers can be reused
+	thread_pool_reset_worker_scratches();
+	return num_hits;
+}
+
+void pbd_get_last_step_statistics(Pbd_Step_Statistics* statistics) {
+	*statistics = last_step_statistics;
+}
+
+void pbd_set_narrowphase_callback(Pbd_Narrowphase_Callback callback, void* data) {
+	narrowphase_callback = callback;
+	narrowphase_callback_data = data;
+}
+
 void pbd_simulate(r64 dt, Entity** entities, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions) {
-	pbd_simulate_with_constraints(dt, entities, NULL, num_substeps, num_pos_iters, enable_collisions);
+	pbd_simulate_with_constraints(dt, entities, NULL, num_substeps, num_pos_iters, enable_collisions, NULL);
 }
 
-void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* external_constraints, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions) {
+void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* external_constraints, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions,
+	Pbd_Step_Statistics* out_statistics) {
 	//feenableexcept(FE_INVALID | FE_OVERFLOW);
 
 	if (dt <= 0.0) return;
 	r64 h = dt / num_substeps;
-
-	Broad_Collision_Pair* broad_collision_pairs = broad_get_collision_pairs(entities);
+	PROFILE_BEGIN(PROFILE_PHASE_STEP);
+
+	// All temporaries of the step come from the scratch arena, which is reset at the end of each substep and of the step,
+	// so stepping doesn't need to allocate memory once the arenas are big enough.
+	Arena* arena = arena_get_scratch();
+	memory_tracker_begin_step();
+
+	Pbd_Step_Statistics statistics = {};
+	statistics.num_bodies = array_length(entities);
+	// The GJK and EPA counters are global, so the step takes the difference
+	GJK_Statistics gjk_statistics_begin;
+	Epa_Statistics epa_statistics_begin;
+	gjk_get_statistics(&gjk_statistics_begin);
+	epa_get_statistics(&epa_statistics_begin);
+
+	memory_tracker_set_phase(MEMORY_PHASE_BROADPHASE);
+	PROFILE_BEGIN(PROFILE_PHASE_BROADPHASE);
+	Broad_Collision_Pair* broad_collision_pairs = broad_get_collision_pairs(entities, arena);
+	statistics.num_broadphase_pairs = array_length(broad_collision_pairs);
+	PROFILE_END_WITH_ARG(PROFILE_PHASE_BROADPHASE, "pairs", statistics.num_broadphase_pairs);
 
 #ifdef ENABLE_SIMULATION_ISLANDS
-	eid** simulation_islands = broad_collect_simulation_islands(entities, broad_collision_pairs, external_constraints);
+	memory_tracker_set_phase(MEMORY_PHASE_ISLANDS);
+	PROFILE_BEGIN(PROFILE_PHASE_ISLANDS);
+	eid** simulation_islands = broad_collect_simulation_islands(entities, broad_collision_pairs, external_constraints, arena);
+	statistics.num_islands = array_length(simulation_islands);
+	for (u32 j = 0; j < array_length(simulation_islands); ++j) {
+		statistics.largest_island_size = MAX(statistics.largest_island_size, (u32)array_length(simulation_islands[j]));
+	}
+	PROFILE_END_WITH_ARG(PROFILE_PHASE_ISLANDS, "islands", statistics.num_islands);
 
+	PROFILE_BEGIN(PROFILE_PHASE_SLEEP);
 	// All entities will be contained in the simulation islands.
 	// Update deactivation time and also, at the same time, its active status
 	for (u32 j = 0; j < array_length(simulation_islands); ++j) {
@@ -504,36 +714,15 @@ void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* extern
 			e->active = !all_inactive;
 		}
 	}
-#if 0
-	for (u32 j = 0; j < array_length(simulation_islands); ++j) {
-		eid* simulation_island = simulation_islands[j];
-		vec4 color = util_pallete(j);
-		for (u32 k = 0; k < array_length(simulation_island); ++k) {
-			Entity* e = entity_get_by_id(simulation_island[k]);
-			e->color = color;
-		}
-	}
-#else
-/*
-	for (u32 j = 0; j < array_length(simulation_islands); ++j) {
-		eid* simulation_island = simulation_islands[j];
-		for (u32 k = 0; k < array_length(simulation_island); ++k) {
-			Entity* e = entity_get_by_id(simulation_island[k]);
-			if (e->active) {
-				e->color = util_pallete(1);
-			} else {
-				e->color = util_pallete(0);
-			}
-		}
-	}
-*/
-#endif
 
 	broad_simulation_islands_destroy(simulation_islands);
+	PROFILE_END(PROFILE_PHASE_SLEEP);
 #endif
 
 	// The main loop of the PBD simulation
 	for (u32 i = 0; i < num_substeps; ++i) {
+		memory_tracker_set_phase(MEMORY_PHASE_OTHER);
+		PROFILE_BEGIN(PROFILE_PHASE_INTEGRATION);
 		for (u32 j = 0; j < array_length(entities); ++j) {
 			Entity* e = entities[j];
 			// Stores the previous position and orientation of the entity
@@ -576,50 +765,55 @@ void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* extern
 #endif
 		}
 
+		PROFILE_END(PROFILE_PHASE_INTEGRATION);
+
+		Arena_Marker substep_marker = arena_get_marker(arena);
+
 		// Create the constraints array
-		Constraint* constraints = copy_constraints(external_constraints);
+		Constraint* constraints = copy_constraints(external_constraints, arena);
 
 		// As explained in sec 3.5, in each substep we need to check for collisions
+		memory_tracker_set_phase(MEMORY_PHASE_NARROWPHASE);
 		if (enable_collisions) {
-			for (u32 j = 0; j < array_length(broad_collision_pairs); ++j) {
-				Entity* e1 = entity_get_by_id(broad_collision_pairs[j].e1_id);
-				Entity* e2 = entity_get_by_id(broad_collision_pairs[j].e2_id);
-
-				// If e1 is "colliding" with e2, they must be either both active or both inactive
-				if (!e1->fixed && !e2->fixed) {
-					assert((e1->active && e2->active) || (!e1->active && !e2->active));
-				}
-
-				// No need to solve the collision if both entities are either inactive or fixed
-				if ((e1->fixed || !e1->active) && (e2->fixed || !e2->active)) {
-					continue;
-				}
-
-				colliders_update(e1->colliders, e1->world_position, &e1->world_rotation);
-				colliders_update(e2->colliders, e2->world_position, &e2->world_rotation);
-
-				Collider_Contact* contacts = colliders_get_contacts(e1->colliders, e2->colliders);
-				if (contacts) {
-					for (u32 l = 0; l < array_length(contacts); ++l) {
-						Collider_Contact* contact = &contacts[l];
-						Constraint constraint;
-						clipping_contact_to_collision_constraint(e1, e2, contact, &constraint);
-						array_push(constraints, constraint);
-					}
-					array_free(contacts);
+			PROFILE_BEGIN(PROFILE_PHASE_NARROWPHASE);
+			Narrowphase_Pair* narrowphase_pairs = get_narrowphase_pairs(broad_collision_pairs, arena);
+			PROFILE_BEGIN(PROFILE_PHASE_COLLIDER_UPDATE);
+			update_colliders(narrowphase_pairs, arena);
+			PROFILE_END(PROFILE_PHASE_COLLIDER_UPDATE);
+			if (narrowphase_callback) {
+				for (u32 j = 0; j < array_length(narrowphase_pairs); ++j) {
+					narrowphase_callback(narrowphase_pairs[j].e1, narrowphase_pairs[j].e2, i, narrowphase_callback_data);
 				}
 			}
+			u32 num_external_constraints = array_length(constraints);
+			statistics.num_narrowphase_hits += collect_collision_constraints(narrowphase_pairs, &constraints, arena);
+			statistics.num_narrowphase_pairs += array_length(narrowphase_pairs);
+			statistics.num_contacts += array_length(constraints) - num_external_constraints;
+			PROFILE_END_WITH_ARG(PROFILE_PHASE_NARROWPHASE, "contacts", array_length(constraints) - num_external_constraints);
+		}
+		statistics.num_constraints += array_length(constraints);
+		for (u32 j = 0; j < array_length(constraints); ++j) {
+			++statistics.num_constraints_by_type[constraints[j].type];
 		}
 
 		// Now we run the PBD solver with NUM_POS_ITERS iterations
+		memory_tracker_set_phase(MEMORY_PHASE_SOLVE);
+		PROFILE_BEGIN(PROFILE_PHASE_POSITION_SOLVE);
 		for (u32 j = 0; j < num_pos_iters; ++j) {
 			for (u32 k = 0; k < array_length(constraints); ++k) {
 				Constraint* constraint = &constraints[k];
 				solve_constraint(constraint, h);
 			}	
 		}
+		PROFILE_END_WITH_ARG(PROFILE_PHASE_POSITION_SOLVE, "constraints", array_length(constraints));
+
+		for (u32 j = 0; j < array_length(constraints); ++j) {
+			statistics.max_positional_error = MAX(statistics.max_positional_error, get_positional_error(&constraints[j]));
+		}
 
 		// The PBD velocity update
+		memory_tracker_set_phase(MEMORY_PHASE_VELOCITY_SOLVE);
+		PROFILE_BEGIN(PROFILE_PHASE_VELOCITY_SOLVE);
 		for (u32 j = 0; j < array_length(entities); ++j) {
 			Entity* e = entities[j];
 			if (e->fixed) continue;
@@ -739,9 +933,37 @@ void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* extern
 			}
 		}
 
-		array_free(constraints);
+		PROFILE_END(PROFILE_PHASE_VELOCITY_SOLVE);
+		arena_reset_to_marker(arena, substep_marker);
+	}
+
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		if (entities[i]->fixed) {
+			++statistics.num_fixed_bodies;
+		} else if (entities[i]->active) {
+			++statistics.num_active_bodies;
+		} else {
+			++statistics.num_sleeping_bodies;
+		}
+	}
+
+	GJK_Statistics gjk_statistics_end;
+	Epa_Statistics epa_statistics_end;
+	gjk_get_statistics(&gjk_statistics_end);
+	epa_get_statistics(&epa_statistics_end);
+	statistics.num_gjk_failures = gjk_statistics_end.num_failures - gjk_statistics_begin.num_failures;
+	statistics.num_epa_iterations = epa_statistics_end.num_iterations - epa_statistics_begin.num_iterations;
+	statistics.num_epa_failures = epa_statistics_end.num_failures - epa_statistics_begin.num_failures;
+
+	last_step_statistics = statistics;
+	if (out_statistics) {
+		*out_statistics = statistics;
 	}
 
-	array_free(broad_collision_pairs);
+	sat_cache_end_step();
+	arena_reset(arena);
+	memory_tracker_end_step();
+	PROFILE_END_WITH_ARG(PROFILE_PHASE_STEP, "bodies", statistics.num_bodies);
+	PROFILE_END_FRAME();
 	//fedisableexcept(FE_INVALID | FE_OVERFLOW);
 }
\ No newline at end of file
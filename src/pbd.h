@@ -19,6 +19,8 @@ typedef enum {
 	SPHERICAL_JOINT_CONSTRAINT
 } Constraint_Type;
 
+#define PBD_NUM_CONSTRAINT_TYPES (SPHERICAL_JOINT_CONSTRAINT + 1)
+
 typedef struct {
 	vec3 r1_lc;
 	vec3 r2_lc;
@@ -90,8 +92,48 @@ typedef struct {
 	};
 } Constraint;
 
+// What a step did. Gathering it only costs a few counters and one pass over the constraints at the end of the step, so it is
+// always on.
+typedef struct {
+	u32 num_bodies;
+	// Bodies that are neither fixed nor sleeping
+	u32 num_active_bodies;
+	u32 num_sleeping_bodies;
+	u32 num_fixed_bodies;
+	u32 num_broadphase_pairs;
+	// Only counted when simulation islands are enabled. Every body that is not fixed is in exactly one island.
+	u32 num_islands;
+	u32 largest_island_size;
+	// The narrowphase and the solver run once per substep, so the following counters are summed over all substeps
+	u32 num_narrowphase_pairs;
+	// Narrowphase pairs that generated at least one contact
+	u32 num_narrowphase_hits;
+	u32 num_contacts;
+	// Collision constraints plus the external constraints
+	u32 num_constraints;
+	// Indexed by Constraint_Type, adds up to 'num_constraints'
+	u32 num_constraints_by_type[PBD_NUM_CONSTRAINT_TYPES];
+	// GJK and EPA calls made by the narrowphase of this step, see 'GJK_Statistics' and 'Epa_Statistics'
+	u32 num_gjk_failures;
+	u32 num_epa_iterations;
+	u32 num_epa_failures;
+	// The largest violation of a positional constraint (penetration for contacts, distance between the attachment points for
+	// joints) left after the position solve of any substep. Orientation constraints are not included.
+	r64 max_positional_error;
+} Pbd_Step_Statistics;
+
+// Called for every pair of entities that goes through the narrowphase, right before it runs, with the entities at the poses
+// that the narrowphase sees. 'substep' is the index of the substep in the step. Meant for tools, e.g. to record these poses.
+typedef void (*Pbd_Narrowphase_Callback)(const Entity* e1, const Entity* e2, u32 substep, void* data);
+
 void pbd_simulate(r64 dt, Entity** entities, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions);
-void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* external_constraints, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions);
+// 'statistics' is optional, if it is not NULL it gets the statistics of the step.
+void pbd_simulate_with_constraints(r64 dt, Entity** entities, Constraint* external_constraints, u32 num_substeps, u32 num_pos_iters, boolean enable_collisions,
+	Pbd_Step_Statistics* statistics);
+// Statistics of the last step that finished.
+void pbd_get_last_step_statistics(Pbd_Step_Statistics* statistics);
+// Pass NULL to remove the callback.
+void pbd_set_narrowphase_callback(Pbd_Narrowphase_Callback callback, void* data);
 
 void pbd_positional_constraint_init(Constraint* constraint, eid e1_id, eid e2_id, vec3 r1_lc, vec3 r2_lc, r64 compliance, vec3 distance);
 void pbd_mutual_orientation_constraint_init(Constraint* constraint, eid e1_id, eid e2_id, r64 compliance);
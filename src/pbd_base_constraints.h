@@ -1,6 +1,6 @@
 #ifndef RAW_PHYSICS_PHYSICS_PBD_BASE_CONSTRAINTS_H
 #define RAW_PHYSICS_PHYSICS_PBD_BASE_CONSTRAINTS_H
-#include "graphics.h"
+#include "entity.h"
 
 typedef struct {
 	Entity* e1;
@@ -0,0 +1,298 @@
+#include "physics_thread.h"
+#include "light_array.h"
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Late steps that are run back to back before giving up on catching up with real time
+#define MAX_CATCH_UP_STEPS 4
+
+// The index of the snapshot that is neither being written nor read, and whether it is newer than the one being read
+#define SNAPSHOT_INDEX_MASK 3
+#define SNAPSHOT_NEW_BIT 4
+
+typedef struct {
+	Physics_Command_Func func;
+	void* data;
+} Physics_Command;
+
+static std::thread thread;
+static std::mutex mutex;
+// Wakes the physics thread up when there are commands, when it is paused or resumed, or when it must stop
+static std::condition_variable wake_up;
+// Signaled by the physics thread when it parks after a pause
+static std::condition_variable parked_changed;
+// Everything below is protected by the mutex, unless noted otherwise
+static boolean running;
+static boolean stop_requested;
+static u32 pause_count;
+static boolean parked;
+static r64 step_delta_time;
+static Physics_Thread_Step_Func step_func;
+// Light array
+static Physics_Command* pending_commands;
+
+// Triple buffer. The writer owns 'write_index', the reader owns 'read_index', and they trade buffers with 'shared_index'.
+// The writer is the physics thread, or whoever holds the mutex while it is parked.
+static Physics_Snapshot snapshots[3];
+static u32 write_index;
+static u32 read_index;
+static std::atomic<u32> shared_index;
+static u64 step_index;
+// Light array, only used by the writer. The poses before the step being run.
+static Physics_Body_Transform* previous_poses;
+
+r64 physics_thread_get_time() {
+	return std::chrono::duration<r64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void record_poses(Physics_Body_Transform** poses) {
+	array_clear(*poses);
+	Entity** entities = entity_get_all();
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		const Entity* entity = entities[i];
+		Physics_Body_Transform pose;
+		pose.id = entity->id;
+		pose.previous_world_position = entity->world_position;
+		pose.previous_world_rotation = entity->world_rotation;
+		pose.world_position = entity->world_position;
+		pose.world_rotation = entity->world_rotation;
+		array_push(*poses, pose);
+	}
+	array_free(entities);
+}
+
+// Fills the write snapshot with the current poses, paired with 'previous_poses', and hands it to the reader
+static void publish(r64 delta_time) {
+	Physics_Snapshot* snapshot = &snapshots[write_index];
+	record_poses(&snapshot->bodies);
+
+	// Entities keep their order from step to step, unless some were destroyed or created in between
+	u32 num_previous = array_length(previous_poses);
+	u32 previous_idx = 0;
+	for (u32 i = 0; i < array_length(snapshot->bodies); ++i) {
+		Physics_Body_Transform* pose = &snapshot->bodies[i];
+		u32 match_idx = previous_idx;
+		if (match_idx >= num_previous || previous_poses[match_idx].id != pose->id) {
+			// Out of order, or past the end of the previous poses: search all of them. The cursor only moves on a match,
+			// so a new entity doesn't stop the lookup for the entities after it.
+			match_idx = num_previous;
+			for (u32 j = 0; j < num_previous; ++j) {
+				if (previous_poses[j].id == pose->id) {
+					match_idx = j;
+					break;
+				}
+			}
+		}
+
+		if (match_idx < num_previous) {
+			pose->previous_world_position = previous_poses[match_idx].world_position;
+			pose->previous_world_rotation = previous_poses[match_idx].world_rotation;
+			previous_idx = match_idx + 1;
+		} else {
+			// Created by the last step, so it is drawn where it is instead of being interpolated
+			pose->previous_world_position = pose->world_position;
+			pose->previous_world_rotation = pose->world_rotation;
+		}
+	}
+
+	snapshot->step_index = step_index;
+	snapshot->delta_time = delta_time;
+	snapshot->publish_time = physics_thread_get_time();
+	write_index = shared_index.exchange(write_index | SNAPSHOT_NEW_BIT, std::memory_order_acq_rel) & SNAPSHOT_INDEX_MASK;
+}
+
+const Physics_Snapshot* physics_thread_acquire_snapshot() {
+	if (shared_index.load(std::memory_order_relaxed) & SNAPSHOT_NEW_BIT) {
+		read_index = shared_index.exchange(read_index, std::memory_order_acq_rel) & SNAPSHOT_INDEX_MASK;
+	}
+	return &snapshots[read_index];
+}
+
+r64 physics_snapshot_get_alpha(const Physics_Snapshot* snapshot) {
+	if (snapshot->delta_time <= 0.0) {
+		return 1.0;
+	}
+	r64 alpha = (physics_thread_get_time() - snapshot->publish_time) / snapshot->delta_time;
+	return CLAMP(alpha, 0.0, 1.0);
+}
+
+static void run_commands(Physics_Command* commands) {
+	for (u32 i = 0; i < array_length(commands); ++i) {
+		commands[i].func(commands[i].data);
+		free(commands[i].data);
+	}
+	array_clear(commands);
+}
+
+static void thread_main() {
+	// Commands are swapped out of the queue, so that they can run without holding the mutex
+	Physics_Command* commands = array_new(Physics_Command);
+	r64 next_step_time = physics_thread_get_time();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		if (array_length(pending_commands) > 0) {
+			Physics_Command* swap = commands;
+			commands = pending_commands;
+			pending_commands = swap;
+			lock.unlock();
+			run_commands(commands);
+			lock.lock();
+			continue;
+		}
+
+		if (stop_requested) {
+			break;
+		}
+
+		if (pause_count > 0) {
+			parked = true;
+			parked_changed.notify_all();
+			wake_up.wait(lock);
+			parked = false;
+			// Don't catch up with the time spent paused
+			next_step_time = physics_thread_get_time();
+			continue;
+		}
+
+		r64 now = physics_thread_get_time();
+		if (now < next_step_time) {
+			std::chrono::duration<r64> wait_time(next_step_time - now);
+			wake_up.wait_for(lock, wait_time);
+			continue;
+		}
+
+		r64 delta_time = step_delta_time;
+		Physics_Thread_Step_Func step = step_func;
+		lock.unlock();
+
+		record_poses(&previous_poses);
+		step(delta_time);
+		++step_index;
+		publish(delta_time);
+
+		lock.lock();
+		next_step_time += delta_time;
+		if (physics_thread_get_time() - next_step_time > MAX_CATCH_UP_STEPS * delta_time) {
+			next_step_time = physics_thread_get_time();
+		}
+	}
+	lock.unlock();
+
+	array_free(commands);
+	arena_destroy_scratch();
+}
+
+void physics_thread_start(Physics_Thread_Step_Func step, r64 delta_time) {
+	assert(!running);
+	for (u32 i = 0; i < 3; ++i) {
+		snapshots[i].bodies = array_new(Physics_Body_Transform);
+		snapshots[i].step_index = 0;
+		snapshots[i].delta_time = delta_time;
+		snapshots[i].publish_time = 0.0;
+	}
+	write_index = 0;
+	read_index = 1;
+	shared_index.store(2, std::memory_order_relaxed);
+	step_index = 0;
+	previous_poses = array_new(Physics_Body_Transform);
+	pending_commands = array_new(Physics_Command);
+
+	// So that there is something to draw before the first step
+	record_poses(&previous_poses);
+	publish(delta_time);
+
+	step_func = step;
+	step_delta_time = delta_time;
+	stop_requested = false;
+	pause_count = 0;
+	parked = false;
+	running = true;
+	thread = std::thread(thread_main);
+}
+
+void physics_thread_stop() {
+	assert(running);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop_requested = true;
+	}
+	wake_up.notify_one();
+	thread.join();
+
+	running = false;
+	for (u32 i = 0; i < 3; ++i) {
+		array_free(snapshots[i].bodies);
+	}
+	array_free(previous_poses);
+	array_free(pending_commands);
+}
+
+boolean physics_thread_is_running() {
+	return running;
+}
+
+void physics_thread_set_delta_time(r64 delta_time) {
+	std::lock_guard<std::mutex> lock(mutex);
+	step_delta_time = delta_time;
+}
+
+void physics_thread_pause() {
+	if (!running) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	++pause_count;
+	wake_up.notify_one();
+	parked_changed.wait(lock, [] { return parked; });
+}
+
+void physics_thread_resume() {
+	if (!running) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(pause_count > 0 && parked);
+		if (pause_count == 1) {
+			// The physics thread can't leave its wait while we hold the mutex, so we can be the writer
+			record_poses(&previous_poses);
+			publish(step_delta_time);
+			// Until the physics thread gets the mutex back, a new pause must not take it for parked: it would run the
+			// queued commands before parking again
+			parked = false;
+		}
+		--pause_count;
+	}
+	wake_up.notify_one();
+}
+
+void physics_thread_push_command(Physics_Command_Func func, const void* data, u32 size) {
+	Physics_Command command;
+	command.func = func;
+	command.data = malloc(MAX(size, 1));
+	if (size > 0) {
+		memcpy(command.data, data, size);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (running && pause_count == 0 && std::this_thread::get_id() != thread.get_id()) {
+			array_push(pending_commands, command);
+			wake_up.notify_one();
+			return;
+		}
+	}
+
+	func(command.data);
+	free(command.data);
+}
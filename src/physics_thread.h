@@ -0,0 +1,59 @@
+#ifndef RAW_PHYSICS_PHYSICS_THREAD_H
+#define RAW_PHYSICS_PHYSICS_THREAD_H
+#include "common.h"
+#include "entity.h"
+
+// Steps the simulation on a thread of its own at a fixed rate, so that the time a step takes doesn't add to the frames of the
+// application. After every step, the poses of all entities are published to a triple buffer, which the application reads
+// without locking and interpolates between the last two steps (see 'physics_snapshot_get_alpha').
+//
+// While the thread runs, entities must only be touched by it. The application queues commands instead, which run on the
+// physics thread before the next step. Work that can't be queued (e.g. loading a scene) is done with the thread paused.
+
+// Steps the simulation once, called by the physics thread
+typedef void (*Physics_Thread_Step_Func)(r64 delta_time);
+// 'data' is a copy of what was given to 'physics_thread_push_command', freed once the command has run
+typedef void (*Physics_Command_Func)(void* data);
+
+typedef struct {
+	eid id;
+	// Before and after the last step. Entities created by the last step have both set to the same pose.
+	vec3 previous_world_position;
+	Quaternion previous_world_rotation;
+	vec3 world_position;
+	Quaternion world_rotation;
+} Physics_Body_Transform;
+
+typedef struct {
+	// Light array, one per entity
+	Physics_Body_Transform* bodies;
+	// Number of steps taken since the thread was started
+	u64 step_index;
+	r64 delta_time;
+	// When the step was done, on the clock of 'physics_thread_get_time'
+	r64 publish_time;
+} Physics_Snapshot;
+
+// Steps are run every 'delta_time' seconds. Late steps are run back to back to catch up, but only a few: past that, the
+// simulation slows down instead of spiraling when a step takes longer than 'delta_time'.
+void physics_thread_start(Physics_Thread_Step_Func step, r64 delta_time);
+// Runs the commands that are still queued and joins the thread.
+void physics_thread_stop();
+boolean physics_thread_is_running();
+void physics_thread_set_delta_time(r64 delta_time);
+// Runs the commands that are still queued and blocks until the thread waits between two steps. Pauses nest.
+void physics_thread_pause();
+// Publishes the current poses, so that entities created or destroyed while paused are drawn right away.
+void physics_thread_resume();
+// Queues 'func' to run on the physics thread before the next step, with a copy of the 'size' bytes at 'data'.
+// When the thread isn't running or is paused, or when called from the physics thread, 'func' runs right away.
+void physics_thread_push_command(Physics_Command_Func func, const void* data, u32 size);
+// Returns the latest snapshot, which stays valid until the next call. Never blocks. Must always be called by the same thread.
+const Physics_Snapshot* physics_thread_acquire_snapshot();
+// Seconds on a monotonic clock
+r64 physics_thread_get_time();
+// How far the poses to draw now are from the previous to the current poses of 'snapshot', in [0, 1].
+// Drawing the interpolated poses keeps motion smooth when frames and steps don't line up, at the cost of one step of latency.
+r64 physics_snapshot_get_alpha(const Physics_Snapshot* snapshot);
+
+#endif
@@ -34,7 +34,9 @@ mat3 get_dynamic_inertia_tensor(Entity* e) {
 	// Can always be used
 	mat3 local_to_world = quaternion_get_matrix3(&e->world_rotation);
 	mat3 inverse_local_to_world;
-	assert(gm_mat3_inverse(&local_to_world, &inverse_local_to_world));
+	boolean invertible = gm_mat3_inverse(&local_to_world, &inverse_local_to_world);
+	assert(invertible);
+	(void)invertible;
 	mat3 transposed_inverse_local_to_world = gm_mat3_transpose(&inverse_local_to_world);
 	mat3 aux = gm_mat3_multiply(&transposed_inverse_local_to_world, &e->inertia_tensor);
 	return gm_mat3_multiply(&aux, &inverse_local_to_world);
@@ -53,7 +55,9 @@ mat3 get_dynamic_inverse_inertia_tensor(Entity* e) {
 	// Can always be used
 	mat3 local_to_world = quaternion_get_matrix3(&e->world_rotation);
 	mat3 inverse_local_to_world;
-	assert(gm_mat3_inverse(&local_to_world, &inverse_local_to_world));
+	boolean invertible = gm_mat3_inverse(&local_to_world, &inverse_local_to_world);
+	assert(invertible);
+	(void)invertible;
 	mat3 transposed_inverse_local_to_world = gm_mat3_transpose(&inverse_local_to_world);
 	mat3 aux = gm_mat3_multiply(&transposed_inverse_local_to_world, &e->inverse_inertia_tensor);
 	return gm_mat3_multiply(&aux, &inverse_local_to_world);
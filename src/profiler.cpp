@@ -0,0 +1,447 @@
+#include "profiler.h"
+
+#ifdef RAW_PHYSICS_PROFILE
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Phases inside the narrowphase run in the workers of the thread pool. Each thread sums the timings of the current step in an
+// accumulator of its own, on its own cache line, and 'profiler_end_frame' merges them. Only the owner adds to an accumulator;
+// the fields are atomic because the merge reads them from another thread.
+#define PROFILER_MAX_THREADS 64
+
+typedef struct alignas(64) {
+	std::atomic<u64> time[PROFILE_PHASE_COUNT];
+	std::atomic<u32> calls[PROFILE_PHASE_COUNT];
+	std::atomic<boolean> is_used;
+} Phase_Accumulator;
+
+// A thread that exits gives its accumulator back, and what it still holds goes into the next frame.
+typedef struct Thread_Accumulator {
+	Phase_Accumulator* accumulator;
+	// Threads beyond PROFILER_MAX_THREADS share the last accumulator
+	boolean is_shared;
+
+	~Thread_Accumulator() {
+		if (accumulator && !is_shared) {
+			accumulator->is_used.store(false, std::memory_order_release);
+		}
+	}
+} Thread_Accumulator;
+
+static Phase_Accumulator accumulators[PROFILER_MAX_THREADS + 1];
+static thread_local Thread_Accumulator thread_accumulator;
+
+// Written at the end of each step, while the application may be copying them from another thread
+static std::mutex frames_mutex;
+static Profile_Frame frames[PROFILER_NUM_FRAMES];
+// Where the next frame goes
+static u32 next_frame;
+static u32 num_frames;
+
+static const u32 phase_depths[PROFILE_PHASE_COUNT] = {
+	0, // PROFILE_PHASE_STEP
+	1, // PROFILE_PHASE_BROADPHASE
+	1, // PROFILE_PHASE_ISLANDS
+	1, // PROFILE_PHASE_SLEEP
+	1, // PROFILE_PHASE_INTEGRATION
+	1, // PROFILE_PHASE_NARROWPHASE
+	2, // PROFILE_PHASE_COLLIDER_UPDATE
+	2, // PROFILE_PHASE_SAT
+	2, // PROFILE_PHASE_GJK
+	2, // PROFILE_PHASE_EPA
+	2, // PROFILE_PHASE_CLIPPING
+	1, // PROFILE_PHASE_POSITION_SOLVE
+	1, // PROFILE_PHASE_VELOCITY_SOLVE
+};
+
+typedef struct {
+	u64 begin_time;
+	u64 end_time;
+	const char* arg_name;
+	s64 arg_value;
+	u32 thread_idx;
+	Profile_Phase phase;
+} Trace_Event;
+
+// Only true during the steps of a capture, checked by every scope
+static std::atomic<boolean> is_tracing;
+static Trace_Event* trace_events;
+// Can go past PROFILER_MAX_TRACE_EVENTS, the events after it are dropped
+static std::atomic<u32> num_trace_events;
+static std::atomic<u32> trace_frames_left;
+// Set by 'profiler_capture_trace', the capture starts at the end of the current step
+static std::atomic<u32> requested_trace_frames;
+static s8 trace_path[256];
+static u64 trace_begin_time;
+static boolean is_environment_checked;
+
+// Threads are numbered in the order they first record an event
+static std::atomic<u32> num_trace_threads;
+static thread_local u32 trace_thread_idx = UINT32_MAX;
+
+// Hardware counters, only read by the thread that enabled them. They are grouped, so they all count over the same time
+// and a single read gets all of them.
+static thread_local boolean is_counter_thread;
+static s32 counter_group_fd = -1;
+static s32 counter_fds[PROFILE_COUNTER_COUNT];
+// Where each counter is in the values of the group, or -1 if it could not be opened
+static s32 counter_positions[PROFILE_COUNTER_COUNT];
+static u32 num_open_counters;
+static u64 phase_counters_begin[PROFILE_PHASE_COUNT][PROFILE_COUNTER_COUNT];
+static u64 current_phase_counters[PROFILE_PHASE_COUNT][PROFILE_COUNTER_COUNT];
+
+// Only the step and the phases directly inside it, since reading the counters is a system call
+static boolean has_counters(Profile_Phase phase) {
+	return is_counter_thread && phase_depths[phase] <= 1;
+}
+
+static void read_counters(u64 values[PROFILE_COUNTER_COUNT]) {
+	memset(values, 0, PROFILE_COUNTER_COUNT * sizeof(u64));
+#if defined(__linux__)
+	// With PERF_FORMAT_GROUP, the group gives the number of counters followed by their values
+	u64 buffer[1 + PROFILE_COUNTER_COUNT];
+	ssize_t size = read(counter_group_fd, buffer, sizeof(buffer));
+	if (size < (ssize_t)((1 + num_open_counters) * sizeof(u64))) {
+		return;
+	}
+
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+		if (counter_positions[i] >= 0) {
+			values[i] = buffer[1 + counter_positions[i]];
+		}
+	}
+#endif
+}
+
+u64 profiler_get_time() {
+	return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void add_trace_event(Profile_Phase phase, u64 begin_time, u64 end_time, const char* arg_name, s64 arg_value) {
+	if (trace_thread_idx == UINT32_MAX) {
+		trace_thread_idx = num_trace_threads.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	u32 event_idx = num_trace_events.fetch_add(1, std::memory_order_relaxed);
+	if (event_idx >= PROFILER_MAX_TRACE_EVENTS) {
+		return;
+	}
+
+	Trace_Event* event = &trace_events[event_idx];
+	event->begin_time = begin_time;
+	event->end_time = end_time;
+	event->arg_name = arg_name;
+	event->arg_value = arg_value;
+	event->thread_idx = trace_thread_idx;
+	event->phase = phase;
+}
+
+static Thread_Accumulator* get_thread_accumulator() {
+	Thread_Accumulator* t = &thread_accumulator;
+	if (!t->accumulator) {
+		for (u32 i = 0; i < PROFILER_MAX_THREADS; ++i) {
+			boolean is_used = false;
+			if (accumulators[i].is_used.compare_exchange_strong(is_used, true, std::memory_order_acquire)) {
+				t->accumulator = &accumulators[i];
+				break;
+			}
+		}
+		if (!t->accumulator) {
+			t->accumulator = &accumulators[PROFILER_MAX_THREADS];
+			t->is_shared = true;
+		}
+	}
+	return t;
+}
+
+u64 profiler_begin(Profile_Phase phase) {
+	if (has_counters(phase)) {
+		read_counters(phase_counters_begin[phase]);
+	}
+	return profiler_get_time();
+}
+
+void profiler_add(Profile_Phase phase, u64 begin_time, u64 end_time, const char* arg_name, s64 arg_value) {
+	Thread_Accumulator* t = get_thread_accumulator();
+	Phase_Accumulator* accumulator = t->accumulator;
+	if (t->is_shared) {
+		accumulator->time[phase].fetch_add(end_time - begin_time, std::memory_order_relaxed);
+		accumulator->calls[phase].fetch_add(1, std::memory_order_relaxed);
+	} else {
+		// No other thread adds to it, so there is no need for a locked read-modify-write
+		accumulator->time[phase].store(accumulator->time[phase].load(std::memory_order_relaxed) + end_time - begin_time,
+			std::memory_order_relaxed);
+		accumulator->calls[phase].store(accumulator->calls[phase].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	if (has_counters(phase)) {
+		u64 counters[PROFILE_COUNTER_COUNT];
+		read_counters(counters);
+		for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+			current_phase_counters[phase][i] += counters[i] - phase_counters_begin[phase][i];
+		}
+	}
+
+	if (is_tracing.load(std::memory_order_relaxed)) {
+		add_trace_event(phase, begin_time, end_time, arg_name, arg_value);
+	}
+}
+
+static void start_trace(u32 num_frames) {
+	trace_events = (Trace_Event*)malloc(PROFILER_MAX_TRACE_EVENTS * sizeof(Trace_Event));
+	if (!trace_events) {
+		fprintf(stderr, "Error allocating trace events: [%s]\n", strerror(errno));
+		return;
+	}
+
+	num_trace_events = 0;
+	trace_frames_left = num_frames;
+	trace_begin_time = profiler_get_time();
+	is_tracing = true;
+}
+
+// Chrome Trace Event format, with one complete ('X') event per scope and timestamps in microseconds
+static void write_trace() {
+	FILE* file = fopen(trace_path, "w");
+	if (!file) {
+		fprintf(stderr, "Error opening file [%s]: [%s]\n", trace_path, strerror(errno));
+		return;
+	}
+
+	u32 num_events = MIN(num_trace_events.load(), PROFILER_MAX_TRACE_EVENTS);
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"raw_physics\"}}");
+	for (u32 i = 0; i < num_events; ++i) {
+		const Trace_Event* event = &trace_events[i];
+		fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"physics\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+			profiler_get_phase_name(event->phase), event->thread_idx, (event->begin_time - trace_begin_time) / 1e3,
+			(event->end_time - event->begin_time) / 1e3);
+		if (event->arg_name) {
+			fprintf(file, ",\"args\":{\"%s\":%lld}", event->arg_name, (long long)event->arg_value);
+		}
+		fprintf(file, "}");
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	if (num_trace_events > PROFILER_MAX_TRACE_EVENTS) {
+		fprintf(stderr, "Trace [%s] is missing %u events, only %u can be recorded\n", trace_path,
+			num_trace_events - PROFILER_MAX_TRACE_EVENTS, PROFILER_MAX_TRACE_EVENTS);
+	}
+}
+
+static void end_trace() {
+	is_tracing = false;
+	write_trace();
+	free(trace_events);
+	trace_events = NULL;
+}
+
+void profiler_end_frame() {
+	if (!is_environment_checked) {
+		is_environment_checked = true;
+		const char* frames = getenv("RAW_PHYSICS_TRACE_FRAMES");
+		if (frames && atoi(frames) > 0) {
+			const char* path = getenv("RAW_PHYSICS_TRACE_PATH");
+			profiler_capture_trace((u32)atoi(frames), path ? path : "trace.json");
+		}
+	}
+
+	if (is_tracing && --trace_frames_left == 0) {
+		end_trace();
+	}
+
+	u32 num_requested_frames = requested_trace_frames.exchange(0);
+	if (!is_tracing && num_requested_frames > 0) {
+		start_trace(num_requested_frames);
+	}
+
+	// The workers are done with the step, since the thread pool waits for them at the end of each parallel loop
+	Profile_Frame frame = {};
+	for (u32 i = 0; i <= PROFILER_MAX_THREADS; ++i) {
+		Phase_Accumulator* accumulator = &accumulators[i];
+		for (u32 j = 0; j < PROFILE_PHASE_COUNT; ++j) {
+			frame.phase_time[j] += accumulator->time[j].exchange(0, std::memory_order_relaxed);
+			frame.phase_calls[j] += accumulator->calls[j].exchange(0, std::memory_order_relaxed);
+		}
+	}
+	memcpy(frame.phase_counters, current_phase_counters, sizeof(current_phase_counters));
+	memset(current_phase_counters, 0, sizeof(current_phase_counters));
+
+	std::lock_guard<std::mutex> lock(frames_mutex);
+	frames[next_frame] = frame;
+	next_frame = (next_frame + 1) % PROFILER_NUM_FRAMES;
+	if (num_frames < PROFILER_NUM_FRAMES) {
+		++num_frames;
+	}
+}
+
+const char* profiler_get_phase_name(Profile_Phase phase) {
+	switch (phase) {
+		case PROFILE_PHASE_STEP: return "Step";
+		case PROFILE_PHASE_BROADPHASE: return "Broadphase";
+		case PROFILE_PHASE_ISLANDS: return "Islands";
+		case PROFILE_PHASE_SLEEP: return "Sleep";
+		case PROFILE_PHASE_INTEGRATION: return "Integration";
+		case PROFILE_PHASE_NARROWPHASE: return "Narrowphase";
+		case PROFILE_PHASE_COLLIDER_UPDATE: return "Collider update";
+		case PROFILE_PHASE_SAT: return "SAT";
+		case PROFILE_PHASE_GJK: return "GJK";
+		case PROFILE_PHASE_EPA: return "EPA";
+		case PROFILE_PHASE_CLIPPING: return "Clipping";
+		case PROFILE_PHASE_POSITION_SOLVE: return "Position solve";
+		case PROFILE_PHASE_VELOCITY_SOLVE: return "Velocity solve";
+		default: return "Unknown";
+	}
+}
+
+u32 profiler_get_phase_depth(Profile_Phase phase) {
+	return phase_depths[phase];
+}
+
+u32 profiler_get_num_frames() {
+	return num_frames;
+}
+
+const Profile_Frame* profiler_get_frame(u32 index) {
+	assert(index < num_frames);
+	u32 oldest_frame = (next_frame + PROFILER_NUM_FRAMES - num_frames) % PROFILER_NUM_FRAMES;
+	return &frames[(oldest_frame + index) % PROFILER_NUM_FRAMES];
+}
+
+u32 profiler_copy_frames(Profile_Frame* copied_frames) {
+	std::lock_guard<std::mutex> lock(frames_mutex);
+	for (u32 i = 0; i < num_frames; ++i) {
+		copied_frames[i] = *profiler_get_frame(i);
+	}
+	return num_frames;
+}
+
+void profiler_capture_trace(u32 num_frames, const char* path) {
+	if (num_frames == 0 || profiler_get_trace_frames_left() > 0) {
+		return;
+	}
+
+	snprintf(trace_path, sizeof(trace_path), "%s", path);
+	requested_trace_frames = num_frames;
+}
+
+u32 profiler_get_trace_frames_left() {
+	return is_tracing ? trace_frames_left.load() : requested_trace_frames.load();
+}
+
+#if defined(__linux__)
+// Counts the calling thread, on any CPU, in user space only (so it works with the default perf_event_paranoid).
+static s32 open_counter(u32 type, u64 config, s32 group_fd) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	// The whole group is enabled at once through its leader
+	attr.disabled = group_fd == -1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return (s32)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+boolean profiler_enable_hardware_counters() {
+	if (counter_group_fd != -1) {
+		return is_counter_thread;
+	}
+
+#if defined(__linux__)
+	const struct {
+		u32 type;
+		u64 config;
+	} events[PROFILE_COUNTER_COUNT] = {
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+		{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	};
+
+	num_open_counters = 0;
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+		counter_fds[i] = open_counter(events[i].type, events[i].config, counter_group_fd);
+		counter_positions[i] = -1;
+		if (counter_fds[i] == -1) {
+			continue;
+		}
+
+		// The first counter that opens leads the group
+		if (counter_group_fd == -1) {
+			counter_group_fd = counter_fds[i];
+		}
+		counter_positions[i] = (s32)num_open_counters++;
+	}
+
+	// errno is left by the last counter that failed
+	if (counter_group_fd == -1) {
+		return false;
+	}
+
+	ioctl(counter_group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(counter_group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	is_counter_thread = true;
+	return true;
+#else
+	errno = ENOSYS;
+	return false;
+#endif
+}
+
+void profiler_disable_hardware_counters() {
+	if (counter_group_fd == -1) {
+		return;
+	}
+
+	assert(is_counter_thread);
+	is_counter_thread = false;
+#if defined(__linux__)
+	// Members first, the leader last
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+		if (counter_fds[i] != -1 && counter_fds[i] != counter_group_fd) {
+			close(counter_fds[i]);
+		}
+	}
+	close(counter_group_fd);
+#endif
+	counter_group_fd = -1;
+	num_open_counters = 0;
+	for (u32 i = 0; i < PROFILE_COUNTER_COUNT; ++i) {
+		counter_positions[i] = -1;
+	}
+}
+
+boolean profiler_has_hardware_counter(Profile_Counter counter) {
+	return counter_group_fd != -1 && counter_positions[counter] >= 0;
+}
+
+const char* profiler_get_counter_name(Profile_Counter counter) {
+	switch (counter) {
+		case PROFILE_COUNTER_CYCLES: return "cycles";
+		case PROFILE_COUNTER_INSTRUCTIONS: return "instructions";
+		case PROFILE_COUNTER_L1D_MISSES: return "l1d_misses";
+		case PROFILE_COUNTER_LLC_MISSES: return "llc_misses";
+		case PROFILE_COUNTER_BRANCH_MISSES: return "branch_misses";
+		default: return "unknown";
+	}
+}
+
+#endif
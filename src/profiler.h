@@ -0,0 +1,133 @@
+#ifndef RAW_PHYSICS_PROFILER_H
+#define RAW_PHYSICS_PROFILER_H
+#include "common.h"
+#include <stddef.h>
+
+// Scoped timers around the phases of the simulation step. The time of each phase is summed over a whole step (including the
+// time spent by the workers of the thread pool, so phases that run in parallel can add up to more than the step itself) and
+// kept for the last PROFILER_NUM_FRAMES steps.
+//
+// A trace of every single scope, with its thread and timestamps, can also be captured for a number of steps and written as
+// Chrome Trace Event JSON (open it in https://ui.perfetto.dev or chrome://tracing). Captures are started by
+// 'profiler_capture_trace', or by setting the environment variable RAW_PHYSICS_TRACE_FRAMES to a number of steps (the file is
+// then RAW_PHYSICS_TRACE_PATH, or "trace.json" if it is not set).
+//
+// On Linux, hardware performance counters (cycles, instructions, cache and branch misses) can be enabled as well. They are
+// read with perf events at the beginning and the end of the step and of the phases directly inside it, so they tell whether
+// a phase is compute-bound or memory-bound. Counters only count the thread that enabled them, i.e. the simulation thread,
+// so the share of the thread pool workers in parallel phases is missing. Run with a single thread to count everything.
+//
+// All instrumentation is compiled out unless RAW_PHYSICS_PROFILE is defined.
+
+#define PROFILER_NUM_FRAMES 240
+// Events after this many are dropped from a trace capture
+#define PROFILER_MAX_TRACE_EVENTS (1 << 20)
+
+// Phases are listed depth first, each one right after its parent.
+typedef enum {
+	PROFILE_PHASE_STEP,
+	PROFILE_PHASE_BROADPHASE,
+	PROFILE_PHASE_ISLANDS,
+	PROFILE_PHASE_SLEEP,
+	PROFILE_PHASE_INTEGRATION,
+	PROFILE_PHASE_NARROWPHASE,
+	PROFILE_PHASE_COLLIDER_UPDATE,
+	PROFILE_PHASE_SAT,
+	PROFILE_PHASE_GJK,
+	PROFILE_PHASE_EPA,
+	PROFILE_PHASE_CLIPPING,
+	PROFILE_PHASE_POSITION_SOLVE,
+	PROFILE_PHASE_VELOCITY_SOLVE,
+	PROFILE_PHASE_COUNT
+} Profile_Phase;
+
+typedef enum {
+	PROFILE_COUNTER_CYCLES,
+	PROFILE_COUNTER_INSTRUCTIONS,
+	// Level 1 data cache read misses
+	PROFILE_COUNTER_L1D_MISSES,
+	// Last level cache misses
+	PROFILE_COUNTER_LLC_MISSES,
+	PROFILE_COUNTER_BRANCH_MISSES,
+	PROFILE_COUNTER_COUNT
+} Profile_Counter;
+
+typedef struct {
+	// Total time of each phase during the step, in nanoseconds
+	u64 phase_time[PROFILE_PHASE_COUNT];
+	// Number of times each scope was entered during the step
+	u32 phase_calls[PROFILE_PHASE_COUNT];
+	// Hardware counters of each phase during the step, only for the phases up to depth 1 and when counters are enabled
+	u64 phase_counters[PROFILE_PHASE_COUNT][PROFILE_COUNTER_COUNT];
+} Profile_Frame;
+
+#ifdef RAW_PHYSICS_PROFILE
+
+// Nanoseconds from a monotonic clock
+u64 profiler_get_time();
+// Returns the time at which the phase begins, which must be passed to 'profiler_add' when the phase ends. Also reads the
+// hardware counters if the phase has any.
+u64 profiler_begin(Profile_Phase phase);
+// 'arg_name' is optional, if it is not NULL the trace event of the scope gets 'arg_value' as an argument.
+void profiler_add(Profile_Phase phase, u64 begin_time, u64 end_time, const char* arg_name, s64 arg_value);
+// Called by the simulation at the end of each step, moves the timings of the step to the ring buffer.
+void profiler_end_frame();
+
+const char* profiler_get_phase_name(Profile_Phase phase);
+// 0 for the step, 1 for the phases directly inside it, and so on
+u32 profiler_get_phase_depth(Profile_Phase phase);
+// Number of frames in the ring buffer, up to PROFILER_NUM_FRAMES.
+u32 profiler_get_num_frames();
+// 'index' 0 is the oldest frame in the ring buffer, and 'profiler_get_num_frames() - 1' the last one. The frame is overwritten
+// by the next steps, so these two must be called from the thread that runs them.
+const Profile_Frame* profiler_get_frame(u32 index);
+// Copies the frames of the ring buffer to 'frames', which has room for PROFILER_NUM_FRAMES, oldest first. Returns the number of
+// frames. Unlike 'profiler_get_frame', it can be called from any thread, even while a step is running.
+u32 profiler_copy_frames(Profile_Frame* frames);
+
+// Records all scopes of the 'num_frames' steps after the current one and writes them to 'path' once they are done.
+// Does nothing if a capture is already running.
+void profiler_capture_trace(u32 num_frames, const char* path);
+// Number of steps that are still going to be recorded, 0 if no capture is running.
+u32 profiler_get_trace_frames_left();
+
+// Opens the hardware counters for the calling thread, which must be the one that runs the simulation steps. Returns false if
+// none of them can be opened, e.g. on other platforms than Linux or when perf events are not allowed (see
+// /proc/sys/kernel/perf_event_paranoid), in which case errno tells why. Some counters may still be missing when it returns true.
+boolean profiler_enable_hardware_counters();
+void profiler_disable_hardware_counters();
+boolean profiler_has_hardware_counter(Profile_Counter counter);
+const char* profiler_get_counter_name(Profile_Counter counter);
+
+typedef struct Profile_Scope {
+	Profile_Phase phase;
+	u64 begin;
+	const char* arg_name;
+	s64 arg_value;
+
+	Profile_Scope(Profile_Phase phase) : phase(phase), begin(profiler_get_time()), arg_name(NULL), arg_value(0) {}
+	~Profile_Scope() { profiler_add(phase, begin, profiler_get_time(), arg_name, arg_value); }
+} Profile_Scope;
+
+// Times the rest of the enclosing block
+#define PROFILE_SCOPE(phase) Profile_Scope profile_scope(phase)
+// Sets the trace argument of the PROFILE_SCOPE of the enclosing block
+#define PROFILE_SCOPE_SET_ARG(name, value) (profile_scope.arg_name = (name), profile_scope.arg_value = (s64)(value))
+// Times the code between the two, which must be in the same block
+#define PROFILE_BEGIN(phase) u64 profile_begin_##phase = profiler_begin(phase)
+#define PROFILE_END(phase) profiler_add(phase, profile_begin_##phase, profiler_get_time(), NULL, 0)
+#define PROFILE_END_WITH_ARG(phase, name, value) profiler_add(phase, profile_begin_##phase, profiler_get_time(), name, (s64)(value))
+#define PROFILE_END_FRAME() profiler_end_frame()
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_SCOPE_SET_ARG(name, value)
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_END_WITH_ARG(phase, name, value)
+#define PROFILE_END_FRAME()
+
+#endif
+
+#endif
@@ -0,0 +1,469 @@
+#include "quickhull.h"
+#include "arena.h"
+#include "light_array.h"
+#include <string.h>
+#include <assert.h>
+#include <float.h>
+
+// Points closer than this to a face, relative to the size of the point cloud, are considered to be on the face
+#define RELATIVE_TOLERANCE 1e-9
+// Triangles are merged into the same polygon if all their vertices are this close to the plane of the polygon, relative to the
+// size of the point cloud
+#define RELATIVE_COPLANAR_TOLERANCE 1e-6
+#define NONE 0xFFFFFFFF
+
+typedef struct {
+	// Counter-clockwise when seen from outside the hull
+	u32 vertices[3];
+	// 'neighbors[i]' is the face on the other side of the edge that goes from 'vertices[i]' to 'vertices[(i + 1) % 3]'
+	u32 neighbors[3];
+	vec3 normal;
+	r64 distance;
+	// Head of the list of points that are outside of this face, linked through 'next_outside'
+	u32 outside_head;
+	u32 visit_mark;
+	boolean deleted;
+} Face;
+
+typedef struct {
+	u32 face;
+	u32 edge;
+} Horizon_Edge;
+
+typedef struct {
+	const vec3* points;
+	u32 num_points;
+	r64 tolerance;
+	r64 coplanar_tolerance;
+	Arena* arena;
+	Face* faces;
+	// Per point
+	u32* next_outside;
+	// Per point, the face being created whose first vertex is the point
+	u32* new_face_by_start;
+	u32 visit_mark;
+	// Reused by every iteration
+	u32* visible_faces;
+	Horizon_Edge* horizon;
+	u32* new_faces;
+} Quickhull;
+
+static r64 get_coordinate(vec3 v, u32 axis) {
+	return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static r64 get_distance_to_face(const Face* face, vec3 point) {
+	return gm_vec3_dot(face->normal, point) - face->distance;
+}
+
+static u32 create_face(Quickhull* qh, u32 a, u32 b, u32 c) {
+	vec3 pa = qh->points[a];
+	vec3 normal = gm_vec3_cross(gm_vec3_subtract(qh->points[b], pa), gm_vec3_subtract(qh->points[c], pa));
+
+	Face face;
+	face.vertices[0] = a;
+	face.vertices[1] = b;
+	face.vertices[2] = c;
+	face.neighbors[0] = face.neighbors[1] = face.neighbors[2] = NONE;
+	face.normal = gm_vec3_normalize(normal);
+	face.distance = gm_vec3_dot(face.normal, pa);
+	face.outside_head = NONE;
+	face.visit_mark = 0;
+	face.deleted = false;
+	array_push(qh->faces, face);
+	return array_length(qh->faces) - 1;
+}
+
+// Adds the point to the outside list of the candidate face it is farthest from. Points that are not outside any of them
+// are inside the hull and are simply dropped.
+static void assign_point(Quickhull* qh, u32 point, const u32* candidate_faces, u32 num_candidate_faces) {
+	r64 max_distance = qh->tolerance;
+	u32 selected_face = NONE;
+	for (u32 i = 0; i < num_candidate_faces; ++i) {
+		r64 distance = get_distance_to_face(&qh->faces[candidate_faces[i]], qh->points[point]);
+		if (distance > max_distance) {
+			max_distance = distance;
+			selected_face = candidate_faces[i];
+		}
+	}
+
+	if (selected_face != NONE) {
+		qh->next_outside[point] = qh->faces[selected_face].outside_head;
+		qh->faces[selected_face].outside_head = point;
+	}
+}
+
+// Finds the edge of 'face' that goes from 'a' to 'b'.
+static u32 get_edge_index(const Face* face, u32 a, u32 b) {
+	for (u32 i = 0; i < 3; ++i) {
+		if (face->vertices[i] == a && face->vertices[(i + 1) % 3] == b) {
+			return i;
+		}
+	}
+
+	assert(0);
+	return NONE;
+}
+
+static boolean build_initial_simplex(Quickhull* qh) {
+	const vec3* points = qh->points;
+
+	// The extreme points along each axis
+	u32 extremes[6] = {0, 0, 0, 0, 0, 0};
+	for (u32 i = 1; i < qh->num_points; ++i) {
+		for (u32 axis = 0; axis < 3; ++axis) {
+			if (get_coordinate(points[i], axis) < get_coordinate(points[extremes[2 * axis]], axis)) {
+				extremes[2 * axis] = i;
+			}
+			if (get_coordinate(points[i], axis) > get_coordinate(points[extremes[2 * axis + 1]], axis)) {
+				extremes[2 * axis + 1] = i;
+			}
+		}
+	}
+
+	// The two extremes that are farthest apart
+	u32 v0 = 0, v1 = 0;
+	r64 max_distance = 0.0;
+	for (u32 i = 0; i < 6; ++i) {
+		for (u32 j = i + 1; j < 6; ++j) {
+			r64 distance = gm_vec3_length(gm_vec3_subtract(points[extremes[i]], points[extremes[j]]));
+			if (distance > max_distance) {
+				max_distance = distance;
+				v0 = extremes[i];
+				v1 = extremes[j];
+			}
+		}
+	}
+	if (max_distance <= qh->tolerance) {
+		return false;
+	}
+
+	// The point that is farthest from the line
+	vec3 direction = gm_vec3_normalize(gm_vec3_subtract(points[v1], points[v0]));
+	u32 v2 = 0;
+	max_distance = 0.0;
+	for (u32 i = 0; i < qh->num_points; ++i) {
+		r64 distance = gm_vec3_length(gm_vec3_cross(direction, gm_vec3_subtract(points[i], points[v0])));
+		if (distance > max_distance) {
+			max_distance = distance;
+			v2 = i;
+		}
+	}
+	if (max_distance <= qh->tolerance) {
+		return false;
+	}
+
+	// The point that is farthest from the plane
+	vec3 normal = gm_vec3_normalize(gm_vec3_cross(gm_vec3_subtract(points[v1], points[v0]), gm_vec3_subtract(points[v2], points[v0])));
+	u32 v3 = 0;
+	max_distance = 0.0;
+	for (u32 i = 0; i < qh->num_points; ++i) {
+		r64 distance = fabs(gm_vec3_dot(normal, gm_vec3_subtract(points[i], points[v0])));
+		if (distance > max_distance) {
+			max_distance = distance;
+			v3 = i;
+		}
+	}
+	if (max_distance <= qh->tolerance) {
+		return false;
+	}
+
+	// The base must face away from the apex
+	if (gm_vec3_dot(normal, gm_vec3_subtract(points[v3], points[v0])) > 0.0) {
+		u32 tmp = v1;
+		v1 = v2;
+		v2 = tmp;
+	}
+
+	u32 faces[4];
+	faces[0] = create_face(qh, v0, v1, v2);
+	faces[1] = create_face(qh, v1, v0, v3);
+	faces[2] = create_face(qh, v2, v1, v3);
+	faces[3] = create_face(qh, v0, v2, v3);
+
+	// Each edge is shared with the face that has the same edge in the opposite direction
+	for (u32 i = 0; i < 4; ++i) {
+		Face* face = &qh->faces[faces[i]];
+		for (u32 e = 0; e < 3; ++e) {
+			u32 a = face->vertices[e];
+			u32 b = face->vertices[(e + 1) % 3];
+			for (u32 j = 0; j < 4; ++j) {
+				const Face* other = &qh->faces[faces[j]];
+				if (j != i && (other->vertices[0] == b || other->vertices[1] == b || other->vertices[2] == b) &&
+					(other->vertices[0] == a || other->vertices[1] == a || other->vertices[2] == a)) {
+					face->neighbors[e] = faces[j];
+				}
+			}
+		}
+	}
+
+	for (u32 i = 0; i < qh->num_points; ++i) {
+		if (i != v0 && i != v1 && i != v2 && i != v3) {
+			assign_point(qh, i, faces, 4);
+		}
+	}
+
+	return true;
+}
+
+static u32 get_farthest_outside_point(const Quickhull* qh, const Face* face) {
+	r64 max_distance = -DBL_MAX;
+	u32 selected_point = NONE;
+	for (u32 point = face->outside_head; point != NONE; point = qh->next_outside[point]) {
+		r64 distance = get_distance_to_face(face, qh->points[point]);
+		if (distance > max_distance) {
+			max_distance = distance;
+			selected_point = point;
+		}
+	}
+
+	return selected_point;
+}
+
+// Adds 'eye' to the hull. 'eye_face' must be one of the faces that the eye is outside of.
+// The faces that can see the eye are deleted, and the hole they leave is filled with a fan of faces that connect the
+// edges of the hole (the horizon) to the eye.
+static void add_point(Quickhull* qh, u32 eye, u32 eye_face) {
+	vec3 eye_point = qh->points[eye];
+	u32 mark = ++qh->visit_mark;
+
+	array_clear(qh->visible_faces);
+	array_clear(qh->horizon);
+	array_clear(qh->new_faces);
+	qh->faces[eye_face].visit_mark = mark;
+	array_push(qh->visible_faces, eye_face);
+
+	// The visible faces are connected, so they can be found with a flood fill starting at the eye face
+	for (u32 i = 0; i < array_length(qh->visible_faces); ++i) {
+		u32 face_idx = qh->visible_faces[i];
+		for (u32 e = 0; e < 3; ++e) {
+			u32 neighbor_idx = qh->faces[face_idx].neighbors[e];
+			Face* neighbor = &qh->faces[neighbor_idx];
+			if (neighbor->visit_mark == mark) {
+				continue;
+			}
+
+			if (get_distance_to_face(neighbor, eye_point) > qh->tolerance) {
+				neighbor->visit_mark = mark;
+				array_push(qh->visible_faces, neighbor_idx);
+			} else {
+				Horizon_Edge edge = {face_idx, e};
+				array_push(qh->horizon, edge);
+			}
+		}
+	}
+
+	for (u32 i = 0; i < array_length(qh->horizon); ++i) {
+		Horizon_Edge edge = qh->horizon[i];
+		const Face* visible_face = &qh->faces[edge.face];
+		u32 a = visible_face->vertices[edge.edge];
+		u32 b = visible_face->vertices[(edge.edge + 1) % 3];
+		u32 hidden_face_idx = visible_face->neighbors[edge.edge];
+
+		// 'visible_face' is not valid anymore after creating the face, since the array might be reallocated
+		u32 new_face_idx = create_face(qh, a, b, eye);
+		qh->faces[new_face_idx].neighbors[0] = hidden_face_idx;
+		Face* hidden_face = &qh->faces[hidden_face_idx];
+		hidden_face->neighbors[get_edge_index(hidden_face, b, a)] = new_face_idx;
+		qh->new_face_by_start[a] = new_face_idx;
+		array_push(qh->new_faces, new_face_idx);
+	}
+
+	// The new faces form a fan around the eye, each one is connected to the one that starts where it ends
+	for (u32 i = 0; i < array_length(qh->new_faces); ++i) {
+		Face* face = &qh->faces[qh->new_faces[i]];
+		u32 next_face_idx = qh->new_face_by_start[face->vertices[1]];
+		assert(qh->faces[next_face_idx].vertices[0] == face->vertices[1]);
+		face->neighbors[1] = next_face_idx;
+		qh->faces[next_face_idx].neighbors[2] = qh->new_faces[i];
+	}
+
+	// The points that were outside of the deleted faces might still be outside of the new ones
+	for (u32 i = 0; i < array_length(qh->visible_faces); ++i) {
+		Face* face = &qh->faces[qh->visible_faces[i]];
+		face->deleted = true;
+		u32 point = face->outside_head;
+		while (point != NONE) {
+			u32 next = qh->next_outside[point];
+			if (point != eye) {
+				assign_point(qh, point, qh->new_faces, array_length(qh->new_faces));
+			}
+			point = next;
+		}
+		face->outside_head = NONE;
+	}
+}
+
+static boolean is_face_on_plane(const Quickhull* qh, const Face* face, vec3 normal, r64 distance) {
+	for (u32 i = 0; i < 3; ++i) {
+		if (fabs(gm_vec3_dot(normal, qh->points[face->vertices[i]]) - distance) > qh->coplanar_tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Merges the coplanar triangles into polygons and fills the result.
+// Only the points that are corners of at least three polygons are kept: the others are in the middle of a polygon or of an edge.
+static void build_result(Quickhull* qh, Quickhull_Result* result) {
+	u32 num_faces = array_length(qh->faces);
+	u32* group_of_face = (u32*)arena_allocate(qh->arena, num_faces * sizeof(u32));
+	memset(group_of_face, 0xFF, num_faces * sizeof(u32));
+	u32* next_on_boundary = (u32*)arena_allocate(qh->arena, qh->num_points * sizeof(u32));
+	u32* num_polygons_of_point = (u32*)arena_allocate(qh->arena, qh->num_points * sizeof(u32));
+	u32* group = arena_array_new(u32, 64, qh->arena);
+
+	u32** polygons = array_new(u32*);
+	result->face_normals = array_new(vec3);
+
+	for (u32 seed = 0; seed < num_faces; ++seed) {
+		if (qh->faces[seed].deleted || group_of_face[seed] != NONE) {
+			continue;
+		}
+
+		// Collect the triangles connected to the seed that are on its plane
+		u32 group_idx = array_length(polygons);
+		vec3 seed_normal = qh->faces[seed].normal;
+		r64 seed_distance = qh->faces[seed].distance;
+		array_clear(group);
+		array_push(group, seed);
+		group_of_face[seed] = group_idx;
+		for (u32 i = 0; i < array_length(group); ++i) {
+			const Face* face = &qh->faces[group[i]];
+			for (u32 e = 0; e < 3; ++e) {
+				u32 neighbor_idx = face->neighbors[e];
+				if (group_of_face[neighbor_idx] == NONE && is_face_on_plane(qh, &qh->faces[neighbor_idx], seed_normal, seed_distance)) {
+					group_of_face[neighbor_idx] = group_idx;
+					array_push(group, neighbor_idx);
+				}
+			}
+		}
+
+		// The polygon is formed by the edges that are not shared by two triangles of the group
+		vec3 normal = {0.0, 0.0, 0.0};
+		u32 num_boundary_edges = 0;
+		u32 start = NONE;
+		for (u32 i = 0; i < array_length(group); ++i) {
+			const Face* face = &qh->faces[group[i]];
+			vec3 a = qh->points[face->vertices[0]];
+			vec3 b = qh->points[face->vertices[1]];
+			vec3 c = qh->points[face->vertices[2]];
+			// Weighted by the area of the triangle
+			normal = gm_vec3_add(normal, gm_vec3_cross(gm_vec3_subtract(b, a), gm_vec3_subtract(c, a)));
+
+			for (u32 e = 0; e < 3; ++e) {
+				if (group_of_face[face->neighbors[e]] != group_idx) {
+					next_on_boundary[face->vertices[e]] = face->vertices[(e + 1) % 3];
+					start = face->vertices[e];
+					++num_boundary_edges;
+				}
+			}
+		}
+
+		u32* polygon = array_new_len(u32, num_boundary_edges);
+		u32 point = start;
+		do {
+			array_push(polygon, point);
+			++num_polygons_of_point[point];
+			point = next_on_boundary[point];
+		} while (point != start && array_length(polygon) < num_boundary_edges);
+		assert(point == start && array_length(polygon) == num_boundary_edges);
+
+		array_push(polygons, polygon);
+		array_push(result->face_normals, gm_vec3_normalize(normal));
+	}
+
+	u32* point_to_vertex = (u32*)arena_allocate(qh->arena, qh->num_points * sizeof(u32));
+	result->vertices = array_new(vec3);
+	for (u32 i = 0; i < qh->num_points; ++i) {
+		if (num_polygons_of_point[i] >= 3) {
+			point_to_vertex[i] = array_length(result->vertices);
+			array_push(result->vertices, qh->points[i]);
+		}
+	}
+
+	for (u32 i = 0; i < array_length(polygons); ++i) {
+		u32* polygon = polygons[i];
+		u32 num_corners = 0;
+		for (u32 j = 0; j < array_length(polygon); ++j) {
+			if (num_polygons_of_point[polygon[j]] >= 3) {
+				polygon[num_corners++] = point_to_vertex[polygon[j]];
+			}
+		}
+		array_length(polygon) = num_corners;
+		assert(num_corners >= 3);
+	}
+	result->faces = polygons;
+}
+
+boolean quickhull_build(const vec3* points, u32 max_vertices, Quickhull_Result* result) {
+	result->vertices = NULL;
+	result->faces = NULL;
+	result->face_normals = NULL;
+
+	Quickhull qh;
+	qh.points = points;
+	qh.num_points = array_length(points);
+	qh.arena = arena_get_scratch();
+	qh.visit_mark = 0;
+	if (qh.num_points < 4) {
+		return false;
+	}
+
+	// The tolerance grows with the coordinates, since so does the floating point error
+	r64 max_coordinates[3] = {0.0, 0.0, 0.0};
+	for (u32 i = 0; i < qh.num_points; ++i) {
+		for (u32 axis = 0; axis < 3; ++axis) {
+			max_coordinates[axis] = MAX(max_coordinates[axis], fabs(get_coordinate(points[i], axis)));
+		}
+	}
+	qh.tolerance = RELATIVE_TOLERANCE * (max_coordinates[0] + max_coordinates[1] + max_coordinates[2]);
+	qh.coplanar_tolerance = RELATIVE_COPLANAR_TOLERANCE * (max_coordinates[0] + max_coordinates[1] + max_coordinates[2]);
+
+	Arena_Marker marker = arena_get_marker(qh.arena);
+	qh.faces = arena_array_new(Face, 4 * qh.num_points, qh.arena);
+	qh.next_outside = (u32*)arena_allocate(qh.arena, qh.num_points * sizeof(u32));
+	qh.new_face_by_start = (u32*)arena_allocate(qh.arena, qh.num_points * sizeof(u32));
+	qh.visible_faces = arena_array_new(u32, 64, qh.arena);
+	qh.horizon = arena_array_new(Horizon_Edge, 64, qh.arena);
+	qh.new_faces = arena_array_new(u32, 64, qh.arena);
+
+	if (!build_initial_simplex(&qh)) {
+		arena_reset_to_marker(qh.arena, marker);
+		return false;
+	}
+
+	// Faces are only appended, and a face is deleted as soon as its farthest point is added, so a single pass visits every
+	// face that has outside points, including the new ones.
+	u32 num_vertices = 4;
+	for (u32 i = 0; i < array_length(qh.faces); ++i) {
+		if (max_vertices != 0 && num_vertices >= max_vertices) {
+			break;
+		}
+
+		if (!qh.faces[i].deleted && qh.faces[i].outside_head != NONE) {
+			u32 eye = get_farthest_outside_point(&qh, &qh.faces[i]);
+			add_point(&qh, eye, i);
+			++num_vertices;
+		}
+	}
+
+	build_result(&qh, result);
+	arena_reset_to_marker(qh.arena, marker);
+	return true;
+}
+
+void quickhull_result_destroy(Quickhull_Result* result) {
+	if (result->faces) {
+		for (u32 i = 0; i < array_length(result->faces); ++i) {
+			array_free(result->faces[i]);
+		}
+		array_free(result->faces);
+	}
+	if (result->vertices) {
+		array_free(result->vertices);
+	}
+	if (result->face_normals) {
+		array_free(result->face_normals);
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef RAW_PHYSICS_QUICKHULL_H
+#define RAW_PHYSICS_QUICKHULL_H
+#include "gm.h"
+
+// Builds the convex hull of a point cloud with the quickhull algorithm ('The Quickhull Algorithm for Convex Hulls',
+// Barber et al. 1996, and 'Implementing Quickhull', Dirk Gregorius, GDC 2014).
+// The hull is built out of triangles, which are merged into polygons afterwards when they are coplanar.
+
+typedef struct {
+	// Only the points that are on the hull, in the same order they appear in the input
+	vec3* vertices;
+	// Each face is an array of vertex indices, counter-clockwise when seen from outside the hull
+	u32** faces;
+	// Outward unit normals of the faces
+	vec3* face_normals;
+} Quickhull_Result;
+
+// 'points' is a light array. Duplicated points are fine. If 'max_vertices' is not 0, the hull stops growing when it has that
+// many vertices, which gives a simpler hull that is contained in the real one.
+// Returns false if the points don't enclose any volume (e.g. they are all coplanar), in which case 'result' is left empty.
+boolean quickhull_build(const vec3* points, u32 max_vertices, Quickhull_Result* result);
+void quickhull_result_destroy(Quickhull_Result* result);
+
+#endif
@@ -1,6 +1,5 @@
 #include "rott_pendulum.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -14,6 +13,7 @@
 #include "entity.h"
 #include "util.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
@@ -42,6 +42,11 @@ static void reset_joint_distance(Entity* e1, Entity* e2, vec3 r1_lc, vec3 r2_lc)
 }
 
 static eid base_id, static_piece_id, free_piece_id;
+// Whether the push key is held. The physics thread pushes once per step while it is, so the force doesn't depend on how many
+// frames are drawn per step. 'base_push_held' belongs to the physics thread and is set by a command whenever the key changes,
+// 'input_base_push_held' is what the input sent last.
+static boolean base_push_held;
+static boolean input_base_push_held;
 
 static Constraint* create_pendulum() {
 	Vertex* cube_vertices;
@@ -52,23 +57,23 @@ static Constraint* create_pendulum() {
 
 	vec3 support_position = {0.0, 0.0, -2.0};
 	vec3 support_collider_scale = {0.1, 0.1, 0.1};
-	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, support_collider_scale);
-	eid support_id = entity_create_fixed(cube_mesh, support_position, quaternion_new({0.0, 0.0, 0.0}, 0.0), support_collider_scale,
+	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, support_collider_scale);
+	eid support_id = examples_util_create_fixed_entity(cube_mesh, support_position, quaternion_new({0.0, 0.0, 0.0}, 0.0), support_collider_scale,
 		{0.0, 1.0, 0.0, 1.0}, support_colliders, 0.5, 0.5, 0.0);
 
 	vec3 base_collider_scale = {1.0, 0.1, 0.1};
-	Collider* base_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, base_collider_scale);
-	base_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), base_collider_scale,
+	Collider* base_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, base_collider_scale);
+	base_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), base_collider_scale,
 		{0x77 / 255.0, 0xc3 / 255.0, 0xec / 255.0}, 1.0, base_colliders, 0.6, 0.6, 0.0);
 
 	vec3 free_piece_collider_scale = {0.1, 1.0, 0.1};
-	Collider* free_piece_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, free_piece_collider_scale);
-	free_piece_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), free_piece_collider_scale,
+	Collider* free_piece_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, free_piece_collider_scale);
+	free_piece_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), free_piece_collider_scale,
 		{1.0, 0.0, 0.0, 1.0}, 1.0, free_piece_colliders, 0.6, 0.6, 0.0);
 
 	vec3 static_piece_collider_scale = {0.1, 1.0, 0.1};
-	Collider* static_piece_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, static_piece_collider_scale);
-	static_piece_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), static_piece_collider_scale,
+	Collider* static_piece_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, static_piece_collider_scale);
+	static_piece_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), static_piece_collider_scale,
 		{0x77 / 255.0, 0xc3 / 255.0, 0xec / 255.0}, 1.0, static_piece_colliders, 0.6, 0.6, 0.0);
 
 	array_free(cube_vertices);
@@ -118,6 +123,8 @@ int ex_rott_pendulum_init() {
 	lights = examples_util_create_lights();
 
 	constraints = create_pendulum();
+	base_push_held = false;
+	input_base_push_held = false;
 
 	return 0;
 }
@@ -130,7 +137,7 @@ void ex_rott_pendulum_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -138,6 +145,16 @@ void ex_rott_pendulum_destroy() {
 	entity_module_destroy();
 }
 
+static void push_base() {
+	Entity* base_entity = entity_get_by_id(base_id);
+	entity_add_force(base_entity, {1.0, 0.0, 0.0}, {0.0, -200.0, 0.0}, true);
+	entity_activate(base_entity);
+}
+
+static void set_base_push_held(void* data) {
+	base_push_held = *(boolean*)data;
+}
+
 void ex_rott_pendulum_update(r64 delta_time) {
 	Entity** entities = entity_get_all();
 	for (u32 i = 0; i < array_length(entities); ++i) {
@@ -152,7 +169,11 @@ void ex_rott_pendulum_update(r64 delta_time) {
 		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
 	}
 
-	pbd_simulate_with_constraints(delta_time, entities, constraints, 50, 50, false);
+	if (base_push_held) {
+		push_base();
+	}
+
+	pbd_simulate_with_constraints(delta_time, entities, constraints, 50, 50, false, NULL);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		entity_clear_forces(entities[i]);
@@ -161,69 +182,63 @@ void ex_rott_pendulum_update(r64 delta_time) {
 }
 
 void ex_rott_pendulum_render() {
-	Entity** entities = entity_get_all();
-
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
+}
+
+// Entities are only touched by commands, since they may be owned by the physics thread
+static void stop_pieces(void* data) {
+	Entity* base_entity = entity_get_by_id(base_id);
+	Entity* static_piece_entity = entity_get_by_id(static_piece_id);
+	Entity* free_piece_entity = entity_get_by_id(free_piece_id);
+	base_entity->linear_velocity = {0.0, 0.0, 0.0};
+	base_entity->angular_velocity = {0.0, 0.0, 0.0};
+	static_piece_entity->linear_velocity = {0.0, 0.0, 0.0};
+	static_piece_entity->angular_velocity = {0.0, 0.0, 0.0};
+	free_piece_entity->linear_velocity = {0.0, 0.0, 0.0};
+	free_piece_entity->angular_velocity = {0.0, 0.0, 0.0};
 }
 
 void ex_rott_pendulum_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 30.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_B]) {
-		Entity* base_entity = entity_get_by_id(base_id);
-		entity_add_force(base_entity, {1.0, 0.0, 0.0}, {0.0, -200.0, 0.0}, true);
-		entity_activate(base_entity);
+	if (key_state[KEY_B] != input_base_push_held) {
+		input_base_push_held = key_state[KEY_B];
+		physics_thread_push_command(set_base_push_held, &input_base_push_held, sizeof(input_base_push_held));
 	}
 
-	if (key_state[GLFW_KEY_V]) {
-		Entity* base_entity = entity_get_by_id(base_id);
-		Entity* static_piece_entity = entity_get_by_id(static_piece_id);
-		Entity* free_piece_entity = entity_get_by_id(free_piece_id);
-		base_entity->linear_velocity = {0.0, 0.0, 0.0};
-		base_entity->angular_velocity = {0.0, 0.0, 0.0};
-		static_piece_entity->linear_velocity = {0.0, 0.0, 0.0};
-		static_piece_entity->angular_velocity = {0.0, 0.0, 0.0};
-		free_piece_entity->linear_velocity = {0.0, 0.0, 0.0};
-		free_piece_entity->angular_velocity = {0.0, 0.0, 0.0};
-		key_state[GLFW_KEY_V] = false;
+	if (key_state[KEY_V]) {
+		physics_thread_push_command(stop_pieces, NULL, 0);
+		key_state[KEY_V] = false;
 	}
 }
 
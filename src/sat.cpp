@@ -0,0 +1,498 @@
+#include "sat.h"
+#include "light_array.h"
+#include <float.h>
+#include "support.h"
+#include "profiler.h"
+#include "hash_table.h"
+#include "arena.h"
+
+// Separating axis test for convex hulls, based on 'The Separating Axis Test between Convex Polyhedra' (Dirk Gregorius, GDC 2013).
+// The face normals of both hulls are tested, plus the cross products of every pair of edges that builds a face of the
+// Minkowski difference (the other pairs can't be separating axes, so they are pruned using the Gauss map).
+
+// The edge-edge query is quadratic, so we only use SAT for hulls that are small enough.
+#define SAT_MAX_EDGE_PAIRS 4096
+
+static const r64 EDGE_PARALLEL_TOLERANCE = 0.005;
+static const r64 RELATIVE_EDGE_TOLERANCE = 0.90;
+static const r64 RELATIVE_FACE_TOLERANCE = 0.95;
+static const r64 ABSOLUTE_TOLERANCE = 0.0025;
+
+static inline u64 hash_table_hash(SAT_Cache_Key key) {
+	return hash_table_hash((u64)(uintptr_t)key.collider1 ^ hash_table_hash((u64)(uintptr_t)key.collider2));
+}
+
+static inline boolean hash_table_equals(SAT_Cache_Key key1, SAT_Cache_Key key2) {
+	return key1.collider1 == key2.collider1 && key1.collider2 == key2.collider2;
+}
+
+// How far each hull may move since its pair was fully tested for the cached feature to be reused without testing the other axes
+static const r64 CACHE_MOTION_TOLERANCE = 0.002;
+
+// The winning feature of each pair, so in the next step it is the first axis to be tested. A stale entry is harmless, since the
+// feature is always validated. Pairs that are not tested during a step are removed at the end of it.
+static Hash_Table<SAT_Cache_Key, SAT_Cache_Entry> cache;
+// Incremented at the end of every step
+static u64 cache_step;
+// The updates of the thread while it is recording, NULL otherwise
+static thread_local SAT_Cache_Update** recorded_updates;
+
+static const SAT_Cache_Entry* get_cache_entry(SAT_Cache_Key key) {
+	if (!cache.control) {
+		return NULL;
+	}
+	return hash_table_get(&cache, key);
+}
+
+static void put_cache_entry(SAT_Cache_Key key, SAT_Cache_Entry entry) {
+	entry.step = cache_step;
+	if (recorded_updates) {
+		SAT_Cache_Update update = {key, entry};
+		array_push(*recorded_updates, update);
+		return;
+	}
+
+	if (!cache.control) {
+		hash_table_create(&cache, 256);
+	}
+	hash_table_put(&cache, key, entry);
+}
+
+void sat_cache_begin_recording(SAT_Cache_Update** updates) {
+	recorded_updates = updates;
+}
+
+void sat_cache_end_recording() {
+	recorded_updates = NULL;
+}
+
+void sat_cache_apply(const SAT_Cache_Update* updates) {
+	if (array_length(updates) == 0) {
+		return;
+	}
+
+	if (!cache.control) {
+		hash_table_create(&cache, array_length(updates));
+	}
+	for (u32 i = 0; i < array_length(updates); ++i) {
+		hash_table_put(&cache, updates[i].key, updates[i].entry);
+	}
+}
+
+void sat_cache_end_step() {
+	if (cache.control) {
+		// Removing shifts elements back, so the keys are collected first
+		SAT_Cache_Key* stale_keys = arena_array_new(SAT_Cache_Key, 64, arena_get_scratch());
+		for (u32 i = 0; i < cache.num_slots; ++i) {
+			if (cache.control[i] != HASH_TABLE_EMPTY && cache.values[i].step != cache_step) {
+				array_push(stale_keys, cache.keys[i]);
+			}
+		}
+		for (u32 i = 0; i < array_length(stale_keys); ++i) {
+			hash_table_remove(&cache, stale_keys[i]);
+		}
+		array_free(stale_keys);
+	}
+
+	++cache_step;
+}
+
+void sat_cache_destroy() {
+	if (cache.control) {
+		hash_table_destroy(&cache);
+	}
+}
+
+// 'radius' is left out, since it is only needed when the pose is cached
+static SAT_Hull_Pose get_hull_pose(const Collider_Convex_Hull* convex_hull) {
+	// The two faces of an edge are never parallel, so together they change with any rotation
+	Collider_Convex_Hull_Edge edge = convex_hull->shape->edges[0];
+	SAT_Hull_Pose pose;
+	pose.point = convex_hull->transformed_vertices[0];
+	pose.normal1 = convex_hull->transformed_face_planes[edge.face1].normal;
+	pose.normal2 = convex_hull->transformed_face_planes[edge.face2].normal;
+	pose.radius = 0.0;
+	return pose;
+}
+
+static r64 get_hull_radius(const Collider_Convex_Hull* convex_hull, vec3 point) {
+	r64 radius_sqd = 0.0;
+	for (u32 i = 0; i < convex_hull->shape->num_vertices; ++i) {
+		vec3 v = gm_vec3_subtract(convex_hull->transformed_vertices[i], point);
+		radius_sqd = MAX(radius_sqd, gm_vec3_dot(v, v));
+	}
+	return sqrt(radius_sqd);
+}
+
+// Bounds how far the vertices of the hull moved since 'cached_pose', roughly: the point moved, plus the rotation (measured by
+// the normals, and scaled up when they are close to each other, since a rotation around them barely changes them) times
+// the distance from the point to the farthest vertex.
+static r64 get_hull_motion(const SAT_Hull_Pose* cached_pose, const SAT_Hull_Pose* pose) {
+	r64 normals_sin = gm_vec3_length(gm_vec3_cross(pose->normal1, pose->normal2));
+	r64 normals_change = gm_vec3_length(gm_vec3_subtract(cached_pose->normal1, pose->normal1)) +
+		gm_vec3_length(gm_vec3_subtract(cached_pose->normal2, pose->normal2));
+	return gm_vec3_length(gm_vec3_subtract(cached_pose->point, pose->point)) + cached_pose->radius * normals_change / normals_sin;
+}
+
+static void cache_feature(SAT_Cache_Key key, const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2,
+	const SAT_Hull_Pose* pose1, const SAT_Hull_Pose* pose2, SAT_Feature_Type type, u32 index1, u32 index2, boolean penetrating) {
+	SAT_Cache_Entry entry;
+	entry.feature.type = type;
+	entry.feature.index1 = index1;
+	entry.feature.index2 = index2;
+	entry.penetrating = penetrating;
+	entry.pose1 = *pose1;
+	entry.pose2 = *pose2;
+	// Only the poses of penetrating hulls are compared later
+	if (penetrating) {
+		entry.pose1.radius = get_hull_radius(convex_hull1, pose1->point);
+		entry.pose2.radius = get_hull_radius(convex_hull2, pose2->point);
+	}
+	put_cache_entry(key, entry);
+}
+
+boolean sat_can_collide_convex_hulls(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2) {
+	return convex_hull1->shape->num_edges * convex_hull2->shape->num_edges <= SAT_MAX_EDGE_PAIRS;
+}
+
+static r64 face_separation(const Collider_Convex_Hull* reference, const Collider_Convex_Hull* incident, u32 face_idx) {
+	Collider_Convex_Hull_Plane plane = reference->transformed_face_planes[face_idx];
+	// @NOTE: support_point_get_index is not const-correct
+	u32 support_idx = support_point_get_index((Collider_Convex_Hull*)incident, gm_vec3_invert(plane.normal));
+	vec3 support = incident->transformed_vertices[support_idx];
+	return gm_vec3_dot(plane.normal, support) - plane.distance;
+}
+
+static r64 query_face_directions(const Collider_Convex_Hull* reference, const Collider_Convex_Hull* incident, u32* face_idx) {
+	r64 max_separation = -DBL_MAX;
+	for (u32 i = 0; i < reference->shape->num_faces; ++i) {
+		r64 separation = face_separation(reference, incident, i);
+		if (separation > max_separation) {
+			max_separation = separation;
+			*face_idx = i;
+			if (separation > 0.0) {
+				// Found a separating axis, no need to continue.
+				break;
+			}
+		}
+	}
+
+	return max_separation;
+}
+
+// Checks whether the arcs AB and CD intersect on the Gauss map, i.e., whether the two edges build a face of the Minkowski difference.
+// 'a' and 'b' are the normals of the faces adjacent to the first edge. 'c' and 'd' are the *inverted* normals of the faces
+// adjacent to the second edge (since we are dealing with the Minkowski difference).
+static boolean is_minkowski_face(vec3 a, vec3 b, vec3 c, vec3 d) {
+	vec3 b_x_a = gm_vec3_cross(b, a);
+	vec3 d_x_c = gm_vec3_cross(d, c);
+	r64 cba = gm_vec3_dot(c, b_x_a);
+	r64 dba = gm_vec3_dot(d, b_x_a);
+	r64 adc = gm_vec3_dot(a, d_x_c);
+	r64 bdc = gm_vec3_dot(b, d_x_c);
+	return cba * dba < 0.0 && adc * bdc < 0.0 && cba * bdc > 0.0;
+}
+
+// Gets the separation along the axis built by edge1 = p1 + t * e1 and edge2 = p2 + t * e2 (or -DBL_MAX if the edges are parallel).
+// 'a' and 'b' are the normals of the faces adjacent to the first edge. The resulting axis always points from the first hull to the
+// second hull.
+static r64 edge_axis_separation(vec3 p1, vec3 e1, vec3 a, vec3 b, vec3 p2, vec3 e2, vec3* axis) {
+	vec3 e1_x_e2 = gm_vec3_cross(e1, e2);
+	r64 length_sqd = gm_vec3_dot(e1_x_e2, e1_x_e2);
+	if (length_sqd < EDGE_PARALLEL_TOLERANCE * EDGE_PARALLEL_TOLERANCE * gm_vec3_dot(e1, e1) * gm_vec3_dot(e2, e2)) {
+		return -DBL_MAX;
+	}
+
+	// Since the edges build a face of the Minkowski difference, the axis is between 'a' and 'b' on the Gauss map.
+	// We use that to make sure that it points outwards of the first hull.
+	vec3 n = gm_vec3_scalar_product(1.0 / sqrt(length_sqd), e1_x_e2);
+	if (gm_vec3_dot(n, gm_vec3_add(a, b)) < 0.0) {
+		n = gm_vec3_invert(n);
+	}
+
+	*axis = n;
+	return gm_vec3_dot(n, gm_vec3_subtract(p2, p1));
+}
+
+static r64 edge_separation(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2,
+	u32 edge1_idx, u32 edge2_idx, vec3* axis) {
+	Collider_Convex_Hull_Edge edge1 = convex_hull1->shape->edges[edge1_idx];
+	Collider_Convex_Hull_Edge edge2 = convex_hull2->shape->edges[edge2_idx];
+
+	vec3 a = convex_hull1->transformed_face_planes[edge1.face1].normal;
+	vec3 b = convex_hull1->transformed_face_planes[edge1.face2].normal;
+	vec3 c = gm_vec3_invert(convex_hull2->transformed_face_planes[edge2.face1].normal);
+	vec3 d = gm_vec3_invert(convex_hull2->transformed_face_planes[edge2.face2].normal);
+
+	if (!is_minkowski_face(a, b, c, d)) {
+		return -DBL_MAX;
+	}
+
+	vec3 p1 = convex_hull1->transformed_vertices[edge1.v1];
+	vec3 e1 = gm_vec3_subtract(convex_hull1->transformed_vertices[edge1.v2], p1);
+	vec3 p2 = convex_hull2->transformed_vertices[edge2.v1];
+	vec3 e2 = gm_vec3_subtract(convex_hull2->transformed_vertices[edge2.v2], p2);
+	return edge_axis_separation(p1, e1, a, b, p2, e2, axis);
+}
+
+static r64 query_edge_directions(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2,
+	u32* edge1_idx, u32* edge2_idx, vec3* axis) {
+	r64 max_separation = -DBL_MAX;
+	for (u32 i = 0; i < convex_hull1->shape->num_edges; ++i) {
+		Collider_Convex_Hull_Edge edge1 = convex_hull1->shape->edges[i];
+		vec3 a = convex_hull1->transformed_face_planes[edge1.face1].normal;
+		vec3 b = convex_hull1->transformed_face_planes[edge1.face2].normal;
+		vec3 b_x_a = gm_vec3_cross(b, a);
+		vec3 p1 = convex_hull1->transformed_vertices[edge1.v1];
+		vec3 e1 = gm_vec3_subtract(convex_hull1->transformed_vertices[edge1.v2], p1);
+
+		for (u32 j = 0; j < convex_hull2->shape->num_edges; ++j) {
+			Collider_Convex_Hull_Edge edge2 = convex_hull2->shape->edges[j];
+			vec3 c = gm_vec3_invert(convex_hull2->transformed_face_planes[edge2.face1].normal);
+			vec3 d = gm_vec3_invert(convex_hull2->transformed_face_planes[edge2.face2].normal);
+
+			// Same as 'is_minkowski_face', but reusing the cross product of the first edge.
+			r64 cba = gm_vec3_dot(c, b_x_a);
+			r64 dba = gm_vec3_dot(d, b_x_a);
+			if (cba * dba >= 0.0) {
+				continue;
+			}
+			vec3 d_x_c = gm_vec3_cross(d, c);
+			r64 adc = gm_vec3_dot(a, d_x_c);
+			r64 bdc = gm_vec3_dot(b, d_x_c);
+			if (adc * bdc >= 0.0 || cba * bdc <= 0.0) {
+				continue;
+			}
+
+			vec3 p2 = convex_hull2->transformed_vertices[edge2.v1];
+			vec3 e2 = gm_vec3_subtract(convex_hull2->transformed_vertices[edge2.v2], p2);
+			vec3 current_axis;
+			r64 separation = edge_axis_separation(p1, e1, a, b, p2, e2, &current_axis);
+			if (separation > max_separation) {
+				max_separation = separation;
+				*edge1_idx = i;
+				*edge2_idx = j;
+				*axis = current_axis;
+				if (separation > 0.0) {
+					return max_separation;
+				}
+			}
+		}
+	}
+
+	return max_separation;
+}
+
+// Gets the separation of the hulls along the axis of 'feature', or -DBL_MAX if the feature doesn't fit the hulls (anymore).
+// 'normal' is set to the axis, pointing from the first hull to the second hull.
+static r64 feature_separation(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2,
+	SAT_Feature feature, vec3* normal) {
+	switch (feature.type) {
+		case SAT_FEATURE_FACE1: {
+			if (feature.index1 >= convex_hull1->shape->num_faces) {
+				return -DBL_MAX;
+			}
+			*normal = convex_hull1->transformed_face_planes[feature.index1].normal;
+			return face_separation(convex_hull1, convex_hull2, feature.index1);
+		} break;
+		case SAT_FEATURE_FACE2: {
+			if (feature.index2 >= convex_hull2->shape->num_faces) {
+				return -DBL_MAX;
+			}
+			*normal = gm_vec3_invert(convex_hull2->transformed_face_planes[feature.index2].normal);
+			return face_separation(convex_hull2, convex_hull1, feature.index2);
+		} break;
+		case SAT_FEATURE_EDGES: {
+			if (feature.index1 >= convex_hull1->shape->num_edges || feature.index2 >= convex_hull2->shape->num_edges) {
+				return -DBL_MAX;
+			}
+			return edge_separation(convex_hull1, convex_hull2, feature.index1, feature.index2, normal);
+		} break;
+	}
+
+	return -DBL_MAX;
+}
+
+// Returns true if the hulls are penetrating. In this case, 'result' holds the axis of minimum penetration and the features
+// that should be used to build the contact manifold.
+boolean sat_collides(Collider* collider1, Collider* collider2, const Collider* cache_key1, const Collider* cache_key2,
+	SAT_Result* result) {
+	PROFILE_SCOPE(PROFILE_PHASE_SAT);
+	assert(collider1->type == COLLIDER_TYPE_CONVEX_HULL);
+	assert(collider2->type == COLLIDER_TYPE_CONVEX_HULL);
+	const Collider_Convex_Hull* convex_hull1 = &collider1->convex_hull;
+	const Collider_Convex_Hull* convex_hull2 = &collider2->convex_hull;
+
+	SAT_Cache_Key cache_key = {cache_key1, cache_key2};
+	const SAT_Cache_Entry* cache_entry = get_cache_entry(cache_key);
+	SAT_Hull_Pose pose1 = get_hull_pose(convex_hull1);
+	SAT_Hull_Pose pose2 = get_hull_pose(convex_hull2);
+	if (cache_entry) {
+		vec3 cached_normal;
+		r64 cached_separation = feature_separation(convex_hull1, convex_hull2, cache_entry->feature, &cached_normal);
+		if (cached_separation > 0.0) {
+			put_cache_entry(cache_key, *cache_entry);
+			return false;
+		}
+
+		// While the hulls barely move, the axis of minimum penetration stays the same, so the other axes are not tested.
+		// Resting contacts take this path almost every step.
+		if (cache_entry->penetrating && cached_separation != -DBL_MAX &&
+			get_hull_motion(&cache_entry->pose1, &pose1) <= CACHE_MOTION_TOLERANCE &&
+			get_hull_motion(&cache_entry->pose2, &pose2) <= CACHE_MOTION_TOLERANCE) {
+			result->feature = cache_entry->feature;
+			result->separation = cached_separation;
+			result->normal = cached_normal;
+			put_cache_entry(cache_key, *cache_entry);
+			return true;
+		}
+	}
+
+	u32 face1_idx = 0;
+	r64 face1_separation = query_face_directions(convex_hull1, convex_hull2, &face1_idx);
+	if (face1_separation > 0.0) {
+		cache_feature(cache_key, convex_hull1, convex_hull2, &pose1, &pose2, SAT_FEATURE_FACE1, face1_idx, 0, false);
+		return false;
+	}
+
+	u32 face2_idx = 0;
+	r64 face2_separation = query_face_directions(convex_hull2, convex_hull1, &face2_idx);
+	if (face2_separation > 0.0) {
+		cache_feature(cache_key, convex_hull1, convex_hull2, &pose1, &pose2, SAT_FEATURE_FACE2, 0, face2_idx, false);
+		return false;
+	}
+
+	u32 edge1_idx = 0, edge2_idx = 0;
+	vec3 edge_axis = {0.0, 0.0, 0.0};
+	r64 edges_separation = query_edge_directions(convex_hull1, convex_hull2, &edge1_idx, &edge2_idx, &edge_axis);
+	if (edges_separation > 0.0) {
+		cache_feature(cache_key, convex_hull1, convex_hull2, &pose1, &pose2, SAT_FEATURE_EDGES, edge1_idx, edge2_idx, false);
+		return false;
+	}
+
+	// The hulls are penetrating. Faces are preferred over edges, and the first hull is preferred over the second one.
+	// This avoids flip-flopping between features that are almost equally good.
+	if (edges_separation > RELATIVE_EDGE_TOLERANCE * MAX(face1_separation, face2_separation) + ABSOLUTE_TOLERANCE) {
+		result->feature.type = SAT_FEATURE_EDGES;
+		result->feature.index1 = edge1_idx;
+		result->feature.index2 = edge2_idx;
+		result->separation = edges_separation;
+		result->normal = edge_axis;
+	} else if (face2_separation > RELATIVE_FACE_TOLERANCE * face1_separation + ABSOLUTE_TOLERANCE) {
+		result->feature.type = SAT_FEATURE_FACE2;
+		result->feature.index1 = 0;
+		result->feature.index2 = face2_idx;
+		result->separation = face2_separation;
+		result->normal = gm_vec3_invert(convex_hull2->transformed_face_planes[face2_idx].normal);
+	} else {
+		result->feature.type = SAT_FEATURE_FACE1;
+		result->feature.index1 = face1_idx;
+		result->feature.index2 = 0;
+		result->separation = face1_separation;
+		result->normal = convex_hull1->transformed_face_planes[face1_idx].normal;
+	}
+
+	cache_feature(cache_key, convex_hull1, convex_hull2, &pose1, &pose2, result->feature.type, result->feature.index1,
+		result->feature.index2, true);
+	return true;
+}
+
+static r64 box_projection_radius(const Collider_Box* box, vec3 axis) {
+	return box->half_extents.x * fabs(gm_vec3_dot(box->axes[0], axis)) +
+		box->half_extents.y * fabs(gm_vec3_dot(box->axes[1], axis)) +
+		box->half_extents.z * fabs(gm_vec3_dot(box->axes[2], axis));
+}
+
+// Gets the separation of the boxes along 'axis', which is flipped (if needed) to point from the first box to the second box.
+static r64 box_axis_separation(const Collider_Box* box1, const Collider_Box* box2, vec3 center_diff, vec3* axis) {
+	r64 distance = gm_vec3_dot(center_diff, *axis);
+	if (distance < 0.0) {
+		*axis = gm_vec3_invert(*axis);
+		distance = -distance;
+	}
+
+	return distance - box_projection_radius(box1, *axis) - box_projection_radius(box2, *axis);
+}
+
+boolean sat_collides_boxes(const Collider_Box* box1, const Collider_Box* box2, SAT_Result* result) {
+	PROFILE_SCOPE(PROFILE_PHASE_SAT);
+	vec3 center_diff = gm_vec3_subtract(box2->center, box1->center);
+
+	r64 face1_separation = -DBL_MAX, face2_separation = -DBL_MAX;
+	u32 face1_idx = 0, face2_idx = 0;
+	vec3 face1_normal, face2_normal;
+	for (u32 i = 0; i < 3; ++i) {
+		vec3 axis = box1->axes[i];
+		r64 separation = box_axis_separation(box1, box2, center_diff, &axis);
+		if (separation > 0.0) {
+			return false;
+		}
+		if (separation > face1_separation) {
+			face1_separation = separation;
+			face1_idx = 2 * i + (gm_vec3_dot(axis, box1->axes[i]) > 0.0 ? 0 : 1);
+			face1_normal = axis;
+		}
+	}
+
+	for (u32 i = 0; i < 3; ++i) {
+		vec3 axis = box2->axes[i];
+		r64 separation = box_axis_separation(box1, box2, center_diff, &axis);
+		if (separation > 0.0) {
+			return false;
+		}
+		if (separation > face2_separation) {
+			face2_separation = separation;
+			// The face of the second box points against the axis
+			face2_idx = 2 * i + (gm_vec3_dot(axis, box2->axes[i]) > 0.0 ? 1 : 0);
+			face2_normal = axis;
+		}
+	}
+
+	r64 edges_separation = -DBL_MAX;
+	u32 edge1_idx = 0, edge2_idx = 0;
+	vec3 edges_normal;
+	for (u32 i = 0; i < 3; ++i) {
+		for (u32 j = 0; j < 3; ++j) {
+			vec3 axis = gm_vec3_cross(box1->axes[i], box2->axes[j]);
+			r64 length = gm_vec3_length(axis);
+			if (length < EDGE_PARALLEL_TOLERANCE) {
+				// Parallel edges, the axis is already covered by the face normals
+				continue;
+			}
+			axis = gm_vec3_scalar_product(1.0 / length, axis);
+			r64 separation = box_axis_separation(box1, box2, center_diff, &axis);
+			if (separation > 0.0) {
+				return false;
+			}
+			if (separation > edges_separation) {
+				edges_separation = separation;
+				edge1_idx = i;
+				edge2_idx = j;
+				edges_normal = axis;
+			}
+		}
+	}
+
+	// Same preferences as for general convex hulls.
+	if (edges_separation > RELATIVE_EDGE_TOLERANCE * MAX(face1_separation, face2_separation) + ABSOLUTE_TOLERANCE) {
+		result->feature.type = SAT_FEATURE_EDGES;
+		result->feature.index1 = edge1_idx;
+		result->feature.index2 = edge2_idx;
+		result->separation = edges_separation;
+		result->normal = edges_normal;
+	} else if (face2_separation > RELATIVE_FACE_TOLERANCE * face1_separation + ABSOLUTE_TOLERANCE) {
+		result->feature.type = SAT_FEATURE_FACE2;
+		result->feature.index1 = 0;
+		result->feature.index2 = face2_idx;
+		result->separation = face2_separation;
+		result->normal = face2_normal;
+	} else {
+		result->feature.type = SAT_FEATURE_FACE1;
+		result->feature.index1 = face1_idx;
+		result->feature.index2 = 0;
+		result->separation = face1_separation;
+		result->normal = face1_normal;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef RAW_PHYSICS_PHYSICS_SAT_H
+#define RAW_PHYSICS_PHYSICS_SAT_H
+#include "common.h"
+#include "gm.h"
+#include "collider.h"
+
+typedef enum {
+	SAT_FEATURE_FACE1, // the reference face belongs to the first hull
+	SAT_FEATURE_FACE2, // the reference face belongs to the second hull
+	SAT_FEATURE_EDGES  // the axis is the cross product of one edge of each hull
+} SAT_Feature_Type;
+
+typedef struct {
+	SAT_Feature_Type type;
+	// FACE1: face of the first hull. EDGES: edge of the first hull.
+	u32 index1;
+	// FACE2: face of the second hull. EDGES: edge of the second hull.
+	u32 index2;
+} SAT_Feature;
+
+typedef struct {
+	SAT_Feature feature;
+	// Negative when the hulls are penetrating.
+	r64 separation;
+	// Always points from the first hull to the second hull.
+	vec3 normal;
+} SAT_Result;
+
+// A point and two face normals of a hull in world space, to tell how far the hull moved since the last time its pair was tested.
+typedef struct {
+	vec3 point;
+	vec3 normal1;
+	vec3 normal2;
+	// Distance from 'point' to the farthest vertex of the hull
+	r64 radius;
+} SAT_Hull_Pose;
+
+// The feature cache remembers the winning feature of each pair of hulls from step to step (see 'sat_collides').
+typedef struct {
+	const Collider* collider1;
+	const Collider* collider2;
+} SAT_Cache_Key;
+
+typedef struct {
+	SAT_Feature feature;
+	// Whether the hulls were penetrating when the feature was found. Only then it is the axis of minimum penetration.
+	boolean penetrating;
+	// The poses of the hulls when the feature was found
+	SAT_Hull_Pose pose1;
+	SAT_Hull_Pose pose2;
+	// Step in which the pair was last tested
+	u64 step;
+} SAT_Cache_Entry;
+
+typedef struct {
+	SAT_Cache_Key key;
+	SAT_Cache_Entry entry;
+} SAT_Cache_Update;
+
+boolean sat_can_collide_convex_hulls(const Collider_Convex_Hull* convex_hull1, const Collider_Convex_Hull* convex_hull2);
+// 'cache_key1' and 'cache_key2' identify the pair in the feature cache. They are the colliders themselves, unless these are
+// temporary views (e.g. of a box).
+// The cached feature of the pair is tested first. If it still separates the hulls, the test is over. If the hulls were
+// penetrating and neither of them moved by more than a small tolerance since the feature was found, the feature is reused
+// without testing the other axes.
+boolean sat_collides(Collider* collider1, Collider* collider2, const Collider* cache_key1, const Collider* cache_key2,
+	SAT_Result* result);
+
+// The feature cache is shared by all threads. While a recording is active on a thread, 'sat_collides' only reads the cache
+// there and appends the features it finds to 'updates' (a light array), which 'sat_cache_apply' writes to the cache later.
+// This way the narrowphase can run in parallel, and since the updates are applied in a fixed order the cache doesn't depend
+// on which thread tested which pair. Without a recording, the cache is written right away, so only one thread may then
+// call 'sat_collides'.
+void sat_cache_begin_recording(SAT_Cache_Update** updates);
+void sat_cache_end_recording();
+// No thread may be recording.
+void sat_cache_apply(const SAT_Cache_Update* updates);
+// Called at the end of each simulation step. Removes the pairs that were not tested during the step.
+void sat_cache_end_step();
+void sat_cache_destroy();
+
+// Boxes only need 15 axes to be tested: the 3 face normals of each box, plus the cross products of their axes.
+// For EDGES, 'index1' and 'index2' are the axes parallel to the edges. For faces, they follow the face indexing of Collider_Box.
+boolean sat_collides_boxes(const Collider_Box* box1, const Collider_Box* box2, SAT_Result* result);
+
+#endif
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "seesaw.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -49,23 +48,23 @@ int ex_seesaw_init() {
 	Mesh seesaw_support_mesh = graphics_mesh_create(seesaw_support_vertices, seesaw_support_indices);
 
 	vec3 floor_scale = {50.0, 1.0, 50.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, floor_scale);
-	entity_create_fixed(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_box_collider_array(floor_scale);
+	examples_util_create_fixed_entity(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, 0.0);
 
 	vec3 support_scale = {2.0, 0.5, 0.25};
-	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(seesaw_support_vertices, seesaw_support_indices, support_scale);
-	entity_create(seesaw_support_mesh, {0.0, -0.2f, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 90.0),
+	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(seesaw_support_vertices, support_scale);
+	examples_util_create_entity(seesaw_support_mesh, {0.0, -0.2f, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 90.0),
 		support_scale, {1.0, 1.0, 1.0, 1.0}, 1.0, support_colliders, 0.8, 0.8, 0.0);
 
 	vec3 platform_scale = {5.0, 0.03, 1.0};
-	Collider* platform_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, platform_scale);
-	entity_create(cube_mesh, {0.0, 0.5f, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
+	Collider* platform_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, platform_scale);
+	examples_util_create_entity(cube_mesh, {0.0, 0.5f, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
 		platform_scale, {1.0, 1.0, 1.0, 1.0}, 1.0, platform_colliders, 0.8, 0.8, 0.0);
 
 	vec3 cube_scale = {1.0, 1.0, 1.0};
-	Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, cube_scale);
-	entity_create(cube_mesh, {4.0, 2.0f, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
+	Collider* cube_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_scale);
+	examples_util_create_entity(cube_mesh, {4.0, 2.0f, 0.0}, quaternion_new({1.0, 0.0, 0.0}, 0.0),
 		cube_scale, {1.0, 1.0, 1.0, 1.0}, 0.5, cube_colliders, 0.8, 0.8, 0.0);
 
 	array_free(cube_vertices);
@@ -84,7 +83,7 @@ void ex_seesaw_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -118,55 +117,45 @@ void ex_seesaw_update(r64 delta_time) {
 }
 
 void ex_seesaw_render() {
-	Entity** entities = entity_get_all();
-
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_seesaw_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
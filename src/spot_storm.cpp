@@ -1,6 +1,5 @@
 #include "spot_storm.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
@@ -33,12 +32,13 @@ static Perspective_Camera create_camera() {
 	return camera;
 }
 
-static Collider* create_spot_colliders(vec3 scale, Vertex** hulls_vertices, u32** hulls_indices) {
+// All spots share the same hull shapes, only the world-space data is created per spot.
+static Collider* create_spot_colliders(Collider_Convex_Hull_Shape** hull_shapes) {
 	Collider* spot_colliders = array_new(Collider);
 	Collider collider;
 
-	for (u32 i = 0; i < array_length(hulls_vertices); ++i) {
-		collider = examples_util_create_convex_hull_collider(hulls_vertices[i], hulls_indices[i], scale);
+	for (u32 i = 0; i < array_length(hull_shapes); ++i) {
+		collider = collider_convex_hull_create_from_shape(hull_shapes[i]);
 		array_push(spot_colliders, collider);
 	}
 
@@ -68,8 +68,8 @@ int ex_spot_storm_init() {
 	Mesh cube_mesh = graphics_mesh_create(cube_vertices, cube_indices);
 
 	vec3 floor_scale = {50.0, 1.0, 50.0};
-	Collider* floor_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, floor_scale);
-	entity_create_fixed(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
+	Collider* floor_colliders = examples_util_create_single_box_collider_array(floor_scale);
+	examples_util_create_fixed_entity(cube_mesh, {0.0, -2.0, 0.0}, quaternion_new({0.0, 1.0, 0.0}, 0.0),
 		floor_scale, {1.0, 1.0, 1.0, 1.0}, floor_colliders, 0.5, 0.5, 0.0);
 	
 	Vertex* spot_vertices;
@@ -116,6 +116,11 @@ int ex_spot_storm_init() {
 	array_push(hulls_vertices, hull_vertices);
 	array_push(hulls_indices, hull_indices);
 
+	Collider_Convex_Hull_Shape** hull_shapes = array_new(Collider_Convex_Hull_Shape*);
+	for (u32 i = 0; i < array_length(hulls_vertices); ++i) {
+		array_push(hull_shapes, examples_util_create_convex_hull_shape(hulls_vertices[i], spot_scale));
+	}
+
 	const u32 N = 2;
 	r64 y = 2.0;
 	r64 gap = 3.5;
@@ -130,8 +135,8 @@ int ex_spot_storm_init() {
 			for (u32 k = 0; k < N; ++k) {
 				z += gap;
 
-				Collider* spot_colliders = create_spot_colliders(spot_scale, hulls_vertices, hulls_indices);
-				entity_create(spot_mesh, {x, y, z}, generate_random_quaternion(),
+				Collider* spot_colliders = create_spot_colliders(hull_shapes);
+				examples_util_create_entity(spot_mesh, {x, y, z}, generate_random_quaternion(),
 					spot_scale, util_pallete(i + j + k), 1.0, spot_colliders, 0.8, 0.8, 0.0);
 			}
 		}
@@ -147,6 +152,11 @@ int ex_spot_storm_init() {
 	}
 	array_free(hulls_vertices);
 	array_free(hulls_indices);
+	// The colliders keep their own references
+	for (u32 i = 0; i < array_length(hull_shapes); ++i) {
+		collider_convex_hull_shape_release(hull_shapes[i]);
+	}
+	array_free(hull_shapes);
 
 	return 0;
 }
@@ -159,7 +169,7 @@ void ex_spot_storm_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -191,54 +201,45 @@ void ex_spot_storm_update(r64 delta_time) {
 }
 
 void ex_spot_storm_render() {
-	Entity** entities = entity_get_all();
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
 }
 
 void ex_spot_storm_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 3.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_SPACE]) {
+	if (key_state[KEY_SPACE]) {
 		examples_util_throw_object(&camera, thrown_objects_initial_linear_velocity_norm);
-		key_state[GLFW_KEY_SPACE] = false;
+		key_state[KEY_SPACE] = false;
 	}
 }
 
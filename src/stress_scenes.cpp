@@ -0,0 +1,355 @@
+#include "stress_scenes.h"
+#include <stdio.h>
+#include <math.h>
+#include "light_array.h"
+#include "entity.h"
+#include "pbd.h"
+#include "util.h"
+
+#define NUM_SUBSTEPS 20
+#define NUM_POS_ITERS 1
+#define GRAVITY 10.0
+
+static Stress_Scene_Parameters parameters;
+static char name[64];
+static Constraint* constraints;
+// The parts of the compound bodies, shared by all of them
+static Collider_Convex_Hull_Shape* compound_shapes[3];
+
+static Collider* create_single_collider_array(Collider collider) {
+	Collider* colliders = array_new(Collider);
+	array_push(colliders, collider);
+	return colliders;
+}
+
+static eid create_box(vec3 position, Quaternion rotation, vec3 half_extents, r64 mass) {
+	Collider* colliders = create_single_collider_array(collider_box_create(half_extents));
+	return entity_create(position, rotation, mass, colliders, 0.6, 0.5, 0.0);
+}
+
+static eid create_fixed_box(vec3 position, vec3 half_extents) {
+	Collider* colliders = create_single_collider_array(collider_box_create(half_extents));
+	return entity_create_fixed(position, quaternion_new({0.0, 1.0, 0.0}, 0.0), colliders, 0.6, 0.5, 0.0);
+}
+
+// A fixed slab whose top face is at y = 0.
+static void create_ground(r64 half_size) {
+	create_fixed_box({0.0, -1.0, 0.0}, {half_size, 1.0, half_size});
+}
+
+static Quaternion random_rotation(Util_Random* random) {
+	vec3 axis = {
+		util_random_float(random, -1.0, 1.0),
+		util_random_float(random, -1.0, 1.0),
+		util_random_float(random, -1.0, 1.0)
+	};
+	if (gm_vec3_length(axis) < 1e-3) {
+		axis = {0.0, 1.0, 0.0};
+	}
+	return quaternion_new(gm_vec3_normalize(axis), util_random_float(random, 0.0, 360.0));
+}
+
+// Number of columns per side when 'count' bodies are stacked in a square footprint about as deep as it is wide.
+static u32 get_columns_per_side(u32 count) {
+	u32 num_layers = MAX(1, (u32)cbrt((r64)count));
+	return MAX(1, (u32)ceil(sqrt((r64)count / num_layers)));
+}
+
+static void create_cube_rain(Util_Random* random) {
+	const u32 N = parameters.width;
+	// More than the diagonal of the cubes plus the jitter, so that they don't overlap whatever their orientation
+	const r64 gap = 2.0;
+	create_ground(N * gap + 10.0);
+
+	r64 offset = -((r64)N - 1.0) * gap / 2.0;
+	for (u32 i = 0; i < N; ++i) {
+		for (u32 j = 0; j < N; ++j) {
+			for (u32 k = 0; k < N; ++k) {
+				vec3 position = {
+					offset + j * gap + util_random_float(random, -0.1, 0.1),
+					2.0 + i * gap,
+					offset + k * gap + util_random_float(random, -0.1, 0.1)
+				};
+				create_box(position, random_rotation(random), {0.5, 0.5, 0.5}, 1.0);
+			}
+		}
+	}
+}
+
+static void create_pyramid() {
+	const u32 H = parameters.width;
+	create_ground(H + 10.0);
+
+	for (u32 layer = 0; layer < H; ++layer) {
+		u32 side = H - layer;
+		r64 offset = -((r64)side - 1.0) / 2.0;
+		for (u32 j = 0; j < side; ++j) {
+			for (u32 k = 0; k < side; ++k) {
+				create_box({offset + j, 0.5 + layer, offset + k}, quaternion_new({0.0, 1.0, 0.0}, 0.0), {0.5, 0.5, 0.5}, 1.0);
+			}
+		}
+	}
+}
+
+static void create_brick_wall() {
+	const u32 W = parameters.width;
+	const u32 H = parameters.height;
+	const vec3 half_extents = {1.0, 0.5, 0.5};
+	create_ground(W * half_extents.x + 10.0);
+
+	r64 offset = -((r64)W - 1.0) * half_extents.x;
+	for (u32 row = 0; row < H; ++row) {
+		// Odd rows are shifted by half a brick
+		r64 row_offset = offset + ((row % 2) ? half_extents.x : 0.0);
+		for (u32 i = 0; i < W; ++i) {
+			vec3 position = {row_offset + i * 2.0 * half_extents.x, half_extents.y + row * 2.0 * half_extents.y, 0.0};
+			create_box(position, quaternion_new({0.0, 1.0, 0.0}, 0.0), half_extents, 1.0);
+		}
+	}
+}
+
+static void create_hinge_chains() {
+	const u32 M = parameters.width;
+	const u32 K = parameters.height;
+	// Links are a little shorter than the distance between joints, so that neighbouring links don't touch
+	const r64 joint_distance = 1.0;
+	const vec3 link_half_extents = {0.45, 0.1, 0.1};
+	const r64 chain_gap = 0.5;
+
+	constraints = array_new(Constraint);
+	r64 z_offset = -((r64)M - 1.0) * chain_gap / 2.0;
+	for (u32 i = 0; i < M; ++i) {
+		// The chains start horizontal, so they swing down in the XY plane
+		vec3 anchor_position = {0.0, K * joint_distance + 2.0, z_offset + i * chain_gap};
+		eid previous_id = create_fixed_box(anchor_position, {0.04, 0.04, 0.04});
+		vec3 previous_joint = {0.0, 0.0, 0.0};
+
+		for (u32 j = 0; j < K; ++j) {
+			vec3 position = gm_vec3_add(anchor_position, {(j + 0.5) * joint_distance, 0.0, 0.0});
+			eid id = create_box(position, quaternion_new({0.0, 1.0, 0.0}, 0.0), link_half_extents, 1.0);
+
+			Constraint constraint;
+			pbd_hinge_joint_constraint_unlimited_init(&constraint, previous_id, id, previous_joint, {-joint_distance / 2.0, 0.0, 0.0},
+				0.0, PBD_POSITIVE_Z_AXIS, PBD_POSITIVE_Z_AXIS);
+			array_push(constraints, constraint);
+
+			previous_id = id;
+			previous_joint = {joint_distance / 2.0, 0.0, 0.0};
+		}
+	}
+}
+
+static Collider_Convex_Hull_Shape* create_box_shape(vec3 center, vec3 half_extents) {
+	vec3* points = array_new(vec3);
+	for (u32 i = 0; i < 8; ++i) {
+		vec3 p = {
+			center.x + ((i & 1) ? half_extents.x : -half_extents.x),
+			center.y + ((i & 2) ? half_extents.y : -half_extents.y),
+			center.z + ((i & 4) ? half_extents.z : -half_extents.z)
+		};
+		array_push(points, p);
+	}
+	Collider_Convex_Hull_Shape* shape = collider_convex_hull_shape_create(points, 0);
+	array_free(points);
+	return shape;
+}
+
+static void create_compound_pile(Util_Random* random) {
+	const u32 N = parameters.width;
+	const r64 gap = 3.2;
+
+	// A dumbbell: a bar with a block on each end
+	compound_shapes[0] = create_box_shape({0.0, 0.0, 0.0}, {0.8, 0.15, 0.15});
+	compound_shapes[1] = create_box_shape({-1.0, 0.0, 0.0}, {0.3, 0.3, 0.3});
+	compound_shapes[2] = create_box_shape({1.0, 0.0, 0.0}, {0.3, 0.3, 0.3});
+
+	u32 side = get_columns_per_side(N);
+	create_ground(side * gap + 10.0);
+
+	r64 offset = -((r64)side - 1.0) * gap / 2.0;
+	for (u32 i = 0; i < N; ++i) {
+		u32 column = i % (side * side);
+		u32 layer = i / (side * side);
+		vec3 position = {
+			offset + (column % side) * gap + util_random_float(random, -0.2, 0.2),
+			2.0 + layer * gap,
+			offset + (column / side) * gap + util_random_float(random, -0.2, 0.2)
+		};
+
+		Collider* colliders = array_new(Collider);
+		for (u32 j = 0; j < 3; ++j) {
+			array_push(colliders, collider_convex_hull_create_from_shape(compound_shapes[j]));
+		}
+		entity_create(position, random_rotation(random), 1.0, colliders, 0.6, 0.5, 0.0);
+	}
+}
+
+static void create_sphere_bed(Util_Random* random) {
+	const u32 N = parameters.width;
+	const r32 radius = 0.5f;
+	const r64 gap = 1.05;
+
+	u32 side = get_columns_per_side(N);
+	r64 half_size = side * gap / 2.0 + 0.5;
+	create_ground(half_size + 10.0);
+
+	// The walls of the box, as high as the spheres are stacked initially
+	r64 wall_half_height = (N / (side * side) + 1) * gap / 2.0 + 1.0;
+	create_fixed_box({half_size + 0.5, wall_half_height, 0.0}, {0.5, wall_half_height, half_size + 1.0});
+	create_fixed_box({-half_size - 0.5, wall_half_height, 0.0}, {0.5, wall_half_height, half_size + 1.0});
+	create_fixed_box({0.0, wall_half_height, half_size + 0.5}, {half_size, wall_half_height, 0.5});
+	create_fixed_box({0.0, wall_half_height, -half_size - 0.5}, {half_size, wall_half_height, 0.5});
+
+	r64 offset = -((r64)side - 1.0) * gap / 2.0;
+	for (u32 i = 0; i < N; ++i) {
+		u32 column = i % (side * side);
+		u32 layer = i / (side * side);
+		vec3 position = {
+			offset + (column % side) * gap + util_random_float(random, -0.02, 0.02),
+			radius + 0.1 + layer * gap,
+			offset + (column / side) * gap + util_random_float(random, -0.02, 0.02)
+		};
+		Collider* colliders = create_single_collider_array(collider_sphere_create(radius));
+		entity_create(position, quaternion_new({0.0, 1.0, 0.0}, 0.0), 1.0, colliders, 0.6, 0.5, 0.0);
+	}
+}
+
+static int stress_scene_init() {
+	if (stress_scene_get_num_bodies(&parameters) > STRESS_SCENE_MAX_BODIES) {
+		fprintf(stderr, "stress scene '%s' has more than %u bodies\n", name, STRESS_SCENE_MAX_BODIES);
+		return -1;
+	}
+
+	entity_module_init();
+	constraints = NULL;
+
+	Util_Random random;
+	util_random_init(&random, parameters.seed);
+
+	switch (parameters.type) {
+		case STRESS_SCENE_CUBE_RAIN: create_cube_rain(&random); break;
+		case STRESS_SCENE_PYRAMID: create_pyramid(); break;
+		case STRESS_SCENE_BRICK_WALL: create_brick_wall(); break;
+		case STRESS_SCENE_HINGE_CHAINS: create_hinge_chains(); break;
+		case STRESS_SCENE_COMPOUND_PILE: create_compound_pile(&random); break;
+		case STRESS_SCENE_SPHERE_BED: create_sphere_bed(&random); break;
+		default: break;
+	}
+
+	return 0;
+}
+
+static void stress_scene_destroy() {
+	Entity** entities = entity_get_all();
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		Entity* e = entities[i];
+		colliders_destroy(e->colliders);
+		array_free(e->colliders);
+		entity_destroy(e);
+	}
+	array_free(entities);
+	entity_module_destroy();
+
+	if (constraints) {
+		array_free(constraints);
+		constraints = NULL;
+	}
+
+	for (u32 i = 0; i < 3; ++i) {
+		if (compound_shapes[i]) {
+			collider_convex_hull_shape_release(compound_shapes[i]);
+			compound_shapes[i] = NULL;
+		}
+	}
+}
+
+static void stress_scene_update(r64 delta_time) {
+	// The simulation brings the colliders of the entities that are close to something up to date itself
+	Entity** entities = entity_get_all();
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		if (entities[i]->fixed) continue;
+		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
+	}
+
+	pbd_simulate_with_constraints(delta_time, entities, constraints, NUM_SUBSTEPS, NUM_POS_ITERS, true, NULL);
+
+	for (u32 i = 0; i < array_length(entities); ++i) {
+		entity_clear_forces(entities[i]);
+	}
+	array_free(entities);
+}
+
+static void stress_scene_render() {
+}
+
+static void stress_scene_input_process(boolean*, r64) {
+}
+
+static void stress_scene_menu_update() {
+}
+
+static void stress_scene_mouse_change_process(boolean, r64, r64) {
+}
+
+static void stress_scene_mouse_click_process(s32, s32, r64, r64) {
+}
+
+static void stress_scene_scroll_change_process(r64, r64) {
+}
+
+static void stress_scene_window_resize_process(s32, s32) {
+}
+
+const char* stress_scene_get_type_name(Stress_Scene_Type type) {
+	switch (type) {
+		case STRESS_SCENE_CUBE_RAIN: return "cube_rain";
+		case STRESS_SCENE_PYRAMID: return "pyramid";
+		case STRESS_SCENE_BRICK_WALL: return "brick_wall";
+		case STRESS_SCENE_HINGE_CHAINS: return "hinge_chains";
+		case STRESS_SCENE_COMPOUND_PILE: return "compound_pile";
+		case STRESS_SCENE_SPHERE_BED: return "sphere_bed";
+		default: return "unknown";
+	}
+}
+
+u64 stress_scene_get_num_bodies(const Stress_Scene_Parameters* parameters) {
+	u64 width = parameters->width;
+	u64 height = parameters->height;
+	switch (parameters->type) {
+		case STRESS_SCENE_CUBE_RAIN: return width * width * width;
+		case STRESS_SCENE_PYRAMID: return width * (width + 1) * (2 * width + 1) / 6;
+		case STRESS_SCENE_BRICK_WALL: return width * height;
+		case STRESS_SCENE_HINGE_CHAINS: return width * height;
+		case STRESS_SCENE_COMPOUND_PILE: return width;
+		case STRESS_SCENE_SPHERE_BED: return width;
+		default: return 0;
+	}
+}
+
+Example_Scene stress_scene_get(const Stress_Scene_Parameters* scene_parameters) {
+	parameters = *scene_parameters;
+	switch (parameters.type) {
+		case STRESS_SCENE_BRICK_WALL:
+		case STRESS_SCENE_HINGE_CHAINS: {
+			snprintf(name, sizeof(name), "%s %ux%u", stress_scene_get_type_name(parameters.type), parameters.width, parameters.height);
+		} break;
+		default: {
+			snprintf(name, sizeof(name), "%s %u", stress_scene_get_type_name(parameters.type), parameters.width);
+		} break;
+	}
+
+	Example_Scene scene = {
+		.name = name,
+		.init = stress_scene_init,
+		.destroy = stress_scene_destroy,
+		.input_process = stress_scene_input_process,
+		.menu_properties_update = stress_scene_menu_update,
+		.mouse_change_process = stress_scene_mouse_change_process,
+		.mouse_click_process = stress_scene_mouse_click_process,
+		.render = stress_scene_render,
+		.scroll_change_process = stress_scene_scroll_change_process,
+		.update = stress_scene_update,
+		.window_resize_process = stress_scene_window_resize_process
+	};
+	return scene;
+}
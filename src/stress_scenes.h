@@ -0,0 +1,42 @@
+#ifndef RAW_PHYSICS_EXAMPLES_STRESS_SCENES_H
+#define RAW_PHYSICS_EXAMPLES_STRESS_SCENES_H
+
+#include "core.h"
+
+// Procedural scenes for benchmarking, whose size is given by parameters. They only create physics entities, nothing is drawn.
+// All randomness comes from the seed, so the same parameters always give the same scene.
+
+#define STRESS_SCENE_MAX_BODIES 100000
+
+typedef enum {
+	// width^3 cubes falling onto the ground with random orientations
+	STRESS_SCENE_CUBE_RAIN,
+	// A square pyramid of cubes, 'width' layers high
+	STRESS_SCENE_PYRAMID,
+	// A wall of 'width' x 'height' staggered bricks
+	STRESS_SCENE_BRICK_WALL,
+	// 'width' independent chains of 'height' links connected by hinge joints, hanging from a fixed anchor
+	STRESS_SCENE_HINGE_CHAINS,
+	// 'width' bodies made of three convex hulls each, falling onto a pile
+	STRESS_SCENE_COMPOUND_PILE,
+	// 'width' spheres settling into a box
+	STRESS_SCENE_SPHERE_BED,
+	STRESS_SCENE_COUNT
+} Stress_Scene_Type;
+
+typedef struct {
+	Stress_Scene_Type type;
+	u32 width;
+	// Only used by the brick wall and the hinge chains
+	u32 height;
+	u64 seed;
+} Stress_Scene_Parameters;
+
+// Returns a scene that creates the stress scene described by 'parameters' when it is initialized. The parameters are copied,
+// but only one stress scene can exist at a time. 'init' fails if the scene would have more than STRESS_SCENE_MAX_BODIES bodies.
+Example_Scene stress_scene_get(const Stress_Scene_Parameters* parameters);
+const char* stress_scene_get_type_name(Stress_Scene_Type type);
+// The number of bodies that the scene creates, not counting the fixed ones.
+u64 stress_scene_get_num_bodies(const Stress_Scene_Parameters* parameters);
+
+#endif
@@ -5,7 +5,7 @@
 u32 support_point_get_index(Collider_Convex_Hull* convex_hull, vec3 direction) {
 	u32 selected_index;
 	r64 max_dot = -DBL_MAX;
-	for (u32 i = 0; i < array_length(convex_hull->transformed_vertices); ++i) {
+	for (u32 i = 0; i < convex_hull->shape->num_vertices; ++i) {
 		r64 dot = gm_vec3_dot(convex_hull->transformed_vertices[i], direction);
 		if (dot > max_dot) {
 			selected_index = i;
@@ -25,6 +25,31 @@ vec3 support_point(Collider* collider, vec3 direction) {
 		case COLLIDER_TYPE_SPHERE: {
 			return gm_vec3_add(collider->sphere.center, gm_vec3_scalar_product(collider->sphere.radius, gm_vec3_normalize(direction)));
 		} break;
+		case COLLIDER_TYPE_BOX: {
+			const Collider_Box* box = &collider->box;
+			vec3 x = gm_vec3_scalar_product(gm_vec3_dot(box->axes[0], direction) >= 0.0 ? box->half_extents.x : -box->half_extents.x, box->axes[0]);
+			vec3 y = gm_vec3_scalar_product(gm_vec3_dot(box->axes[1], direction) >= 0.0 ? box->half_extents.y : -box->half_extents.y, box->axes[1]);
+			vec3 z = gm_vec3_scalar_product(gm_vec3_dot(box->axes[2], direction) >= 0.0 ? box->half_extents.z : -box->half_extents.z, box->axes[2]);
+			return gm_vec3_add(box->center, gm_vec3_add(x, gm_vec3_add(y, z)));
+		} break;
+		case COLLIDER_TYPE_CAPSULE: {
+			const Collider_Capsule* capsule = &collider->capsule;
+			r64 h = gm_vec3_dot(capsule->axis, direction) >= 0.0 ? capsule->half_height : -capsule->half_height;
+			vec3 sphere_center = gm_vec3_add(capsule->center, gm_vec3_scalar_product(h, capsule->axis));
+			return gm_vec3_add(sphere_center, gm_vec3_scalar_product(capsule->radius, gm_vec3_normalize(direction)));
+		} break;
+		case COLLIDER_TYPE_CYLINDER: {
+			const Collider_Cylinder* cylinder = &collider->cylinder;
+			r64 proj = gm_vec3_dot(cylinder->axis, direction);
+			vec3 cap_center = gm_vec3_add(cylinder->center,
+				gm_vec3_scalar_product(proj >= 0.0 ? cylinder->half_height : -cylinder->half_height, cylinder->axis));
+			vec3 radial = gm_vec3_subtract(direction, gm_vec3_scalar_product(proj, cylinder->axis));
+			r64 radial_length = gm_vec3_length(radial);
+			if (radial_length < 1e-12) {
+				return cap_center;
+			}
+			return gm_vec3_add(cap_center, gm_vec3_scalar_product(cylinder->radius / radial_length, radial));
+		} break;
 	}
 	
 	assert(0);
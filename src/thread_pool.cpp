@@ -0,0 +1,191 @@
+#include "thread_pool.h"
+#include "memory_tracker.h"
+#include "arena.h"
+#include <assert.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Chunks per thread. Having more chunks than threads balances the load when some items are much more expensive than others.
+#define CHUNKS_PER_THREAD 4
+#define MAX_THREADS 64
+
+typedef struct {
+	Thread_Pool_Task task;
+	void* data;
+	u32 count;
+	u32 num_chunks;
+	// Phase of the thread that started the job, which the workers take on while they run its chunks
+	Memory_Phase memory_phase;
+	std::atomic<u32> next_chunk;
+	std::atomic<u32> remaining_chunks;
+	// Number of workers inside 'run_chunks'. Protected by the mutex.
+	u32 num_active_workers;
+} Thread_Pool_Job;
+
+static std::thread workers[MAX_THREADS];
+// Scratch arena of each worker, set by the worker when it starts. Protected by the mutex.
+static Arena* worker_scratches[MAX_THREADS];
+static u32 num_workers;
+static std::mutex mutex;
+static std::condition_variable job_available;
+static std::condition_variable job_finished;
+// The job lives in the stack of the thread that called 'thread_pool_parallel_for'. It is NULL when there is no job running.
+// Protected by the mutex.
+static Thread_Pool_Job* current_job;
+// Incremented for every new job, so workers know when there is something new to do. Protected by the mutex.
+static u64 job_generation;
+static boolean shutting_down;
+
+static void get_chunk_range(u32 count, u32 num_chunks, u32 chunk_idx, u32* begin, u32* end) {
+	*begin = (u32)(((u64)count * chunk_idx) / num_chunks);
+	*end = (u32)(((u64)count * (chunk_idx + 1)) / num_chunks);
+}
+
+// Runs chunks of the job until there are none left.
+static void run_chunks(Thread_Pool_Job* job) {
+	for (;;) {
+		u32 chunk_idx = job->next_chunk.fetch_add(1);
+		if (chunk_idx >= job->num_chunks) {
+			return;
+		}
+
+		u32 begin, end;
+		get_chunk_range(job->count, job->num_chunks, chunk_idx, &begin, &end);
+		job->task(job->data, chunk_idx, begin, end);
+		job->remaining_chunks.fetch_sub(1);
+	}
+}
+
+static void worker_main(u32 worker_idx) {
+	Arena* worker_scratch = arena_get_scratch();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		worker_scratches[worker_idx] = worker_scratch;
+	}
+
+	u64 last_generation = 0;
+	for (;;) {
+		Thread_Pool_Job* job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			job_available.wait(lock, [&] { return shutting_down || job_generation != last_generation; });
+			if (shutting_down) {
+				worker_scratches[worker_idx] = NULL;
+				break;
+			}
+			last_generation = job_generation;
+			job = current_job;
+			if (!job) {
+				// We woke up too late, the job is already done
+				continue;
+			}
+			++job->num_active_workers;
+		}
+
+		memory_tracker_set_phase(job->memory_phase);
+		run_chunks(job);
+		memory_tracker_set_phase(MEMORY_PHASE_NONE);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--job->num_active_workers;
+		}
+		job_finished.notify_all();
+	}
+
+	arena_destroy_scratch();
+}
+
+void thread_pool_init(u32 num_threads) {
+	assert(num_workers == 0);
+	if (num_threads == 0) {
+		num_threads = std::thread::hardware_concurrency();
+	}
+
+	num_workers = CLAMP(num_threads, 1, MAX_THREADS) - 1;
+	shutting_down = false;
+	for (u32 i = 0; i < num_workers; ++i) {
+		workers[i] = std::thread(worker_main, i);
+	}
+}
+
+void thread_pool_destroy() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		shutting_down = true;
+	}
+	job_available.notify_all();
+
+	for (u32 i = 0; i < num_workers; ++i) {
+		workers[i].join();
+	}
+	num_workers = 0;
+}
+
+u32 thread_pool_get_num_threads() {
+	return num_workers + 1;
+}
+
+u32 thread_pool_get_num_chunks(u32 count, u32 min_chunk_size) {
+	if (count == 0) {
+		return 0;
+	}
+
+	u32 chunk_size = MAX(min_chunk_size, 1);
+	u32 max_chunks = (count + chunk_size - 1) / chunk_size;
+	u32 num_chunks = num_workers == 0 ? 1 : CHUNKS_PER_THREAD * thread_pool_get_num_threads();
+	return CLAMP(num_chunks, 1, max_chunks);
+}
+
+void thread_pool_parallel_for(u32 count, u32 min_chunk_size, Thread_Pool_Task task, void* data) {
+	u32 num_chunks = thread_pool_get_num_chunks(count, min_chunk_size);
+	if (num_chunks == 0) {
+		return;
+	}
+
+	if (num_workers == 0 || num_chunks == 1) {
+		for (u32 i = 0; i < num_chunks; ++i) {
+			u32 begin, end;
+			get_chunk_range(count, num_chunks, i, &begin, &end);
+			task(data, i, begin, end);
+		}
+		return;
+	}
+
+	Thread_Pool_Job job;
+	job.task = task;
+	job.data = data;
+	job.count = count;
+	job.num_chunks = num_chunks;
+	job.memory_phase = memory_tracker_get_phase();
+	job.next_chunk = 0;
+	job.remaining_chunks = num_chunks;
+	job.num_active_workers = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		current_job = &job;
+		++job_generation;
+	}
+	job_available.notify_all();
+
+	// The calling thread also works while it waits
+	run_chunks(&job);
+
+	// Workers might still be finishing their chunks, and they can't touch the job after we return
+	std::unique_lock<std::mutex> lock(mutex);
+	job_finished.wait(lock, [&] { return job.remaining_chunks.load() == 0 && job.num_active_workers == 0; });
+	current_job = NULL;
+}
+
+void thread_pool_reset_worker_scratches() {
+	std::lock_guard<std::mutex> lock(mutex);
+	assert(!current_job);
+	for (u32 i = 0; i < num_workers; ++i) {
+		if (worker_scratches[i]) {
+			arena_reset(worker_scratches[i]);
+		}
+	}
+}
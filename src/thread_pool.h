@@ -0,0 +1,25 @@
+#ifndef RAW_PHYSICS_THREAD_POOL_H
+#define RAW_PHYSICS_THREAD_POOL_H
+#include "common.h"
+
+// Processes the items [begin, end) of the chunk 'chunk_idx'.
+typedef void (*Thread_Pool_Task)(void* data, u32 chunk_idx, u32 begin, u32 end);
+
+// Creates the worker threads. If 'num_threads' is 0, one thread per hardware thread is used (including the calling thread).
+// If the pool is never initialized, all work runs serially on the calling thread.
+void thread_pool_init(u32 num_threads);
+void thread_pool_destroy();
+// Number of threads that run tasks, including the calling thread.
+u32 thread_pool_get_num_threads();
+// Number of chunks that 'thread_pool_parallel_for' will split 'count' items into.
+u32 thread_pool_get_num_chunks(u32 count, u32 min_chunk_size);
+// Splits [0, count) into contiguous chunks of about 'min_chunk_size' items or more, and runs 'task' for each chunk in the pool.
+// Since chunks are contiguous, results that are stored per chunk and merged in chunk order come out in item order, no matter
+// which thread ran each chunk. Blocks until all chunks are done. Must not be called from inside a task.
+void thread_pool_parallel_for(u32 count, u32 min_chunk_size, Thread_Pool_Task task, void* data);
+// Resets the scratch arenas of the worker threads, which tasks use for the results they hand back to the caller. Must be called
+// once the caller is done with them, and not while 'thread_pool_parallel_for' is running. The scratch arena of the calling
+// thread, which also runs tasks, is left alone.
+void thread_pool_reset_worker_scratches();
+
+#endif
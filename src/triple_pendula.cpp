@@ -1,9 +1,9 @@
 #include "triple_pendula.h"
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+#include "key_codes.h"
 #include "light_array.h"
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include "imgui.h"
 #include "graphics.h"
 #include "obj.h"
@@ -14,6 +14,7 @@
 #include "entity.h"
 #include "util.h"
 #include "examples_util.h"
+#include "physics_thread.h"
 
 static Perspective_Camera camera;
 static Light* lights;
@@ -43,6 +44,19 @@ static void reset_joint_distance(Entity* e1, Entity* e2, vec3 r1_lc, vec3 r2_lc)
 
 static eid base_id, piece_2_id, piece_3_id;
 
+typedef enum {
+	PUSH_PIECE_3,
+	PUSH_PIECE_2,
+	PUSH_BASE,
+	PUSH_COUNT
+} Push;
+
+// Whether the key of each push is held. The physics thread pushes once per step while it is, so the force doesn't depend on
+// how many frames are drawn per step. 'pushes_held' belongs to the physics thread and is set by a command whenever the keys
+// change, 'input_pushes_held' is what the input sent last.
+static boolean pushes_held[PUSH_COUNT];
+static boolean input_pushes_held[PUSH_COUNT];
+
 static Constraint* create_pendulum() {
 	Vertex* cube_vertices;
 	u32* cube_indices;
@@ -52,23 +66,23 @@ static Constraint* create_pendulum() {
 
 	vec3 support_position = {0.0, 0.0, -2.0};
 	vec3 support_collider_scale = {0.1, 0.1, 0.1};
-	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, support_collider_scale);
-	eid support_id = entity_create_fixed(cube_mesh, support_position, quaternion_new({0.0, 0.0, 0.0}, 0.0), support_collider_scale,
+	Collider* support_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, support_collider_scale);
+	eid support_id = examples_util_create_fixed_entity(cube_mesh, support_position, quaternion_new({0.0, 0.0, 0.0}, 0.0), support_collider_scale,
 		{0.0, 1.0, 0.0, 1.0}, support_colliders, 0.5, 0.5, 0.0);
 
 	vec3 base_collider_scale = {0.1, 1.0, 0.1};
-	Collider* base_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, base_collider_scale);
-	base_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), base_collider_scale,
+	Collider* base_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, base_collider_scale);
+	base_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), base_collider_scale,
 		{0x77 / 255.0, 0xc3 / 255.0, 0xec / 255.0}, 1.0, base_colliders, 0.6, 0.6, 0.0);
 
 	vec3 piece_2_collider_scale = {0.1, 1.0, 0.1};
-	Collider* piece_2_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, piece_2_collider_scale);
-	piece_2_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), piece_2_collider_scale,
+	Collider* piece_2_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, piece_2_collider_scale);
+	piece_2_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), piece_2_collider_scale,
 		{1.0, 1.0, 0.0, 1.0}, 1.0, piece_2_colliders, 0.6, 0.6, 0.0);
 
 	vec3 piece_3_collider_scale = {0.1, 0.5, 0.1};
-	Collider* piece_3_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, cube_indices, piece_3_collider_scale);
-	piece_3_id = entity_create(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), piece_3_collider_scale,
+	Collider* piece_3_colliders = examples_util_create_single_convex_hull_collider_array(cube_vertices, piece_3_collider_scale);
+	piece_3_id = examples_util_create_entity(cube_mesh, {0.0, 0.0, 0.0}, quaternion_new({0.0, 0.0, 0.0}, 0.0), piece_3_collider_scale,
 		{1.0, 1.0, 1.0, 1.0}, 1.0, piece_3_colliders, 0.6, 0.6, 0.0);
 
 	array_free(cube_vertices);
@@ -117,6 +131,8 @@ int ex_triple_pendula_init() {
 	lights = examples_util_create_lights();
 
 	constraints = create_pendulum();
+	memset(pushes_held, 0, sizeof(pushes_held));
+	memset(input_pushes_held, 0, sizeof(input_pushes_held));
 
 	return 0;
 }
@@ -129,7 +145,7 @@ void ex_triple_pendula_destroy() {
 		Entity* e = entities[i];
 		colliders_destroy(e->colliders);
 		array_free(e->colliders);
-		mesh_destroy(&e->mesh);
+		graphics_entity_render_data_destroy(e->id);
 		entity_destroy(e);
 	}
 	array_free(entities);
@@ -137,6 +153,16 @@ void ex_triple_pendula_destroy() {
 	entity_module_destroy();
 }
 
+static void push_piece(eid id, vec3 position) {
+	Entity* piece_entity = entity_get_by_id(id);
+	entity_add_force(piece_entity, position, {200.0, 0.0, 0.0}, true);
+	entity_activate(piece_entity);
+}
+
+static void set_pushes_held(void* data) {
+	memcpy(pushes_held, data, sizeof(pushes_held));
+}
+
 void ex_triple_pendula_update(r64 delta_time) {
 	Entity** entities = entity_get_all();
 	for (u32 i = 0; i < array_length(entities); ++i) {
@@ -151,7 +177,17 @@ void ex_triple_pendula_update(r64 delta_time) {
 		entity_add_force(entities[i], {0.0, 0.0, 0.0}, {0.0, -GRAVITY * 1.0 / entities[i]->inverse_mass, 0.0}, false);
 	}
 
-	pbd_simulate_with_constraints(delta_time, entities, constraints, 50, 50, false);
+	if (pushes_held[PUSH_PIECE_3]) {
+		push_piece(piece_3_id, {0.0, 0.0, 0.0});
+	}
+	if (pushes_held[PUSH_PIECE_2]) {
+		push_piece(piece_2_id, {0.0, -1.0, 0.0});
+	}
+	if (pushes_held[PUSH_BASE]) {
+		push_piece(base_id, {0.0, -1.0, 0.0});
+	}
+
+	pbd_simulate_with_constraints(delta_time, entities, constraints, 50, 50, false, NULL);
 
 	for (u32 i = 0; i < array_length(entities); ++i) {
 		entity_clear_forces(entities[i]);
@@ -160,81 +196,66 @@ void ex_triple_pendula_update(r64 delta_time) {
 }
 
 void ex_triple_pendula_render() {
-	Entity** entities = entity_get_all();
-
-	for (u32 i = 0; i < array_length(entities); ++i) {
-		graphics_entity_render_phong_shader(&camera, entities[i], lights);
-	}
+	examples_util_render_entities(&camera, lights);
 
 	graphics_renderer_primitives_flush(&camera);
-	array_free(entities);
+}
+
+static void stop_pieces(void* data) {
+	Entity* base_entity = entity_get_by_id(base_id);
+	Entity* piece_2_entity = entity_get_by_id(piece_2_id);
+	Entity* piece_3_entity = entity_get_by_id(piece_3_id);
+	base_entity->linear_velocity = {0.0, 0.0, 0.0};
+	base_entity->angular_velocity = {0.0, 0.0, 0.0};
+	piece_2_entity->linear_velocity = {0.0, 0.0, 0.0};
+	piece_2_entity->angular_velocity = {0.0, 0.0, 0.0};
+	piece_3_entity->linear_velocity = {0.0, 0.0, 0.0};
+	piece_3_entity->angular_velocity = {0.0, 0.0, 0.0};
 }
 
 void ex_triple_pendula_input_process(boolean* key_state, r64 delta_time) {
 	r64 movement_speed = 30.0;
 	r64 rotation_speed = 300.0;
 
-	if (key_state[GLFW_KEY_LEFT_SHIFT]) {
+	if (key_state[KEY_LEFT_SHIFT]) {
 		movement_speed = 0.5;
 	}
-	if (key_state[GLFW_KEY_RIGHT_SHIFT]) {
+	if (key_state[KEY_RIGHT_SHIFT]) {
 		movement_speed = 0.01;
 	}
 
-	if (key_state[GLFW_KEY_W]) {
+	if (key_state[KEY_W]) {
 		camera_move_forward(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_S]) {
+	if (key_state[KEY_S]) {
 		camera_move_forward(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_A]) {
+	if (key_state[KEY_A]) {
 		camera_move_right(&camera, -movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_D]) {
+	if (key_state[KEY_D]) {
 		camera_move_right(&camera, movement_speed * delta_time);
 	}
-	if (key_state[GLFW_KEY_L]) {
+	if (key_state[KEY_L]) {
 		static boolean wireframe = false;
 
-		if (wireframe) {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		} else {
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		}
-
 		wireframe = !wireframe;
-		key_state[GLFW_KEY_L] = false;
-	}
-
-	if (key_state[GLFW_KEY_M]) {
-		Entity* piece_3_entity = entity_get_by_id(piece_3_id);
-		entity_add_force(piece_3_entity, {0.0, 0.0, 0.0}, {200.0, 0.0, 0.0}, true);
-		entity_activate(piece_3_entity);
-	}
-
-	if (key_state[GLFW_KEY_N]) {
-		Entity* piece_2_entity = entity_get_by_id(piece_2_id);
-		entity_add_force(piece_2_entity, {0.0, -1.0, 0.0}, {200.0, 0.0, 0.0}, true);
-		entity_activate(piece_2_entity);
+		graphics_set_wireframe(wireframe);
+		key_state[KEY_L] = false;
 	}
 
-	if (key_state[GLFW_KEY_B]) {
-		Entity* piece_1_entity = entity_get_by_id(base_id);
-		entity_add_force(piece_1_entity, {0.0, -1.0, 0.0}, {200.0, 0.0, 0.0}, true);
-		entity_activate(piece_1_entity);
+	boolean keys_held[PUSH_COUNT];
+	keys_held[PUSH_PIECE_3] = key_state[KEY_M];
+	keys_held[PUSH_PIECE_2] = key_state[KEY_N];
+	keys_held[PUSH_BASE] = key_state[KEY_B];
+	if (memcmp(keys_held, input_pushes_held, sizeof(keys_held)) != 0) {
+		memcpy(input_pushes_held, keys_held, sizeof(keys_held));
+		physics_thread_push_command(set_pushes_held, keys_held, sizeof(keys_held));
 	}
 
-	if (key_state[GLFW_KEY_V]) {
-		Entity* base_entity = entity_get_by_id(base_id);
-		Entity* piece_2_entity = entity_get_by_id(piece_2_id);
-		Entity* piece_3_entity = entity_get_by_id(piece_3_id);
-		base_entity->linear_velocity = {0.0, 0.0, 0.0};
-		base_entity->angular_velocity = {0.0, 0.0, 0.0};
-		piece_2_entity->linear_velocity = {0.0, 0.0, 0.0};
-		piece_2_entity->angular_velocity = {0.0, 0.0, 0.0};
-		piece_3_entity->linear_velocity = {0.0, 0.0, 0.0};
-		piece_3_entity->angular_velocity = {0.0, 0.0, 0.0};
-		key_state[GLFW_KEY_V] = false;
+	if (key_state[KEY_V]) {
+		physics_thread_push_command(stop_pieces, NULL, 0);
+		key_state[KEY_V] = false;
 	}
 }
 
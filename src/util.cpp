@@ -6,8 +6,20 @@
 #include "entity.h"
 #include <limits.h>
 
-r64 util_random_float(r64 min, r64 max) {
-	r64 scale = rand() / (r64)RAND_MAX;
+void util_random_init(Util_Random* random, u64 seed) {
+	random->state = seed;
+}
+
+u64 util_random_u64(Util_Random* random) {
+	u64 z = (random->state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+r64 util_random_float(Util_Random* random, r64 min, r64 max) {
+	// The top 53 bits give every double in [0, 1) with the same spacing
+	r64 scale = (util_random_u64(random) >> 11) * (1.0 / 9007199254740992.0);
 	return min + scale * (max - min);
 }
 
@@ -122,32 +134,3 @@ vec4 util_pallete(u32 n) {
 	u32 idx = n % COLOR_PALETTE_MAX_NUM;
 	return color_palette[idx];
 }
-
-// Hash Utils
-
-int util_eid_compare(const void *key1, const void *key2) {
-	eid id1 = *(eid*)key1;
-	eid id2 = *(eid*)key2;
-	return id1 == id2;
-}
-
-unsigned int util_eid_hash(const void *key) {
-	eid id = *(eid*)key;
-	return (unsigned int)id;
-}
-
-int util_vec3_compare(const void *key1, const void *key2) {
-	vec3 v1 = *(vec3*)key1;
-	vec3 v2 = *(vec3*)key2;
-	return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
-}
-
-unsigned int util_vec3_hash(const void *key) {
-	vec3 v = *(vec3*)key;
-	unsigned long long x, y, z;
-	assert(sizeof(r64) == sizeof(unsigned long long));
-	memcpy(&x, &v.x, sizeof(r64));
-	memcpy(&y, &v.y, sizeof(r64));
-	memcpy(&z, &v.z, sizeof(r64));
-	return (unsigned int)((x + y + z) % UINT_MAX);
-}
\ No newline at end of file